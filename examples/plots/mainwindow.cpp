@@ -1115,7 +1115,7 @@ void MainWindow::realtimeDataSlot()
     ui->statusBar->showMessage(
           QString("%1 FPS, Total Data points: %2")
           .arg(frameCount/(key-lastFpsKey), 0, 'f', 0)
-          .arg(ui->customPlot->graph(0)->data()->count()+ui->customPlot->graph(1)->data()->count())
+          .arg(ui->customPlot->graph(0)->data()->size()+ui->customPlot->graph(1)->data()->size())
           , 0);
     lastFpsKey = key;
     frameCount = 0;
@@ -1156,7 +1156,7 @@ void MainWindow::bracketDataSlot()
     ui->statusBar->showMessage(
           QString("%1 FPS, Total Data points: %2")
           .arg(frameCount/(key-lastFpsKey), 0, 'f', 0)
-          .arg(ui->customPlot->graph(0)->data()->count())
+          .arg(ui->customPlot->graph(0)->data()->size())
           , 0);
     lastFpsKey = key;
     frameCount = 0;
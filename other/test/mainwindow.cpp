@@ -549,8 +549,8 @@ void MainWindow::daqPerformanceDataSlot()
 void MainWindow::daqPerformanceReplotSlot()
 {
   double lastX = 0;
-  if (mCustomPlot->graph(0)->data()->end() != mCustomPlot->graph(0)->data()->begin())
-    lastX = (mCustomPlot->graph(0)->data()->end()-1).key();
+  if (!mCustomPlot->graph(0)->data()->isEmpty())
+    lastX = mCustomPlot->graph(0)->data()->last().key;
   mCustomPlot->xAxis->setRange(lastX, 10, Qt::AlignRight);
   mCustomPlot->replot();
   
@@ -51,7 +51,9 @@ QCPPainter::QCPPainter() :
   QPainter(),
   mScaledExportMode(false),
   mPdfExportMode(false),
-  mIsAntialiasing(false)
+  mDraftMode(false),
+  mIsAntialiasing(false),
+  mCurrentScatterStamp(-1)
 {
 }
 
@@ -63,7 +65,9 @@ QCPPainter::QCPPainter(QPaintDevice *device) :
   QPainter(device),
   mScaledExportMode(false),
   mPdfExportMode(false),
-  mIsAntialiasing(false)
+  mDraftMode(false),
+  mIsAntialiasing(false),
+  mCurrentScatterStamp(-1)
 {
 }
 
@@ -136,6 +140,27 @@ void QCPPainter::drawLine(const QLineF &line)
     QPainter::drawLine(line.toLine());
 }
 
+/*! \overload
+  
+  Draws all \a lines with one call, applying the same workaround as \ref drawLine when
+  antialiasing is disabled.
+  
+  \note this function hides the non-virtual base class implementation.
+*/
+void QCPPainter::drawLines(const QVector<QLineF> &lines)
+{
+  if (mIsAntialiasing)
+  {
+    QPainter::drawLines(lines);
+  } else
+  {
+    QVector<QLine> roundedLines(lines.size());
+    for (int i=0; i<lines.size(); ++i)
+      roundedLines[i] = lines.at(i).toLine();
+    QPainter::drawLines(roundedLines);
+  }
+}
+
 /*! 
   Sets whether painting uses antialiasing or not. Use this method instead of using setRenderHint
   with QPainter::Antialiasing directly, as it allows QCPPainter to regain pixel exactness between
@@ -213,6 +238,35 @@ void QCPPainter::setScaledExportMode(bool enabled)
   mScaledExportMode = enabled;
 }
 
+/*!
+  Sets whether the painter is used to draw an intermediate frame during a user interaction, such
+  as dragging or zooming an axis range.
+
+  Plottables may then reduce their level of detail to keep the interaction responsive, see \ref
+  QCustomPlot::setDraftPointBudget. QCustomPlot sets this mode itself where appropriate; painters
+  used for exporting never are in draft mode.
+*/
+void QCPPainter::setDraftMode(bool enabled)
+{
+  mDraftMode = enabled;
+}
+
+/*!
+  Sets the \a region (in the coordinates the layerables draw in) that is actually rendered with
+  this painter, including a margin for scatter symbols and pen widths of data points just outside
+  of it. Plottables may then skip generating the geometry of data points outside of \a region.
+
+  QCustomPlot sets this when it renders only a narrow strip of the axis rect, see
+  QCP::phScrollOnDrag. The default is a null rect, meaning the whole axis rect is rendered.
+
+  Unlike a clip rect, this doesn't limit the drawing itself, so the painter should additionally be
+  clipped to the region.
+*/
+void QCPPainter::setDataRegion(const QRectF &region)
+{
+  mDataRegion = region;
+}
+
 /*!
   Provides a workaround for a QPainter bug that prevents scaling of pen widths for pens with width
   0, although the QPainter::NonCosmeticDefaultPen render hint is set.
@@ -236,8 +290,333 @@ void QCPPainter::fixScaledPen()
   
   If the \a style is ssPixmap, make sure to pass the respective pixmap with \ref setScatterPixmap before calling
   this function.
+  
+  When painting on a raster paint device, the symbols are drawn as pre-rendered stamps (see \ref drawScatterStamp).
 */
 void QCPPainter::drawScatter(double x, double y, double size, QCP::ScatterStyle style)
+{
+  if (scatterStampUsable(size, style))
+    drawScatterStamp(x, y, size, style);
+  else
+    drawScatterShape(x, y, size, style);
+}
+
+/*!
+  Draws scatter symbols with the specified \a style and \a size in pixels at all pixel positions
+  in \a points. The result is the same as calling \ref drawScatter for each point.
+  
+  When exporting to a vector format such as PDF, the symbols of all points are combined into one
+  painter path, which is drawn at once. The paint engine then emits a single path object instead
+  of one per symbol, which reduces export time and file size considerably for many points.
+  
+  Unlike \ref drawScatter, this leaves the brush of the painter unchanged.
+*/
+void QCPPainter::drawScatters(const QVector<QPointF> &points, double size, QCP::ScatterStyle style)
+{
+  if (points.isEmpty() || style == QCP::ssNone)
+    return;
+  const QBrush oldBrush = brush();
+  if (!vectorExport() || style == QCP::ssPixmap)
+  {
+    for (int i=0; i<points.size(); ++i)
+      drawScatter(points.at(i).x(), points.at(i).y(), size, style);
+  } else if (style == QCP::ssDot)
+  {
+    drawPoints(points.constData(), points.size());
+  } else
+  {
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill); // overlapping discs mustn't cancel each other out
+    for (int i=0; i<points.size(); ++i)
+      addScatterShape(&path, points.at(i).x(), points.at(i).y(), size, style);
+    setBrush(style == QCP::ssDisc ? QBrush(pen().color()) : QBrush(Qt::NoBrush));
+    drawPath(path);
+  }
+  setBrush(oldBrush);
+}
+
+/*! \internal
+  
+  Returns \a end moved away from \a from by \a distance, i.e. the end point of the segment from \a
+  from to \a end, when the segment is extended by \a distance. Used by \ref drawPolylineChunked to
+  emulate square caps.
+*/
+static QPointF qcpExtendSegment(const QPointF &from, const QPointF &end, double distance)
+{
+  QPointF dir = end-from;
+  double length = qSqrt(dir.x()*dir.x()+dir.y()*dir.y());
+  if (length == 0)
+    return end;
+  return end+dir*(distance/length);
+}
+
+/*! \internal
+  
+  Adds a half disc with the given \a radius to \a path, centered on \a end and facing away from \a
+  from. Used by \ref drawPolylineChunked to emulate round caps.
+*/
+static void qcpAddRoundCap(QPainterPath *path, const QPointF &from, const QPointF &end, double radius)
+{
+  QPointF dir = end-from;
+  if (dir.x() == 0 && dir.y() == 0)
+    return;
+  double angle = qAtan2(-dir.y(), dir.x())/M_PI*180.0; // counter-clockwise on screen, like QPainterPath::arcTo
+  path->moveTo(end);
+  path->arcTo(QRectF(end.x()-radius, end.y()-radius, 2*radius, 2*radius), angle-90, 180);
+  path->closeSubpath();
+}
+
+/*!
+  Draws the polyline through \a points like QPainter::drawPolyline, but submits it in chunks of at
+  most \a chunkSize points. The cost of stroking a polyline grows faster than linearly with the
+  number of points (especially for antialiased, wide or dashed pens), so drawing very long
+  polylines in chunks is considerably faster.
+  
+  Each chunk ends in the middle of the segment following its last point, where the next chunk
+  starts. So all joins are drawn by one chunk, and the chunks abut on a straight segment without
+  overlapping, with a flat cap at both sides. Every pixel is thus painted once, which keeps
+  antialiased edges intact. The caps at the two ends of the polyline are emulated: Square caps by
+  extending the first and last segment by half the pen width, round caps by adding half discs.
+  Dashed pens continue their dash offset across chunk boundaries. Their dashes are drawn with a flat
+  cap, too, a square cap is emulated by lengthening the dashes of the pattern by one pen width and
+  shortening the gaps accordingly.
+  
+  The polyline is drawn at once if it has at most \a chunkSize points, if \a chunkSize is smaller
+  than 3 or if the painter is in PDF export mode. This is also the case for cosmetic pens, whose
+  stroking cost is linear anyway, for dashed pens with round caps or with gaps narrower than the
+  square caps, and if the seams between the chunks could be visible, i.e. for pens that aren't
+  opaque, a painter opacity below one or composition modes other than SourceOver.
+  
+  If \a chunkSize is negative, the chunk size is chosen for the current pen, see \ref
+  autoPolylineChunkSize.
+  
+  \see QCustomPlot::setPolylineChunkSize
+*/
+void QCPPainter::drawPolylineChunked(const QVector<QPointF> &points, int chunkSize)
+{
+  const int count = points.size();
+  const QPen originalPen = pen();
+  if (chunkSize < 0)
+    chunkSize = autoPolylineChunkSize(originalPen);
+  const bool solid = originalPen.style() == Qt::SolidLine;
+  const Qt::PenCapStyle capStyle = originalPen.capStyle();
+  QVector<qreal> dashPattern;
+  if (!solid && capStyle == Qt::SquareCap)
+  {
+    // a square cap adds half a pen width to both ends of every dash:
+    dashPattern = originalPen.dashPattern();
+    for (int i=0; i<dashPattern.size(); ++i)
+    {
+      dashPattern[i] += i%2 == 0 ? 1 : -1;
+      if (dashPattern.at(i) < 0)
+      {
+        dashPattern.clear(); // the square caps of neighbouring dashes overlap, can't be emulated
+        chunkSize = 0;
+        break;
+      }
+    }
+  }
+  if (chunkSize < 3 || count <= chunkSize || mPdfExportMode || originalPen.isCosmetic() || (!solid && capStyle == Qt::RoundCap) ||
+      !originalPen.brush().isOpaque() || opacity() < 1 || compositionMode() != QPainter::CompositionMode_SourceOver)
+  {
+    drawPolyline(points.constData(), count);
+    return;
+  }
+  
+  const double halfWidth = originalPen.widthF()*0.5;
+  QPen chunkPen = originalPen;
+  chunkPen.setCapStyle(Qt::FlatCap);
+  if (!dashPattern.isEmpty())
+    chunkPen.setDashPattern(dashPattern);
+  double length = 0; // length of the drawn polyline up to the first point of the current chunk, for the dash offset
+  QVector<QPointF> chunk;
+  chunk.reserve(chunkSize);
+  QPointF chunkStart = capStyle == Qt::SquareCap ? qcpExtendSegment(points.at(1), points.at(0), halfWidth) : points.at(0);
+  int first = 1; // index of the first original point after chunkStart
+  while (true)
+  {
+    int last = qMin(first+chunkSize-3, count-1);
+    while (last < count-1 && points.at(last) == points.at(last+1)) // don't end a chunk on a segment without direction
+      ++last;
+    chunk.resize(0);
+    chunk.append(chunkStart);
+    for (int i=first; i<=last; ++i)
+      chunk.append(points.at(i));
+    if (last < count-1)
+      chunk.append((points.at(last)+points.at(last+1))*0.5);
+    else if (capStyle == Qt::SquareCap)
+      chunk.last() = qcpExtendSegment(points.at(count-2), points.at(count-1), halfWidth);
+    if (!solid)
+      chunkPen.setDashOffset(originalPen.dashOffset()+length/originalPen.widthF()); // dash patterns are in units of the pen width
+    setPen(chunkPen);
+    drawPolyline(chunk.constData(), chunk.size());
+    if (last == count-1)
+      break;
+    if (!solid)
+    {
+      for (int i=1; i<chunk.size(); ++i)
+        length += QLineF(chunk.at(i-1), chunk.at(i)).length();
+    }
+    chunkStart = chunk.last();
+    first = last+1;
+  }
+  setPen(originalPen);
+  
+  if (solid && capStyle == Qt::RoundCap)
+  {
+    QPainterPath caps;
+    qcpAddRoundCap(&caps, points.at(1), points.at(0), halfWidth);
+    qcpAddRoundCap(&caps, points.at(count-2), points.at(count-1), halfWidth);
+    const QBrush oldBrush = brush();
+    setPen(Qt::NoPen);
+    setBrush(originalPen.brush());
+    drawPath(caps);
+    setBrush(oldBrush);
+    setPen(originalPen);
+  }
+}
+
+/*! \internal
+  
+  Returns the chunk size \ref drawPolylineChunked uses for polylines drawn with \a pen, if no
+  chunk size is specified. The value depends on the pen class. The values below are estimates
+  derived from how the raster engine strokes each class, they haven't been tuned by measurement
+  yet. The benchmark QCPGraph_ChunkedPolyline (tests/benchmark) compares them with fixed chunk
+  sizes for each class:
+  
+  \li Thin solid pens (width of at most one) are drawn by the cosmetic stroker of the raster
+  engine, or nearly as cheaply, so their cost is linear in the number of points. They aren't
+  chunked (returns 0).
+  \li Wide solid pens are stroked into an outline which is then filled. This gets expensive for
+  long polylines, chunks of 200 points keep it cheap without submitting too many small chunks.
+  \li Dashed pens create a separate subpath for every dash, so the outlines grow faster with the
+  number of points. They use smaller chunks of 100 points.
+*/
+int QCPPainter::autoPolylineChunkSize(const QPen &pen) const
+{
+  if (pen.style() != Qt::SolidLine)
+    return 100;
+  else if (pen.widthF() > 1)
+    return 200;
+  else
+    return 0;
+}
+
+/*! \internal
+  
+  Returns whether the painter is used for exporting to a vector format, like PDF (see \ref
+  setPdfExportMode) or PostScript. Scatters are then batched by \ref drawScatters.
+*/
+bool QCPPainter::vectorExport() const
+{
+  if (mPdfExportMode)
+    return true;
+  if (!paintEngine())
+    return false;
+  QPaintEngine::Type type = paintEngine()->type();
+  return type == QPaintEngine::Pdf || type == QPaintEngine::PostScript || type == QPaintEngine::SVG || type == QPaintEngine::MacPrinter;
+}
+
+/*! \internal
+  
+  Returns whether a scatter of the given \a size and \a style may be drawn by \ref
+  drawScatterStamp. This is the case for the vector shaped scatter styles of moderate size, when
+  painting on a raster paint engine without a transformation other than a translation. PDF export,
+  scaled export, QPicture recording and other paint engines use the vector path.
+*/
+bool QCPPainter::scatterStampUsable(double size, QCP::ScatterStyle style) const
+{
+  if (style == QCP::ssNone || style == QCP::ssDot || style == QCP::ssPixmap)
+    return false;
+  if (mPdfExportMode || size > 64)
+    return false;
+  if (!paintEngine() || paintEngine()->type() != QPaintEngine::Raster)
+    return false;
+  return transform().type() <= QTransform::TxTranslate && compositionMode() == QPainter::CompositionMode_SourceOver;
+}
+
+/*! \internal
+  
+  Draws the scatter like \ref drawScatterShape, but by drawing a pre-rendered image (stamp) of the
+  scatter symbol. Stamps are rendered once per combination of scatter style, size, pen,
+  antialiasing and sub-pixel translation, with a separate image for every quarter pixel offset of
+  the symbol center, and are kept for the lifetime of the painter. For plots with many scatters,
+  this is a lot faster than stroking each symbol.
+  
+  Non-antialiased symbols are placed exactly like the vector path places them (for symbol sizes
+  that are multiples of 0.5 pixels), antialiased ones with quarter pixel precision.
+  
+  \see scatterStampUsable
+*/
+void QCPPainter::drawScatterStamp(double x, double y, double size, QCP::ScatterStyle style)
+{
+  const QTransform &t = transform();
+  QPointF translation(t.dx()-floor(t.dx()), t.dy()-floor(t.dy()));
+  
+  // find the stamp for the current painter state, starting with the one used last:
+  if (mCurrentScatterStamp < 0 || mScatterStamps.at(mCurrentScatterStamp).style != style || mScatterStamps.at(mCurrentScatterStamp).size != size ||
+      mScatterStamps.at(mCurrentScatterStamp).antialiasing != mIsAntialiasing || mScatterStamps.at(mCurrentScatterStamp).translation != translation ||
+      mScatterStamps.at(mCurrentScatterStamp).pen != pen())
+  {
+    mCurrentScatterStamp = -1;
+    for (int i=0; i<mScatterStamps.size(); ++i)
+    {
+      const ScatterStamp &stamp = mScatterStamps.at(i);
+      if (stamp.style == style && stamp.size == size && stamp.antialiasing == mIsAntialiasing && stamp.translation == translation && stamp.pen == pen())
+      {
+        mCurrentScatterStamp = i;
+        break;
+      }
+    }
+    if (mCurrentScatterStamp < 0)
+    {
+      if (mScatterStamps.size() >= 8) // painter states usually alternate between few stamps, drop the oldest one
+        mScatterStamps.removeFirst();
+      ScatterStamp stamp;
+      stamp.style = style;
+      stamp.size = size;
+      stamp.pen = pen();
+      stamp.antialiasing = mIsAntialiasing;
+      stamp.translation = translation;
+      stamp.center = qCeil(size/2.0+qMax(1.0, pen().widthF())+2);
+      mScatterStamps.append(stamp);
+      mCurrentScatterStamp = mScatterStamps.size()-1;
+    }
+  }
+  ScatterStamp &stamp = mScatterStamps[mCurrentScatterStamp];
+  
+  // split the position into whole pixels and a quarter pixel offset (rounded for antialiased
+  // symbols, truncated for non-antialiased ones, so the rounding of drawLine is reproduced):
+  double ix = floor(x);
+  double iy = floor(y);
+  int qx = int((x-ix)*4+(mIsAntialiasing ? 0.5 : 0));
+  int qy = int((y-iy)*4+(mIsAntialiasing ? 0.5 : 0));
+  if (qx > 3) { ix += 1; qx = 0; }
+  if (qy > 3) { iy += 1; qy = 0; }
+  
+  QImage &image = stamp.images[4*qy+qx];
+  if (image.isNull())
+  {
+    image = QImage(2*stamp.center+2, 2*stamp.center+2, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+    QCPPainter stampPainter(&image);
+    stampPainter.setRenderHints(renderHints());
+    stampPainter.mIsAntialiasing = mIsAntialiasing;
+    stampPainter.translate(translation);
+    stampPainter.QPainter::setPen(stamp.pen);
+    stampPainter.drawScatterShape(stamp.center+qx*0.25, stamp.center+qy*0.25, size, style);
+  }
+  // ix-center-translation maps to a whole device pixel, so the image is drawn without resampling:
+  drawImage(QPointF(ix-stamp.center-translation.x(), iy-stamp.center-translation.y()), image);
+}
+
+/*! \internal
+  
+  Draws the scatter symbol of the given \a size and \a style at \a x and \a y by stroking its
+  vector shape with the current pen. This is the path used by \ref drawScatter where stamps
+  aren't usable (see \ref drawScatterStamp).
+*/
+void QCPPainter::drawScatterShape(double x, double y, double size, QCP::ScatterStyle style)
 {
   double w = size/2.0;
   switch (style)
@@ -359,6 +738,136 @@ void QCPPainter::drawScatter(double x, double y, double size, QCP::ScatterStyle
   }
 }
 
+/*! \internal
+  
+  Adds the vector shape of a scatter symbol of the given \a size and \a style at \a x and \a y
+  to \a path, matching the shape drawn by \ref drawScatterShape. Used by \ref drawScatters to
+  combine many symbols into one path. Only vector shaped styles are supported, i.e. not
+  QCP::ssNone, QCP::ssDot and QCP::ssPixmap.
+*/
+void QCPPainter::addScatterShape(QPainterPath *path, double x, double y, double size, QCP::ScatterStyle style) const
+{
+  double w = size/2.0;
+  switch (style)
+  {
+    case QCP::ssCross:
+    {
+      path->moveTo(x-w, y-w);
+      path->lineTo(x+w, y+w);
+      path->moveTo(x-w, y+w);
+      path->lineTo(x+w, y-w);
+      break;
+    }
+    case QCP::ssPlus:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x+w, y);
+      path->moveTo(x, y+w);
+      path->lineTo(x, y-w);
+      break;
+    }
+    case QCP::ssCircle:
+    case QCP::ssDisc:
+    {
+      path->addEllipse(QPointF(x, y), w, w);
+      break;
+    }
+    case QCP::ssSquare:
+    {
+      path->addRect(QRectF(x-w, y-w, size, size));
+      break;
+    }
+    case QCP::ssDiamond:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x, y-w);
+      path->lineTo(x+w, y);
+      path->lineTo(x, y+w);
+      path->closeSubpath();
+      break;
+    }
+    case QCP::ssStar:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x+w, y);
+      path->moveTo(x, y+w);
+      path->lineTo(x, y-w);
+      path->moveTo(x-w*0.707, y-w*0.707);
+      path->lineTo(x+w*0.707, y+w*0.707);
+      path->moveTo(x-w*0.707, y+w*0.707);
+      path->lineTo(x+w*0.707, y-w*0.707);
+      break;
+    }
+    case QCP::ssTriangle:
+    {
+      path->moveTo(x-w, y+0.755*w);
+      path->lineTo(x+w, y+0.755*w);
+      path->lineTo(x, y-0.977*w);
+      path->closeSubpath();
+      break;
+    }
+    case QCP::ssTriangleInverted:
+    {
+      path->moveTo(x-w, y-0.755*w);
+      path->lineTo(x+w, y-0.755*w);
+      path->lineTo(x, y+0.977*w);
+      path->closeSubpath();
+      break;
+    }
+    case QCP::ssCrossSquare:
+    {
+      path->moveTo(x-w, y-w);
+      path->lineTo(x+w*0.95, y+w*0.95);
+      path->moveTo(x-w, y+w*0.95);
+      path->lineTo(x+w*0.95, y-w);
+      path->addRect(QRectF(x-w, y-w, size, size));
+      break;
+    }
+    case QCP::ssPlusSquare:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x+w*0.95, y);
+      path->moveTo(x, y+w);
+      path->lineTo(x, y-w);
+      path->addRect(QRectF(x-w, y-w, size, size));
+      break;
+    }
+    case QCP::ssCrossCircle:
+    {
+      path->moveTo(x-w*0.707, y-w*0.707);
+      path->lineTo(x+w*0.67, y+w*0.67);
+      path->moveTo(x-w*0.707, y+w*0.67);
+      path->lineTo(x+w*0.67, y-w*0.707);
+      path->addEllipse(QPointF(x, y), w, w);
+      break;
+    }
+    case QCP::ssPlusCircle:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x+w, y);
+      path->moveTo(x, y+w);
+      path->lineTo(x, y-w);
+      path->addEllipse(QPointF(x, y), w, w);
+      break;
+    }
+    case QCP::ssPeace:
+    {
+      path->moveTo(x, y-w);
+      path->lineTo(x, y+w);
+      path->moveTo(x, y);
+      path->lineTo(x-w*0.707, y+w*0.707);
+      path->moveTo(x, y);
+      path->lineTo(x+w*0.707, y+w*0.707);
+      path->addEllipse(QPointF(x, y), w, w);
+      break;
+    }
+    case QCP::ssNone:
+    case QCP::ssDot:
+    case QCP::ssPixmap:
+      break;
+  }
+}
+
 
 // ================================================================================
 // =================== QCPLayer
@@ -402,6 +911,27 @@ void QCPPainter::drawScatter(double x, double y, double size, QCP::ScatterStyle
   
   When a layer is deleted, the objects on it are not deleted with it, but fall on the layer below
   the deleted layer, see QCustomPlot::removeLayer.
+  
+  \section layerbuffering Buffered layers
+  
+  By default, layers are logical (\ref lmLogical): They only control the rendering order, and all
+  layerables on them are drawn anew on every QCustomPlot::replot. If a layer is set to \ref
+  lmBuffered with \ref setMode, it renders its layerables into an own offscreen buffer instead. The
+  buffer is then composited onto the plot at the layer's position in the rendering order.
+  
+  A QCustomPlot::replot invalidates the buffers of all layers, because it may change axis ranges,
+  margins etc. However, a buffered layer can be replotted individually with \ref replot. Only that
+  layer's buffer (and any other buffer that was invalidated, see \ref invalidateBuffer) is then
+  rendered, all other buffered layers are just composited again. This is useful for objects that
+  change often while the rest of the plot stays the same, for example a tracer item following the
+  mouse cursor: Place the tracer on a buffered layer on top, place the expensive graphs on a
+  buffered layer, too (e.g. set the "main" layer to \ref lmBuffered), and call \ref replot of the
+  tracer's layer when moving it. The cost of moving the tracer then is mostly the cost of a few
+  pixmap blits, independent of the number and size of the graphs.
+  
+  Layerables on logical layers are still drawn at every (full or layer) replot, so expensive objects
+  should reside on buffered layers when using layer replots. Buffered layers need memory for a
+  pixmap the size of the QCustomPlot widget each.
 */
 
 /* start documentation of inline functions */
@@ -412,6 +942,13 @@ void QCPPainter::drawScatter(double x, double y, double size, QCP::ScatterStyle
   i.e. layerables with higher indices are drawn above layerables with lower indices.
 */
 
+/*! \fn LayerMode QCPLayer::mode() const
+  
+  Returns whether this layer is drawn directly or via an own buffer.
+  
+  \see setMode
+*/
+
 /* end documentation of inline functions */
 
 /*!
@@ -424,7 +961,9 @@ void QCPPainter::drawScatter(double x, double y, double size, QCP::ScatterStyle
 */
 QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mParentPlot(parentPlot),
-  mName(layerName)
+  mName(layerName),
+  mMode(lmLogical),
+  mBufferValid(false)
 {
   // Note: no need to make sure layerName doesn't already, because layer
   // management is done with QCustomPlot functions.
@@ -445,6 +984,74 @@ int QCPLayer::index() const
   return mParentPlot->mLayers.indexOf(const_cast<QCPLayer*>(this));
 }
 
+/*!
+  Sets whether this layer renders its layerables into an own buffer (\ref lmBuffered) or whether
+  they are drawn directly onto the plot at every replot (\ref lmLogical).
+  
+  Only buffered layers can be replotted individually with \ref replot. See the \ref
+  layerbuffering "class documentation" for details.
+  
+  Switching the mode invalidates the buffer, so the layer is rendered at the next replot. Switching
+  to \ref lmLogical releases the memory of the buffer.
+*/
+void QCPLayer::setMode(LayerMode mode)
+{
+  if (mMode != mode)
+  {
+    mMode = mode;
+    if (mMode == lmLogical)
+      mBuffer = QPixmap();
+    mBufferValid = false;
+  }
+}
+
+/*!
+  Marks the buffer of this layer as outdated, so it is rendered again at the next replot of this
+  or any other buffered layer (see \ref replot). A full QCustomPlot::replot invalidates the buffers
+  of all layers anyway.
+  
+  The buffer is invalidated automatically when layerables are added to or removed from the layer.
+  When changing properties of a layerable (e.g. the position of an item) and then calling \ref
+  replot on a different layer than the one of the layerable, call this function on the
+  layerable's layer before.
+  
+  For logical layers (\ref lmLogical), this function does nothing.
+*/
+void QCPLayer::invalidateBuffer()
+{
+  mBufferValid = false;
+}
+
+/*!
+  Replots only this layer, if it is a buffered layer (\ref lmBuffered). Its buffer is rendered
+  again, and then composited with the unchanged buffers of the other buffered layers and the
+  layerables of the logical layers into the plot's paint buffer. Finally, the widget surface is
+  updated.
+  
+  Since the axis ranges, tick vectors and margins are not recalculated, this must only be used for
+  changes that don't affect other layers, for example moving an item on this layer. Unlike
+  QCustomPlot::replot, this function doesn't emit QCustomPlot::beforeReplot and
+  QCustomPlot::afterReplot.
+  
+  If this layer is a logical layer (\ref lmLogical), or the plotting hint QCP::phAsyncReplot is set
+  (in which case layer buffers aren't used), this performs a full QCustomPlot::replot.
+  
+  \see setMode, invalidateBuffer
+*/
+void QCPLayer::replot()
+{
+  if (mMode == lmBuffered && !mParentPlot->plottingHints().testFlag(QCP::phAsyncReplot))
+  {
+    mBufferValid = false;
+    if (!mParentPlot->mReplotting) // if a replot is in progress, it renders this layer anyway
+    {
+      mParentPlot->mScrollBuffer.valid = false;
+      mParentPlot->compositeLayers(false);
+    }
+  } else
+    mParentPlot->replot();
+}
+
 /*! \internal
   
   Adds the \a layerable to the list of this layer. If \a prepend is set to true, the layerable will
@@ -463,6 +1070,7 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
       mChildren.prepend(layerable);
     else
       mChildren.append(layerable);
+    mBufferValid = false;
   } else
     qDebug() << Q_FUNC_INFO << "layerable is already child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
@@ -478,7 +1086,9 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
 */
 void QCPLayer::removeChild(QCPLayerable *layerable)
 {
-  if (!mChildren.removeOne(layerable))
+  if (mChildren.removeOne(layerable))
+    mBufferValid = false;
+  else
     qDebug() << Q_FUNC_INFO << "layerable is not child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
 
@@ -909,7 +1519,9 @@ bool QCPRange::validRange(const QCPRange &range)
 */
 QCPGrid::QCPGrid(QCPAxis *parentAxis) :
   QCPLayerable(parentAxis->parentPlot()),
-  mParentAxis(parentAxis)
+  mParentAxis(parentAxis),
+  mSectionBrushEven(Qt::NoBrush),
+  mSectionBrushOdd(Qt::NoBrush)
 {
   setPen(QPen(QColor(200,200,200), 0, Qt::DotLine));
   setSubGridPen(QPen(QColor(220,220,220), 0, Qt::DotLine));
@@ -918,6 +1530,9 @@ QCPGrid::QCPGrid(QCPAxis *parentAxis) :
   setAntialiased(false);
   setAntialiasedSubGrid(false);
   setAntialiasedZeroLine(false);
+  
+  //DBG:
+  //setSectionBrushes(QBrush(Qt::lightGray), QBrush(Qt::gray));
 }
 
 QCPGrid::~QCPGrid()
@@ -977,6 +1592,16 @@ void QCPGrid::setZeroLinePen(const QPen &pen)
   mZeroLinePen = pen;
 }
 
+/*!
+  Sets the brushes that will be used to draw tick section backgrounds of the axes alternatingly. To
+  disable alternating background brushes for axis tick sections, set the brushes to Qt::NoBrush
+*/
+void QCPGrid::setSectionBrushes(const QBrush &brushEven, const QBrush &brushOdd)
+{
+  mSectionBrushEven = brushEven;
+  mSectionBrushOdd = brushOdd;
+}
+
 /*! \internal
 
   A convenience function to easily set the QPainter::Antialiased hint on the provided \a painter
@@ -1005,11 +1630,63 @@ void QCPGrid::draw(QCPPainter *painter)
 {
   if (!mParentAxis->visible()) return; // also don't draw grid when parent axis isn't visible
   
+  if (mSectionBrushEven != Qt::NoBrush || mSectionBrushOdd != Qt::NoBrush)
+    drawSections(painter);
   if (mSubGridVisible)
     drawSubGridLines(painter);
   drawGridLines(painter);
 }
 
+/*! \internal
+  
+  Draws tick sections of the axis with alternating brushes set via \ref setSectionBrushes.
+  
+  Called by QCustomPlot::draw to draw the sections of an axis.
+*/
+void QCPGrid::drawSections(QCPPainter *painter) const
+{
+  int lowTick = mParentAxis->mLowestVisibleTick;
+  int highTick = mParentAxis->mHighestVisibleTick;
+  double t1, t2; // helper variable, result of coordinate-to-pixel transforms
+  if (mParentAxis->orientation() == Qt::Horizontal)
+  {
+    // TODO: make this properly work. Doesn't work when only one tick in range and probably when logarithmic scale.
+    // idea for no tick in visible range: if (lowtick > hightick), draw full axis fillrect with color depending on
+    // side (left or right of ticks) and whether there are ticks to left/right in tickvector.
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(Qt::NoPen);
+    for (int i=lowTick; i <= highTick-1; ++i)
+    {
+      int sectionId = 0;
+      if (mParentAxis->autoTicks())
+      {
+        double sectionHalf = (mParentAxis->mTickVector.at(i)+mParentAxis->mTickVector.at(i+1))/2.0;
+        sectionId = qFloor(sectionHalf/mParentAxis->mTickStep);
+      }
+      {
+        sectionId = i;
+      }
+      t1 = mParentAxis->coordToPixel(mParentAxis->mTickVector.at(i)); // x1
+      t2 = mParentAxis->coordToPixel(mParentAxis->mTickVector.at(i+1)); // x2
+      if (i == lowTick) // draw first section extra
+      {
+        painter->setBrush((sectionId-1) % 2 == 0 ? mSectionBrushEven : mSectionBrushOdd);
+        painter->drawRect(QRectF(mParentAxis->mAxisRect.left(), mParentAxis->mAxisRect.top(), t1-mParentAxis->mAxisRect.left(), mParentAxis->mAxisRect.height()));
+      }
+      painter->setBrush(sectionId % 2 == 0 ? mSectionBrushEven : mSectionBrushOdd);
+      painter->drawRect(QRectF(t1, mParentAxis->mAxisRect.top(), t2-t1, mParentAxis->mAxisRect.height()));
+      if (i == highTick-1) // draw last section extra
+      {
+        painter->setBrush((sectionId+1) % 2 == 0 ? mSectionBrushEven : mSectionBrushOdd);
+        painter->drawRect(QRectF(t2, mParentAxis->mAxisRect.top(), mParentAxis->mAxisRect.right()-t2+1, mParentAxis->mAxisRect.height()));
+      }
+    }
+  } else
+  {
+    // TODO: same for Qt::Vertical
+  }
+}
+
 /*! \internal
   
   Draws the main grid lines and possibly a zero line with the specified painter.
@@ -1041,6 +1718,7 @@ void QCPGrid::drawGridLines(QCPPainter *painter) const
         }
       }
     }
+    // draw grid lines:
     applyDefaultAntialiasingHint(painter);
     painter->setPen(mPen);
     for (int i=lowTick; i <= highTick; ++i)
@@ -2260,7 +2938,89 @@ double QCPAxis::coordToPixel(double value) const
   }
 }
 
-/*!
+/*! \overload
+  
+  Transforms the \a count values at \a coords (in coordinates of the axis) to pixel coordinates of
+  the QCustomPlot widget and writes them to \a pixels. The values are located at steps of \a
+  coordStride bytes, the results are written at steps of \a pixelStride bytes. This allows reading
+  from and writing to arrays of structs directly, e.g. writing the x coordinates of an array of
+  QPointF with a \a pixelStride of sizeof(QPointF).
+  
+  This is much faster than calling \ref coordToPixel(double value) const for each value, because
+  the axis properties are evaluated once per call and the transformation is reduced to one
+  multiplication and addition per value (plus a logarithm on logarithmic axes). If both strides are
+  the natural ones (i.e. the values and results are contiguous arrays), the transformation loop can
+  be vectorized by the compiler.
+  
+  The results may differ from the ones of \ref coordToPixel(double value) const in the last digits,
+  due to the different order of the floating point operations.
+*/
+void QCPAxis::coordToPixel(const double *coords, qreal *pixels, int count, int coordStride, int pixelStride) const
+{
+  if (count <= 0) return;
+  const char *source = reinterpret_cast<const char*>(coords);
+  char *dest = reinterpret_cast<char*>(pixels);
+  
+  // pixel position of the range bounds (for non-reversed range), and the pixel extent of the range:
+  double lowerPixel, extent;
+  if (orientation() == Qt::Horizontal)
+  {
+    lowerPixel = mAxisRect.left();
+    extent = mAxisRect.width();
+  } else
+  {
+    lowerPixel = mAxisRect.bottom();
+    extent = -mAxisRect.height();
+  }
+  
+  if (mScaleType == stLinear)
+  {
+    // pixel = (coord-lower)*factor + offset
+    const double lower = mRange.lower;
+    const double factor = (mRangeReversed ? -extent : extent)/mRange.size();
+    const double offset = (mRangeReversed ? lowerPixel+extent : lowerPixel);
+    if (coordStride == sizeof(double) && pixelStride == sizeof(qreal))
+    {
+      for (int i=0; i<count; ++i)
+        pixels[i] = (coords[i]-lower)*factor+offset;
+    } else
+    {
+      for (int i=0; i<count; ++i)
+        *reinterpret_cast<qreal*>(dest+qint64(i)*pixelStride) = (*reinterpret_cast<const double*>(source+qint64(i)*coordStride)-lower)*factor+offset;
+    }
+  } else // mScaleType == stLogarithmic
+  {
+    // pixel = ln(coord/lower)*factor + offset, the base of the logarithm cancels out:
+    const double lower = mRange.lower;
+    const double factor = (mRangeReversed ? -extent : extent)/qLn(mRange.upper/mRange.lower);
+    const double offset = (mRangeReversed ? lowerPixel+extent : lowerPixel);
+    // invalid values for logarithmic scale are drawn outside the visible range, as in coordToPixel(double):
+    double beyondUpper, beyondLower;
+    if (orientation() == Qt::Horizontal)
+    {
+      beyondUpper = !mRangeReversed ? mAxisRect.right()+200 : mAxisRect.left()-200;
+      beyondLower = !mRangeReversed ? mAxisRect.left()-200 : mAxisRect.right()+200;
+    } else
+    {
+      beyondUpper = !mRangeReversed ? mAxisRect.top()-200 : mAxisRect.bottom()+200;
+      beyondLower = !mRangeReversed ? mAxisRect.bottom()+200 : mAxisRect.top()-200;
+    }
+    for (int i=0; i<count; ++i)
+    {
+      const double value = *reinterpret_cast<const double*>(source+qint64(i)*coordStride);
+      double pixel;
+      if (value >= 0 && mRange.upper < 0)
+        pixel = beyondUpper;
+      else if (value <= 0 && mRange.upper > 0)
+        pixel = beyondLower;
+      else
+        pixel = qLn(value/lower)*factor+offset;
+      *reinterpret_cast<qreal*>(dest+qint64(i)*pixelStride) = pixel;
+    }
+  }
+}
+
+/*!
   Returns the part of the axis that is hit by \a pos (in pixels). The return value of this function
   is independent of the user-selectable parts defined with \ref setSelectable. Further, this
   function does not change the current selection state of the axis.
@@ -2687,21 +3447,17 @@ void QCPAxis::draw(QCPPainter *painter)
 
 /*! \internal
   
-  Draws a single tick label with the provided \a painter. The tick label is always bound to an axis
-  in one direction (distance to axis in that direction is however controllable via \a
-  distanceToAxis in pixels). The position in the other direction is passed in the \a position
-  parameter. Hence for the bottom axis, \a position would indicate the horizontal pixel position
-  (not coordinate!), at which the label should be drawn.
-  
-  In order to draw the axis label after all the tick labels in a position, that doesn't overlap
-  with the tick labels, we need to know the largest tick label size. This is done by passing a \a
-  tickLabelsSize to all \ref drawTickLabel calls during the process of drawing all tick labels of
-  one axis. \a tickLabelSize is only expanded, if the drawn label exceeds the value \a
-  tickLabelsSize currently holds.
+  Draws a single tick label with the provided \a painter, utilizing the internal label cache to
+  significantly speed up drawing of labels that were drawn in previous calls. The tick label is
+  always bound to an axis, the distance to the axis is controllable via \a distanceToAxis in
+  pixels. The pixel position in the axis direction is passed in the \a position parameter. Hence
+  for the bottom axis, \a position would indicate the horizontal pixel position (not coordinate),
+  at which the label should be drawn.
   
-  This function is also responsible for turning ugly exponential numbers "5.5e9" into a more
-  beautifully typeset format "5.5 [multiplication sign] 10 [superscript] 9". This feature is
-  controlled with \ref setNumberFormat.
+  In order to later draw the axis label in a place that doesn't overlap with the tick labels, the
+  largest tick label size is needed. This is acquired by passing a \a tickLabelsSize to all \ref
+  drawTickLabel calls during the process of drawing all tick labels of one axis. \a tickLabelSize
+  is only expanded, if the drawn label exceeds the value \a tickLabelsSize currently holds.
   
   The label is drawn with the font and pen that are currently set on the \a painter. To draw
   superscripted powers, the font is temporarily made smaller by a fixed factor.
@@ -2718,7 +3474,7 @@ void QCPAxis::placeTickLabel(QCPPainter *painter, double position, int distanceT
     case atTop:    labelAnchor = QPointF(position, mAxisRect.top()-distanceToAxis); break;
     case atBottom: labelAnchor = QPointF(position, mAxisRect.bottom()+distanceToAxis); break;
   }
-  if (parentPlot()->plottingHints().testFlag(QCP::phCacheLabels)) // label caching enabled
+  if (labelCacheUsable()) // label caching enabled
   {
     if (!mLabelCache.contains(text))  // no cached label exists, create it
     {
@@ -2776,6 +3532,15 @@ void QCPAxis::placeTickLabel(QCPPainter *painter, double position, int distanceT
     tickLabelsSize->setHeight(finalSize.height());
 }
 
+/*! \internal
+  
+  This is a \ref placeTickLabel helper function.
+  
+  Draws the tick label specified in \a labelData with \a painter at the pixel positions \a x and \a
+  y. This function is used by \ref placeTickLabel to create cached tick labels or to directly draw
+  the labels on the QCustomPlot surface when label caching is disabled (when QCP::phCacheLabels
+  plotting hint is not set).
+*/
 void QCPAxis::drawTickLabel(QCPPainter *painter, double x, double y, const QCPAxis::TickLabelData &labelData) const
 {
   // backup painter settings that we're about to change:
@@ -2804,6 +3569,14 @@ void QCPAxis::drawTickLabel(QCPPainter *painter, double x, double y, const QCPAx
   painter->setFont(oldFont);
 }
 
+/*! \internal
+  
+  This is a \ref placeTickLabel helper function.
+  
+  Transforms the passed \a text and \a font to a tickLabelData structure that can then be further
+  processed by \ref getTickLabelDrawOffset and \ref drawTickLabel. Thus it splits the text into base
+  and exponent if necessary (see \ref setNumberFormat) and calculates appropriate bounding boxes.
+*/
 QCPAxis::TickLabelData QCPAxis::getTickLabelData(const QFont &font, const QString &text) const
 {
   TickLabelData result;
@@ -2862,6 +3635,16 @@ QCPAxis::TickLabelData QCPAxis::getTickLabelData(const QFont &font, const QStrin
   return result;
 }
 
+/*! \internal
+  
+  This is a \ref placeTickLabel helper function.
+  
+  Calculates the offset at which the top left corner of the specified tick label shall be drawn.
+  The offset is relative to a point right next to the tick the label belongs to.
+  
+  This function is thus responsible for e.g. centering tick labels under ticks and positioning them
+  appropriately when they are rotated.
+*/
 QPointF QCPAxis::getTickLabelDrawOffset(const QCPAxis::TickLabelData &labelData) const
 {
   /*
@@ -2966,7 +3749,7 @@ void QCPAxis::getMaxTickLabelSize(const QFont &font, const QString &text,  QSize
 {
   // note: this function must return the same tick label sizes as the placeTickLabel function.
   QSize finalSize;
-  if (parentPlot()->plottingHints().testFlag(QCP::phCacheLabels) && mLabelCache.contains(text)) // label caching enabled and have cached label
+  if (labelCacheUsable() && mLabelCache.contains(text)) // label caching enabled and have cached label
   {
     const CachedLabel *cachedLabel = mLabelCache.object(text);
     finalSize = cachedLabel->pixmap.size();
@@ -2983,6 +3766,18 @@ void QCPAxis::getMaxTickLabelSize(const QFont &font, const QString &text,  QSize
     tickLabelsSize->setHeight(finalSize.height());
 }
 
+/*! \internal
+  
+  Returns whether tick labels may be drawn from and stored in the label cache. This is the case if
+  the plotting hint QCP::phCacheLabels is set and the axis is drawn on the thread the parent plot
+  lives in. When rendering on a worker thread (see QCustomPlot::toImage), the cache, which holds
+  pixmaps and isn't synchronized, is bypassed.
+*/
+bool QCPAxis::labelCacheUsable() const
+{
+  return mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && QThread::currentThread() == mParentPlot->thread();
+}
+
 /*! \internal
   
   Handles the selection \a event and returns true when the selection event hit any parts of the
@@ -5106,6 +5901,46 @@ void QCPAbstractPlottable::applyErrorBarsAntialiasingHint(QCPPainter *painter) c
   applyAntialiasingHint(painter, mAntialiasedErrorBars, QCP::aeErrorBars);
 }
 
+/*! \internal
+
+  Returns whether scatter symbols of the given \a style (and \a scatterPixmap, if the style is
+  QCP::ssPixmap) may be culled with \ref cullScatter. This is the case if the plotting hint
+  QCP::phCullScatters is set and the symbols are opaque, so a symbol drawn on top of an identical
+  one doesn't change the result.
+  
+  \see cullScatter
+*/
+bool QCPAbstractPlottable::scatterCullingUsable(QCP::ScatterStyle style, const QPixmap &scatterPixmap) const
+{
+  if (!mParentPlot->plottingHints().testFlag(QCP::phCullScatters))
+    return false;
+  if (style == QCP::ssPixmap)
+    return !scatterPixmap.hasAlphaChannel();
+  return mainPen().color().alpha() == 255;
+}
+
+/*! \internal
+
+  Returns true if a scatter symbol at the pixel position \a x, \a y may be skipped, because a
+  symbol was already drawn on that pixel. Otherwise marks the pixel as occupied and returns false.
+  
+  \a occupancy holds one bit for every pixel of \a rect, which is usually the clip rect of the
+  plottable. It must be initialized with rect.width()*rect.height() cleared bits before the first
+  symbol. Symbols outside \a rect are never skipped.
+  
+  \see scatterCullingUsable
+*/
+bool QCPAbstractPlottable::cullScatter(QBitArray &occupancy, const QRect &rect, double x, double y) const
+{
+  if (!(x >= rect.left() && y >= rect.top() && x < rect.left()+rect.width() && y < rect.top()+rect.height())) // also catches NaN
+    return false;
+  int index = int(x-rect.left()) + int(y-rect.top())*rect.width();
+  if (occupancy.testBit(index))
+    return true;
+  occupancy.setBit(index);
+  return false;
+}
+
 /*! \internal
 
   Finds the shortest squared distance of \a point to the line segment defined by \a start and \a
@@ -6530,6 +7365,37 @@ void QCPLineEnding::draw(QCPPainter *painter, const QVector2D &pos, double angle
   drawing pixel precise things, e.g. scatters, isn't possible with Qt 4.8.0/1. So it's a performance vs. plot
   quality tradeoff when switching to Qt 4.8.
   \li To increase responsiveness during dragging, consider setting \ref QCustomPlot::setNoAntialiasingOnDrag to true.
+  \li For graphs and curves with long lines (e.g. with adaptive sampling disabled), especially with antialiased, wide or
+  dashed pens, keep the automatic polyline chunk size (\ref QCustomPlot::setPolylineChunkSize), so the lines are stroked
+  in chunks.
+  \li If graphs with very many visible points make dragging and zooming sluggish, set a draft point budget (\ref
+  QCustomPlot::setDraftPointBudget). While interacting, such graphs are then drawn coarsely, and in full detail once the
+  interaction is idle.
+  \li When dragging plots with large graphs, set the plotting hint QCP::phScrollOnDrag. The graphs are then only rendered
+  in the strips that are newly exposed by the drag, the rest of the axis rect is shifted.
+  \li If the plot is replotted from many places (e.g. a slot connected to a data arrival signal), set the plotting hint
+  QCP::phQueuedReplot. Replots are then deferred to the next event loop iteration and coalesced, so the plot is rendered
+  at most once per event loop iteration. This also applies to the replots during range dragging and zooming.
+  \li If rasterizing the plot takes long (e.g. large antialiased or semi-transparent fills), set the plotting hint
+  QCP::phAsyncReplot, so it happens on a worker thread and the application stays responsive.
+  \li With many expensive plottables (e.g. dozens of graphs with millions of points), set the plotting hint
+  QCP::phParallelPlottables, so they are drawn concurrently on all cores.
+  \li For very large rastered exports, set an export tile size (\ref QCustomPlot::setExportTileSize), so the image
+  is rasterized on all cores. If the image doesn't fit into memory, export it with \ref QCustomPlot::savePpm, which
+  writes it band by band.
+  \li If only a few objects change frequently (e.g. a tracer item following the mouse), put them on a buffered layer (\ref
+  QCPLayer::setMode) and replot only that layer with \ref QCPLayer::replot. Put the expensive objects (e.g. the "main"
+  layer with the graphs) on buffered layers, too, so they are only composited instead of redrawn.
+  \li For dense scatter plots with many points on the same pixels, set the plotting hint QCP::phCullScatters, so only one
+  symbol per pixel is drawn.
+  \li Keep adaptive sampling of graphs enabled (\ref QCPGraph::setAdaptiveSampling, default). With it, the cost of drawing
+  a graph line depends on the size of the axis rect rather than on the number of visible data points.
+  \li For graphs with millions of points that are zoomed and dragged a lot, enable the level of detail index
+  (\ref QCPGraph::setLodIndex). Adaptive sampling then doesn't need to visit every visible data point anymore.
+  \li For realtime plots that show a sliding window of recent data, set a data capacity on the graphs (\ref
+  QCPGraph::setDataCapacity). New data points then overwrite the oldest ones in a preallocated ring buffer.
+  \li When loading large data sets into graphs, pass the data sorted by key and set the alreadySorted parameter of \ref
+  QCPGraph::setData or \ref QCPGraph::addData, if possible.
   \li On X11 (linux), avoid the (slow) native drawing system, use raster by supplying
   "-graphicssystem raster" as command line argument or calling QApplication::setGraphicsSystem("raster")
   before creating the QApplication object.
@@ -6780,11 +7646,20 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   QWidget(parent),
   mDragging(false),
   mReplotting(false),
-  mPlottingHints(QCP::phCacheLabels)
+  mReplotQueued(false),
+  mDragReplotQueued(false),
+  mAsyncFramePending(false),
+  mDropRunningAsyncFrame(false),
+  mPlottingHints(QCP::phCacheLabels),
+  mDrafting(false)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
   setMouseTracking(true);
+  mScrollBuffer.valid = false;
+  connect(&mAsyncFrameWatcher, SIGNAL(finished()), this, SLOT(asyncFrameFinished()));
+  mRefineTimer.setSingleShot(true);
+  connect(&mRefineTimer, SIGNAL(timeout()), this, SLOT(refineReplot()));
   QLocale currentLocale = locale();
   currentLocale.setNumberOptions(QLocale::OmitGroupSeparator);
   setLocale(currentLocale);
@@ -6841,6 +7716,10 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   setNotAntialiasedElements(QCP::aeNone);
   setInteractions(iRangeDrag|iRangeZoom);
   setMultiSelectModifier(Qt::ControlModifier);
+  setExportTileSize(0);
+  setDraftPointBudget(0);
+  setRefineDelay(250);
+  setPolylineChunkSize(-1);
   setRangeDragAxes(xAxis, yAxis);
   setRangeZoomAxes(xAxis, yAxis);
   setRangeDrag(0);
@@ -6855,6 +7734,7 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
 
 QCustomPlot::~QCustomPlot()
 {
+  mAsyncFrameWatcher.waitForFinished();
   clearPlottables();
   clearItems();
   delete legend;
@@ -7460,6 +8340,81 @@ void QCustomPlot::setMultiSelectModifier(Qt::KeyboardModifier modifier)
   mMultiSelectModifier = modifier;
 }
 
+/*!
+  Sets the edge length in pixels of the tiles that rastered exports (\ref toImage, \ref
+  saveRastered, \ref savePng, etc.) are rendered in. If the exported image is larger than one
+  tile, the drawing commands of the plot are recorded once and then rasterized tile by tile on
+  multiple threads, directly into the resulting image. This is useful for very large exports
+  (e.g. posters with 16k x 8k pixels), which would otherwise be rasterized by a single thread.
+  
+  Since the tiles are rasterized on worker threads, this requires the raster graphics system on
+  X11 if pixmaps are part of the plot (e.g. cached tick labels, see QCustomPlot::toImage).
+  
+  Tiling doesn't reduce the memory needed by \ref toImage and the save functions based on it: The
+  complete image is allocated, and the recorded drawing commands are held in addition while the
+  tiles are rasterized, so the peak memory grows with the image size. Only \ref savePpm streams
+  the image to the file in bands of \a pixels rows, so its memory doesn't depend on the image
+  height.
+  
+  Set \a pixels to 0 (the default) to disable tiled rendering.
+*/
+void QCustomPlot::setExportTileSize(int pixels)
+{
+  mExportTileSize = qMax(0, pixels);
+}
+
+/*!
+  Sets the number of visible data points up to which plottables are drawn in full detail while the
+  user drags or zooms the axis ranges (\ref setInteractions). Plottables with more visible data
+  points are then drawn with reduced detail, e.g. a graph draws a coarsely decimated line and
+  skips its scatter symbols, error bars and channel fill. As soon as the interaction has been idle
+  for the refine delay (\ref setRefineDelay) or the mouse button is released, the plot is replotted
+  in full detail.
+  
+  This keeps interactions with very large graphs responsive, at the price of a coarser look while
+  interacting. Exports are always drawn in full detail.
+  
+  Set \a points to 0 (the default) to always draw in full detail.
+  
+  \see QCPPainter::setDraftMode
+*/
+void QCustomPlot::setDraftPointBudget(int points)
+{
+  mDraftPointBudget = qMax(0, points);
+}
+
+/*!
+  Sets the time in milliseconds after the last drag or zoom step, after which a plot that was drawn
+  with reduced detail during the interaction is replotted in full detail. The default is 250 ms.
+  
+  \see setDraftPointBudget
+*/
+void QCustomPlot::setRefineDelay(int msec)
+{
+  mRefineDelay = qMax(0, msec);
+}
+
+/*!
+  Sets the maximum number of points per chunk, in which the lines of graphs and curves are drawn.
+  Stroking a polyline gets disproportionately expensive with its number of points, especially with
+  antialiased, wide or dashed pens, so drawing long lines in chunks of a few hundred points is
+  considerably faster. Joins and caps are still drawn correctly and the chunks don't overlap, see
+  QCPPainter::drawPolylineChunked. The benchmarks in tests/benchmark compare chunk sizes for
+  different pens.
+  
+  If a fixed chunk size is set, it takes precedence over the plotting hint QCP::phFastPolylines,
+  which draws each line segment separately and thus loses the joins.
+  
+  Set \a points to -1 (the default) to choose the chunk size per pen, e.g. thin solid lines aren't
+  chunked while wide and dashed lines are (see QCPPainter::drawPolylineChunked). In this mode, the
+  plotting hint QCP::phFastPolylines takes precedence. Set \a points to 0 to always draw lines as
+  a single polyline.
+*/
+void QCustomPlot::setPolylineChunkSize(int points)
+{
+  mPolylineChunkSize = qMax(-1, points);
+}
+
 /*!
   Returns the plottable with \a index. If the index is invalid, returns 0.
   
@@ -8236,30 +9191,74 @@ void QCustomPlot::deselectAll()
   Causes a complete replot (axes, labels, graphs, etc.) into the internal buffer. Finally, update()
   is called, to redraw the buffer on the QCustomPlot widget surface.
   
+  The buffers of all buffered layers (see QCPLayer::setMode) are invalidated and rendered again. To
+  replot only the contents of a single buffered layer, use QCPLayer::replot.
+  
+  The \a priority controls whether the replot is performed immediately or queued for the next
+  event loop iteration, see \ref RefreshPriority. By default (\ref rpHint), replots are queued if
+  the plotting hint QCP::phQueuedReplot is set. Queued replots are coalesced: No matter how many
+  replots are requested until the event loop is reached (e.g. by a burst of data arrival signals
+  or mouse move events), the plot is only rendered once. An immediate replot also takes care of a
+  pending queued replot.
+  
+  If the plotting hint QCP::phAsyncReplot is set, the replot only records the drawing commands of
+  the plot in a QPicture on the GUI thread, which is fast compared to rasterizing them. The QPicture
+  is then rasterized into a QImage on a worker thread, while the event loop keeps running. When the
+  frame is finished, it replaces the internal buffer and the widget surface is updated. If further
+  replots are requested while a frame is rasterized, only the most recent one is rasterized next,
+  the others are dropped. In this mode, layer buffers aren't used (see QCPLayer::setMode). Since
+  pixmaps (e.g. cached tick labels, scatter pixmaps and the axis background) are then drawn on a
+  worker thread, this mode requires the raster graphics system on X11 (see \ref
+  performancetweaks).
+  
   Before the replot happens, the signal \ref beforeReplot is emitted. After the replot, \ref afterReplot is
   emitted. It is safe to mutually connect the replot slot with any of those two signals on two QCustomPlots
-  to make them replot synchronously (i.e. it won't cause an infinite recursion).
-*/
-void QCustomPlot::replot()
-{
+  to make them replot synchronously (i.e. it won't cause an infinite recursion). In asynchronous mode,
+  \ref afterReplot is emitted when the drawing commands are recorded, the frame appears on the
+  widget surface later.
+  
+  If the plotting hint QCP::phParallelPlottables is set, plottables that follow each other on a
+  layer are drawn concurrently on worker threads (e.g. with many graphs on the "main" layer). Each
+  is rendered into an own image of the size of its clip rect, the images are then composited in
+  layer order. The replot still returns only when the frame is complete. Plottables must not share
+  unguarded mutable state for this. For the plottables of QCustomPlot this is the case: draw
+  doesn't modify the plottable, and the geometry a channel fill reads from another graph is
+  guarded by that graph's cache (see QCPGraph::setChannelFillGraph). Like with
+  QCP::phAsyncReplot, drawing pixmaps (scatter pixmaps) on worker threads requires the raster
+  graphics system on X11.
+*/
+void QCustomPlot::replot(QCustomPlot::RefreshPriority priority)
+{
+  if (priority == rpQueued || (priority == rpHint && mPlottingHints.testFlag(QCP::phQueuedReplot)))
+  {
+    mDragReplotQueued = false; // a full replot supersedes a queued drag replot
+    if (!mReplotQueued)
+    {
+      mReplotQueued = true;
+      QMetaObject::invokeMethod(this, "processQueuedReplot", Qt::QueuedConnection);
+    }
+    return;
+  }
+  
   if (mReplotting) // incase signals loop back to replot slot
     return;
   mReplotting = true;
+  mReplotQueued = false; // a pending queued replot would render the same state again
+  mDragReplotQueued = false;
+  mScrollBuffer.valid = false;
   emit beforeReplot();
-  mPaintBuffer.fill(mColor);
-  QCPPainter painter;
-  painter.begin(&mPaintBuffer);
-  if (painter.isActive()) 
+  for (int i=0; i<mLayers.size(); ++i)
+    mLayers.at(i)->invalidateBuffer();
+  if (mPlottingHints.testFlag(QCP::phAsyncReplot))
   {
-    painter.setRenderHint(QPainter::HighQualityAntialiasing);
-    draw(&painter);
-    if (mPlottingHints.testFlag(QCP::phForceRepaint))
-      repaint();
-    else
-      update();
-    painter.end();
-  } else // might happen if QCustomPlot has width or height zero
-    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer";
+    recordAsyncFrame();
+  } else
+  {
+    // an asynchronous frame that is still being rasterized is older than this replot:
+    mAsyncFramePending = false;
+    mDropRunningAsyncFrame = mAsyncFrameWatcher.isRunning();
+    compositeLayers(true);
+  }
   emit afterReplot();
   mReplotting = false;
 }
@@ -8382,8 +9381,7 @@ bool QCustomPlot::savePdf(const QString &fileName, bool noCosmeticPen, int width
     newWidth = width;
     newHeight = height;
   }
-  QCP::PlottingHints plottingHintsBackup = mPlottingHints;
-  setPlottingHint(QCP::phCacheLabels, false);
+  
   QPrinter printer(QPrinter::ScreenResolution);
   printer.setOutputFileName(fileName);
   printer.setFullPage(true);
@@ -8405,7 +9403,6 @@ bool QCustomPlot::savePdf(const QString &fileName, bool noCosmeticPen, int width
   }
   mViewport = oldViewport;
   updateAxisRect();
-  setPlottingHints(plottingHintsBackup);
   return success;
 }
 
@@ -8549,10 +9546,17 @@ void QCustomPlot::paintEvent(QPaintEvent *event)
 void QCustomPlot::resizeEvent(QResizeEvent *event)
 {
   // resize and repaint the buffer:
+  QPixmap oldBuffer = mPaintBuffer;
   mPaintBuffer = QPixmap(event->size());
+  if (mPlottingHints.testFlag(QCP::phAsyncReplot)) // show the old frame until the new one is rasterized
+  {
+    mPaintBuffer.fill(mColor);
+    QPainter painter(&mPaintBuffer);
+    painter.drawPixmap(0, 0, oldBuffer);
+  }
   mViewport = rect();
   updateAxisRect();
-  replot();
+  replot(rpImmediate); // the new buffer is uninitialized, so don't wait for a queued replot
 }
 
 /*! \internal
@@ -8697,7 +9701,18 @@ void QCustomPlot::mouseMoveEvent(QMouseEvent *event)
       {
         if (mNoAntialiasingOnDrag)
           setNotAntialiasedElements(QCP::aeAll);
-        replot();
+        beginDraft();
+        if (mPlottingHints.testFlag(QCP::phQueuedReplot))
+        {
+          // coalesce drag steps like other replots, the queued replot takes the fast path if possible:
+          if (!mReplotQueued)
+          {
+            mReplotQueued = true;
+            mDragReplotQueued = true;
+            QMetaObject::invokeMethod(this, "processQueuedReplot", Qt::QueuedConnection);
+          }
+        } else if (!dragReplot())
+          replot();
       }
     }
   }
@@ -8723,6 +9738,18 @@ void QCustomPlot::mouseReleaseEvent(QMouseEvent *event)
     setNotAntialiasedElements(mNotAADragBackup);
     doReplot = true;
   }
+  if (mScrollBuffer.valid) // the drag was rendered by shifting, finish with a complete replot
+  {
+    mScrollBuffer.pixmap = QPixmap();
+    mScrollBuffer.valid = false;
+    doReplot = true;
+  }
+  if (mDrafting) // the drag was rendered with reduced detail, finish in full detail right away
+  {
+    mDrafting = false;
+    mRefineTimer.stop();
+    doReplot = true;
+  }
   
   // determine whether it was a drag or click operation:
   if ((mDragStart-event->pos()).manhattanLength() < 5) // was a click
@@ -8853,6 +9880,7 @@ void QCustomPlot::wheelEvent(QWheelEvent *event)
         factor = pow(mRangeZoomFactorVert, wheelSteps);
         mRangeZoomVertAxis->scaleRange(factor, mRangeZoomVertAxis->pixelToCoord(event->pos().y()));
       }
+      beginDraft();
       replot();
     }
   }
@@ -9042,61 +10070,23 @@ bool QCustomPlot::handleTitleSelection(QMouseEvent *event, bool additiveSelectio
   This is the main draw function which first generates the tick vectors of all axes,
   calculates and applies appropriate margins if autoMargin is true and finally draws
   all elements with the passed \a painter. (axis background, title, subgrid, grid, axes, plottables)
+  
+  All layers are drawn directly with \a painter, regardless of their QCPLayer::mode. This is used
+  for exporting the plot (e.g. \ref savePdf, \ref pixmap). The widget surface is drawn by \ref
+  compositeLayers.
 */
 void QCustomPlot::draw(QCPPainter *painter)
 {
-  // calculate title bounding box:
-  if (!mTitle.isEmpty())
-  {
-    painter->setFont(titleSelected() ? mSelectedTitleFont : mTitleFont);
-    mTitleBoundingBox = painter->fontMetrics().boundingRect(mViewport, Qt::TextDontClip | Qt::AlignHCenter, mTitle);
-  } else
-    mTitleBoundingBox = QRect();
-  
-  // prepare values of ticks and tick strings:
-  xAxis->setupTickVectors();
-  yAxis->setupTickVectors();
-  xAxis2->setupTickVectors();
-  yAxis2->setupTickVectors();
-  // set auto margin such that tick/axis labels etc. are not clipped:
-  if (mAutoMargin)
-  {
-    setMargin(yAxis->calculateMargin(),
-              yAxis2->calculateMargin(),
-              xAxis2->calculateMargin()+mTitleBoundingBox.height(),
-              xAxis->calculateMargin());
-  }
-  // position legend:
-  legend->reArrange();
+  updateLayout(painter);
   
   // draw axis background:
   drawAxisBackground(painter);
   
   // draw all layered objects (grid, axes, plottables, items, legend,...):
   for (int layerIndex=0; layerIndex < mLayers.size(); ++layerIndex)
-  {
-    QList<QCPLayerable*> layerChildren = mLayers.at(layerIndex)->children();
-    for (int k=0; k < layerChildren.size(); ++k)
-    {
-      QCPLayerable *child = layerChildren.at(k);
-      if (child->visible())
-      {
-        painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
-        child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
-      }
-    }
-  }
+    drawLayer(painter, mLayers.at(layerIndex));
   
-  // draw title:
-  if (!mTitle.isEmpty())
-  {
-    painter->setFont(titleSelected() ? mSelectedTitleFont : mTitleFont);
-    painter->setPen(QPen(titleSelected() ? mSelectedTitleColor : mTitleColor));
-    painter->drawText(mTitleBoundingBox, Qt::TextDontClip | Qt::AlignHCenter, mTitle);
-  }
+  drawTitle(painter);
 }
 
 /*! \internal
@@ -9132,164 +10122,2355 @@ void QCustomPlot::drawAxisBackground(QCPPainter *painter)
 
 /*! \internal
   
-  calculates mAxisRect by applying the margins inward to mViewport. The axisRect is then passed on
-  to all axes via QCPAxis::setAxisRect
+  Performs the replot that was queued by \ref replot, unless an immediate replot has taken care of
+  it in the meantime.
   
-  \see setMargin, setAxisRect
+  If only range drag steps were queued (see \ref mouseMoveEvent with QCP::phQueuedReplot), the
+  replot is performed with \ref dragReplot if possible.
 */
-void QCustomPlot::updateAxisRect()
+void QCustomPlot::processQueuedReplot()
 {
-  mAxisRect = mViewport.adjusted(mMarginLeft, mMarginTop, -mMarginRight, -mMarginBottom);
-  xAxis->setAxisRect(mAxisRect);
-  yAxis->setAxisRect(mAxisRect);
-  xAxis2->setAxisRect(mAxisRect);
-  yAxis2->setAxisRect(mAxisRect);
+  if (mReplotQueued)
+  {
+    bool dragOnly = mDragReplotQueued;
+    mDragReplotQueued = false;
+    if (!dragOnly || !dragReplot())
+      replot(rpImmediate);
+  }
 }
 
 /*! \internal
   
-  Returns whether the point \a pos in pixels hits the plot title.
+  Called when the worker thread has finished rasterizing a frame that was started with \ref
+  startAsyncFrame. Unless the frame was made obsolete by a synchronous replot in the meantime (or
+  the widget was resized), it becomes the new internal buffer and the widget surface is updated.
+  If a newer frame is pending, its rasterization is started.
 */
-bool QCustomPlot::selectTestTitle(const QPointF &pos) const
+void QCustomPlot::asyncFrameFinished()
 {
-  return mTitleBoundingBox.contains(pos.toPoint());
+  QImage frame = mAsyncFrameWatcher.result();
+  if (!mDropRunningAsyncFrame && frame.size() == mPaintBuffer.size())
+  {
+    mPaintBuffer = QPixmap::fromImage(frame);
+    if (mPlottingHints.testFlag(QCP::phForceRepaint))
+      repaint();
+    else
+      update();
+  }
+  mDropRunningAsyncFrame = false;
+  if (mAsyncFramePending)
+  {
+    mAsyncFramePending = false;
+    QPicture pendingFrame = mPendingAsyncFrame;
+    mPendingAsyncFrame = QPicture();
+    startAsyncFrame(pendingFrame);
+  }
 }
 
-/*!
-  Saves the plot to a rastered image file \a fileName in the image format \a
-  format. The plot is sized to \a width and \a height in pixels and scaled with
-  \a scale. (width 100 and scale 2.0 lead to a full resolution file with width
-  200.) If the \a format supports compression, \a quality may be between 0 and
-  100 to control it.
-  
-  Returns true on success. If this function fails, most likely the given \a format isn't supported
-  by the system, see Qt docs about QImageWriter::supportedImageFormats().
+/*! \internal
   
-  \see saveBmp, saveJpg, savePng, savePdf
+  Called when the interaction that was started with \ref beginDraft has been idle for the refine
+  delay. Replots the plot in full detail.
 */
-bool QCustomPlot::saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality)
+void QCustomPlot::refineReplot()
 {
-  int newWidth, newHeight;
-  if (width == 0 || height == 0)
-  {
-    newWidth = this->width();
-    newHeight = this->height();
-  } else
-  {
-    newWidth = width;
-    newHeight = height;
-  }
-  int scaledWidth = qRound(scale*newWidth);
-  int scaledHeight = qRound(scale*newHeight);
-
-  QPixmap pngBuffer(scaledWidth, scaledHeight); // use QPixmap instead of QImage (like live painting buffer), because it supports background transparency (of mColor).
-  pngBuffer.fill(mColor);
-  QCPPainter painter(&pngBuffer);
-  QRect oldViewport = mViewport;
-  mViewport = QRect(0, 0, newWidth, newHeight);
-  updateAxisRect();
-  if (!qFuzzyCompare(scale, 1.0))
+  if (mDrafting)
   {
-    if (scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines would disappear
-    {
-      painter.setScaledExportMode(true);
-      painter.setRenderHint(QPainter::NonCosmeticDefaultPen);
-    }
-    painter.scale(scale, scale);
+    mDrafting = false;
+    replot();
   }
-  draw(&painter);
-  mViewport = oldViewport;
-  updateAxisRect();
-  return pngBuffer.save(fileName, format, quality);
 }
 
-/*!
-  Renders the plot to a pixmap and returns it.
+/*! \internal
   
-  The plot is sized to \a width and \a height in pixels and scaled with \a scale. (width 100 and
-  scale 2.0 lead to a full resolution pixmap with width 200.)
+  Calculates the title bounding box, generates the tick vectors of all axes, applies appropriate
+  margins if autoMargin is true and positions the legend. The \a painter is only used to determine
+  the font metrics of the title.
   
-  \see saveRastered, saveBmp, savePng, saveJpg, savePdf
+  \see draw, compositeLayers
 */
-QPixmap QCustomPlot::pixmap(int width, int height, double scale)
+void QCustomPlot::updateLayout(QCPPainter *painter)
 {
-  int newWidth, newHeight;
-  if (width == 0 || height == 0)
+  // calculate title bounding box:
+  if (!mTitle.isEmpty())
   {
-    newWidth = this->width();
-    newHeight = this->height();
+    painter->setFont(titleSelected() ? mSelectedTitleFont : mTitleFont);
+    mTitleBoundingBox = painter->fontMetrics().boundingRect(mViewport, Qt::TextDontClip | Qt::AlignHCenter, mTitle);
   } else
-  {
-    newWidth = width;
-    newHeight = height;
+    mTitleBoundingBox = QRect();
+  
+  // prepare values of ticks and tick strings:
+  xAxis->setupTickVectors();
+  yAxis->setupTickVectors();
+  xAxis2->setupTickVectors();
+  yAxis2->setupTickVectors();
+  // set auto margin such that tick/axis labels etc. are not clipped:
+  if (mAutoMargin)
+  {
+    setMargin(yAxis->calculateMargin(),
+              yAxis2->calculateMargin(),
+              xAxis2->calculateMargin()+mTitleBoundingBox.height(),
+              xAxis->calculateMargin());
+  }
+  // position legend:
+  legend->reArrange();
+}
+
+/*! \internal
+  
+  Draws all visible layerables of \a layer with the provided \a painter, each clipped to its
+  clip rect and with its default antialiasing hint applied.
+  
+  \see draw, compositeLayers
+*/
+void QCustomPlot::drawLayer(QCPPainter *painter, QCPLayer *layer)
+{
+  QList<QCPLayerable*> layerChildren = layer->children();
+  for (int k=0; k < layerChildren.size(); ++k)
+  {
+    if (layerChildren.at(k)->visible())
+      drawLayerable(painter, layerChildren.at(k));
+  }
+}
+
+/*! \internal
+  
+  Like \ref drawLayer, but consecutive visible plottables on \a layer are drawn concurrently: Up to
+  QThread::idealThreadCount plottables at a time are rendered on worker threads into separate
+  transparent images covering their clip rects (see \ref renderLayerable). The images are then
+  drawn with \a painter in the order of the plottables on the layer, so the result looks the same
+  as with \ref drawLayer. Other layerables (e.g. items) are drawn directly on the calling thread.
+  
+  \a painter must paint on a device of the size of the internal paint buffer without any
+  transformation, which is why this is only used by \ref compositeLayers.
+  
+  \see QCP::phParallelPlottables
+*/
+void QCustomPlot::drawLayerParallel(QCPPainter *painter, QCPLayer *layer)
+{
+  QList<QCPLayerable*> layerChildren = layer->children();
+  const int maxBatchSize = qMax(1, QThread::idealThreadCount());
+  int k = 0;
+  while (k < layerChildren.size())
+  {
+    // collect consecutive visible plottables, invisible layerables don't interrupt a batch:
+    QList<QCPLayerable*> batch;
+    while (k < layerChildren.size() && batch.size() < maxBatchSize)
+    {
+      QCPLayerable *child = layerChildren.at(k);
+      if (child->visible())
+      {
+        if (!qobject_cast<QCPAbstractPlottable*>(child))
+          break;
+        batch.append(child);
+        // the level of detail index of a graph is built lazily. Build it here, so a graph with a
+        // channel fill to this one doesn't race with it for that:
+        if (QCPGraph *graph = qobject_cast<QCPGraph*>(child))
+          graph->data()->ensureLodIndex();
+      }
+      ++k;
+    }
+    
+    if (batch.size() > 1)
+    {
+      QList<QFuture<QImage> > images;
+      QList<QRect> rects;
+      for (int i=0; i<batch.size(); ++i)
+      {
+        rects.append(batch.at(i)->clipRect().translated(0, -1) & mPaintBuffer.rect());
+        images.append(QtConcurrent::run(renderLayerable, batch.at(i), rects.last(), painter->draftMode()));
+      }
+      for (int i=0; i<batch.size(); ++i)
+        painter->drawImage(rects.at(i).topLeft(), images.at(i).result()); // result() waits for the worker
+    } else if (batch.size() == 1)
+    {
+      drawLayerable(painter, batch.first());
+    } else if (k < layerChildren.size()) // layerChildren.at(k) is a visible layerable that isn't a plottable
+    {
+      drawLayerable(painter, layerChildren.at(k));
+      ++k;
+    }
+  }
+}
+
+/*! \internal
+  
+  Draws the \a layerable with the provided \a painter, clipped to its clip rect and with its
+  default antialiasing hint applied.
+*/
+void QCustomPlot::drawLayerable(QCPPainter *painter, QCPLayerable *layerable)
+{
+  painter->save();
+  painter->setClipRect(layerable->clipRect().translated(0, -1));
+  layerable->applyDefaultAntialiasingHint(painter);
+  layerable->draw(painter);
+  painter->restore();
+}
+
+/*! \internal
+  
+  Renders the \a layerable into a transparent image that corresponds to the region \a rect of the
+  plot, and returns it. If \a draft is true, the painter is put in draft mode (see \ref
+  QCPPainter::setDraftMode). This runs on a worker thread, see \ref drawLayerParallel.
+*/
+QImage QCustomPlot::renderLayerable(QCPLayerable *layerable, const QRect &rect, bool draft)
+{
+  QImage image(rect.size(), QImage::Format_ARGB32_Premultiplied);
+  image.fill(0);
+  if (!rect.isEmpty())
+  {
+    QCPPainter painter(&image);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    painter.setDraftMode(draft);
+    painter.translate(-rect.topLeft());
+    painter.setClipRect(rect);
+    layerable->applyDefaultAntialiasingHint(&painter);
+    layerable->draw(&painter);
+  }
+  return image;
+}
+
+/*! \internal
+  
+  Draws the plot title with the provided \a painter, inside the title bounding box determined by
+  the last call to \ref updateLayout.
+*/
+void QCustomPlot::drawTitle(QCPPainter *painter)
+{
+  if (!mTitle.isEmpty())
+  {
+    painter->setFont(titleSelected() ? mSelectedTitleFont : mTitleFont);
+    painter->setPen(QPen(titleSelected() ? mSelectedTitleColor : mTitleColor));
+    painter->drawText(mTitleBoundingBox, Qt::TextDontClip | Qt::AlignHCenter, mTitle);
+  }
+}
+
+/*! \internal
+  
+  Paints the plot into the internal paint buffer and updates the widget surface. If \a relayout
+  is true, the tick vectors, margins and legend position are recalculated first (see \ref
+  updateLayout), otherwise the layout of the previous replot is used.
+  
+  Logical layers (QCPLayer::lmLogical) are drawn directly into the paint buffer. Buffered layers
+  (QCPLayer::lmBuffered) are only rendered into their own buffer if it was invalidated (or the
+  widget size changed), and are then composited into the paint buffer.
+  
+  \see replot, QCPLayer::replot
+*/
+void QCustomPlot::compositeLayers(bool relayout)
+{
+  mPaintBuffer.fill(mColor);
+  QCPPainter painter;
+  painter.begin(&mPaintBuffer);
+  if (painter.isActive()) 
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    painter.setDraftMode(mDrafting);
+    if (relayout)
+      updateLayout(&painter);
+    drawAxisBackground(&painter);
+    const bool parallel = mPlottingHints.testFlag(QCP::phParallelPlottables);
+    for (int layerIndex=0; layerIndex < mLayers.size(); ++layerIndex)
+    {
+      QCPLayer *layer = mLayers.at(layerIndex);
+      if (layer->mode() == QCPLayer::lmBuffered)
+      {
+        if (layer->mBuffer.size() != mPaintBuffer.size())
+        {
+          layer->mBuffer = QPixmap(mPaintBuffer.size());
+          layer->mBufferValid = false;
+        }
+        if (!layer->mBufferValid)
+        {
+          layer->mBuffer.fill(Qt::transparent);
+          QCPPainter layerPainter;
+          layerPainter.begin(&layer->mBuffer);
+          if (layerPainter.isActive())
+          {
+            layerPainter.setRenderHint(QPainter::HighQualityAntialiasing);
+            layerPainter.setDraftMode(mDrafting);
+            if (parallel)
+              drawLayerParallel(&layerPainter, layer);
+            else
+              drawLayer(&layerPainter, layer);
+            layerPainter.end();
+            layer->mBufferValid = true;
+          } else
+            qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer of layer" << layer->name();
+        }
+        painter.drawPixmap(0, 0, layer->mBuffer);
+      } else if (parallel)
+        drawLayerParallel(&painter, layer);
+      else
+        drawLayer(&painter, layer);
+    }
+    drawTitle(&painter);
+    if (mPlottingHints.testFlag(QCP::phForceRepaint))
+      repaint();
+    else
+      update();
+    painter.end();
+  } else // might happen if QCustomPlot has width or height zero
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer";
+}
+
+/*! \internal
+  
+  Rasterizes the recorded drawing commands \a frame into an image of the given \a size, filled with
+  \a background first. Runs on a worker thread, see \ref QCustomPlot::startAsyncFrame.
+*/
+static QImage qcpRasterizeFrame(const QPicture &frame, const QSize &size, const QColor &background)
+{
+  QImage image(size, QImage::Format_ARGB32_Premultiplied);
+  image.fill(0);
+  QPainter painter(&image);
+  painter.fillRect(image.rect(), background);
+  painter.drawPicture(0, 0, frame);
+  return image;
+}
+
+/*! \internal
+  
+  Records the drawing commands of the whole plot (see \ref draw) in a QPicture and passes it on to
+  \ref startAsyncFrame. If a frame is currently being rasterized, the recorded frame becomes the
+  pending frame instead, replacing (and thus dropping) a previously pending frame.
+  
+  \see replot, QCP::phAsyncReplot
+*/
+void QCustomPlot::recordAsyncFrame()
+{
+  QPicture frame;
+  QCPPainter painter;
+  painter.begin(&frame);
+  if (painter.isActive())
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    painter.setDraftMode(mDrafting);
+    draw(&painter);
+    painter.end();
+    if (mAsyncFrameWatcher.isRunning())
+    {
+      mPendingAsyncFrame = frame;
+      mAsyncFramePending = true;
+    } else
+      startAsyncFrame(frame);
+  } else
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on picture";
+}
+
+/*! \internal
+  
+  Starts rasterizing the recorded \a frame on a worker thread, with the size of the internal buffer
+  and the background color. When finished, \ref asyncFrameFinished is called.
+*/
+void QCustomPlot::startAsyncFrame(const QPicture &frame)
+{
+  mDropRunningAsyncFrame = false;
+  mAsyncFrameWatcher.setFuture(QtConcurrent::run(qcpRasterizeFrame, frame, mPaintBuffer.size(), mColor));
+}
+
+/*! \internal
+  
+  Replots the plot during a range drag (see \ref mouseMoveEvent), if the plotting hint
+  QCP::phScrollOnDrag is set. Returns false if the fast path isn't enabled or currently not
+  possible, in which case the caller should perform a normal \ref replot.
+  
+  The visible layerables in the rendering order are split in two: The bottom ones that are shifted
+  by the drag (plottables and grids that only use the drag axes in the dragged orientations, see
+  \ref scrollable), and all others, starting with the first layerable that isn't shifted. The
+  former are drawn from the scroll buffer, which is updated by \ref updateScrollBuffer, the latter
+  are drawn normally on top. For typical plots, the first group contains the grids and graphs,
+  and the second one the axes, legend and items.
+  
+  Like \ref replot, this emits \ref beforeReplot and \ref afterReplot. If the plotting hint
+  QCP::phQueuedReplot is set, the drag steps are coalesced and this is called from \ref
+  processQueuedReplot instead.
+*/
+bool QCustomPlot::dragReplot()
+{
+  if (!mPlottingHints.testFlag(QCP::phScrollOnDrag) || mPlottingHints.testFlag(QCP::phAsyncReplot) || mReplotting || mPaintBuffer.isNull())
+    return false;
+  
+  mReplotting = true;
+  mReplotQueued = false;
+  mDragReplotQueued = false;
+  emit beforeReplot();
+  for (int i=0; i<mLayers.size(); ++i)
+    mLayers.at(i)->invalidateBuffer();
+  mPaintBuffer.fill(mColor);
+  QCPPainter painter;
+  painter.begin(&mPaintBuffer);
+  if (painter.isActive())
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    painter.setDraftMode(mDrafting);
+    updateLayout(&painter);
+    drawAxisBackground(&painter);
+    
+    // split visible layerables into the bottom ones that are shifted by the drag and the others:
+    QList<QCPLayerable*> scrolled, others;
+    QList<QCPAxis*> usedAxes;
+    for (int layerIndex=0; layerIndex < mLayers.size(); ++layerIndex)
+    {
+      QList<QCPLayerable*> layerChildren = mLayers.at(layerIndex)->children();
+      for (int k=0; k < layerChildren.size(); ++k)
+      {
+        QCPLayerable *child = layerChildren.at(k);
+        if (!child->visible())
+          continue;
+        if (others.isEmpty() && scrollable(child, &usedAxes))
+          scrolled.append(child);
+        else
+          others.append(child);
+      }
+    }
+    
+    updateScrollBuffer(scrolled, usedAxes);
+    painter.drawPixmap(mAxisRect.translated(0, -1).topLeft(), mScrollBuffer.pixmap);
+    for (int i=0; i<others.size(); ++i)
+      drawLayerable(&painter, others.at(i));
+    drawTitle(&painter);
+    if (mPlottingHints.testFlag(QCP::phForceRepaint))
+      repaint();
+    else
+      update();
+    painter.end();
+  } else
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer";
+  emit afterReplot();
+  mReplotting = false;
+  return true;
+}
+
+/*! \internal
+  
+  Returns whether the contents of \a layerable move rigidly with a range drag, so it may be drawn
+  from the scroll buffer (see \ref dragReplot). This is the case for plottables and grids, if each
+  of their axes is the range drag axis of its orientation, or its orientation isn't dragged at all.
+  
+  If so, the axes of \a layerable are added to \a usedAxes (if not already contained).
+*/
+bool QCustomPlot::scrollable(QCPLayerable *layerable, QList<QCPAxis*> *usedAxes) const
+{
+  QList<QCPAxis*> axes;
+  if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(layerable))
+    axes << plottable->keyAxis() << plottable->valueAxis();
+  else if (QCPGrid *grid = qobject_cast<QCPGrid*>(layerable))
+    axes << grid->mParentAxis;
+  else
+    return false;
+  
+  for (int i=0; i<axes.size(); ++i)
+  {
+    QCPAxis *axis = axes.at(i);
+    if (!axis)
+      return false;
+    Qt::Orientation orientation = axis->orientation();
+    if (mRangeDrag.testFlag(orientation) && axis != (orientation == Qt::Horizontal ? mRangeDragHorzAxis : mRangeDragVertAxis))
+      return false;
+  }
+  for (int i=0; i<axes.size(); ++i)
+  {
+    if (!usedAxes->contains(axes.at(i)))
+      usedAxes->append(axes.at(i));
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Brings the scroll buffer up to date with the current axis ranges, for the provided scrollable
+  \a layerables, which use the axes \a usedAxes.
+  
+  If the buffer holds the same layerables for the same axis rect, and the ranges of the used drag
+  axes were only shifted by a whole number of pixels (while the other used axes kept their
+  ranges), the buffer contents are shifted accordingly and only the exposed strips are rendered
+  (see \ref renderScrollBuffer). Otherwise, the whole buffer is rendered.
+*/
+void QCustomPlot::updateScrollBuffer(const QList<QCPLayerable*> &layerables, const QList<QCPAxis*> &usedAxes)
+{
+  const QList<QCPAxis*> allAxes = QList<QCPAxis*>() << xAxis << yAxis << xAxis2 << yAxis2;
+  const QRect bufferRect = mAxisRect.translated(0, -1); // layerables are clipped to this rect, see drawLayerable
+  
+  // determine the pixel offset of the contents since the buffer was rendered:
+  bool shiftable = mScrollBuffer.valid && mScrollBuffer.axisRect == mAxisRect && mScrollBuffer.layerables == layerables;
+  QPoint offset;
+  for (int i=0; i<usedAxes.size() && shiftable; ++i)
+  {
+    QCPAxis *axis = usedAxes.at(i);
+    QCPRange oldRange = mScrollBuffer.axisRanges.at(allAxes.indexOf(axis));
+    QCPRange newRange = axis->range();
+    if (mRangeDrag.testFlag(axis->orientation())) // range drag axis, range may be shifted
+    {
+      bool sameSpan;
+      if (axis->scaleType() == QCPAxis::stLinear)
+        sameSpan = qAbs(newRange.size()-oldRange.size()) <= oldRange.size()*1e-9;
+      else
+        sameSpan = qAbs(newRange.upper/newRange.lower-oldRange.upper/oldRange.lower) <= oldRange.upper/oldRange.lower*1e-9;
+      double shift = axis->coordToPixel(oldRange.lower)-axis->coordToPixel(newRange.lower);
+      if (!sameSpan || qAbs(shift-qRound(shift)) > 0.01)
+        shiftable = false;
+      else if (axis->orientation() == Qt::Horizontal)
+        offset.setX(qRound(shift));
+      else
+        offset.setY(qRound(shift));
+    } else if (newRange.lower != oldRange.lower || newRange.upper != oldRange.upper)
+      shiftable = false;
+  }
+  if (qAbs(offset.x()) >= bufferRect.width() || qAbs(offset.y()) >= bufferRect.height())
+    shiftable = false;
+  
+  if (shiftable)
+  {
+    if (offset.isNull())
+      return;
+    QPixmap shifted(bufferRect.size());
+    shifted.fill(Qt::transparent);
+    QPainter shiftPainter(&shifted);
+    shiftPainter.drawPixmap(offset, mScrollBuffer.pixmap);
+    shiftPainter.end();
+    mScrollBuffer.pixmap = shifted;
+    // render the exposed strips, the horizontal strip leaves out the columns of the vertical strip:
+    int dx = qAbs(offset.x());
+    int dy = qAbs(offset.y());
+    if (dx > 0)
+    {
+      QRect strip(offset.x() > 0 ? bufferRect.left() : bufferRect.right()+1-dx, bufferRect.top(), dx, bufferRect.height());
+      renderScrollBuffer(layerables, strip, true);
+    }
+    if (dy > 0)
+    {
+      QRect strip(offset.x() > 0 ? bufferRect.left()+dx : bufferRect.left(), offset.y() > 0 ? bufferRect.top() : bufferRect.bottom()+1-dy, bufferRect.width()-dx, dy);
+      renderScrollBuffer(layerables, strip, true);
+    }
+  } else
+  {
+    mScrollBuffer.pixmap = QPixmap(bufferRect.size());
+    mScrollBuffer.pixmap.fill(Qt::transparent);
+    renderScrollBuffer(layerables, bufferRect, false);
+  }
+  
+  mScrollBuffer.valid = true;
+  mScrollBuffer.axisRect = mAxisRect;
+  mScrollBuffer.layerables = layerables;
+  mScrollBuffer.axisRanges.clear();
+  for (int i=0; i<allAxes.size(); ++i)
+    mScrollBuffer.axisRanges.append(allAxes.at(i)->range());
+}
+
+/*! \internal
+  
+  Draws the \a layerables into the scroll buffer, clipped to \a region (in widget coordinates).
+  
+  If \a restrictData is true, the \a region, widened by the pixel overhang of the layerables (see
+  \ref scrollOverhang), is passed to the layerables as data region of the painter (see
+  QCPPainter::setDataRegion). Graphs then only process the data in and near the region, which
+  makes rendering a narrow strip cheap, while scatter symbols and error bars of data points just
+  outside the region still reach into it. If the overhang isn't bounded, the layerables are only
+  clipped to the region. The axes aren't modified, so no rangeChanged signals are emitted and the
+  geometry caches of the graphs aren't affected.
+*/
+void QCustomPlot::renderScrollBuffer(const QList<QCPLayerable*> &layerables, const QRect &region, bool restrictData)
+{
+  QCPPainter painter(&mScrollBuffer.pixmap);
+  painter.setRenderHint(QPainter::HighQualityAntialiasing);
+  painter.setDraftMode(mDrafting);
+  int overhang = restrictData ? scrollOverhang(layerables) : -1;
+  if (overhang >= 0)
+    painter.setDataRegion(QRectF(region.adjusted(-overhang, -overhang, overhang, overhang)));
+  painter.translate(-mAxisRect.translated(0, -1).topLeft());
+  for (int i=0; i<layerables.size(); ++i)
+  {
+    QCPLayerable *layerable = layerables.at(i);
+    painter.save();
+    painter.setClipRect(layerable->clipRect().translated(0, -1) & region);
+    layerable->applyDefaultAntialiasingHint(&painter);
+    layerable->draw(&painter);
+    painter.restore();
+  }
+  painter.end();
+}
+
+/*! \internal
+  
+  Returns by how many pixels the drawing of the scrollable \a layerables may reach beyond the
+  pixel positions of their data, i.e. half the extent of scatter symbols and error bar ends plus
+  the pen widths. Returns -1 if this isn't bounded in pixels, e.g. for bars, statistical boxes and
+  graphs with key error bars, whose extent is given in plot coordinates.
+  
+  \see renderScrollBuffer
+*/
+int QCustomPlot::scrollOverhang(const QList<QCPLayerable*> &layerables) const
+{
+  double overhang = 0;
+  for (int i=0; i<layerables.size(); ++i)
+  {
+    QCPLayerable *layerable = layerables.at(i);
+    double symbolSize, penWidth;
+    if (QCPGraph *graph = qobject_cast<QCPGraph*>(layerable))
+    {
+      if (graph->errorType() == QCPGraph::etKey || graph->errorType() == QCPGraph::etBoth)
+        return -1;
+      symbolSize = graph->scatterStyle() == QCP::ssPixmap ? qMax(graph->scatterPixmap().width(), graph->scatterPixmap().height()) : graph->scatterSize();
+      if (graph->errorType() != QCPGraph::etNone)
+        symbolSize = qMax(symbolSize, graph->errorBarSize());
+      penWidth = qMax(qMax(graph->pen().widthF(), graph->selectedPen().widthF()), graph->errorPen().widthF());
+    } else if (QCPCurve *curve = qobject_cast<QCPCurve*>(layerable))
+    {
+      symbolSize = curve->scatterStyle() == QCP::ssPixmap ? qMax(curve->scatterPixmap().width(), curve->scatterPixmap().height()) : curve->scatterSize();
+      penWidth = qMax(curve->pen().widthF(), curve->selectedPen().widthF());
+    } else if (QCPGrid *grid = qobject_cast<QCPGrid*>(layerable))
+    {
+      symbolSize = 0;
+      penWidth = qMax(qMax(grid->pen().widthF(), grid->subGridPen().widthF()), grid->zeroLinePen().widthF());
+    } else
+      return -1;
+    overhang = qMax(overhang, symbolSize*0.5 + qMax(penWidth, 1.0));
+  }
+  return qCeil(overhang)+1; // one more pixel for antialiasing
+}
+
+/*! \internal
+  
+  Called for every drag and zoom step of a user interaction. If a draft point budget is set (\ref
+  setDraftPointBudget), the following replots are drawn with reduced detail, until the interaction
+  has been idle for the refine delay (\ref setRefineDelay) and \ref refineReplot is called.
+*/
+void QCustomPlot::beginDraft()
+{
+  if (mDraftPointBudget > 0)
+  {
+    mDrafting = true;
+    mRefineTimer.start(mRefineDelay);
+  }
+}
+
+/*! \internal
+  
+  calculates mAxisRect by applying the margins inward to mViewport. The axisRect is then passed on
+  to all axes via QCPAxis::setAxisRect
+  
+  \see setMargin, setAxisRect
+*/
+void QCustomPlot::updateAxisRect()
+{
+  mAxisRect = mViewport.adjusted(mMarginLeft, mMarginTop, -mMarginRight, -mMarginBottom);
+  xAxis->setAxisRect(mAxisRect);
+  yAxis->setAxisRect(mAxisRect);
+  xAxis2->setAxisRect(mAxisRect);
+  yAxis2->setAxisRect(mAxisRect);
+}
+
+/*! \internal
+  
+  Returns whether the point \a pos in pixels hits the plot title.
+*/
+bool QCustomPlot::selectTestTitle(const QPointF &pos) const
+{
+  return mTitleBoundingBox.contains(pos.toPoint());
+}
+
+/*!
+  Saves the plot to a rastered image file \a fileName in the image format \a
+  format. The plot is sized to \a width and \a height in pixels and scaled with
+  \a scale. (width 100 and scale 2.0 lead to a full resolution file with width
+  200.) If the \a format supports compression, \a quality may be between 0 and
+  100 to control it.
+  
+  Returns true on success. If this function fails, most likely the given \a format isn't supported
+  by the system, see Qt docs about QImageWriter::supportedImageFormats().
+  
+  The plot is rendered with \ref toImage, so this function may be called from a worker thread
+  under the same conditions.
+  
+  \see saveBmp, saveJpg, savePng, savePdf
+*/
+bool QCustomPlot::saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality)
+{
+  return toImage(width, height, scale).save(fileName, format, quality);
+}
+
+/*!
+  Renders the plot to a pixmap and returns it.
+  
+  The plot is sized to \a width and \a height in pixels and scaled with \a scale. (width 100 and
+  scale 2.0 lead to a full resolution pixmap with width 200.)
+  
+  \see saveRastered, saveBmp, savePng, saveJpg, savePdf
+*/
+QPixmap QCustomPlot::pixmap(int width, int height, double scale)
+{
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  int scaledWidth = qRound(scale*newWidth);
+  int scaledHeight = qRound(scale*newHeight);
+
+  QPixmap result(scaledWidth, scaledHeight);
+  result.fill(mColor);
+  QCPPainter painter(&result);
+  QRect oldViewport = mViewport;
+  mViewport = QRect(0, 0, newWidth, newHeight);
+  updateAxisRect();
+  if (!qFuzzyCompare(scale, 1.0))
+  {
+    if (scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines would disappear
+    {
+      painter.setScaledExportMode(true);
+      painter.setRenderHint(QPainter::NonCosmeticDefaultPen);
+    }
+    painter.scale(scale, scale);
+  }
+  draw(&painter);
+  mViewport = oldViewport;
+  updateAxisRect();
+  return result;
+}
+
+/*! \internal
+  
+  Rasterizes the recorded drawing commands \a pictureData (see QPicture::data) in the region \a
+  tile into the pixels of an ARGB32_Premultiplied image, which start with the top left pixel of the
+  tile at \a bits and have \a bytesPerLine bytes per line. Runs on a worker thread, see \ref
+  QCustomPlot::setExportTileSize and \ref QCustomPlot::savePpm.
+  
+  Each tile creates its own QPicture from \a pictureData, because playing a QPicture isn't
+  reentrant.
+*/
+static void qcpRenderTile(uchar *bits, int bytesPerLine, const QRect &tile, const QByteArray &pictureData)
+{
+  QImage tileImage(bits, tile.width(), tile.height(), bytesPerLine, QImage::Format_ARGB32_Premultiplied);
+  QPicture picture;
+  picture.setData(pictureData.constData(), pictureData.size());
+  QPainter painter(&tileImage);
+  painter.translate(-tile.topLeft());
+  painter.drawPicture(0, 0, picture);
+}
+
+/*!
+  Renders the plot to an image and returns it.
+  
+  The plot is sized to \a width and \a height in pixels and scaled with \a scale. (width 100 and
+  scale 2.0 lead to a full resolution image with width 200.) If \a width or \a height is zero, the
+  current widget size is used.
+  
+  Unlike \ref pixmap, this function doesn't need the GUI thread and the widget doesn't need to be
+  shown. This allows generating images without a display, and in parallel: Create several
+  QCustomPlot instances (widgets must be created on the GUI thread) and hand each one to a worker
+  thread, which sets it up and calls toImage or \ref saveRastered. While a worker thread renders a
+  plot, no other thread may access that plot. Tick labels aren't pixmap-cached when rendering on a
+  thread other than the one the plot lives in (see QCP::phCacheLabels). Pixmaps set by the user
+  (e.g. \ref setAxisBackground, scatter pixmaps, QCPItemPixmap) are still drawn, which requires the
+  raster graphics system on X11 when rendering on a worker thread.
+  
+  Large images can be rendered in tiles on multiple threads, see \ref setExportTileSize.
+  
+  \see pixmap, saveRastered
+*/
+QImage QCustomPlot::toImage(int width, int height, double scale)
+{
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  int scaledWidth = qRound(scale*newWidth);
+  int scaledHeight = qRound(scale*newHeight);
+  
+  QImage result(scaledWidth, scaledHeight, QImage::Format_ARGB32_Premultiplied); // supports background transparency (of mColor), like the pixmaps
+  result.fill(0);
+  {
+    QPainter backgroundPainter(&result);
+    backgroundPainter.fillRect(result.rect(), mColor);
+  }
+  // with tiled rendering, record the drawing commands and rasterize them tile by tile afterwards:
+  const bool tiled = mExportTileSize > 0 && (scaledWidth > mExportTileSize || scaledHeight > mExportTileSize);
+  QPicture picture;
+  QCPPainter painter;
+  if (tiled)
+    painter.begin(&picture);
+  else
+    painter.begin(&result);
+  drawExport(&painter, newWidth, newHeight, scale);
+  painter.end();
+  
+  if (tiled)
+  {
+    const QByteArray pictureData(picture.data(), picture.size());
+    uchar *bits = result.bits();
+    QFutureSynchronizer<void> synchronizer;
+    for (int y=0; y<scaledHeight; y+=mExportTileSize)
+    {
+      for (int x=0; x<scaledWidth; x+=mExportTileSize)
+      {
+        QRect tile(x, y, qMin(mExportTileSize, scaledWidth-x), qMin(mExportTileSize, scaledHeight-y));
+        synchronizer.addFuture(QtConcurrent::run(qcpRenderTile, bits + y*result.bytesPerLine() + x*4, result.bytesPerLine(), tile, pictureData));
+      }
+    }
+    synchronizer.waitForFinished();
+  }
+  return result;
+}
+
+/*!
+  Saves a binary PPM (portable pixmap) image file to \a fileName on disc. The parameters \a width,
+  \a height and \a scale have the same meaning as for \ref savePng.
+  
+  Unlike the other save functions, this doesn't allocate the complete image. The drawing commands
+  of the plot are recorded once, then the image is rasterized in bands of full width on multiple
+  threads and each band is written to the file before the next ones are rasterized. The band
+  height is the export tile size (\ref setExportTileSize) or 256 rows if tiled rendering is
+  disabled. So apart from the recorded drawing commands, the memory needed is bounded by the width
+  of the image times the band height times the number of cores, regardless of the image height.
+  This allows exporting images that are larger than the available memory. The file can be converted
+  to other formats by external tools.
+  
+  PPM doesn't support transparency, so a translucent background color (\ref setColor) is blended
+  with white.
+  
+  Returns true on success, or false if the file couldn't be written.
+  
+  \see savePng, saveRastered, toImage
+*/
+bool QCustomPlot::savePpm(const QString &fileName, int width, int height, double scale)
+{
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  int scaledWidth = qRound(scale*newWidth);
+  int scaledHeight = qRound(scale*newHeight);
+  if (scaledWidth <= 0 || scaledHeight <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "Invalid image size" << scaledWidth << scaledHeight;
+    return false;
+  }
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't open file" << fileName;
+    return false;
+  }
+  
+  QPicture picture;
+  QCPPainter painter;
+  painter.begin(&picture);
+  drawExport(&painter, newWidth, newHeight, scale);
+  painter.end();
+  const QByteArray pictureData(picture.data(), picture.size());
+  
+  char header[64];
+  int headerLength = qsnprintf(header, sizeof(header), "P6\n%d %d\n255\n", scaledWidth, scaledHeight);
+  bool ok = file.write(header, headerLength) == headerLength;
+  const int bandHeight = mExportTileSize > 0 ? mExportTileSize : 256;
+  const int concurrentBands = qMax(1, QThread::idealThreadCount());
+  QByteArray line(3*scaledWidth, 0);
+  for (int firstTop=0; firstTop<scaledHeight && ok; firstTop+=concurrentBands*bandHeight)
+  {
+    // rasterize the next bands concurrently, then write them in order:
+    QVector<QImage> bands;
+    for (int top=firstTop; top<scaledHeight && bands.size()<concurrentBands; top+=bandHeight)
+      bands.append(QImage(scaledWidth, qMin(bandHeight, scaledHeight-top), QImage::Format_ARGB32_Premultiplied));
+    QFutureSynchronizer<void> synchronizer;
+    for (int i=0; i<bands.size(); ++i)
+    {
+      QPainter backgroundPainter(&bands[i]);
+      backgroundPainter.fillRect(bands[i].rect(), Qt::white);
+      backgroundPainter.fillRect(bands[i].rect(), mColor);
+      backgroundPainter.end();
+      synchronizer.addFuture(QtConcurrent::run(qcpRenderTile, bands[i].bits(), bands[i].bytesPerLine(), QRect(0, firstTop+i*bandHeight, scaledWidth, bands.at(i).height()), pictureData));
+    }
+    synchronizer.waitForFinished();
+    for (int i=0; i<bands.size() && ok; ++i)
+    {
+      for (int row=0; row<bands.at(i).height() && ok; ++row)
+      {
+        const QRgb *pixels = reinterpret_cast<const QRgb*>(bands.at(i).scanLine(row));
+        char *rgb = line.data();
+        for (int x=0; x<scaledWidth; ++x)
+        {
+          *rgb++ = char(qRed(pixels[x]));
+          *rgb++ = char(qGreen(pixels[x]));
+          *rgb++ = char(qBlue(pixels[x]));
+        }
+        ok = file.write(line) == line.size();
+      }
+    }
+  }
+  if (!ok)
+    qDebug() << Q_FUNC_INFO << "Couldn't write file" << fileName;
+  return ok;
+}
+
+/*! \internal
+  
+  Draws the plot with \a painter for an export, sized to \a width and \a height in pixels and
+  scaled with \a scale (see \ref toImage). The viewport of the plot is restored afterwards.
+*/
+void QCustomPlot::drawExport(QCPPainter *painter, int width, int height, double scale)
+{
+  QRect oldViewport = mViewport;
+  mViewport = QRect(0, 0, width, height);
+  updateAxisRect();
+  if (!qFuzzyCompare(scale, 1.0))
+  {
+    if (scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines would disappear
+    {
+      painter->setScaledExportMode(true);
+      painter->setRenderHint(QPainter::NonCosmeticDefaultPen);
+    }
+    painter->scale(scale, scale);
+  }
+  draw(painter);
+  mViewport = oldViewport;
+  updateAxisRect();
+}
+
+
+// ================================================================================
+// =================== QCPData
+// ================================================================================
+
+/*! \class QCPData
+  \brief Holds the data of one single data point for QCPGraph.
+  
+  The stored data is:
+  \li \a key: coordinate on the key axis of this data point
+  \li \a value: coordinate on the value axis of this data point
+  \li \a keyErrorMinus: negative error in the key dimension (for error bars)
+  \li \a keyErrorPlus: positive error in the key dimension (for error bars)
+  \li \a valueErrorMinus: negative error in the value dimension (for error bars)
+  \li \a valueErrorPlus: positive error in the value dimension (for error bars)
+  
+  \see QCPDataMap
+*/
+
+/*!
+  Constructs a data point with key, value and all errors set to zero.
+*/
+QCPData::QCPData() :
+  key(0),
+  value(0),
+  keyErrorPlus(0),
+  keyErrorMinus(0),
+  valueErrorPlus(0),
+  valueErrorMinus(0)
+{
+}
+
+/*!
+  Constructs a data point with the specified \a key and \a value. All errors are set to zero.
+*/
+QCPData::QCPData(double key, double value) :
+  key(key),
+  value(value),
+  keyErrorPlus(0),
+  keyErrorMinus(0),
+  valueErrorPlus(0),
+  valueErrorMinus(0)
+{
+}
+
+
+// ================================================================================
+// =================== QCPDataView
+// ================================================================================
+
+/*! \class QCPDataView
+  \brief Read-only view on keys and values of data points, located anywhere in memory
+  
+  A data view describes where the keys and values of a number of data points are stored, by a
+  pointer to the first key, a pointer to the first value and a stride for each. The stride is the
+  distance in bytes from one key (or value) to the next. This way, keys and values can be stored in
+  two separate arrays of doubles (stride sizeof(double), the default), interleaved in one array of
+  structs (stride sizeof(struct)), or in any other regular layout. The view doesn't own or copy the
+  memory it refers to.
+  
+  The keys must be sorted ascending, because searching by key (\ref lowerBound, \ref upperBound)
+  is done with binary searches.
+  
+  QCPGraph uses data views to read data points independently of whether they are held in its own
+  \ref QCPDataContainer (\ref QCPDataContainer::view) or provided by an external data source (\ref
+  QCPAbstractDataSource::dataView, \ref QCPGraph::setDataSource).
+*/
+
+/*! \fn int QCPDataView::size() const
+  
+  Returns the number of data points in the view.
+*/
+
+/*! \fn bool QCPDataView::isEmpty() const
+  
+  Returns true if the view contains no data points.
+*/
+
+/*! \fn double QCPDataView::key(int index) const
+  
+  Returns the key of the data point at \a index. \a index must be a valid index, i.e. 0 <= \a index
+  < \ref size.
+*/
+
+/*! \fn double QCPDataView::value(int index) const
+  
+  Returns the value of the data point at \a index. \a index must be a valid index, i.e. 0 <= \a
+  index < \ref size.
+*/
+
+/*! \fn const double *QCPDataView::keys() const
+  
+  Returns a pointer to the key of the first data point. The following keys are located at steps of
+  \ref keyStride bytes. Together, they can be passed to functions working on arrays of doubles,
+  like \ref QCPAxis::coordToPixel(const double *coords, qreal *pixels, int count, int coordStride, int pixelStride) const.
+*/
+
+/*! \fn const double *QCPDataView::values() const
+  
+  Returns a pointer to the value of the first data point. The following values are located at steps
+  of \ref valueStride bytes.
+*/
+
+/*! \fn int QCPDataView::keyStride() const
+  
+  Returns the distance in bytes from one key to the next.
+*/
+
+/*! \fn int QCPDataView::valueStride() const
+  
+  Returns the distance in bytes from one value to the next.
+*/
+
+/*!
+  Constructs an empty data view.
+*/
+QCPDataView::QCPDataView() :
+  mKeys(0),
+  mValues(0),
+  mKeyStride(0),
+  mValueStride(0),
+  mSize(0)
+{
+}
+
+/*!
+  Constructs a data view of \a size data points. The key of the first data point is located at \a
+  keys, the following keys are found at steps of \a keyStride bytes. Accordingly, the values are
+  located at \a values with steps of \a valueStride bytes.
+  
+  The keys must be sorted ascending. The memory must stay valid as long as the view is used.
+*/
+QCPDataView::QCPDataView(const double *keys, const double *values, int size, int keyStride, int valueStride) :
+  mKeys(reinterpret_cast<const char*>(keys)),
+  mValues(reinterpret_cast<const char*>(values)),
+  mKeyStride(keyStride),
+  mValueStride(valueStride),
+  mSize(size)
+{
+  if (mSize < 0 || (mSize > 0 && (!mKeys || !mValues)))
+  {
+    qDebug() << Q_FUNC_INFO << "invalid size or null pointer, constructing empty view";
+    mSize = 0;
+  }
+}
+
+/*!
+  Returns a view on the \a count data points starting at \a index. The range is clipped to the
+  data points of this view, so the returned view may be smaller than \a count.
+*/
+QCPDataView QCPDataView::mid(int index, int count) const
+{
+  index = qBound(0, index, mSize);
+  count = qBound(0, count, mSize-index);
+  if (count == 0)
+    return QCPDataView();
+  QCPDataView result(*this);
+  result.mKeys += qint64(index)*mKeyStride;
+  result.mValues += qint64(index)*mValueStride;
+  result.mSize = count;
+  return result;
+}
+
+/*!
+  Returns the index of the first data point whose key is equal to or greater than \a key. If there
+  is no such data point, returns \ref size.
+  
+  \see upperBound
+*/
+int QCPDataView::lowerBound(double key) const
+{
+  int begin = 0;
+  int count = mSize;
+  while (count > 0)
+  {
+    int half = count/2;
+    if (this->key(begin+half) < key)
+    {
+      begin += half+1;
+      count -= half+1;
+    } else
+      count = half;
+  }
+  return begin;
+}
+
+/*!
+  Returns the index of the first data point whose key is greater than \a key. If there is no such
+  data point, returns \ref size.
+  
+  \see lowerBound
+*/
+int QCPDataView::upperBound(double key) const
+{
+  int begin = 0;
+  int count = mSize;
+  while (count > 0)
+  {
+    int half = count/2;
+    if (!(key < this->key(begin+half)))
+    {
+      begin += half+1;
+      count -= half+1;
+    } else
+      count = half;
+  }
+  return begin;
+}
+
+
+// ================================================================================
+// =================== QCPAbstractDataSource
+// ================================================================================
+
+/*! \class QCPAbstractDataSource
+  \brief The abstract base class for external data that is plotted by a QCPGraph without copying
+  
+  Normally, a QCPGraph holds its data points in its own \ref QCPDataContainer, so all data is
+  copied into the graph when calling \ref QCPGraph::setData or \ref QCPGraph::addData. If the data
+  already lives in memory the application manages, e.g. an acquisition buffer or a memory-mapped
+  file, this duplicates potentially huge amounts of memory. Instead, an instance of a subclass of
+  QCPAbstractDataSource can be passed to \ref QCPGraph::setDataSource. The graph then reads the
+  data points directly from the memory described by \ref dataView whenever it is replotted.
+  
+  Subclasses must implement \ref dataView, returning a \ref QCPDataView that describes where the
+  keys and values are located. The keys must be sorted ascending. Whenever the data or its
+  location changes, the subclass should emit \ref dataChanged. Since QCPGraph only reads the data
+  during replots, the memory must not be changed or freed while a replot is in progress.
+  
+  For data in plain arrays, \ref QCPArrayDataSource can be used directly.
+  
+  External data sources can't provide error bars.
+*/
+
+/* start of documentation of pure virtual functions */
+
+/*! \fn virtual QCPDataView QCPAbstractDataSource::dataView() const = 0
+  
+  Returns a view on the current data of this data source. QCPGraph calls this function at the
+  beginning of every operation that reads the data, e.g. once per replot, so the returned view
+  may change between calls.
+*/
+
+/* end of documentation of pure virtual functions */
+/* start of documentation of signals */
+
+/*! \fn void QCPAbstractDataSource::dataChanged()
+  
+  This signal should be emitted by subclasses when the data or its location in memory has changed.
+  Connect it to a slot that replots the plot, if the changes shall become visible immediately.
+*/
+
+/* end of documentation of signals */
+
+/*!
+  Constructs an abstract data source with the given \a parent.
+*/
+QCPAbstractDataSource::QCPAbstractDataSource(QObject *parent) :
+  QObject(parent)
+{
+}
+
+QCPAbstractDataSource::~QCPAbstractDataSource()
+{
+}
+
+
+// ================================================================================
+// =================== QCPArrayDataSource
+// ================================================================================
+
+/*! \class QCPArrayDataSource
+  \brief A data source for QCPGraph that refers to keys and values in application-owned arrays
+  
+  This is the straightforward implementation of \ref QCPAbstractDataSource for data that is stored
+  in arrays with a fixed location. Pass the location of the arrays with \ref setArrays. If the
+  arrays are filled successively, e.g. by an acquisition, update the number of valid data points
+  with \ref setSize. If the data was changed in place, call \ref notifyDataChanged.
+  
+  The arrays are not copied and must stay valid as long as the data source refers to them.
+*/
+
+/*! \fn int QCPArrayDataSource::size() const
+  
+  Returns the number of data points as set with \ref setArrays or \ref setSize.
+*/
+
+/*!
+  Constructs an empty array data source with the given \a parent. Call \ref setArrays to let it
+  refer to data.
+*/
+QCPArrayDataSource::QCPArrayDataSource(QObject *parent) :
+  QCPAbstractDataSource(parent),
+  mKeys(0),
+  mValues(0),
+  mSize(0),
+  mKeyStride(sizeof(double)),
+  mValueStride(sizeof(double))
+{
+}
+
+QCPArrayDataSource::~QCPArrayDataSource()
+{
+}
+
+/*!
+  Sets the location of the data. The key of the first of \a size data points is located at \a
+  keys, the following keys are found at steps of \a keyStride bytes. Accordingly, the values are
+  located at \a values with steps of \a valueStride bytes. The default strides correspond to two
+  separate arrays of doubles. For an array of structs, pass the address of the key and value
+  member of the first struct and sizeof(struct) as strides.
+  
+  The keys must be sorted ascending. Emits \ref dataChanged.
+*/
+void QCPArrayDataSource::setArrays(const double *keys, const double *values, int size, int keyStride, int valueStride)
+{
+  mKeys = keys;
+  mValues = values;
+  mSize = size;
+  mKeyStride = keyStride;
+  mValueStride = valueStride;
+  emit dataChanged();
+}
+
+/*!
+  Sets the number of valid data points in the arrays passed with \ref setArrays. This is useful
+  when the arrays are filled successively. Emits \ref dataChanged.
+*/
+void QCPArrayDataSource::setSize(int size)
+{
+  mSize = size;
+  emit dataChanged();
+}
+
+/* inherits documentation from base class */
+QCPDataView QCPArrayDataSource::dataView() const
+{
+  return QCPDataView(mKeys, mValues, mSize, mKeyStride, mValueStride);
+}
+
+/*!
+  Emits \ref dataChanged. Call this function after the data in the arrays was modified in place.
+*/
+void QCPArrayDataSource::notifyDataChanged()
+{
+  emit dataChanged();
+}
+
+
+// ================================================================================
+// =================== QCPDataLodIndex
+// ================================================================================
+
+/*! \class QCPDataLodIndex
+  \brief Level of detail index over the values of a QCPDataContainer
+  
+  This is an internal class used by \ref QCPDataContainer, when its level of detail index is
+  enabled (\ref QCPDataContainer::setLodIndex). It allows to determine the minimum and maximum
+  value of any index range of the data points in O(log n), instead of scanning all points in the
+  range.
+  
+  The index is a pyramid of levels. Level 0 divides the data points into buckets of
+  2^baseShift consecutive points and stores the minimum and maximum value of each bucket (as a
+  QCPRange). Every higher level combines two buckets of the level below, so the bucket size
+  doubles from level to level, until the top level consists of a single bucket. The first and last
+  value of a bucket are not stored, since they can be read directly from the data container.
+  
+  Buckets are aligned to an absolute index, that keeps counting when data points are removed from
+  the front. This way, the index can be maintained incrementally in the typical realtime use case
+  of appending points at the end (\ref append) and removing old points at the front (\ref
+  removeFront), or truncating the data at the end (\ref removeBack). All other modifications of
+  the data container invalidate the index (\ref invalidate), and it is rebuilt the next time it is
+  needed.
+*/
+
+/*!
+  Constructs an invalid level of detail index. Call \ref rebuild to make it valid.
+*/
+QCPDataLodIndex::QCPDataLodIndex() :
+  mOffset(0),
+  mValid(false)
+{
+}
+
+/*!
+  Marks the index as invalid and frees its memory. Until the next call to \ref rebuild, all
+  updates via \ref append, \ref removeFront and \ref removeBack are ignored.
+*/
+void QCPDataLodIndex::invalidate()
+{
+  mLevels.clear();
+  mFirstBucket.clear();
+  mOffset = 0;
+  mValid = false;
+}
+
+/*!
+  Builds the index for the data points in \a data, which must be sorted by key. Afterwards, the
+  index is valid.
+*/
+void QCPDataLodIndex::rebuild(const QCPDataView &data)
+{
+  invalidate();
+  mValid = true;
+  append(data, 0);
+}
+
+/*!
+  Updates the index after data points were appended at the end of the data container. \a data is
+  the view on all data points of the container after the points were appended, \a oldSize is the
+  size of the container before.
+*/
+void QCPDataLodIndex::append(const QCPDataView &data, int oldSize)
+{
+  int newSize = data.size();
+  if (!mValid || newSize <= oldSize) return;
+  
+  qint64 firstChangedBucket = (mOffset+oldSize) >> baseShift;
+  if (mLevels.isEmpty())
+  {
+    mLevels.append(QVector<QCPRange>());
+    mFirstBucket.append(firstChangedBucket);
+  }
+  // update level 0 directly with the new data points:
+  QVector<QCPRange> &level = mLevels[0];
+  for (int i=oldSize; i<newSize; ++i)
+  {
+    int bucket = ((mOffset+i) >> baseShift) - mFirstBucket.at(0);
+    double value = data.value(i);
+    if (bucket == level.size())
+    {
+      level.append(QCPRange(value, value));
+    } else
+    {
+      QCPRange &range = level[bucket];
+      if (value < range.lower)
+        range.lower = value;
+      if (value > range.upper)
+        range.upper = value;
+    }
+  }
+  updateUpperLevels(firstChangedBucket);
+}
+
+/*!
+  Updates the index after \a count data points were removed from the front of the data container.
+  
+  Buckets that only contained removed points are dropped. The bucket containing the new first data
+  point keeps its stale range. This is no problem, because only buckets that lie completely inside
+  the queried index range are used by \ref valueRange.
+*/
+void QCPDataLodIndex::removeFront(int count)
+{
+  if (!mValid || count <= 0) return;
+  
+  mOffset += count;
+  for (int i=0; i<mLevels.size(); ++i)
+  {
+    int obsoleteBuckets = qMin(qint64(mLevels.at(i).size()), (mOffset >> (baseShift+i)) - mFirstBucket.at(i));
+    if (obsoleteBuckets > 0)
+    {
+      mLevels[i].remove(0, obsoleteBuckets);
+      mFirstBucket[i] += obsoleteBuckets;
+    }
+    if (mLevels.at(i).isEmpty()) // let next appended data point start in correct bucket
+      mFirstBucket[i] = mOffset >> (baseShift+i);
+  }
+}
+
+/*!
+  Updates the index after data points were removed from the end of the data container. \a data is
+  the view on the remaining data points of the container.
+  
+  Unlike in \ref removeFront, the buckets containing the new last data point must be recalculated,
+  because further data points appended later will end up in them.
+*/
+void QCPDataLodIndex::removeBack(const QCPDataView &data)
+{
+  if (!mValid) return;
+  int newSize = data.size();
+  if (newSize <= 0)
+  {
+    // nothing left to index, start over but keep counting the absolute index:
+    qint64 offset = mOffset;
+    rebuild(data);
+    mOffset = offset;
+    return;
+  }
+  
+  qint64 end = mOffset+newSize; // absolute index after last data point
+  for (int i=0; i<mLevels.size(); ++i)
+  {
+    int bucketCount = ((end-1) >> (baseShift+i)) - mFirstBucket.at(i) + 1;
+    if (bucketCount < mLevels.at(i).size())
+      mLevels[i].resize(bucketCount);
+  }
+  // recalculate last bucket of level 0 from the data points, the upper levels from their children:
+  qint64 lastBucket = (end-1) >> baseShift;
+  int begin = qMax(lastBucket << baseShift, mOffset) - mOffset;
+  QCPRange range(data.value(begin), data.value(begin));
+  for (int i=begin+1; i<newSize; ++i)
+  {
+    double value = data.value(i);
+    if (value < range.lower)
+      range.lower = value;
+    if (value > range.upper)
+      range.upper = value;
+  }
+  mLevels[0].last() = range;
+  updateUpperLevels(lastBucket);
+}
+
+/*!
+  Returns the minimum (QCPRange::lower) and maximum (QCPRange::upper) value of the data points with
+  indices from \a begin up to \a end (excluding \a end). \a data is the view on the data points of
+  the container the index was built for. The range from \a begin to \a end must not be empty.
+  
+  The data points at the borders of the range, which only partially cover a bucket, are read
+  directly from \a data. The rest of the range is covered with the largest possible buckets of the
+  index, so this takes O(log n) time.
+  
+  The index must be valid when calling this function.
+*/
+QCPRange QCPDataLodIndex::valueRange(const QCPDataView &data, int begin, int end) const
+{
+  QCPRange result(data.value(begin), data.value(begin));
+  qint64 lowerIndex = mOffset+begin+1;
+  qint64 upperIndex = mOffset+end;
+  const qint64 bucketMask = (qint64(1) << baseShift)-1;
+  // data points before the first complete bucket:
+  while (lowerIndex < upperIndex && (lowerIndex & bucketMask) != 0)
+  {
+    double value = data.value(lowerIndex-mOffset);
+    if (value < result.lower)
+      result.lower = value;
+    if (value > result.upper)
+      result.upper = value;
+    ++lowerIndex;
+  }
+  // data points after the last complete bucket:
+  while (upperIndex > lowerIndex && (upperIndex & bucketMask) != 0)
+  {
+    --upperIndex;
+    double value = data.value(upperIndex-mOffset);
+    if (value < result.lower)
+      result.lower = value;
+    if (value > result.upper)
+      result.upper = value;
+  }
+  // complete buckets, walking up the levels:
+  qint64 lowerBucket = lowerIndex >> baseShift;
+  qint64 upperBucket = upperIndex >> baseShift;
+  for (int i=0; i<mLevels.size() && lowerBucket < upperBucket; ++i)
+  {
+    const QVector<QCPRange> &level = mLevels.at(i);
+    qint64 firstBucket = mFirstBucket.at(i);
+    bool topLevel = i == mLevels.size()-1;
+    while (lowerBucket < upperBucket && (topLevel || (lowerBucket & 1) != 0))
+    {
+      const QCPRange &range = level.at(lowerBucket-firstBucket);
+      if (range.lower < result.lower)
+        result.lower = range.lower;
+      if (range.upper > result.upper)
+        result.upper = range.upper;
+      ++lowerBucket;
+    }
+    if (lowerBucket < upperBucket && (upperBucket & 1) != 0)
+    {
+      --upperBucket;
+      const QCPRange &range = level.at(upperBucket-firstBucket);
+      if (range.lower < result.lower)
+        result.lower = range.lower;
+      if (range.upper > result.upper)
+        result.upper = range.upper;
+    }
+    lowerBucket >>= 1;
+    upperBucket >>= 1;
+  }
+  return result;
+}
+
+/*! \internal
+  
+  Recalculates the buckets of all levels above level 0 that depend on the level 0 bucket \a
+  firstChangedBucket or any bucket after it. New levels are added on top until the top level
+  consists of a single bucket.
+*/
+void QCPDataLodIndex::updateUpperLevels(qint64 firstChangedBucket)
+{
+  for (int i=1; i<mLevels.size() || mLevels.last().size() > 1; ++i)
+  {
+    if (i == mLevels.size())
+    {
+      // add new top level, which needs to be calculated completely:
+      mLevels.append(QVector<QCPRange>());
+      mFirstBucket.append(mFirstBucket.at(i-1) >> 1);
+      firstChangedBucket = mFirstBucket.at(i-1);
+    }
+    const QVector<QCPRange> &childLevel = mLevels.at(i-1);
+    qint64 firstChild = mFirstBucket.at(i-1);
+    qint64 endChild = firstChild+childLevel.size();
+    if (endChild <= firstChild) break;
+    QVector<QCPRange> &level = mLevels[i];
+    qint64 firstBucket = mFirstBucket.at(i);
+    qint64 endBucket = ((endChild-1) >> 1) + 1;
+    level.resize(endBucket-firstBucket);
+    for (qint64 bucket=qMax(firstChangedBucket >> 1, firstBucket); bucket<endBucket; ++bucket)
+    {
+      qint64 child = qMax(bucket*2, firstChild);
+      QCPRange range = childLevel.at(child-firstChild);
+      if (child+1 < endChild && child+1 < bucket*2+2)
+      {
+        const QCPRange &secondRange = childLevel.at(child+1-firstChild);
+        if (secondRange.lower < range.lower)
+          range.lower = secondRange.lower;
+        if (secondRange.upper > range.upper)
+          range.upper = secondRange.upper;
+      }
+      level[bucket-firstBucket] = range;
+    }
+    firstChangedBucket >>= 1;
+  }
+}
+
+
+// ================================================================================
+// =================== QCPDataContainer
+// ================================================================================
+
+/*! \class QCPDataContainer
+  \brief Holds the data points of a QCPGraph in a contiguous array sorted by key.
+  
+  Unlike a \ref QCPDataMap, where every data point is a separately allocated tree node, this
+  container keeps all data points in one contiguous block of memory, sorted ascending by their key.
+  Iterating over a key range therefore streams linearly through memory, which is what the drawing
+  routines of QCPGraph spend most of their time doing.
+  
+  As long as no data point carries error values, only the key and value of each point are stored,
+  which makes the container a third of the size of an array of \ref QCPData. As soon as a point
+  with non-zero errors is added, the container switches to a layout that stores all members of
+  \ref QCPData (\ref hasErrors). Since the points aren't stored as \ref QCPData instances, \ref at
+  returns them by value. For fast iteration over keys and values, use \ref view.
+  
+  Appending points with keys equal to or greater than the current last key (the typical case for
+  realtime data) is amortized O(1). Points with smaller keys are inserted at their sorted
+  position. Searching by key (\ref lowerBound, \ref upperBound) is done with binary searches and
+  returns indices that can be passed to \ref at.
+  
+  Points with equal keys are allowed and keep the order in which they were added.
+  
+  Optionally, the container maintains a level of detail index over the values of its data points
+  (\ref setLodIndex), which allows \ref valueRange to determine the value extremes of any index
+  range in O(log n).
+  
+  For realtime data, the container can be limited to a fixed capacity (\ref setCapacity). It then
+  works as a ring buffer that overwrites the oldest data points when new ones are appended, without
+  any memory allocations.
+  
+  \see QCPGraph::data, QCPGraph::setData
+*/
+
+/*! \internal
+  
+  Comparison function that orders \ref QCPData instances by their key. Used for sorting inside
+  \ref QCPDataContainer.
+*/
+inline bool qcpDataKeyLessThan(const QCPData &a, const QCPData &b)
+{
+  return a.key < b.key;
+}
+
+/*! \fn int QCPDataContainer::size() const
+  
+  Returns the number of data points in the container.
+*/
+
+/*! \fn bool QCPDataContainer::isEmpty() const
+  
+  Returns true if the container holds no data points.
+*/
+
+/*! \fn QCPData QCPDataContainer::first() const
+  
+  Returns the data point with the smallest key. The container must not be empty.
+*/
+
+/*! \fn QCPData QCPDataContainer::last() const
+  
+  Returns the data point with the largest key. The container must not be empty.
+*/
+
+/*! \fn bool QCPDataContainer::hasErrors() const
+  
+  Returns whether the container stores error values for its data points. This is the case as soon
+  as a data point with non-zero errors was added. Otherwise, only keys and values are stored and
+  the errors returned by \ref at are zero.
+*/
+
+/*! \fn int QCPDataContainer::revision() const
+  
+  Returns the revision of the data points. The revision changes whenever data points are removed
+  or replaced, but neither when data points are appended at the end nor when they are removed from
+  the front (see \ref frontOffset). So as long as the revision stays the same, the data point with
+  index \a i at some earlier point now has index \a i minus the growth of \ref frontOffset, if it
+  wasn't removed. This allows to incrementally maintain information derived from the data points,
+  like QCPGraph does for its key and value ranges.
+  
+  Revisions are unique among all containers, except for copies of a container, which hold the
+  same data points.
+*/
+
+/*! \fn qint64 QCPDataContainer::frontOffset() const
+  
+  Returns the total number of data points that were removed from the front of the container, e.g.
+  with \ref removeBefore or by overwriting the oldest points of a ring buffer (\ref setCapacity).
+  The sum of the front offset and the index of a data point identifies the point as long as the
+  \ref revision stays the same.
+*/
+
+/*!
+  Constructs an empty data container.
+*/
+QCPDataContainer::QCPDataContainer() :
+  mRecordSize(compactRecordSize),
+  mBegin(0),
+  mSize(0),
+  mCapacity(0),
+  mAppendStart(0),
+  mRevision(0),
+  mFrontOffset(0),
+  mLodIndexEnabled(false)
+{
+  newRevision();
+}
+
+/*!
+  Returns the data point at \a index. Data points are sorted ascending by key, so index 0 is the
+  point with the smallest key. \a index must be a valid index, i.e. 0 <= \a index < \ref size.
+  
+  If the container doesn't store errors (\ref hasErrors), the errors of the returned point are zero.
+*/
+QCPData QCPDataContainer::at(int index) const
+{
+  const double *record = mStore.constData()+qint64(mBegin+index)*mRecordSize;
+  QCPData result(record[0], record[1]);
+  if (mRecordSize == fullRecordSize)
+  {
+    result.keyErrorPlus = record[2];
+    result.keyErrorMinus = record[3];
+    result.valueErrorPlus = record[4];
+    result.valueErrorMinus = record[5];
   }
-  int scaledWidth = qRound(scale*newWidth);
-  int scaledHeight = qRound(scale*newHeight);
+  return result;
+}
 
-  QPixmap result(scaledWidth, scaledHeight);
-  result.fill(mColor);
-  QCPPainter painter(&result);
-  QRect oldViewport = mViewport;
-  mViewport = QRect(0, 0, newWidth, newHeight);
-  updateAxisRect();
-  if (!qFuzzyCompare(scale, 1.0))
+/*!
+  Limits the number of data points in the container to \a capacity. If \a capacity is 0, the
+  container grows without limit, which is the default.
+  
+  With a capacity, the container works as a ring buffer: When data points are appended at the end
+  while the container is full, the oldest data points (those with the smallest keys) are discarded
+  to make room. The memory for the ring buffer is allocated once in this function, so appending and
+  removing data points in the typical realtime usage (appending new points, optionally removing old
+  ones with \ref removeBefore) is O(1) per point and never allocates memory.
+  
+  The ring buffer holds every data point twice, at its position and at its position plus \a
+  capacity. This way, the data points are always contiguous in memory even when the ring has
+  wrapped around, and all functions that take indices or search by key work unchanged. The memory
+  consumption is thus twice the one of \a capacity data points.
+  
+  Modifications that don't append at the end or remove from the front (e.g. inserting a point with
+  a key smaller than the last key) are still possible, but are O(n) in ring buffer mode. This also
+  applies to the first point with errors that is appended to a container which didn't store errors
+  so far (see \ref hasErrors).
+  
+  If the container currently holds more than \a capacity data points, the oldest ones are removed.
+*/
+void QCPDataContainer::setCapacity(int capacity)
+{
+  if (capacity < 0)
   {
-    if (scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines would disappear
+    qDebug() << Q_FUNC_INFO << "capacity must not be negative:" << capacity;
+    return;
+  }
+  QVector<QCPData> data = toVector();
+  mCapacity = capacity;
+  assign(data, hasErrors());
+}
+
+/*!
+  Sets whether the container maintains a level of detail index over the values of its data points.
+  The index allows \ref valueRange to determine the minimum and maximum value of a range of data
+  points in O(log n) time, instead of scanning all points in the range. It requires roughly a
+  quarter of the memory of the data values themselves.
+  
+  The index is kept up to date incrementally when points are appended at the end or removed from
+  the front or the end of the container (e.g. with \ref removeBefore), which is the typical usage
+  in realtime plots. Any other modification causes the index to be rebuilt the next time it is
+  needed.
+*/
+void QCPDataContainer::setLodIndex(bool enabled)
+{
+  mLodIndexEnabled = enabled;
+  if (!mLodIndexEnabled)
+    mLodIndex.invalidate();
+}
+
+/*!
+  Replaces the current data with the data points in \a dataMap. Since the map is already sorted,
+  this is a linear operation.
+*/
+void QCPDataContainer::set(const QCPDataMap &dataMap)
+{
+  QVector<QCPData> data;
+  data.reserve(dataMap.size());
+  QCPDataMap::const_iterator it = dataMap.constBegin();
+  while (it != dataMap.constEnd())
+  {
+    data.append(it.value());
+    ++it;
+  }
+  assign(data, false);
+}
+
+/*! \overload
+  
+  Replaces the current data with the data points in \a data. The points may be passed in any order,
+  they are sorted by key if necessary (see \ref add for details on the sorting).
+  
+  If you know that the keys in \a data are ascending, set \a alreadySorted to true. This skips the
+  check whether sorting is necessary. If the keys aren't ascending despite \a alreadySorted being
+  true, the behaviour of the container is undefined.
+*/
+void QCPDataContainer::set(const QVector<QCPData> &data, bool alreadySorted)
+{
+  if (alreadySorted || isSorted(data))
+  {
+    assign(data, false);
+  } else
+  {
+    QVector<QCPData> sorted = data;
+    sortByKey(sorted);
+    assign(sorted, false);
+  }
+}
+
+/*!
+  Adds the data points in \a dataMap to the current data. Since the map is already sorted, it is
+  merged with the current data in linear time (see \ref add(const QVector<QCPData> &data, bool
+  alreadySorted)).
+*/
+void QCPDataContainer::add(const QCPDataMap &dataMap)
+{
+  if (dataMap.isEmpty()) return;
+  QVector<QCPData> data;
+  data.reserve(dataMap.size());
+  QCPDataMap::const_iterator it = dataMap.constBegin();
+  while (it != dataMap.constEnd())
+  {
+    data.append(it.value());
+    ++it;
+  }
+  mergeSorted(data);
+}
+
+/*! \overload
+  
+  Adds the data points in \a data to the current data. The points may be passed in any order.
+  
+  If the keys in \a data are ascending, the points are merged with the current data in linear
+  time. Only the current points with keys greater than the smallest key in \a data need to be
+  touched, so if all keys in \a data are equal to or greater than the current last key, the points
+  are simply appended. If the keys aren't ascending, \a data is sorted first. Large vectors are
+  sorted in chunks on multiple threads, which are then merged.
+  
+  If you know that the keys in \a data are ascending, set \a alreadySorted to true. This skips the
+  check whether sorting is necessary. If the keys aren't ascending despite \a alreadySorted being
+  true, the behaviour of the container is undefined.
+*/
+void QCPDataContainer::add(const QVector<QCPData> &data, bool alreadySorted)
+{
+  if (data.isEmpty()) return;
+  if (alreadySorted || isSorted(data))
+  {
+    mergeSorted(data);
+  } else
+  {
+    QVector<QCPData> sorted = data;
+    sortByKey(sorted);
+    mergeSorted(sorted);
+  }
+}
+
+/*! \overload
+  
+  Adds the single data point \a data. If its key is equal to or greater than the current last key,
+  this is an amortized O(1) operation. Otherwise the point is inserted at its sorted position,
+  which takes time proportional to the number of points with greater keys.
+*/
+void QCPDataContainer::add(const QCPData &data)
+{
+  if (isEmpty() || data.key >= last().key)
+  {
+    reserveAppend(1, containsErrors(data));
+    appendUnchecked(data);
+    finishAppend();
+  } else
+    mergeSorted(QVector<QCPData>() << data);
+}
+
+/*!
+  Removes all data points with keys smaller than \a key.
+*/
+void QCPDataContainer::removeBefore(double key)
+{
+  removeRange(0, lowerBound(key));
+}
+
+/*!
+  Removes all data points with keys greater than \a key.
+*/
+void QCPDataContainer::removeAfter(double key)
+{
+  removeRange(upperBound(key), mSize);
+}
+
+/*!
+  Removes all data points with keys greater than \a fromKey and smaller than or equal to \a toKey.
+  If \a fromKey is greater or equal to \a toKey, the function does nothing.
+*/
+void QCPDataContainer::remove(double fromKey, double toKey)
+{
+  if (fromKey >= toKey) return;
+  int begin = upperBound(fromKey);
+  int end = upperBound(toKey);
+  removeRange(begin, end);
+}
+
+/*! \overload
+  
+  Removes all data points with a key equal to \a key.
+*/
+void QCPDataContainer::remove(double key)
+{
+  int begin = lowerBound(key);
+  int end = upperBound(key);
+  removeRange(begin, end);
+}
+
+/*!
+  Removes all data points. If the container has a capacity (\ref setCapacity), the memory of the
+  ring buffer is kept.
+  
+  Afterwards, the container doesn't store errors anymore until a point with errors is added (\ref
+  hasErrors).
+*/
+void QCPDataContainer::clear()
+{
+  newRevision();
+  mBegin = 0;
+  mSize = 0;
+  mRecordSize = compactRecordSize;
+  if (mCapacity == 0)
+    mStore.clear();
+  else
+    mStore.resize(2*mCapacity*mRecordSize);
+  mLodIndex.invalidate();
+}
+
+/*!
+  Preallocates memory for at least \a size data points. If you know in advance how many points
+  will be added, this avoids reallocations while adding them.
+  
+  If the container has a capacity (\ref setCapacity), the memory is already allocated and this
+  function does nothing.
+*/
+void QCPDataContainer::reserve(int size)
+{
+  if (mCapacity == 0)
+    mStore.reserve(size*mRecordSize);
+}
+
+/*!
+  Returns the index of the first data point whose key is equal to or greater than \a key. If there
+  is no such data point, returns \ref size.
+  
+  \see upperBound
+*/
+int QCPDataContainer::lowerBound(double key) const
+{
+  return view().lowerBound(key);
+}
+
+/*!
+  Returns the index of the first data point whose key is greater than \a key. If there is no such
+  data point, returns \ref size.
+  
+  \see lowerBound
+*/
+int QCPDataContainer::upperBound(double key) const
+{
+  return view().upperBound(key);
+}
+
+/*!
+  If the level of detail index is enabled (\ref setLodIndex) but currently not built, builds it.
+  Otherwise does nothing.
+  
+  The index is built lazily by the first query that needs it (e.g. \ref valueRange), which
+  modifies the container. Call this before the container is read from several threads
+  concurrently (see QCP::phParallelPlottables), so the reads don't race for building the index.
+*/
+void QCPDataContainer::ensureLodIndex() const
+{
+  if (mLodIndexEnabled && !mLodIndex.isValid())
+    mLodIndex.rebuild(view());
+}
+
+/*!
+  Returns the minimum (QCPRange::lower) and maximum (QCPRange::upper) value of the data points with
+  indices from \a begin up to \a end (excluding \a end). If the range is empty, returns a default
+  constructed QCPRange.
+  
+  If the level of detail index is enabled (\ref setLodIndex), this takes O(log n) time. Otherwise
+  all data points in the range are scanned.
+*/
+QCPRange QCPDataContainer::valueRange(int begin, int end) const
+{
+  begin = qMax(begin, 0);
+  end = qMin(end, mSize);
+  if (begin >= end)
+    return QCPRange();
+  
+  QCPDataView data = view();
+  if (mLodIndexEnabled)
+  {
+    ensureLodIndex();
+    return mLodIndex.valueRange(data, begin, end);
+  }
+  QCPRange result(data.value(begin), data.value(begin));
+  for (int i=begin+1; i<end; ++i)
+  {
+    const double value = data.value(i);
+    if (value < result.lower)
+      result.lower = value;
+    if (value > result.upper)
+      result.upper = value;
+  }
+  return result;
+}
+
+/*!
+  Returns a \ref QCPDataView on the keys and values of the data points in this container. The view
+  becomes invalid when the container is modified.
+*/
+QCPDataView QCPDataContainer::view() const
+{
+  if (mSize == 0)
+    return QCPDataView();
+  const double *record = mStore.constData()+qint64(mBegin)*mRecordSize;
+  const int stride = mRecordSize*sizeof(double);
+  return QCPDataView(record, record+1, mSize, stride, stride);
+}
+
+/*!
+  Returns a copy of the data points in the form of a \ref QCPDataMap.
+*/
+QCPDataMap QCPDataContainer::toMap() const
+{
+  QCPDataMap result;
+  for (int i=0; i<mSize; ++i)
+  {
+    QCPData data = at(i);
+    result.insertMulti(data.key, data);
+  }
+  return result;
+}
+
+/*! \internal
+  
+  Removes the data points with indices from \a begin up to \a end (excluding \a end) and updates
+  the level of detail index accordingly.
+  
+  Removing from the front of a ring buffer only moves its start, removing from the back only
+  reduces its size. Both are O(1). Removing from the front increases the \ref frontOffset instead
+  of changing the \ref revision, so information derived from the remaining points stays valid.
+*/
+void QCPDataContainer::removeRange(int begin, int end)
+{
+  if (begin >= end) return;
+  if (begin == 0)
+  {
+    mFrontOffset += end;
+    if (mCapacity > 0)
+      mBegin = (mBegin+end) % mCapacity;
+    else
+      mStore.remove(0, end*mRecordSize);
+    mSize -= end;
+    mLodIndex.removeFront(end);
+  } else if (end == mSize)
+  {
+    newRevision();
+    if (mCapacity == 0)
+      mStore.resize(begin*mRecordSize);
+    mSize = begin;
+    mLodIndex.removeBack(view());
+  } else if (mCapacity == 0)
+  {
+    newRevision();
+    mStore.remove(begin*mRecordSize, (end-begin)*mRecordSize);
+    mSize -= end-begin;
+    mLodIndex.invalidate();
+  } else
+  {
+    QVector<QCPData> data = toVector();
+    data.remove(begin, end-begin);
+    assign(data, hasErrors());
+  }
+}
+
+/*! \internal
+  
+  Assigns a new, unique revision to the container. Must be called whenever data points are removed
+  or replaced, except when they are removed from the front (see \ref revision and \ref frontOffset).
+*/
+void QCPDataContainer::newRevision()
+{
+  static QAtomicInt revisionCounter;
+  mRevision = revisionCounter.fetchAndAddRelaxed(1)+1;
+}
+
+/*! \internal
+  
+  Prepares the appending of \a count data points with \ref appendUnchecked. In ring buffer mode,
+  the oldest data points are discarded to make room for the new ones, otherwise memory is
+  reserved. Further calls of \ref appendUnchecked must be concluded with \ref finishAppend.
+  
+  If \a withErrors is true and the container doesn't store errors yet, it is converted to the
+  layout that stores errors.
+  
+  If more points than the capacity of the ring buffer are appended, the first ones of them are
+  overwritten by the later ones within \ref appendUnchecked.
+*/
+void QCPDataContainer::reserveAppend(int count, bool withErrors)
+{
+  if (withErrors && mRecordSize != fullRecordSize)
+    assign(toVector(), true);
+  if (mCapacity > 0)
+  {
+    int discard = qMin(mSize, mSize+count-mCapacity);
+    if (discard > 0)
+      removeRange(0, discard);
+  } else
+    mStore.reserve((mSize+count)*mRecordSize);
+  mAppendStart = mSize;
+}
+
+/*! \internal
+  
+  Appends \a data at the end of the container without checking the key order and without updating
+  the level of detail index. Must be embraced by \ref reserveAppend and \ref finishAppend.
+  
+  In ring buffer mode, every data point is written twice, at its slot in the ring and at the slot
+  plus the capacity, so the data points are contiguous in memory starting at mBegin, regardless
+  where the ring currently wraps around.
+*/
+void QCPDataContainer::appendUnchecked(const QCPData &data)
+{
+  if (mCapacity > 0)
+  {
+    if (mSize == mCapacity) // only happens if more points than the capacity are appended at once
     {
-      painter.setScaledExportMode(true);
-      painter.setRenderHint(QPainter::NonCosmeticDefaultPen);
+      mBegin = (mBegin+1) % mCapacity;
+      --mSize;
+      --mAppendStart;
+      ++mFrontOffset;
     }
-    painter.scale(scale, scale);
+    int slot = (mBegin+mSize) % mCapacity;
+    writeRecord(slot, data);
+    writeRecord(slot+mCapacity, data);
+  } else
+  {
+    mStore.resize((mSize+1)*mRecordSize);
+    writeRecord(mSize, data);
   }
-  draw(&painter);
-  mViewport = oldViewport;
-  updateAxisRect();
+  ++mSize;
+}
+
+/*! \internal
+  
+  Concludes appending data points with \ref appendUnchecked by updating the level of detail index.
+*/
+void QCPDataContainer::finishAppend()
+{
+  if (mAppendStart < 0)
+  {
+    // the ring buffer was overrun by the appended points, the index can't follow incrementally:
+    mLodIndex.invalidate();
+  } else
+    mLodIndex.append(view(), mAppendStart);
+}
+
+/*! \internal
+  
+  Writes \a data to the record at \a slot of the store, using the current record layout. If the
+  layout doesn't hold errors, the errors of \a data are dropped.
+*/
+void QCPDataContainer::writeRecord(int slot, const QCPData &data)
+{
+  double *record = mStore.data()+qint64(slot)*mRecordSize;
+  record[0] = data.key;
+  record[1] = data.value;
+  if (mRecordSize == fullRecordSize)
+  {
+    record[2] = data.keyErrorPlus;
+    record[3] = data.keyErrorMinus;
+    record[4] = data.valueErrorPlus;
+    record[5] = data.valueErrorMinus;
+  }
+}
+
+/*! \internal
+  
+  Returns a copy of all data points in the container as a plain vector.
+*/
+QVector<QCPData> QCPDataContainer::toVector() const
+{
+  QVector<QCPData> result;
+  result.reserve(mSize);
+  for (int i=0; i<mSize; ++i)
+    result.append(at(i));
   return result;
 }
 
+/*! \internal
+  
+  Replaces the content of the store with \a data, which must be sorted by key. The record layout
+  holds errors if \a withErrors is true or any point in \a data has non-zero errors, otherwise
+  only keys and values are stored.
+  
+  In ring buffer mode, the oldest points that exceed the capacity are discarded and the remaining
+  ones are written to a newly allocated ring buffer.
+*/
+void QCPDataContainer::assign(const QVector<QCPData> &data, bool withErrors)
+{
+  for (int i=0; i<data.size() && !withErrors; ++i)
+    withErrors = containsErrors(data.at(i));
+  mRecordSize = withErrors ? fullRecordSize : compactRecordSize;
+  newRevision();
+  
+  int discard = mCapacity > 0 ? qMax(0, data.size()-mCapacity) : 0;
+  mBegin = 0;
+  mSize = data.size()-discard;
+  if (mCapacity > 0)
+  {
+    mStore = QVector<double>(2*mCapacity*mRecordSize);
+    for (int i=0; i<mSize; ++i)
+    {
+      writeRecord(i, data.at(i+discard));
+      writeRecord(i+mCapacity, data.at(i+discard));
+    }
+  } else
+  {
+    mStore = QVector<double>(mSize*mRecordSize);
+    for (int i=0; i<mSize; ++i)
+      writeRecord(i, data.at(i));
+  }
+  mLodIndex.invalidate();
+}
+
+/*! \internal
+  
+  Adds the points in \a data, which must be sorted by key, to the container.
+  
+  The current points with keys up to the smallest key in \a data keep their place. The remaining
+  points (the tail) are merged with \a data in linear time, removed from the container and then
+  appended again together with \a data. This way, the ring buffer and the level of detail index
+  are handled by the same code as a plain append, which is also what this function boils down to
+  when \a data starts after the current last key.
+*/
+void QCPDataContainer::mergeSorted(const QVector<QCPData> &data)
+{
+  if (data.isEmpty()) return;
+  if (isEmpty())
+  {
+    assign(data, false);
+    return;
+  }
+  
+  int split = upperBound(data.first().key);
+  QVector<QCPData> merged;
+  if (split < mSize)
+  {
+    merged.resize(mSize-split+data.size());
+    QCPDataView current = view();
+    int i = split;
+    int j = 0;
+    int k = 0;
+    while (i < mSize && j < data.size())
+    {
+      // on equal keys, current points come first, to keep points in the order they were added:
+      if (data.at(j).key < current.key(i))
+        merged[k++] = data.at(j++);
+      else
+        merged[k++] = at(i++);
+    }
+    while (i < mSize)
+      merged[k++] = at(i++);
+    while (j < data.size())
+      merged[k++] = data.at(j++);
+    removeRange(split, mSize);
+  } else
+    merged = data; // plain append, implicitly shared
+  
+  bool withErrors = false;
+  for (int i=0; i<data.size() && !withErrors; ++i)
+    withErrors = containsErrors(data.at(i));
+  reserveAppend(merged.size(), withErrors);
+  for (int i=0; i<merged.size(); ++i)
+    appendUnchecked(merged.at(i));
+  finishAppend();
+}
+
+/*! \internal
+  
+  Sorts a range of data points by key, keeping the order of points with equal keys. Used as task
+  of \ref QCPDataContainer::sortByKey.
+*/
+static void qcpSortDataRange(QCPData *begin, QCPData *end)
+{
+  qStableSort(begin, end, qcpDataKeyLessThan);
+}
 
-// ================================================================================
-// =================== QCPData
-// ================================================================================
+/*! \internal
+  
+  Merges the two sorted, adjacent ranges of data points from \a begin to \a middle and from \a
+  middle to \a end into \a dest. Points of the first range come before points of the second range
+  with equal keys. Used as task of \ref QCPDataContainer::sortByKey.
+*/
+static void qcpMergeDataRanges(const QCPData *begin, const QCPData *middle, const QCPData *end, QCPData *dest)
+{
+  const QCPData *first = begin;
+  const QCPData *second = middle;
+  while (first != middle && second != end)
+  {
+    if (second->key < first->key)
+      *dest++ = *second++;
+    else
+      *dest++ = *first++;
+  }
+  dest = qCopy(first, middle, dest);
+  qCopy(second, end, dest);
+}
 
-/*! \class QCPData
-  \brief Holds the data of one single data point for QCPGraph.
+/*! \internal
   
-  The stored data is:
-  \li \a key: coordinate on the key axis of this data point
-  \li \a value: coordinate on the value axis of this data point
-  \li \a keyErrorMinus: negative error in the key dimension (for error bars)
-  \li \a keyErrorPlus: positive error in the key dimension (for error bars)
-  \li \a valueErrorMinus: negative error in the value dimension (for error bars)
-  \li \a valueErrorPlus: positive error in the value dimension (for error bars)
+  Sorts \a data by key, keeping the order of points with equal keys.
   
-  \see QCPDataMap
+  If \a data is large enough to be split into several chunks of at least parallelSortChunkSize
+  points, and more than one processor core is available, the chunks are sorted concurrently in the
+  global thread pool. The sorted chunks are then merged pairwise, again concurrently, until one
+  sorted range is left.
 */
+void QCPDataContainer::sortByKey(QVector<QCPData> &data)
+{
+  const int size = data.size();
+  int chunkCount = qMin(QThread::idealThreadCount(), size/parallelSortChunkSize);
+  if (chunkCount < 2)
+  {
+    qStableSort(data.begin(), data.end(), qcpDataKeyLessThan);
+    return;
+  }
+  
+  // sort chunks concurrently:
+  QVector<int> bounds(chunkCount+1);
+  for (int i=0; i<=chunkCount; ++i)
+    bounds[i] = qint64(size)*i/chunkCount;
+  QCPData *source = data.data();
+  QFutureSynchronizer<void> synchronizer;
+  for (int i=0; i<chunkCount; ++i)
+    synchronizer.addFuture(QtConcurrent::run(qcpSortDataRange, source+bounds.at(i), source+bounds.at(i+1)));
+  synchronizer.waitForFinished();
+  
+  // merge neighbouring chunks until only one is left, alternating between data and buffer as destination:
+  QVector<QCPData> buffer(size);
+  QCPData *dest = buffer.data();
+  while (bounds.size() > 2)
+  {
+    QVector<int> mergedBounds;
+    for (int i=0; i+1<bounds.size(); i+=2)
+    {
+      mergedBounds.append(bounds.at(i));
+      if (i+2 < bounds.size())
+        synchronizer.addFuture(QtConcurrent::run(qcpMergeDataRanges, source+bounds.at(i), source+bounds.at(i+1), source+bounds.at(i+2), dest+bounds.at(i)));
+      else
+        qCopy(source+bounds.at(i), source+bounds.at(i+1), dest+bounds.at(i)); // odd chunk out, carry over
+    }
+    mergedBounds.append(size);
+    synchronizer.waitForFinished();
+    bounds = mergedBounds;
+    qSwap(source, dest);
+  }
+  if (source != data.data())
+    qCopy(source, source+size, data.data());
+}
 
-/*!
-  Constructs a data point with key, value and all errors set to zero.
+/*! \internal
+  
+  Returns whether the keys of the points in \a data are ascending.
 */
-QCPData::QCPData() :
-  key(0),
-  value(0),
-  keyErrorPlus(0),
-  keyErrorMinus(0),
-  valueErrorPlus(0),
-  valueErrorMinus(0)
+bool QCPDataContainer::isSorted(const QVector<QCPData> &data)
 {
+  for (int i=1; i<data.size(); ++i)
+  {
+    if (data.at(i).key < data.at(i-1).key)
+      return false;
+  }
+  return true;
 }
 
-/*!
-  Constructs a data point with the specified \a key and \a value. All errors are set to zero.
+/*! \internal
+  
+  Returns whether any of the errors of \a data is non-zero.
 */
-QCPData::QCPData(double key, double value) :
-  key(key),
-  value(value),
-  keyErrorPlus(0),
-  keyErrorMinus(0),
-  valueErrorPlus(0),
-  valueErrorMinus(0)
+bool QCPDataContainer::containsErrors(const QCPData &data)
 {
+  return data.keyErrorPlus != 0 || data.keyErrorMinus != 0 || data.valueErrorPlus != 0 || data.valueErrorMinus != 0;
 }
 
 
@@ -9337,7 +12518,7 @@ QCPData::QCPData(double key, double value) :
 QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable(keyAxis, valueAxis)
 {
-  mData = new QCPDataMap;
+  mData = new QCPDataContainer;
   
   setPen(QPen(Qt::blue));
   setErrorPen(QPen(Qt::black));
@@ -9352,6 +12533,9 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setErrorBarSize(6);
   setErrorBarSkipSymbol(true);
   setChannelFillGraph(0);
+  setAdaptiveSampling(true);
+  setLodIndex(false);
+  setDataCapacity(0);
 }
 
 QCPGraph::~QCPGraph()
@@ -9374,8 +12558,11 @@ QCPGraph::~QCPGraph()
   If \a copy is set to true, data points in \a data will only be copied. if false, the graph
   takes ownership of the passed data and replaces the internal data pointer with it. This is
   significantly faster than copying for large datasets.
+  
+  The level of detail index and capacity settings of the graph (\ref setLodIndex, \ref
+  setDataCapacity) are applied to the new data.
 */
-void QCPGraph::setData(QCPDataMap *data, bool copy)
+void QCPGraph::setData(QCPDataContainer *data, bool copy)
 {
   if (copy)
   {
@@ -9385,6 +12572,24 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
     delete mData;
     mData = data;
   }
+  mData->newRevision(); // data may carry a revision the geometry cache has already seen, e.g. when copied from another container
+  mData->setLodIndex(mLodIndex);
+  mData->setCapacity(mDataCapacity);
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided \a data map. The data points are transferred into
+  the graph's internal \ref QCPDataContainer.
+  
+  If \a copy is set to true, \a data will stay untouched. If false, the graph takes ownership of
+  the passed map and deletes it after its points were transferred.
+*/
+void QCPGraph::setData(QCPDataMap *data, bool copy)
+{
+  mData->set(*data);
+  if (!copy)
+    delete data;
 }
 
 /*! \overload
@@ -9392,19 +12597,21 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
   Replaces the current data with the provided points in \a key and \a value pairs. The provided
   vectors should have equal length. Else, the number of added points will be the size of the
   smallest vector.
+  
+  If you know that \a key is sorted ascending, set \a alreadySorted to true to skip the check
+  whether the points need to be sorted (see \ref QCPDataContainer::set).
 */
-void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
+void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value, bool alreadySorted)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    mData->insertMulti(newData.key, newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
   }
+  mData->set(newData, alreadySorted);
 }
 
 /*!
@@ -9418,19 +12625,18 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.valueErrorMinus = valueError[i];
-    newData.valueErrorPlus = valueError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].valueErrorMinus = valueError[i];
+    newData[i].valueErrorPlus = valueError[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -9444,20 +12650,19 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.valueErrorMinus = valueErrorMinus[i];
-    newData.valueErrorPlus = valueErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].valueErrorMinus = valueErrorMinus[i];
+    newData[i].valueErrorPlus = valueErrorPlus[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -9471,19 +12676,18 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, keyError.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyError[i];
-    newData.keyErrorPlus = keyError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyError[i];
+    newData[i].keyErrorPlus = keyError[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -9497,20 +12701,19 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyErrorMinus[i];
-    newData.keyErrorPlus = keyErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyErrorMinus[i];
+    newData[i].keyErrorPlus = keyErrorPlus[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -9524,22 +12727,21 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError, const QVector<double> &valueError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
   n = qMin(n, keyError.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyError[i];
-    newData.keyErrorPlus = keyError[i];
-    newData.valueErrorMinus = valueError[i];
-    newData.valueErrorPlus = valueError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyError[i];
+    newData[i].keyErrorPlus = keyError[i];
+    newData[i].valueErrorMinus = valueError[i];
+    newData[i].valueErrorPlus = valueError[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -9553,24 +12755,23 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyErrorMinus[i];
-    newData.keyErrorPlus = keyErrorPlus[i];
-    newData.valueErrorMinus = valueErrorMinus[i];
-    newData.valueErrorPlus = valueErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyErrorMinus[i];
+    newData[i].keyErrorPlus = keyErrorPlus[i];
+    newData[i].valueErrorMinus = valueErrorMinus[i];
+    newData[i].valueErrorPlus = valueErrorPlus[i];
   }
+  mData->set(newData);
 }
 
 
@@ -9693,13 +12894,102 @@ void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
   mChannelFillGraph = targetGraph;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this graph. QCustomPlot's adaptive
+  sampling technique can drastically improve the replot performance for graphs with a large number
+  of points (e.g. above 10,000), without notably changing the appearance of the graph.
+  
+  When many data points fall into the same pixel column of the key axis, only the first and last
+  point of that column and the points with the minimum and maximum value inside it are used for
+  the line. The resulting line covers exactly the same pixels, but the number of line segments
+  that need to be drawn only depends on the size of the axis rect and not on the number of data
+  points. This applies to all line styles (\ref setLineStyle). Scatter symbols and error bars are
+  still drawn for every visible data point.
+  
+  Adaptive sampling is enabled by default. There is usually no reason to disable it, except when
+  the exact path of the line inside a single pixel column is relevant, e.g. when exporting to a
+  vector format with the intention to zoom into the graph.
+*/
+void QCPGraph::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
+/*!
+  Sets whether the graph's data container maintains a level of detail index over the data values
+  (see \ref QCPDataContainer::setLodIndex).
+  
+  With adaptive sampling (\ref setAdaptiveSampling), every visible data point is still visited
+  once per replot. For graphs with millions of points in the visible key range, this scan becomes
+  the dominating cost. If the level of detail index is enabled, the adaptive sampling instead
+  determines the value extremes of each pixel column with binary searches and index lookups, so
+  the replot time becomes nearly independent of the number of visible data points. The line
+  covers the same pixels, only the exact keys at which the minimum and maximum of a pixel column
+  are reached are no longer preserved.
+  
+  The index costs additional memory of roughly a quarter of the data values and some time when
+  data is modified. It is therefore disabled by default. Enable it for very large graphs that are
+  replotted often, e.g. when the user zooms and drags through a long recording.
+*/
+void QCPGraph::setLodIndex(bool enabled)
+{
+  mLodIndex = enabled;
+  mData->setLodIndex(mLodIndex);
+}
+
+/*!
+  Limits the number of data points the graph holds to \a capacity. When new data points are added
+  to a full graph, the oldest data points are discarded. If \a capacity is 0, the number of data
+  points is unlimited, which is the default.
+  
+  This is intended for realtime plots that show a sliding window of the most recent data. The data
+  container then works as a preallocated ring buffer (see \ref QCPDataContainer::setCapacity), so
+  adding a point and discarding the oldest one is O(1) and doesn't allocate memory. Calling \ref
+  removeDataBefore additionally to trim the data by key stays O(1), too.
+  
+  Note that the ring buffer uses the memory of twice \a capacity data points, regardless of how
+  many points the graph currently holds.
+*/
+void QCPGraph::setDataCapacity(int capacity)
+{
+  if (capacity < 0)
+  {
+    qDebug() << Q_FUNC_INFO << "capacity must not be negative:" << capacity;
+    return;
+  }
+  mDataCapacity = capacity;
+  mData->setCapacity(mDataCapacity);
+}
+
+/*!
+  Sets an external data source that this graph plots instead of the data in its own data
+  container. The graph then reads the keys and values directly from the memory described by the
+  source (see \ref QCPAbstractDataSource), so large data sets that already exist in the
+  application's memory, e.g. acquisition buffers or memory-mapped files, don't need to be copied.
+  Only the visible data points (reduced by adaptive sampling, see \ref setAdaptiveSampling) are
+  read during a replot.
+  
+  The graph doesn't take ownership of \a source. If \a source is deleted, the graph automatically
+  returns to plotting its own data container. Pass 0 to return to the data container explicitly.
+  
+  While a data source is set, the data container (\ref data) still exists and may be modified
+  with the usual functions like \ref setData and \ref addData, but it isn't plotted. Since data
+  sources don't provide error bars, the error bars of a graph with a data source are not drawn.
+  
+  \see dataView
+*/
+void QCPGraph::setDataSource(QCPAbstractDataSource *source)
+{
+  mDataSource = source;
+}
+
 /*!
   Adds the provided data points in \a dataMap to the current data.
   \see removeData
 */
 void QCPGraph::addData(const QCPDataMap &dataMap)
 {
-  mData->unite(dataMap);
+  mData->add(dataMap);
 }
 
 /*! \overload
@@ -9708,7 +12998,7 @@ void QCPGraph::addData(const QCPDataMap &dataMap)
 */
 void QCPGraph::addData(const QCPData &data)
 {
-  mData->insertMulti(data.key, data);
+  mData->add(data);
 }
 
 /*! \overload
@@ -9717,26 +13007,27 @@ void QCPGraph::addData(const QCPData &data)
 */
 void QCPGraph::addData(double key, double value)
 {
-  QCPData newData;
-  newData.key = key;
-  newData.value = value;
-  mData->insertMulti(newData.key, newData);
+  mData->add(QCPData(key, value));
 }
 
 /*! \overload
   Adds the provided data points as \a key and \a value pairs to the current data.
+  
+  Sorted points are merged with the current data in linear time, unsorted ones are sorted first
+  (see \ref QCPDataContainer::add). If you know that \a keys is sorted ascending, set \a
+  alreadySorted to true to skip the check whether the points need to be sorted.
   \see removeData
 */
-void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values)
+void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
 {
   int n = qMin(keys.size(), values.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = keys[i];
-    newData.value = values[i];
-    mData->insertMulti(newData.key, newData);
+    newData[i].key = keys[i];
+    newData[i].value = values[i];
   }
+  mData->add(newData, alreadySorted);
 }
 
 /*!
@@ -9745,9 +13036,7 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
-  QCPDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->removeBefore(key);
 }
 
 /*!
@@ -9756,10 +13045,7 @@ void QCPGraph::removeDataBefore(double key)
 */
 void QCPGraph::removeDataAfter(double key)
 {
-  if (mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->removeAfter(key);
 }
 
 /*!
@@ -9771,11 +13057,7 @@ void QCPGraph::removeDataAfter(double key)
 */
 void QCPGraph::removeData(double fromKey, double toKey)
 {
-  if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(fromKey);
-  QCPDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->remove(fromKey, toKey);
 }
 
 /*! \overload
@@ -9800,10 +13082,25 @@ void QCPGraph::clearData()
   mData->clear();
 }
 
+/*!
+  Returns a \ref QCPDataView on the keys and values this graph currently plots. If a data source
+  is set (\ref setDataSource), this is the view provided by the data source, otherwise a view on
+  the graph's data container (\ref data).
+  
+  The view is only valid until the data is modified.
+*/
+QCPDataView QCPGraph::dataView() const
+{
+  if (mDataSource)
+    return mDataSource->dataView();
+  else
+    return mData->view();
+}
+
 /* inherits documentation from base class */
 double QCPGraph::selectTest(const QPointF &pos) const
 {
-  if (mData->isEmpty() || !mVisible)
+  if (dataView().isEmpty() || !mVisible)
     return -1;
   
   return pointDistance(pos);
@@ -9829,7 +13126,7 @@ void QCPGraph::rescaleKeyAxis(bool onlyEnlarge, bool includeErrorBars) const
 {
   // this code is a copy of QCPAbstractPlottable::rescaleKeyAxis with the only change
   // that getKeyRange is passed the includeErrorBars value.
-  if (mData->isEmpty()) return;
+  if (dataView().isEmpty()) return;
 
   SignDomain signDomain = sdBoth;
   if (mKeyAxis->scaleType() == QCPAxis::stLogarithmic)
@@ -9857,17 +13154,38 @@ void QCPGraph::rescaleKeyAxis(bool onlyEnlarge, bool includeErrorBars) const
   when determining the new axis range.
 */
 void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
+{
+  rescaleValueAxis(onlyEnlarge, includeErrorBars, false);
+}
+
+/*! \overload
+  
+  If \a inKeyRange is true, only the data points with keys inside the current range of the key
+  axis are taken into consideration, so the value axis is fit to the visible part of the graph.
+  Calling this in a slot connected to the \ref QCPAxis::rangeChanged signal of the key axis keeps
+  the graph vertically fit while the user drags or zooms horizontally.
+  
+  The visible data points are found with binary searches. If the level of detail index is enabled
+  (\ref setLodIndex), their value range is determined in O(log n) time, so this function is cheap
+  even for millions of visible points. This does not apply to logarithmic value axes, or if error
+  bars are included and the graph has error values. Then the visible points are scanned.
+*/
+void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars, bool inKeyRange) const
 {
   // this code is a copy of QCPAbstractPlottable::rescaleValueAxis with the only change
-  // is that getValueRange is passed the includeErrorBars value.
-  if (mData->isEmpty()) return;
+  // is that getValueRange is passed the includeErrorBars value and optionally the key range.
+  if (dataView().isEmpty()) return;
 
   SignDomain signDomain = sdBoth;
   if (mValueAxis->scaleType() == QCPAxis::stLogarithmic)
     signDomain = (mValueAxis->range().upper < 0 ? sdNegative : sdPositive);
   
   bool validRange;
-  QCPRange newRange = getValueRange(validRange, signDomain, includeErrorBars);
+  QCPRange newRange;
+  if (inKeyRange)
+    newRange = getValueRange(validRange, signDomain, includeErrorBars, mKeyAxis->range());
+  else
+    newRange = getValueRange(validRange, signDomain, includeErrorBars);
   
   if (validRange)
   {
@@ -9885,35 +13203,64 @@ void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
 /* inherits documentation from base class */
 void QCPGraph::draw(QCPPainter *painter)
 {
-  if (mKeyAxis->range().size() <= 0 || mData->isEmpty()) return;
+  if (mKeyAxis->range().size() <= 0 || dataView().isEmpty()) return;
   if (mLineStyle == lsNone && mScatterStyle == QCP::ssNone) return;
   
-  // allocate line and (if necessary) point vectors:
-  QVector<QPointF> *lineData = new QVector<QPointF>;
-  QVector<QCPData> *pointData = 0;
-  if (mScatterStyle != QCP::ssNone)
-    pointData = new QVector<QCPData>;
+  // if only a part of the axis rect is rendered (see QCPPainter::setDataRegion), only process the
+  // data in and near it:
+  QCPRange keyRange = mKeyAxis->range();
+  bool restricted = !painter->dataRegion().isNull();
+  if (restricted)
+  {
+    QRectF region = painter->dataRegion();
+    double a, b;
+    if (mKeyAxis->orientation() == Qt::Horizontal)
+    {
+      a = mKeyAxis->pixelToCoord(region.left());
+      b = mKeyAxis->pixelToCoord(region.right());
+    } else
+    {
+      a = mKeyAxis->pixelToCoord(region.bottom());
+      b = mKeyAxis->pixelToCoord(region.top());
+    }
+    keyRange.lower = qMax(keyRange.lower, qMin(a, b));
+    keyRange.upper = qMin(keyRange.upper, qMax(a, b));
+    if (keyRange.lower > keyRange.upper)
+      return;
+  }
+  
+  // during user interactions, reduce detail if more points are visible than the draft point budget:
+  int draftStride = 1;
+  if (painter->draftMode() && mParentPlot->draftPointBudget() > 0)
+  {
+    int lower, upper, count;
+    getVisibleDataBounds(lower, upper, count, keyRange);
+    int budget = mParentPlot->draftPointBudget();
+    if (count > budget)
+      draftStride = (count+budget-1)/budget;
+  }
   
-  // fill vectors with data appropriate to plot style:
-  getPlotData(lineData, pointData);
+  // get line and (if necessary) point vectors appropriate to plot style:
+  QVector<QPointF> lineData;
+  QVector<QCPData> pointData;
+  bool drawScatters = mScatterStyle != QCP::ssNone && (draftStride == 1 || mLineStyle == lsNone); // with reduced detail, scatters are only drawn if there is no line
+  if (restricted) // the geometry cache holds the whole axis range
+    getPlotData(&lineData, drawScatters ? &pointData : 0, draftStride, keyRange);
+  else
+    getCachedPlotData(&lineData, drawScatters ? &pointData : 0, draftStride);
 
   // draw fill of graph:
-  drawFill(painter, lineData);
+  drawFill(painter, &lineData, draftStride);
   
   // draw line:
   if (mLineStyle == lsImpulse)
-    drawImpulsePlot(painter, lineData);
+    drawImpulsePlot(painter, &lineData);
   else if (mLineStyle != lsNone)
-    drawLinePlot(painter, lineData); // also step plots can be drawn as a line plot
+    drawLinePlot(painter, &lineData); // also step plots can be drawn as a line plot
   
   // draw scatters:
-  if (pointData)
-    drawScatterPlot(painter, pointData);
-  
-  // free allocated line and point vectors:
-  delete lineData;
-  if (pointData)
-    delete pointData;
+  if (drawScatters)
+    drawScatterPlot(painter, &pointData, draftStride);
 }
 
 /* inherits documentation from base class */
@@ -9954,67 +13301,155 @@ void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRect &rect) const
   line style of the graph.
   \param lineData will be filled with raw points that will be drawn with the according draw functions, e.g. \ref drawLinePlot and \ref drawImpulsePlot.
   These aren't necessarily the original data points, since for step plots for example, additional points are needed for drawing lines that make up steps.
-  If the line style of the graph is \ref lsNone, the \a lineData vector will be left untouched.
+  If the line style of the graph is \ref lsNone or the graph has no data, the \a lineData vector will be left untouched.
   \param pointData will be filled with the original data points so \ref drawScatterPlot can draw the scatter symbols accordingly. If no scatters need to be
   drawn, i.e. scatter style is \ref QCP::ssNone, pass 0 as \a pointData, and this step will be skipped.
+  \param draftStride is one for the full level of detail. While the graph is drawn with reduced detail
+  (see QCustomPlot::setDraftPointBudget), only every \a draftStride-th data point is used.
+  \param keyRange is the key range whose data points are processed, usually the range of the key
+  axis. When only a part of the axis rect is drawn, \ref draw passes the corresponding key range.
   
   \see getScatterPlotData, getLinePlotData, getStepLeftPlotData, getStepRightPlotData, getStepCenterPlotData, getImpulsePlotData
 */
-void QCPGraph::getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
+  if (dataView().isEmpty()) return;
   switch(mLineStyle)
   {
-    case lsNone: getScatterPlotData(pointData); break;
-    case lsLine: getLinePlotData(lineData, pointData); break;
-    case lsStepLeft: getStepLeftPlotData(lineData, pointData); break;
-    case lsStepRight: getStepRightPlotData(lineData, pointData); break;
-    case lsStepCenter: getStepCenterPlotData(lineData, pointData); break;
-    case lsImpulse: getImpulsePlotData(lineData, pointData); break;
+    case lsNone: getScatterPlotData(pointData, draftStride, keyRange); break;
+    case lsLine: getLinePlotData(lineData, pointData, draftStride, keyRange); break;
+    case lsStepLeft: getStepLeftPlotData(lineData, pointData, draftStride, keyRange); break;
+    case lsStepRight: getStepRightPlotData(lineData, pointData, draftStride, keyRange); break;
+    case lsStepCenter: getStepCenterPlotData(lineData, pointData, draftStride, keyRange); break;
+    case lsImpulse: getImpulsePlotData(lineData, pointData, draftStride, keyRange); break;
+  }
+}
+
+/*! \internal
+  
+  Like \ref getPlotData, but the generated vectors are retained in a cache and reused, as long as
+  the axis ranges, axis rects and scale types, the line style and sampling settings as well as the
+  data points (see QCPDataContainer::revision) are unchanged. Drawing, hit testing (\ref
+  pointDistance) and channel fills of other graphs (\ref getChannelFillPolygon) thus share the
+  generated geometry, and replots that don't change the graph don't regenerate it.
+  
+  The returned vectors are implicitly shared with the cache, so callers may modify them without
+  affecting it.
+  
+  Graphs with an external data source (\ref setDataSource), which may change without notice, and
+  requests with reduced detail (\a draftStride greater than one) don't use the cache.
+  
+  This is thread-safe, a channel fill may request the geometry of its target graph from a worker
+  thread (see QCP::phParallelPlottables). The level of detail is passed in by the caller rather
+  than kept on the graph, so such a request always gets the full detail, even while the target
+  graph itself is drawn with reduced detail.
+*/
+void QCPGraph::getCachedPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride) const
+{
+  if (dataView().isEmpty()) return;
+  if (mDataSource || draftStride > 1)
+  {
+    getPlotData(lineData, pointData, draftStride, mKeyAxis->range());
+    return;
+  }
+  
+  QMutexLocker locker(&mGeometryCacheMutex);
+  CachedGeometry &cache = mGeometryCache;
+  CachedAxisState keyAxisState = cachedAxisState(mKeyAxis);
+  CachedAxisState valueAxisState = cachedAxisState(mValueAxis);
+  if (!cache.valid || !(cache.keyAxis == keyAxisState) || !(cache.valueAxis == valueAxisState) ||
+      cache.lineStyle != mLineStyle || cache.adaptiveSampling != mAdaptiveSampling || cache.lodIndex != mLodIndex ||
+      cache.revision != mData->revision() || cache.frontOffset != mData->frontOffset() || cache.size != mData->size())
+  {
+    cache.lineData.clear();
+    cache.pointData.clear();
+    getPlotData(&cache.lineData, pointData ? &cache.pointData : 0, 1, mKeyAxis->range());
+    cache.valid = true;
+    cache.hasPointData = pointData != 0;
+    cache.keyAxis = keyAxisState;
+    cache.valueAxis = valueAxisState;
+    cache.lineStyle = mLineStyle;
+    cache.adaptiveSampling = mAdaptiveSampling;
+    cache.lodIndex = mLodIndex;
+    cache.revision = mData->revision();
+    cache.frontOffset = mData->frontOffset();
+    cache.size = mData->size();
+  } else if (pointData && !cache.hasPointData) // the point vector doesn't depend on the line style, see getPlotData
+  {
+    getScatterPlotData(&cache.pointData, 1, mKeyAxis->range());
+    cache.hasPointData = true;
   }
+  if (lineData)
+    *lineData = cache.lineData;
+  if (pointData)
+    *pointData = cache.pointData;
+}
+
+/*! \internal
+  
+  Returns the state of \a axis that determines how coordinates are transformed to pixels, for use
+  as part of the key of the geometry cache (see \ref getCachedPlotData).
+*/
+QCPGraph::CachedAxisState QCPGraph::cachedAxisState(QCPAxis *axis) const
+{
+  CachedAxisState state;
+  state.axis = axis;
+  state.range = axis->range();
+  state.axisRect = axis->axisRect();
+  state.scaleType = axis->scaleType();
+  state.scaleLogBase = axis->scaleLogBase();
+  state.rangeReversed = axis->rangeReversed();
+  return state;
+}
+
+bool QCPGraph::CachedAxisState::operator==(const CachedAxisState &other) const
+{
+  return axis == other.axis && range.lower == other.range.lower && range.upper == other.range.upper &&
+      axisRect == other.axisRect && scaleType == other.scaleType && scaleLogBase == other.scaleLogBase &&
+      rangeReversed == other.rangeReversed;
 }
 
 /*! 
   \internal
-  If line style is \ref lsNone and scatter style is not \ref QCP::ssNone, this function serves at providing the
-  visible data points in \a pointData, so the \ref drawScatterPlot function can draw the scatter points
-  accordingly.
+  Provides the visible data points in \a pointData, so the \ref drawScatterPlot function can draw
+  the scatter points accordingly. If line style is \ref lsNone, this is the only plot data that is
+  generated.
   
-  If line style is not \ref lsNone, this function is not called and the data for the scatter points
-  are (if needed) calculated inside the corresponding other "get(...)PlotData" functions.
+  For the other line styles, the "get(...)PlotData" functions call this function to fill their \a
+  pointData. Unlike the line data, the scatter points are never reduced by adaptive sampling (see
+  \ref setAdaptiveSampling), so every visible data point gets its scatter symbol.
   \see drawScatterPlot
 */
-void QCPGraph::getScatterPlotData(QVector<QCPData> *pointData) const
+void QCPGraph::getScatterPlotData(QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
   if (!pointData) return;
   
   // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  if (draftStride > 1) // reduced detail (see draw), only use every draftStride-th point
+  {
+    QCPDataView data = dataView();
+    pointData->clear();
+    pointData->reserve(dataCount/draftStride+1);
+    for (int i=lower; i<=upper; i+=draftStride)
+      pointData->append(QCPData(data.key(i), data.value(i)));
+    return;
+  }
   // prepare vectors:
-  if (pointData)
-    pointData->resize(dataCount);
+  pointData->resize(dataCount);
 
-  // position data points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
-  int i = 0;
-  if (mKeyAxis->orientation() == Qt::Vertical)
+  // copy data points:
+  if (mDataSource)
   {
-    while (it != upperEnd)
-    {
-      (*pointData)[i] = it.value();
-      ++i;
-      ++it;
-    }
-  } else // key axis is horizontal
+    QCPDataView data = dataView();
+    for (int i=0; i<dataCount; ++i)
+      (*pointData)[i] = QCPData(data.key(lower+i), data.value(lower+i));
+  } else
   {
-    while (it != upperEnd)
-    {
-      (*pointData)[i] = it.value();
-      ++i;
-      ++it;
-    }
+    for (int i=0; i<dataCount; ++i)
+      (*pointData)[i] = mData->at(lower+i);
   }
 }
 
@@ -10028,48 +13463,33 @@ void QCPGraph::getScatterPlotData(QVector<QCPData> *pointData) const
   filling the vector.
   \see drawLinePlot
 */
-void QCPGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the line consists of:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
   // prepare vectors:
-  if (lineData)
-  { 
-    // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-    lineData->reserve(dataCount+2);
-    lineData->resize(dataCount);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  lineData->reserve(count+2);
+  lineData->resize(count);
 
-  // position data points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
-  int i = 0;
+  // position data points, transforming keys and values directly into the coordinates of the polyline points:
+  if (count == 0) return;
+  QPointF *points = lineData->data();
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
-    while (it != upperEnd)
-    {
-      if (pointData)
-        (*pointData)[i] = it.value();
-      (*lineData)[i].setX(mValueAxis->coordToPixel(it.value().value));
-      (*lineData)[i].setY(mKeyAxis->coordToPixel(it.key()));
-      ++i;
-      ++it;
-    }
+    mValueAxis->coordToPixel(data.values(), &points->rx(), count, data.valueStride(), sizeof(QPointF));
+    mKeyAxis->coordToPixel(data.keys(), &points->ry(), count, data.keyStride(), sizeof(QPointF));
   } else // key axis is horizontal
   {
-    while (it != upperEnd)
-    {
-      if (pointData)
-        (*pointData)[i] = it.value();
-      (*lineData)[i].setX(mKeyAxis->coordToPixel(it.key()));
-      (*lineData)[i].setY(mValueAxis->coordToPixel(it.value().value));
-      ++i;
-      ++it;
-    }
+    mKeyAxis->coordToPixel(data.keys(), &points->rx(), count, data.keyStride(), sizeof(QPointF));
+    mValueAxis->coordToPixel(data.values(), &points->ry(), count, data.valueStride(), sizeof(QPointF));
   }
 }
 
@@ -10083,69 +13503,56 @@ void QCPGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *poi
   filling the vector.
   \see drawLinePlot
 */
-void QCPGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the line consists of:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
+  QVector<qreal> keyPixels, valuePixels;
+  getPixelCoords(data, &keyPixels, &valuePixels);
   // prepare vectors:
-  if (lineData)
-  {
-    // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-    // multiplied by 2 because step plot needs two polyline points per one actual data point
-    lineData->reserve(dataCount*2+2);
-    lineData->resize(dataCount*2);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  // multiplied by 2 because step plot needs two polyline points per one actual data point
+  lineData->reserve(count*2+2);
+  lineData->resize(count*2);
   
   // position data points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
   int i = 0;
-  int ipoint = 0;
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
-    double lastValue = mValueAxis->coordToPixel(it.value().value);
+    double lastValue = valuePixels.at(0);
     double key;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = mKeyAxis->coordToPixel(it.key());
+      key = keyPixels.at(d);
       (*lineData)[i].setX(lastValue);
       (*lineData)[i].setY(key);
       ++i;
-      lastValue = mValueAxis->coordToPixel(it.value().value);
+      lastValue = valuePixels.at(d);
       (*lineData)[i].setX(lastValue);
       (*lineData)[i].setY(key);
       ++i;
-      ++it;
     }
   } else // key axis is horizontal
   {
-    double lastValue = mValueAxis->coordToPixel(it.value().value);
+    double lastValue = valuePixels.at(0);
     double key;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = mKeyAxis->coordToPixel(it.key());
+      key = keyPixels.at(d);
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(lastValue);
       ++i;
-      lastValue = mValueAxis->coordToPixel(it.value().value);
+      lastValue = valuePixels.at(d);
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(lastValue);
       ++i;
-      ++it;
     }
   }
 }
@@ -10160,69 +13567,56 @@ void QCPGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData>
   filling the vector.
   \see drawLinePlot
 */
-void QCPGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
-  int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
-  // prepare vectors:
-  if (lineData)
-  {
-    // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-    // multiplied by 2 because step plot needs two polyline points per one actual data point
-    lineData->reserve(dataCount*2+2);
-    lineData->resize(dataCount*2);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the line consists of:
+  int lower, upper;
+  int dataCount;
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
+  QVector<qreal> keyPixels, valuePixels;
+  getPixelCoords(data, &keyPixels, &valuePixels);
+  // prepare vectors:
+  // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  // multiplied by 2 because step plot needs two polyline points per one actual data point
+  lineData->reserve(count*2+2);
+  lineData->resize(count*2);
   
   // position points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
   int i = 0;
-  int ipoint = 0;
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = mKeyAxis->coordToPixel(it.key());
+    double lastKey = keyPixels.at(0);
     double value;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      value = mValueAxis->coordToPixel(it.value().value);
+      value = valuePixels.at(d);
       (*lineData)[i].setX(value);
       (*lineData)[i].setY(lastKey);
       ++i;
-      lastKey = mKeyAxis->coordToPixel(it.key());
+      lastKey = keyPixels.at(d);
       (*lineData)[i].setX(value);
       (*lineData)[i].setY(lastKey);
       ++i;
-      ++it;
     }
   } else // key axis is horizontal
   {
-    double lastKey = mKeyAxis->coordToPixel(it.key());
+    double lastKey = keyPixels.at(0);
     double value;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      value = mValueAxis->coordToPixel(it.value().value);
+      value = valuePixels.at(d);
       (*lineData)[i].setX(lastKey);
       (*lineData)[i].setY(value);
       ++i;
-      lastKey = mKeyAxis->coordToPixel(it.key());
+      lastKey = keyPixels.at(d);
       (*lineData)[i].setX(lastKey);
       (*lineData)[i].setY(value);
       ++i;
-      ++it;
     }
   }
 }
@@ -10237,92 +13631,67 @@ void QCPGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData>
   filling the vector.
   \see drawLinePlot
 */
-void QCPGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the line consists of:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
+  QVector<qreal> keyPixels, valuePixels;
+  getPixelCoords(data, &keyPixels, &valuePixels);
   // prepare vectors:
-  if (lineData)
-  {
-    // added 2 to reserve memory for lower/upper fill base points that might be needed for base fill
-    // multiplied by 2 because step plot needs two polyline points per one actual data point
-    lineData->reserve(dataCount*2+2);
-    lineData->resize(dataCount*2);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // added 2 to reserve memory for lower/upper fill base points that might be needed for base fill
+  // multiplied by 2 because step plot needs two polyline points per one actual data point
+  lineData->reserve(count*2+2);
+  lineData->resize(count*2);
   
   // position points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
   int i = 0;
-  int ipoint = 0;
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = mKeyAxis->coordToPixel(it.key());
-    double lastValue = mValueAxis->coordToPixel(it.value().value);
+    double lastKey = keyPixels.at(0);
+    double lastValue = valuePixels.at(0);
     double key;
-    if (pointData)
-    {
-      (*pointData)[ipoint] = it.value();
-      ++ipoint;
-    }
     (*lineData)[i].setX(lastValue);
     (*lineData)[i].setY(lastKey);
-    ++it;
     ++i;
-    while (it != upperEnd)
+    for (int d=1; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = (mKeyAxis->coordToPixel(it.key())-lastKey)*0.5 + lastKey;
+      key = (keyPixels.at(d)-lastKey)*0.5 + lastKey;
       (*lineData)[i].setX(lastValue);
       (*lineData)[i].setY(key);
       ++i;
-      lastValue = mValueAxis->coordToPixel(it.value().value);
-      lastKey = mKeyAxis->coordToPixel(it.key());
+      lastValue = valuePixels.at(d);
+      lastKey = keyPixels.at(d);
       (*lineData)[i].setX(lastValue);
       (*lineData)[i].setY(key);
-      ++it;
       ++i;
     }
     (*lineData)[i].setX(lastValue);
     (*lineData)[i].setY(lastKey);
   } else // key axis is horizontal
   {
-    double lastKey = mKeyAxis->coordToPixel(it.key());
-    double lastValue = mValueAxis->coordToPixel(it.value().value);
+    double lastKey = keyPixels.at(0);
+    double lastValue = valuePixels.at(0);
     double key;
-    if (pointData)
-    {
-      (*pointData)[ipoint] = it.value();
-      ++ipoint;
-    }
     (*lineData)[i].setX(lastKey);
     (*lineData)[i].setY(lastValue);
-    ++it;
     ++i;
-    while (it != upperEnd)
+    for (int d=1; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = (mKeyAxis->coordToPixel(it.key())-lastKey)*0.5 + lastKey;
+      key = (keyPixels.at(d)-lastKey)*0.5 + lastKey;
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(lastValue);
       ++i;
-      lastValue = mValueAxis->coordToPixel(it.value().value);
-      lastKey = mKeyAxis->coordToPixel(it.key());
+      lastValue = valuePixels.at(d);
+      lastKey = keyPixels.at(d);
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(lastValue);
-      ++it;
       ++i;
     }
     (*lineData)[i].setX(lastKey);
@@ -10340,65 +13709,52 @@ void QCPGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData
   filling the vector.
   \see drawImpulsePlot
 */
-void QCPGraph::getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the impulses are drawn for:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
+  QVector<qreal> keyPixels, valuePixels;
+  getPixelCoords(data, &keyPixels, &valuePixels);
   // prepare vectors:
-  if (lineData)
-  {
-    // no need to reserve 2 extra points, because there is no fill for impulse plot
-    lineData->resize(dataCount*2);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // no need to reserve 2 extra points, because there is no fill for impulse plot
+  lineData->resize(count*2);
   
   // position data points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
   int i = 0;
-  int ipoint = 0;
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
     double zeroPointX = mValueAxis->coordToPixel(0);
     double key;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = mKeyAxis->coordToPixel(it.key());
+      key = keyPixels.at(d);
       (*lineData)[i].setX(zeroPointX);
       (*lineData)[i].setY(key);
       ++i;
-      (*lineData)[i].setX(mValueAxis->coordToPixel(it.value().value));
+      (*lineData)[i].setX(valuePixels.at(d));
       (*lineData)[i].setY(key);
       ++i;
-      ++it;
     }
   } else // key axis is horizontal
   {
     double zeroPointY = mValueAxis->coordToPixel(0);
     double key;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = mKeyAxis->coordToPixel(it.key());
+      key = keyPixels.at(d);
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(zeroPointY);
       ++i;
       (*lineData)[i].setX(key);
-      (*lineData)[i].setY(mValueAxis->coordToPixel(it.value().value));
+      (*lineData)[i].setY(valuePixels.at(d));
       ++i;
-      ++it;
     }
   }
 }
@@ -10414,12 +13770,15 @@ void QCPGraph::getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *
   polygon is calculated with the \ref getChannelFillPolygon function.
   \see drawLinePlot
 */
-void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const
+void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData, int draftStride) const
 {
   if (mLineStyle == lsImpulse) return; // fill doesn't make sense for impulse plot
   if (mainBrush().style() == Qt::NoBrush || mainBrush().color().alpha() == 0) return;
+  if (draftStride > 1 && mChannelFillGraph) return; // reduced detail, the channel needs the full line of the other graph
   
   applyFillAntialiasingHint(painter);
+  if (draftStride > 1) // reduced detail, fill without antialiasing
+    painter->setAntialiasing(false);
   if (!mChannelFillGraph)
   {
     // draw base fill under graph, fill goes all the way to the zero-value-line:
@@ -10444,22 +13803,24 @@ void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const
   is outputted by all "get(...)PlotData" functions, together with the (line style dependent) line data.
   \see drawLinePlot, drawImpulsePlot
 */
-void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData) const
+void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData, int draftStride) const
 {
+  if (pointData->isEmpty()) return;
+  
+  // transform all points to pixel coordinates at once:
+  const QCPData *points = pointData->constData();
+  QVector<qreal> keyPixels(pointData->size()), valuePixels(pointData->size());
+  mKeyAxis->coordToPixel(&points->key, keyPixels.data(), pointData->size(), sizeof(QCPData));
+  mValueAxis->coordToPixel(&points->value, valuePixels.data(), pointData->size(), sizeof(QCPData));
+  
   // draw error bars:
-  if (mErrorType != etNone)
+  if (mErrorType != etNone && !mDataSource && draftStride == 1) // external data sources don't provide error bars, reduced detail skips them
   {
     applyErrorBarsAntialiasingHint(painter);
     painter->setPen(mErrorPen);
-    if (mKeyAxis->orientation() == Qt::Vertical)
-    {
-      for (int i=0; i<pointData->size(); ++i)
-        drawError(painter, mValueAxis->coordToPixel(pointData->at(i).value), mKeyAxis->coordToPixel(pointData->at(i).key), pointData->at(i));
-    } else
-    {
-      for (int i=0; i<pointData->size(); ++i)
-        drawError(painter, mKeyAxis->coordToPixel(pointData->at(i).key), mValueAxis->coordToPixel(pointData->at(i).value), pointData->at(i));
-    }
+    QVector<QLineF> errorLines;
+    getErrorBarLines(&errorLines, pointData, keyPixels, valuePixels);
+    painter->drawLines(errorLines);
   }
   
   // draw scatter point symbols:
@@ -10467,15 +13828,28 @@ void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData)
   painter->setPen(mainPen());
   painter->setBrush(mainBrush());
   painter->setScatterPixmap(mScatterPixmap);
+  const qreal *xPixels = keyPixels.constData();
+  const qreal *yPixels = valuePixels.constData();
   if (mKeyAxis->orientation() == Qt::Vertical)
-  {
+    qSwap(xPixels, yPixels);
+  QVector<QPointF> scatters;
+  scatters.reserve(pointData->size());
+  if (scatterCullingUsable(mScatterStyle, mScatterPixmap))
+  {
+    // skip symbols on pixels that already hold an identical symbol:
+    QRect rect = clipRect();
+    QBitArray occupancy(rect.width()*rect.height());
     for (int i=0; i<pointData->size(); ++i)
-      painter->drawScatter(mValueAxis->coordToPixel(pointData->at(i).value), mKeyAxis->coordToPixel(pointData->at(i).key), mScatterSize, mScatterStyle);
+    {
+      if (!cullScatter(occupancy, rect, xPixels[i], yPixels[i]))
+        scatters.append(QPointF(xPixels[i], yPixels[i]));
+    }
   } else
   {
     for (int i=0; i<pointData->size(); ++i)
-      painter->drawScatter(mKeyAxis->coordToPixel(pointData->at(i).key), mValueAxis->coordToPixel(pointData->at(i).value), mScatterSize, mScatterStyle);
+      scatters.append(QPointF(xPixels[i], yPixels[i]));
   }
+  painter->drawScatters(scatters, mScatterSize, mScatterStyle);
 }
 
 /*! 
@@ -10495,23 +13869,13 @@ void QCPGraph::drawLinePlot(QCPPainter *painter, QVector<QPointF> *lineData) con
     painter->setPen(mainPen());
     painter->setBrush(Qt::NoBrush);
     
-    /* Draws polyline in batches, currently not used:
-    int p = 0;
-    while (p < lineData->size())
+    // draw long lines in chunks (see QCustomPlot::setPolylineChunkSize), or if drawing solid line
+    // and not in PDF, use much faster line drawing instead of polyline:
+    int chunkSize = mParentPlot->polylineChunkSize();
+    if (chunkSize > 0 || (chunkSize < 0 && !mParentPlot->plottingHints().testFlag(QCP::phFastPolylines)))
     {
-      int batch = qMin(25, lineData->size()-p);
-      if (p != 0)
-      {
-        ++batch;
-        --p; // to draw the connection lines between two batches
-      }
-      painter->drawPolyline(lineData->constData()+p, batch);
-      p += batch;
-    }
-    */
-    
-    // if drawing solid line and not in PDF, use much faster line drawing instead of polyline:
-    if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
+      painter->drawPolylineChunked(*lineData, chunkSize);
+    } else if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
         painter->pen().style() == Qt::SolidLine &&
         !painter->pdfExportMode())
     {
@@ -10544,137 +13908,324 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData)
   }
 }
 
-/*! 
-  \internal
-  called by the scatter drawing function (\ref drawScatterPlot) to draw the error bars on one data
-  point. \a x and \a y pixel positions of the data point are passed since they are already known in
-  pixel coordinates in the drawing function, so we save some extra coordToPixel transforms here. \a
-  data is therefore only used for the errors, not key and value.
+/*! \internal
+  
+  Called by the scatter drawing function (\ref drawScatterPlot) to generate the line segments of the
+  error bars of all points in \a pointData, so they can be drawn with a single call. \a keyPixels
+  and \a valuePixels are the pixel positions of the data points, which are already known in the
+  drawing function, so we save some extra coordToPixel transforms here. The segments are appended
+  to \a lines.
+  
+  Value error bars of consecutive points that fall into the same pixel column along the key axis
+  are merged into one envelope, reaching from the lowest to the highest error bound of those points
+  (with handles only at the ends). For dense graphs, this limits the number of value error bars to
+  the number of pixel columns.
 */
-void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData &data) const
+void QCPGraph::getErrorBarLines(QVector<QLineF> *lines, const QVector<QCPData> *pointData, const QVector<qreal> &keyPixels, const QVector<qreal> &valuePixels) const
 {
-  double a, b; // positions of error bar bounds in pixels
-  double barWidthHalf = mErrorBarSize*0.5;
-  double skipSymbolMargin = mScatterSize*1.25; // pixels left blank per side, when mErrorBarSkipSymbol is true
-
-  if (mKeyAxis->orientation() == Qt::Vertical)
+  const bool keyVertical = mKeyAxis->orientation() == Qt::Vertical;
+  const bool keyErrors = mErrorType == etKey || mErrorType == etBoth;
+  const bool valueErrors = mErrorType == etValue || mErrorType == etBoth;
+  const int count = pointData->size();
+  lines->reserve(lines->size() + count*((keyErrors ? 4 : 0) + (valueErrors ? 4 : 0)));
+  
+  if (keyErrors)
   {
-    // draw key error vertically and value error horizontally
-    if (mErrorType == etKey || mErrorType == etBoth)
+    for (int i=0; i<count; ++i)
     {
-      a = mKeyAxis->coordToPixel(data.key-data.keyErrorMinus);
-      b = mKeyAxis->coordToPixel(data.key+data.keyErrorPlus);
-      if (mKeyAxis->rangeReversed())
-        qSwap(a,b);
-      // draw spine:
-      if (mErrorBarSkipSymbol)
+      const QCPData &data = pointData->at(i);
+      addErrorBarLines(lines, keyVertical, valuePixels.at(i), keyPixels.at(i), mKeyAxis->coordToPixel(data.key-data.keyErrorMinus),
+                       mKeyAxis->coordToPixel(data.key+data.keyErrorPlus), mErrorBarSkipSymbol);
+    }
+  }
+  if (valueErrors)
+  {
+    int i = 0;
+    while (i < count)
+    {
+      // collect the points in the pixel column of point i (keys are sorted, so they are consecutive):
+      double column = floor(keyPixels.at(i));
+      double a = mValueAxis->coordToPixel(pointData->at(i).value-pointData->at(i).valueErrorMinus);
+      double b = mValueAxis->coordToPixel(pointData->at(i).value+pointData->at(i).valueErrorPlus);
+      double lower = qMin(a, b);
+      double upper = qMax(a, b);
+      int end = i+1;
+      while (end < count && floor(keyPixels.at(end)) == column)
       {
-        if (a-y > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(x, a, x, y+skipSymbolMargin));
-        if (y-b > skipSymbolMargin) 
-          painter->drawLine(QLineF(x, y-skipSymbolMargin, x, b));
-      } else
-        painter->drawLine(QLineF(x, a, x, b));
-      // draw handles:
-      painter->drawLine(QLineF(x-barWidthHalf, a, x+barWidthHalf, a));
-      painter->drawLine(QLineF(x-barWidthHalf, b, x+barWidthHalf, b));
-    }
-    if (mErrorType == etValue || mErrorType == etBoth)
-    {
-      a = mValueAxis->coordToPixel(data.value-data.valueErrorMinus);
-      b = mValueAxis->coordToPixel(data.value+data.valueErrorPlus);
-      if (mValueAxis->rangeReversed())
-        qSwap(a,b);
-      // draw spine:
-      if (mErrorBarSkipSymbol)
-      {
-        if (x-a > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(a, y, x-skipSymbolMargin, y));
-        if (b-x > skipSymbolMargin)
-          painter->drawLine(QLineF(x+skipSymbolMargin, y, b, y));
-      } else
-        painter->drawLine(QLineF(a, y, b, y));
-      // draw handles:
-      painter->drawLine(QLineF(a, y-barWidthHalf, a, y+barWidthHalf));
-      painter->drawLine(QLineF(b, y-barWidthHalf, b, y+barWidthHalf));
-    }
-  } else // mKeyAxis->orientation() is Qt::Horizontal
-  {
-    // draw value error vertically and key error horizontally
-    if (mErrorType == etKey || mErrorType == etBoth)
-    {
-      a = mKeyAxis->coordToPixel(data.key-data.keyErrorMinus);
-      b = mKeyAxis->coordToPixel(data.key+data.keyErrorPlus);
-      if (mKeyAxis->rangeReversed())
-        qSwap(a,b);
-      // draw spine:
-      if (mErrorBarSkipSymbol)
-      {
-        if (x-a > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(a, y, x-skipSymbolMargin, y));
-        if (b-x > skipSymbolMargin)
-          painter->drawLine(QLineF(x+skipSymbolMargin, y, b, y));
-      } else
-        painter->drawLine(QLineF(a, y, b, y));
-      // draw handles:
-      painter->drawLine(QLineF(a, y-barWidthHalf, a, y+barWidthHalf));
-      painter->drawLine(QLineF(b, y-barWidthHalf, b, y+barWidthHalf));
-    }
-    if (mErrorType == etValue || mErrorType == etBoth)
-    {
-      a = mValueAxis->coordToPixel(data.value-data.valueErrorMinus);
-      b = mValueAxis->coordToPixel(data.value+data.valueErrorPlus);
-      if (mValueAxis->rangeReversed())
-        qSwap(a,b);
-      // draw spine:
-      if (mErrorBarSkipSymbol)
-      {
-        if (a-y > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(x, a, x, y+skipSymbolMargin));
-        if (y-b > skipSymbolMargin)
-          painter->drawLine(QLineF(x, y-skipSymbolMargin, x, b));
-      } else
-        painter->drawLine(QLineF(x, a, x, b));
-      // draw handles:
-      painter->drawLine(QLineF(x-barWidthHalf, a, x+barWidthHalf, a));
-      painter->drawLine(QLineF(x-barWidthHalf, b, x+barWidthHalf, b));
+        a = mValueAxis->coordToPixel(pointData->at(end).value-pointData->at(end).valueErrorMinus);
+        b = mValueAxis->coordToPixel(pointData->at(end).value+pointData->at(end).valueErrorPlus);
+        lower = qMin(lower, qMin(a, b));
+        upper = qMax(upper, qMax(a, b));
+        ++end;
+      }
+      if (end-i == 1)
+        addErrorBarLines(lines, !keyVertical, keyPixels.at(i), valuePixels.at(i), lower, upper, mErrorBarSkipSymbol);
+      else // envelope of several error bars, the symbols cover most of it anyway, so don't skip them
+        addErrorBarLines(lines, !keyVertical, keyPixels.at(i), 0, lower, upper, false);
+      i = end;
     }
   }
 }
 
+/*! \internal
+  
+  Appends the line segments of a single error bar to \a lines. The spine of the error bar reaches
+  from pixel position \a a to \a b, and is vertical if \a verticalSpine is true, horizontal
+  otherwise. \a spinePos is the pixel position of the spine perpendicular to it, \a symbolPos the
+  position of the data point along it. If \a skipSymbol is true, the spine leaves a gap around the
+  scatter symbol (see \ref setErrorBarSkipSymbol). The handles at both ends are \ref
+  setErrorBarSize pixels wide.
+*/
+void QCPGraph::addErrorBarLines(QVector<QLineF> *lines, bool verticalSpine, double spinePos, double symbolPos, double a, double b, bool skipSymbol) const
+{
+  double lower = qMin(a, b);
+  double upper = qMax(a, b);
+  double barWidthHalf = mErrorBarSize*0.5;
+  double skipSymbolMargin = mScatterSize*1.25; // pixels left blank per side, when skipSymbol is true
+  
+  // collect segments with coordinates along the spine and across it:
+  QLineF segments[4];
+  int segmentCount = 0;
+  if (skipSymbol)
+  {
+    if (symbolPos-lower > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolMargin
+      segments[segmentCount++] = QLineF(lower, spinePos, symbolPos-skipSymbolMargin, spinePos);
+    if (upper-symbolPos > skipSymbolMargin)
+      segments[segmentCount++] = QLineF(symbolPos+skipSymbolMargin, spinePos, upper, spinePos);
+  } else
+    segments[segmentCount++] = QLineF(lower, spinePos, upper, spinePos);
+  // handles:
+  segments[segmentCount++] = QLineF(lower, spinePos-barWidthHalf, lower, spinePos+barWidthHalf);
+  segments[segmentCount++] = QLineF(upper, spinePos-barWidthHalf, upper, spinePos+barWidthHalf);
+  
+  for (int i=0; i<segmentCount; ++i)
+  {
+    if (verticalSpine)
+      lines->append(QLineF(segments[i].y1(), segments[i].x1(), segments[i].y2(), segments[i].x2()));
+    else
+      lines->append(segments[i]);
+  }
+}
+
 /*! 
   \internal
   called by the specific plot data generating functions "get(...)PlotData" to determine
   which data range is visible, so only that needs to be processed.
   
-  \param[out] lower returns an iterator to the lowest data point that needs to be taken into account
+  \param[out] lower returns the index of the lowest data point that needs to be taken into account
   when plotting. Note that in order to get a clean plot all the way to the edge of the axes, \a lower
   may still be outside the visible range.
-  \param[out] upper returns an iterator to the highest data point. Same as before, \a upper may also
+  \param[out] upper returns the index of the highest data point. Same as before, \a upper may also
   lie outside of the visible range.
   \param[out] count number of data points that need plotting, i.e. points between \a lower and \a upper,
   including them. This is useful for allocating the array of QPointFs in the specific drawing functions.
+  \param keyRange the key range that is drawn, see \ref getPlotData.
 */
-void QCPGraph::getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper, int &count) const
+void QCPGraph::getVisibleDataBounds(int &lower, int &upper, int &count, const QCPRange &keyRange) const
 {
-  // get visible data range as QMap iterators
-  QCPDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis->range().lower);
-  QCPDataMap::const_iterator ubound = mData->upperBound(mKeyAxis->range().upper)-1;
-  bool lowoutlier = lbound != mData->constBegin(); // indicates whether there exist points below axis range
-  bool highoutlier = ubound+1 != mData->constEnd(); // indicates whether there exist points above axis range
+  // get visible data range as indices into the data view
+  QCPDataView data = dataView();
+  int lbound = data.lowerBound(keyRange.lower);
+  int ubound = data.upperBound(keyRange.upper)-1;
+  bool lowoutlier = lbound != 0; // indicates whether there exist points below axis range
+  bool highoutlier = ubound+1 != data.size(); // indicates whether there exist points above axis range
   lower = (lowoutlier ? lbound-1 : lbound); // data pointrange that will be actually drawn
   upper = (highoutlier ? ubound+1 : ubound); // data pointrange that will be actually drawn
   
-  // count number of points in range lower to upper (including them), so we can allocate array for them in draw functions:
-  QCPDataMap::const_iterator it = lower;
-  count = 1;
-  while (it != upper)
+  // number of points in range lower to upper (including them), so we can allocate array for them in draw functions:
+  count = upper-lower+1;
+}
+
+/*! \internal
+  
+  Returns a view on the data points from which the line of the graph is generated, for the visible
+  data range from index \a lower to \a upper (including them) as determined by \ref
+  getVisibleDataBounds.
+  
+  If adaptive sampling is enabled (\ref setAdaptiveSampling) and there are considerably more points
+  in the visible range than pixels along the key axis, the points are reduced with \ref
+  getAdaptiveSampledData. Then \a sampledData is used as storage for the reduced points and the
+  returned view refers to it. Otherwise the returned view refers directly to the graph's data
+  (\ref dataView) and \a sampledData is left untouched.
+  
+  While the graph is drawn with reduced detail (see QCustomPlot::setDraftPointBudget), only every
+  n-th point is used instead, so the draft point budget isn't exceeded. This doesn't need to visit
+  all visible points. The level of detail index (\ref setLodIndex) is accurate and fast, so it is
+  still used if available.
+*/
+QCPDataView QCPGraph::getLineSourceData(int lower, int upper, QVector<QCPData> *sampledData, int draftStride) const
+{
+  if (draftStride > 1 && !(mAdaptiveSampling && !mDataSource && mData->lodIndex()))
+  {
+    // keep the last point, so the line still reaches the border of the axis rect:
+    QCPDataView data = dataView();
+    sampledData->clear();
+    sampledData->reserve((upper-lower)/draftStride+2);
+    for (int i=lower; i<upper; i+=draftStride)
+      sampledData->append(QCPData(data.key(i), data.value(i)));
+    sampledData->append(QCPData(data.key(upper), data.value(upper)));
+    return QCPDataView(&sampledData->constData()->key, &sampledData->constData()->value, sampledData->size(), sizeof(QCPData), sizeof(QCPData));
+  }
+  if (mAdaptiveSampling)
   {
-    ++it;
-    ++count;
+    int keyPixelSpan = (mKeyAxis->orientation() == Qt::Horizontal ? mKeyAxis->axisRect().width() : mKeyAxis->axisRect().height());
+    if (upper-lower+1 > 4*keyPixelSpan) // adaptive sampling only reduces the point count if there are more than four points per pixel column
+    {
+      getAdaptiveSampledData(sampledData, lower, upper);
+      if (sampledData->isEmpty())
+        return QCPDataView();
+      return QCPDataView(&sampledData->constData()->key, &sampledData->constData()->value, sampledData->size(), sizeof(QCPData), sizeof(QCPData));
+    }
+  }
+  return dataView().mid(lower, upper-lower+1);
+}
+
+/*! \internal
+  
+  Reduces the data points from index \a lower to \a upper (including them) and places the result
+  in \a sampledData. The data points are grouped by the pixel column their key falls into. Of each
+  group, only the first point, the point with the minimum value, the point with the maximum value
+  and the last point are kept, in their original order. Connecting the kept points with lines
+  covers the same pixels as connecting all original points, so this reduction is invisible in
+  the plot while limiting the number of points to four per pixel column.
+  
+  \see setAdaptiveSampling, getLineSourceData
+*/
+void QCPGraph::getAdaptiveSampledData(QVector<QCPData> *sampledData, int lower, int upper) const
+{
+  int keyPixelSpan = (mKeyAxis->orientation() == Qt::Horizontal ? mKeyAxis->axisRect().width() : mKeyAxis->axisRect().height());
+  if (!mDataSource && mData->lodIndex() && upper-lower+1 > 64*keyPixelSpan) // with the level of detail index, columns are processed in O(log n) instead of scanning their points
+  {
+    getLodSampledData(sampledData, lower, upper);
+    return;
+  }
+  sampledData->clear();
+  sampledData->reserve(4*(keyPixelSpan+2)); // +2 for the columns of the points outside the visible range
+  
+  QCPDataView data = dataView();
+  int entryIndex = lower; // first point of current pixel column
+  int minIndex = lower;
+  int maxIndex = lower;
+  double minValue = data.value(lower);
+  double maxValue = minValue;
+  double column = floor(mKeyAxis->coordToPixel(data.key(lower)));
+  for (int i=lower+1; i<=upper+1; ++i) // i == upper+1 is used to finish the last column
+  {
+    double currentColumn = 0;
+    if (i <= upper)
+    {
+      currentColumn = floor(mKeyAxis->coordToPixel(data.key(i)));
+      if (currentColumn == column)
+      {
+        double value = data.value(i);
+        if (value < minValue)
+        {
+          minValue = value;
+          minIndex = i;
+        }
+        if (value > maxValue)
+        {
+          maxValue = value;
+          maxIndex = i;
+        }
+        continue;
+      }
+    }
+    // column is finished, append entry, extremes and exit point in their original order, skipping duplicates:
+    int columnIndices[4] = {entryIndex, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), i-1};
+    int lastIndex = -1;
+    for (int k=0; k<4; ++k)
+    {
+      if (columnIndices[k] != lastIndex)
+      {
+        sampledData->append(QCPData(data.key(columnIndices[k]), data.value(columnIndices[k])));
+        lastIndex = columnIndices[k];
+      }
+    }
+    // start next column:
+    if (i <= upper)
+    {
+      column = currentColumn;
+      entryIndex = minIndex = maxIndex = i;
+      minValue = maxValue = data.value(i);
+    }
+  }
+}
+
+/*! \internal
+  
+  Like \ref getAdaptiveSampledData, reduces the data points from index \a lower to \a upper
+  (including them) to at most four points per pixel column and places the result in \a
+  sampledData. Instead of visiting every data point, the borders of each pixel column are found by
+  binary searches and the value extremes inside the column are retrieved from the level of detail
+  index of the data container (\ref QCPDataContainer::valueRange). This makes the effort
+  proportional to the number of pixel columns times log n.
+  
+  Since the index doesn't tell where inside a column the extremes are located, they are placed at
+  the keys of the first and last point of the column, ordered such that the line runs through the
+  whole value range of the column and continues to the last point without crossing back.
+  
+  \see setLodIndex
+*/
+void QCPGraph::getLodSampledData(QVector<QCPData> *sampledData, int lower, int upper) const
+{
+  int keyPixelSpan = (mKeyAxis->orientation() == Qt::Horizontal ? mKeyAxis->axisRect().width() : mKeyAxis->axisRect().height());
+  sampledData->clear();
+  sampledData->reserve(4*(keyPixelSpan+2)); // +2 for the columns of the points outside the visible range
+  
+  QCPDataView data = mData->view();
+  // pixel coordinate may increase or decrease with key, depending on axis orientation and range reversal:
+  bool ascending = mKeyAxis->coordToPixel(data.key(upper)) >= mKeyAxis->coordToPixel(data.key(lower));
+  int begin = lower;
+  while (begin <= upper)
+  {
+    // find end of current pixel column (index after its last point):
+    double column = floor(mKeyAxis->coordToPixel(data.key(begin)));
+    int end = ascending ? data.lowerBound(mKeyAxis->pixelToCoord(column+1)) : data.upperBound(mKeyAxis->pixelToCoord(column));
+    end = qBound(begin+1, end, upper+1); // guarantee progress in case pixelToCoord isn't exactly inverse to coordToPixel
+    if (end-begin <= 4)
+    {
+      for (int i=begin; i<end; ++i)
+        sampledData->append(QCPData(data.key(i), data.value(i)));
+    } else
+    {
+      QCPData entry(data.key(begin), data.value(begin));
+      QCPData exit(data.key(end-1), data.value(end-1));
+      QCPRange extremes = mData->valueRange(begin+1, end-1);
+      sampledData->append(entry);
+      if (exit.value >= entry.value)
+      {
+        sampledData->append(QCPData(entry.key, extremes.lower));
+        sampledData->append(QCPData(exit.key, extremes.upper));
+      } else
+      {
+        sampledData->append(QCPData(entry.key, extremes.upper));
+        sampledData->append(QCPData(exit.key, extremes.lower));
+      }
+      sampledData->append(exit);
+    }
+    begin = end;
   }
 }
 
+/*! \internal
+  
+  Transforms the keys and values of the data points in \a data to pixel coordinates along the key
+  and value axis, respectively, and writes them to \a keyPixels and \a valuePixels. The
+  transformation is done in batches with \ref QCPAxis::coordToPixel(const double *coords, qreal
+  *pixels, int count, int coordStride, int pixelStride) const.
+  
+  Used by the plot data generating functions that need more than one polyline point per data point.
+*/
+void QCPGraph::getPixelCoords(const QCPDataView &data, QVector<qreal> *keyPixels, QVector<qreal> *valuePixels) const
+{
+  keyPixels->resize(data.size());
+  valuePixels->resize(data.size());
+  if (data.isEmpty()) return;
+  mKeyAxis->coordToPixel(data.keys(), keyPixels->data(), data.size(), data.keyStride());
+  mValueAxis->coordToPixel(data.values(), valuePixels->data(), data.size(), data.valueStride());
+}
+
 /*! 
   \internal
   The line data vector generated by e.g. getLinePlotData contains only the line
@@ -10836,8 +14387,8 @@ QPointF QCPGraph::upperFillBasePoint(double upperKey) const
 /*! \internal
   
   Generates the polygon needed for drawing channel fills between this graph (data passed via \a
-  lineData) and the graph specified by mChannelFillGraph (data generated by calling its \ref
-  getPlotData function). May return an empty polygon if the key ranges have no overlap or fill
+  lineData) and the graph specified by mChannelFillGraph (data retrieved by calling its \ref
+  getCachedPlotData function). May return an empty polygon if the key ranges have no overlap or fill
   target graph and this graph don't have same orientation (i.e. both key axes horizontal or both
   key axes vertical). For increased performance (due to implicit sharing), keep the returned QPolygonF
   const.
@@ -10849,7 +14400,7 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData
   
   if (lineData->isEmpty()) return QPolygonF();
   QVector<QPointF> otherData;
-  mChannelFillGraph->getPlotData(&otherData, 0);
+  mChannelFillGraph->getCachedPlotData(&otherData, 0, 1); // always full detail, see getCachedPlotData
   if (otherData.isEmpty()) return QPolygonF();
   QVector<QPointF> thisData;
   thisData.reserve(lineData->size()+otherData.size()); // because we will join both vectors at end of this function
@@ -11043,14 +14594,15 @@ int QCPGraph::findIndexAboveY(const QVector<QPointF> *data, double y) const
 */
 double QCPGraph::pointDistance(const QPointF &pixelPoint) const
 {
-  if (mData->isEmpty())
+  QCPDataView data = dataView();
+  if (data.isEmpty())
   {
     qDebug() << Q_FUNC_INFO << "requested point distance on graph" << mName << "without data";
     return 500;
   }
-  if (mData->size() == 1)
+  if (data.size() == 1)
   {
-    QPointF dataPoint = coordsToPixels(mData->constBegin().key(), mData->constBegin().value().value);
+    QPointF dataPoint = coordsToPixels(data.key(0), data.value(0));
     return QVector2D(dataPoint-pixelPoint).length();
   }
   
@@ -11061,47 +14613,45 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint) const
   if (mLineStyle == lsNone)
   {
     // no line displayed, only calculate distance to scatter points:
-    QVector<QCPData> *pointData = new QVector<QCPData>;
-    getScatterPlotData(pointData);
+    QVector<QCPData> pointData;
+    getCachedPlotData(0, &pointData, 1);
     double minDistSqr = std::numeric_limits<double>::max();
     QPointF ptA;
-    QPointF ptB = coordsToPixels(pointData->at(0).key, pointData->at(0).value); // getScatterPlotData returns in plot coordinates, so transform to pixels
-    for (int i=1; i<pointData->size(); ++i)
+    QPointF ptB = coordsToPixels(pointData.at(0).key, pointData.at(0).value); // getScatterPlotData returns in plot coordinates, so transform to pixels
+    for (int i=1; i<pointData.size(); ++i)
     {
       ptA = ptB;
-      ptB = coordsToPixels(pointData->at(i).key, pointData->at(i).value);
+      ptB = coordsToPixels(pointData.at(i).key, pointData.at(i).value);
       double currentDistSqr = distSqrToLine(ptA, ptB, pixelPoint);
       if (currentDistSqr < minDistSqr)
         minDistSqr = currentDistSqr;
     }
-    delete pointData;
     return sqrt(minDistSqr);
   } else
   {
     // line displayed calculate distance to line segments:
-    QVector<QPointF> *lineData = new QVector<QPointF>;
-    getPlotData(lineData, 0); // unlike with getScatterPlotData we get pixel coordinates here
+    QVector<QPointF> lineData;
+    getCachedPlotData(&lineData, 0, 1); // unlike with getScatterPlotData we get pixel coordinates here
     double minDistSqr = std::numeric_limits<double>::max();
     if (mLineStyle == lsImpulse)
     {
       // impulse plot differs from other line styles in that the lineData points are only pairwise connected:
-      for (int i=0; i<lineData->size()-1; i+=2) // iterate pairs
+      for (int i=0; i<lineData.size()-1; i+=2) // iterate pairs
       {
-        double currentDistSqr = distSqrToLine(lineData->at(i), lineData->at(i+1), pixelPoint);
+        double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
         if (currentDistSqr < minDistSqr)
           minDistSqr = currentDistSqr;
       }
     } else 
     {
       // all other line plots (line and step) connect points directly:
-      for (int i=0; i<lineData->size()-1; ++i)
+      for (int i=0; i<lineData.size()-1; ++i)
       {
-        double currentDistSqr = distSqrToLine(lineData->at(i), lineData->at(i+1), pixelPoint);
+        double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
         if (currentDistSqr < minDistSqr)
           minDistSqr = currentDistSqr;
       }
     }
-    delete lineData;
     return sqrt(minDistSqr);
   }
 }
@@ -11151,102 +14701,147 @@ QCPRange QCPGraph::getValueRange(bool &validRange, SignDomain inSignDomain) cons
 */
 QCPRange QCPGraph::getKeyRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const
 {
-  QCPRange range;
-  bool haveLower = false;
-  bool haveUpper = false;
+  if (mDataSource || !mData->hasErrors())
+    includeErrors = false; // no error values stored (see QCPDataContainer::hasErrors) or provided by the data source
+  
+  if (inSignDomain == sdBoth && !includeErrors) // keys are sorted, so the range spans from the first to the last key
+  {
+    QCPDataView data = dataView();
+    validRange = !data.isEmpty();
+    return validRange ? QCPRange(data.key(0), data.key(data.size()-1)) : QCPRange();
+  }
+  
+  // the range of the data container is cached and only extended by appended points, as long as no
+  // points were removed or replaced (see QCPDataContainer::revision). External data sources
+  // may change without notice, so their range is always determined from scratch:
+  CachedRange uncached;
+  CachedRange &cache = mDataSource ? uncached : mKeyRangeCache[inSignDomain][includeErrors ? 1 : 0];
+  if (!mDataSource)
+  {
+    // points removed from the front only invalidate the range if they determined one of its bounds:
+    qint64 frontOffset = mData->frontOffset();
+    if (cache.revision != mData->revision() || (cache.haveLower && cache.lowerIndex < frontOffset) || (cache.haveUpper && cache.upperIndex < frontOffset))
+    {
+      cache = CachedRange();
+      cache.revision = mData->revision();
+      cache.end = frontOffset;
+    }
+    cache.frontOffset = frontOffset;
+  }
+  int size = dataView().size();
+  int begin = int(qMax(qint64(0), cache.end-cache.frontOffset));
+  if (begin < size)
+  {
+    accumulateKeyRange(cache, inSignDomain, includeErrors, begin, size);
+    cache.end = cache.frontOffset+size;
+  }
+  
+  validRange = cache.haveLower && cache.haveUpper;
+  return cache.range;
+}
+
+/*! \internal
   
+  Extends the key range in \a cache by the data points with indices from \a begin up to \a end
+  (excluding \a end), following the rules of \ref getKeyRange. Used by \ref getKeyRange to update
+  its cached ranges incrementally.
+*/
+void QCPGraph::accumulateKeyRange(CachedRange &cache, SignDomain inSignDomain, bool includeErrors, int begin, int end) const
+{
   double current, currentErrorMinus, currentErrorPlus;
+  QCPDataView data = dataView();
   
   if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
-      if (current-currentErrorMinus < range.lower || !haveLower)
+      current = data.key(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).keyErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).keyErrorPlus : 0);
+      if (current-currentErrorMinus < cache.range.lower || !cache.haveLower)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if (current+currentErrorPlus > range.upper || !haveUpper)
+      if (current+currentErrorPlus > cache.range.upper || !cache.haveUpper)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
-      ++it;
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
-      if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus < 0)
+      current = data.key(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).keyErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).keyErrorPlus : 0);
+      if ((current-currentErrorMinus < cache.range.lower || !cache.haveLower) && current-currentErrorMinus < 0)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if ((current+currentErrorPlus > range.upper || !haveUpper) && current+currentErrorPlus < 0)
+      if ((current+currentErrorPlus > cache.range.upper || !cache.haveUpper) && current+currentErrorPlus < 0)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
       if (includeErrors) // in case point is in valid sign domain but errobars stretch beyond it, we still want to geht that point.
       {
-        if ((current < range.lower || !haveLower) && current < 0)
+        if ((current < cache.range.lower || !cache.haveLower) && current < 0)
         {
-          range.lower = current;
-          haveLower = true;
+          cache.range.lower = current;
+          cache.haveLower = true;
+          cache.lowerIndex = cache.frontOffset+i;
         }
-        if ((current > range.upper || !haveUpper) && current < 0)
+        if ((current > cache.range.upper || !cache.haveUpper) && current < 0)
         {
-          range.upper = current;
-          haveUpper = true;
+          cache.range.upper = current;
+          cache.haveUpper = true;
+          cache.upperIndex = cache.frontOffset+i;
         }
       }
-      ++it;
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
-      if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus > 0)
+      current = data.key(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).keyErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).keyErrorPlus : 0);
+      if ((current-currentErrorMinus < cache.range.lower || !cache.haveLower) && current-currentErrorMinus > 0)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if ((current+currentErrorPlus > range.upper || !haveUpper) && current+currentErrorPlus > 0)
+      if ((current+currentErrorPlus > cache.range.upper || !cache.haveUpper) && current+currentErrorPlus > 0)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
       if (includeErrors) // in case point is in valid sign domain but errobars stretch beyond it, we still want to get that point.
       {
-        if ((current < range.lower || !haveLower) && current > 0)
+        if ((current < cache.range.lower || !cache.haveLower) && current > 0)
         {
-          range.lower = current;
-          haveLower = true;
+          cache.range.lower = current;
+          cache.haveLower = true;
+          cache.lowerIndex = cache.frontOffset+i;
         }
-        if ((current > range.upper || !haveUpper) && current > 0)
+        if ((current > cache.range.upper || !cache.haveUpper) && current > 0)
         {
-          range.upper = current;
-          haveUpper = true;
+          cache.range.upper = current;
+          cache.haveUpper = true;
+          cache.upperIndex = cache.frontOffset+i;
         }
       }
-      ++it;
     }
   }
-  
-  validRange = haveLower && haveUpper;
-  return range;
 }
 
 /*! \overload
@@ -11256,102 +14851,182 @@ QCPRange QCPGraph::getKeyRange(bool &validRange, SignDomain inSignDomain, bool i
 */
 QCPRange QCPGraph::getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const
 {
-  QCPRange range;
-  bool haveLower = false;
-  bool haveUpper = false;
+  if (mDataSource || !mData->hasErrors())
+    includeErrors = false; // no error values stored (see QCPDataContainer::hasErrors) or provided by the data source
+  
+  // the range of the data container is cached and only extended by appended points, as long as no
+  // points were removed or replaced (see QCPDataContainer::revision). External data sources
+  // may change without notice, so their range is always determined from scratch:
+  CachedRange uncached;
+  CachedRange &cache = mDataSource ? uncached : mValueRangeCache[inSignDomain][includeErrors ? 1 : 0];
+  if (!mDataSource)
+  {
+    // points removed from the front only invalidate the range if they determined one of its bounds:
+    qint64 frontOffset = mData->frontOffset();
+    if (cache.revision != mData->revision() || (cache.haveLower && cache.lowerIndex < frontOffset) || (cache.haveUpper && cache.upperIndex < frontOffset))
+    {
+      cache = CachedRange();
+      cache.revision = mData->revision();
+      cache.end = frontOffset;
+    }
+    cache.frontOffset = frontOffset;
+  }
+  int size = dataView().size();
+  int begin = int(qMax(qint64(0), cache.end-cache.frontOffset));
+  if (begin == 0 && size > 0 && !mDataSource && inSignDomain == sdBoth && !includeErrors && mData->lodIndex())
+  {
+    // the level of detail index provides the range in O(log n), but not the points that determine
+    // it, so the range is conservatively determined anew after the next removal from the front:
+    cache.range = mData->valueRange(0, size);
+    cache.haveLower = true;
+    cache.haveUpper = true;
+    cache.lowerIndex = cache.frontOffset;
+    cache.upperIndex = cache.frontOffset;
+    begin = size;
+    cache.end = cache.frontOffset+size;
+  }
+  if (begin < size)
+  {
+    accumulateValueRange(cache, inSignDomain, includeErrors, begin, size);
+    cache.end = cache.frontOffset+size;
+  }
+  
+  validRange = cache.haveLower && cache.haveUpper;
+  return cache.range;
+}
+
+/*! \overload
+  
+  Returns the value range of the data points with keys inside \a inKeyRange only.
+  
+  The data points in \a inKeyRange are found with binary searches. Their value range is taken from
+  \ref QCPDataContainer::valueRange, which is O(log n) if the level of detail index is enabled
+  (\ref setLodIndex). For sign domains other than \ref sdBoth, when errors are included, or for
+  external data sources, the data points in \a inKeyRange are scanned.
+  
+  \see rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars, bool inKeyRange)
+*/
+QCPRange QCPGraph::getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors, const QCPRange &inKeyRange) const
+{
+  if (mDataSource || !mData->hasErrors())
+    includeErrors = false; // no error values stored (see QCPDataContainer::hasErrors) or provided by the data source
+  
+  QCPDataView data = dataView();
+  int begin = data.lowerBound(inKeyRange.lower);
+  int end = data.upperBound(inKeyRange.upper);
+  if (!mDataSource && inSignDomain == sdBoth && !includeErrors)
+  {
+    validRange = begin < end;
+    return mData->valueRange(begin, end);
+  }
+  CachedRange range;
+  accumulateValueRange(range, inSignDomain, includeErrors, begin, end);
+  validRange = range.haveLower && range.haveUpper;
+  return range.range;
+}
+
+/*! \internal
   
+  Extends the value range in \a cache by the data points with indices from \a begin up to \a end
+  (excluding \a end), following the rules of \ref getValueRange. Used by \ref getValueRange to update
+  its cached ranges incrementally.
+*/
+void QCPGraph::accumulateValueRange(CachedRange &cache, SignDomain inSignDomain, bool includeErrors, int begin, int end) const
+{
   double current, currentErrorMinus, currentErrorPlus;
+  QCPDataView data = dataView();
   
   if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
-      if (current-currentErrorMinus < range.lower || !haveLower)
+      current = data.value(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).valueErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).valueErrorPlus : 0);
+      if (current-currentErrorMinus < cache.range.lower || !cache.haveLower)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if (current+currentErrorPlus > range.upper || !haveUpper)
+      if (current+currentErrorPlus > cache.range.upper || !cache.haveUpper)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
-      ++it;
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
-      if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus < 0)
+      current = data.value(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).valueErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).valueErrorPlus : 0);
+      if ((current-currentErrorMinus < cache.range.lower || !cache.haveLower) && current-currentErrorMinus < 0)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if ((current+currentErrorPlus > range.upper || !haveUpper) && current+currentErrorPlus < 0)
+      if ((current+currentErrorPlus > cache.range.upper || !cache.haveUpper) && current+currentErrorPlus < 0)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
       if (includeErrors) // in case point is in valid sign domain but errobars stretch beyond it, we still want to get that point.
       {
-        if ((current < range.lower || !haveLower) && current < 0)
+        if ((current < cache.range.lower || !cache.haveLower) && current < 0)
         {
-          range.lower = current;
-          haveLower = true;
+          cache.range.lower = current;
+          cache.haveLower = true;
+          cache.lowerIndex = cache.frontOffset+i;
         }
-        if ((current > range.upper || !haveUpper) && current < 0)
+        if ((current > cache.range.upper || !cache.haveUpper) && current < 0)
         {
-          range.upper = current;
-          haveUpper = true;
+          cache.range.upper = current;
+          cache.haveUpper = true;
+          cache.upperIndex = cache.frontOffset+i;
         }
       }
-      ++it;
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
-      if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus > 0)
+      current = data.value(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).valueErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).valueErrorPlus : 0);
+      if ((current-currentErrorMinus < cache.range.lower || !cache.haveLower) && current-currentErrorMinus > 0)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if ((current+currentErrorPlus > range.upper || !haveUpper) && current+currentErrorPlus > 0)
+      if ((current+currentErrorPlus > cache.range.upper || !cache.haveUpper) && current+currentErrorPlus > 0)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
       if (includeErrors) // in case point is in valid sign domain but errobars stretch beyond it, we still want to geht that point.
       {
-        if ((current < range.lower || !haveLower) && current > 0)
+        if ((current < cache.range.lower || !cache.haveLower) && current > 0)
         {
-          range.lower = current;
-          haveLower = true;
+          cache.range.lower = current;
+          cache.haveLower = true;
+          cache.lowerIndex = cache.frontOffset+i;
         }
-        if ((current > range.upper || !haveUpper) && current > 0)
+        if ((current > cache.range.upper || !cache.haveUpper) && current > 0)
         {
-          range.upper = current;
-          haveUpper = true;
+          cache.range.upper = current;
+          cache.haveUpper = true;
+          cache.upperIndex = cache.frontOffset+i;
         }
       }
-      ++it;
     }
   }
-  
-  validRange = haveLower && haveUpper;
-  return range;
 }
 
 
@@ -11722,8 +15397,13 @@ void QCPCurve::draw(QCPPainter *painter)
     applyDefaultAntialiasingHint(painter);
     painter->setPen(mainPen());
     painter->setBrush(Qt::NoBrush);
-    // if drawing solid line and not in PDF, use much faster line drawing instead of polyline:
-    if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
+    // draw long lines in chunks (see QCustomPlot::setPolylineChunkSize), or if drawing solid line
+    // and not in PDF, use much faster line drawing instead of polyline:
+    int chunkSize = mParentPlot->polylineChunkSize();
+    if (chunkSize > 0 || (chunkSize < 0 && !mParentPlot->plottingHints().testFlag(QCP::phFastPolylines)))
+    {
+      painter->drawPolylineChunked(*lineData, chunkSize);
+    } else if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
         painter->pen().style() == Qt::SolidLine &&
         !painter->pdfExportMode())
     {
@@ -11785,8 +15465,21 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> *poin
   painter->setPen(mainPen());
   painter->setBrush(mainBrush());
   painter->setScatterPixmap(mScatterPixmap);
-  for (int i=0; i<pointData->size(); ++i)
-    painter->drawScatter(pointData->at(i).x(), pointData->at(i).y(), mScatterSize, mScatterStyle);
+  if (scatterCullingUsable(mScatterStyle, mScatterPixmap))
+  {
+    // skip symbols on pixels that already hold an identical symbol:
+    QRect rect = clipRect();
+    QBitArray occupancy(rect.width()*rect.height());
+    QVector<QPointF> scatters;
+    scatters.reserve(pointData->size());
+    for (int i=0; i<pointData->size(); ++i)
+    {
+      if (!cullScatter(occupancy, rect, pointData->at(i).x(), pointData->at(i).y()))
+        scatters.append(pointData->at(i));
+    }
+    painter->drawScatters(scatters, mScatterSize, mScatterStyle);
+  } else
+    painter->drawScatters(*pointData, mScatterSize, mScatterStyle);
 }
 
 /*! \internal
@@ -11806,7 +15499,11 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
      fills inside R consistent.
      The region R has index 5.
   */
-  lineData->reserve(mData->size());
+  // the points of the line are collected in plot coordinates first, and transformed to pixels at once at the end:
+  QVector<QCPCurveData> points;
+  QVector<int> pointRegions; // region of each point, for points that are placed optimized outside R (see outsidePixelPoint), else 5
+  points.reserve(mData->size());
+  pointRegions.reserve(mData->size());
   QCPCurveDataMap::const_iterator it;
   int lastRegion = 5;
   int currentRegion = 5;
@@ -11858,17 +15555,24 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
     if (currentRegion == 5 || (firstPoint && mBrush.style() != Qt::NoBrush)) // current is in R, add current and last if it wasn't added already
     {
       if (!addedLastAlready) // in case curve just entered R, make sure the last point outside R is also drawn correctly
-        lineData->append(coordsToPixels((it-1).value().key, (it-1).value().value)); // add last point to vector
+      {
+        points.append((it-1).value()); // add last point to vector
+        pointRegions.append(5);
+      }
       else if (lastRegion != 5) // added last already. If that's the case, we probably added it at optimized position. So go back and make sure it's at original position (else the angle changes under which this segment enters R)
       {
         if (!firstPoint) // because on firstPoint, currentRegion is 5 and addedLastAlready is true, although there is no last point
-          lineData->replace(lineData->size()-1, coordsToPixels((it-1).value().key, (it-1).value().value));
+        {
+          points.last() = (it-1).value();
+          pointRegions.last() = 5;
+        }
       }
-      lineData->append(coordsToPixels(it.value().key, it.value().value)); // add current point to vector
+      points.append(it.value()); // add current point to vector
+      pointRegions.append(5);
       addedLastAlready = true; // so in next iteration, we don't add this point twice
     } else if (currentRegion != lastRegion) // changed region, add current and last if not added already
     {
-      // using outsideCoordsToPixels instead of coorsToPixels for optimized point placement (places points just outside axisRect instead of potentially far away)
+      // using a region other than 5 for optimized point placement (places points just outside axisRect instead of potentially far away, see outsidePixelPoint)
       
       // if we're coming from R or we skip diagonally over the corner regions (so line might still be visible in R), we can't place points optimized
       if (lastRegion == 5 || // coming from R
@@ -11880,16 +15584,24 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
       {
         // always add last point if not added already, original:
         if (!addedLastAlready)
-          lineData->append(coordsToPixels((it-1).value().key, (it-1).value().value));
+        {
+          points.append((it-1).value());
+          pointRegions.append(5);
+        }
         // add current point, original:
-        lineData->append(coordsToPixels(it.value().key, it.value().value));
+        points.append(it.value());
+        pointRegions.append(5);
       } else // no special case that forbids optimized point placement, so do it:
       {
         // always add last point if not added already, optimized:
         if (!addedLastAlready)
-          lineData->append(outsideCoordsToPixels((it-1).value().key, (it-1).value().value, currentRegion));
+        {
+          points.append((it-1).value());
+          pointRegions.append(currentRegion);
+        }
         // add current point, optimized:
-        lineData->append(outsideCoordsToPixels(it.value().key, it.value().value, currentRegion));
+        points.append(it.value());
+        pointRegions.append(currentRegion);
       }
       addedLastAlready = true; // so that if next point enters 5, or crosses another region boundary, we don't add this point twice
     } else // neither in R, nor crossed a region boundary, skip current point
@@ -11901,7 +15613,29 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   }
   // If curve ends outside R, we want to add very last point so the fill looks like it should when the curve started inside R:
   if (lastRegion != 5 && mBrush.style() != Qt::NoBrush && !mData->isEmpty())
-    lineData->append(coordsToPixels((mData->constEnd()-1).value().key, (mData->constEnd()-1).value().value));
+  {
+    points.append((mData->constEnd()-1).value());
+    pointRegions.append(5);
+  }
+  
+  // transform all points to pixel coordinates at once:
+  lineData->resize(points.size());
+  if (points.isEmpty()) return;
+  QPointF *pixels = lineData->data();
+  if (mKeyAxis->orientation() == Qt::Horizontal)
+  {
+    mKeyAxis->coordToPixel(&points.constData()->key, &pixels->rx(), points.size(), sizeof(QCPCurveData), sizeof(QPointF));
+    mValueAxis->coordToPixel(&points.constData()->value, &pixels->ry(), points.size(), sizeof(QCPCurveData), sizeof(QPointF));
+  } else
+  {
+    mKeyAxis->coordToPixel(&points.constData()->key, &pixels->ry(), points.size(), sizeof(QCPCurveData), sizeof(QPointF));
+    mValueAxis->coordToPixel(&points.constData()->value, &pixels->rx(), points.size(), sizeof(QCPCurveData), sizeof(QPointF));
+  }
+  for (int i=0; i<pointRegions.size(); ++i)
+  {
+    if (pointRegions.at(i) != 5)
+      pixels[i] = outsidePixelPoint(pixels[i], pointRegions.at(i));
+  }
 }
 
 /*! \internal 
@@ -11939,19 +15673,19 @@ double QCPCurve::pointDistance(const QPointF &pixelPoint) const
 
 /*! \internal
   
-  This is a specialized \ref coordsToPixels function for points that are outside the visible
-  axisRect and just crossing a boundary (since \ref getCurveData reduces non-visible curve segments
-  to those line segments that cross region boundaries, see documentation there). It only uses the
-  coordinate parallel to the region boundary of the axisRect. The other coordinate is picked 10
-  pixels outside the axisRect. Together with the optimization in \ref getCurveData this improves
-  performance for large curves (or zoomed in ones) significantly while keeping the illusion the
-  whole curve and its filling is still being drawn for the viewer.
+  Returns \a pixelPoint moved just outside the visible axisRect, for points that are outside the
+  axisRect in \a region and just crossing a boundary (since \ref getCurveData reduces non-visible
+  curve segments to those line segments that cross region boundaries, see documentation there). It
+  only keeps the coordinate parallel to the region boundary of the axisRect. The other coordinate is
+  picked 10 pixels outside the axisRect. Together with the optimization in \ref getCurveData this
+  improves performance for large curves (or zoomed in ones) significantly while keeping the
+  illusion the whole curve and its filling is still being drawn for the viewer.
 */
-QPointF QCPCurve::outsideCoordsToPixels(double key, double value, int region) const
+QPointF QCPCurve::outsidePixelPoint(const QPointF &pixelPoint, int region) const
 {
   int margin = 10;
   QRect axisRect = mKeyAxis->axisRect() | mValueAxis->axisRect();
-  QPointF result = coordsToPixels(key, value);
+  QPointF result = pixelPoint;
   switch (region)
   {
     case 2: result.setX(axisRect.left()-margin); break; // left
@@ -12396,11 +16130,11 @@ void QCPBars::draw(QCPPainter *painter)
 {
   if (mData->isEmpty()) return;
   
-  QCPBarDataMap::const_iterator it;
-  for (it = mData->constBegin(); it != mData->constEnd(); ++it)
+  // only visit bars that reach into the visible key range, found by binary search in the sorted map:
+  QCPBarDataMap::const_iterator it = mData->lowerBound(mKeyAxis->range().lower-mWidth*0.5);
+  QCPBarDataMap::const_iterator itEnd = mData->upperBound(mKeyAxis->range().upper+mWidth*0.5);
+  for (; it != itEnd; ++it)
   {
-    if (it.key()+mWidth*0.5 < mKeyAxis->range().lower || it.key()-mWidth*0.5 > mKeyAxis->range().upper)
-      continue;
     QPolygonF barPolygon = getBarPolygon(it.key(), it.value().value);
     // draw bar fill:
     if (mainBrush().style() != Qt::NoBrush && mainBrush().color().alpha() != 0)
@@ -12973,11 +16707,10 @@ void QCPStatisticalBox::drawOutliers(QCPPainter *painter) const
   applyScattersAntialiasingHint(painter);
   painter->setPen(mOutlierPen);
   painter->setBrush(Qt::NoBrush);
+  QVector<QPointF> scatters(mOutliers.size());
   for (int i=0; i<mOutliers.size(); ++i)
-  {
-    QPointF dataPoint = coordsToPixels(mKey, mOutliers.at(i));
-    painter->drawScatter(dataPoint.x(), dataPoint.y(), mOutlierSize, mOutlierStyle);
-  }
+    scatters[i] = coordsToPixels(mKey, mOutliers.at(i));
+  painter->drawScatters(scatters, mOutlierSize, mOutlierStyle);
 }
 
 /* inherits documentation from base class */
@@ -14695,7 +18428,7 @@ void QCPItemTracer::setGraph(QCPGraph *graph)
 
 /*!
   Sets the key of the graph's data point the tracer will be positioned at. This is the only free
-  cordinate of a tracer when attached to a graph.
+  coordinate of a tracer when attached to a graph.
   
   Depending on \ref setInterpolating, the tracer will be either positioned on the data point
   closest to \a key, or will stay exactly at \a key and interpolate the value linearly.
@@ -14845,40 +18578,42 @@ void QCPItemTracer::updatePosition()
   {
     if (mParentPlot->hasPlottable(mGraph))
     {
-      if (mGraph->data()->size() > 1)
+      QCPDataView data = mGraph->dataView();
+      if (data.size() > 1)
       {
-        QCPDataMap::const_iterator first = mGraph->data()->constBegin();
-        QCPDataMap::const_iterator last = mGraph->data()->constEnd()-1;
-        if (mGraphKey < first.key())
-          position->setCoords(first.key(), first.value().value);
-        else if (mGraphKey > last.key())
-          position->setCoords(last.key(), last.value().value);
+        int last = data.size()-1;
+        if (mGraphKey < data.key(0))
+          position->setCoords(data.key(0), data.value(0));
+        else if (mGraphKey > data.key(last))
+          position->setCoords(data.key(last), data.value(last));
         else
         {
-          QCPDataMap::const_iterator it = first;
-          it = mGraph->data()->lowerBound(mGraphKey);
-          if (it != first) // mGraphKey is somewhere between iterators
+          int index = data.lowerBound(mGraphKey);
+          if (index != 0) // mGraphKey is somewhere between data points
           {
-            QCPDataMap::const_iterator prevIt = it-1;
+            double prevKey = data.key(index-1);
+            double prevValue = data.value(index-1);
+            double nextKey = data.key(index);
+            double nextValue = data.value(index);
             if (mInterpolating)
             {
-              // interpolate between iterators around mGraphKey:
-              double slope = (it.value().value-prevIt.value().value)/(it.key()-prevIt.key());
-              position->setCoords(mGraphKey, (mGraphKey-prevIt.key())*slope+prevIt.value().value);
+              // interpolate between data points around mGraphKey:
+              double slope = (nextValue-prevValue)/(nextKey-prevKey);
+              position->setCoords(mGraphKey, (mGraphKey-prevKey)*slope+prevValue);
             } else
             {
-              // find iterator with key closest to mGraphKey:
-              if (mGraphKey < (prevIt.key()+it.key())*0.5)
-                it = prevIt;
-              position->setCoords(it.key(), it.value().value);
+              // find data point with key closest to mGraphKey:
+              if (mGraphKey < (prevKey+nextKey)*0.5)
+                position->setCoords(prevKey, prevValue);
+              else
+                position->setCoords(nextKey, nextValue);
             }
-          } else // mGraphKey is exactly on first iterator
-            position->setCoords(it.key(), it.value().value);
+          } else // mGraphKey is exactly on first data point
+            position->setCoords(data.key(0), data.value(0));
         }
-      } else if (mGraph->data()->size() == 1)
+      } else if (data.size() == 1)
       {
-        QCPDataMap::const_iterator it = mGraph->data()->constBegin();
-        position->setCoords(it.key(), it.value().value);
+        position->setCoords(data.key(0), data.value(0));
       } else
         qDebug() << Q_FUNC_INFO << "graph has no data";
     } else
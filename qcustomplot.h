@@ -31,6 +31,8 @@
 #include <QPaintEvent>
 #include <QMouseEvent>
 #include <QPixmap>
+#include <QPicture>
+#include <QFile>
 #include <QVector>
 #include <QString>
 #include <QPrinter>
@@ -41,6 +43,15 @@
 #include <QVector2D>
 #include <QStack>
 #include <QCache>
+#include <QBitArray>
+#include <QPointer>
+#include <QThread>
+#include <QMutex>
+#include <QTimer>
+#include <QtConcurrentRun>
+#include <QFutureSynchronizer>
+#include <QFutureWatcher>
+#include <QAtomicInt>
 #include <qmath.h>
 #include <limits>
 
@@ -137,6 +148,17 @@ enum PlottingHint { phNone            = 0x000 ///< <tt>0x000</tt> No hints are s
                     ,phForceRepaint   = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called. This is set by default
                                               ///<                on Windows-Systems to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phQueuedReplot   = 0x008 ///< <tt>0x008</tt> QCustomPlot::replot() only schedules a replot for the next event loop iteration. Multiple replot requests
+                                              ///<                until then are coalesced into a single replot (see QCustomPlot::RefreshPriority).
+                    ,phAsyncReplot    = 0x010 ///< <tt>0x010</tt> QCustomPlot::replot() records the drawing commands and rasterizes them on a worker thread. The finished frame is
+                                              ///<                shown when ready, frames made stale by newer replots are dropped (see QCustomPlot::replot).
+                    ,phParallelPlottables = 0x020 ///< <tt>0x020</tt> Consecutive plottables on a layer are drawn concurrently on worker threads into separate images, which are then
+                                              ///<                composited in layer order (see QCustomPlot::replot).
+                    ,phScrollOnDrag   = 0x040 ///< <tt>0x040</tt> While the user drags the axis ranges, the previous contents of the axis rect are shifted by the drag distance and
+                                              ///<                only the newly exposed strips are rendered (see QCustomPlot::dragReplot). Combined with
+                                              ///<                phQueuedReplot, the drag steps are coalesced.
+                    ,phCullScatters   = 0x080 ///< <tt>0x080</tt> Graphs and curves skip scatter symbols that would be drawn on the same pixel as a previous, opaque symbol of the
+                                              ///<                same plottable. This bounds the number of drawn symbols by the pixel count of the axis rect.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 } // end of namespace QCP
@@ -144,6 +166,17 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::AntialiasedElements)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::PlottingHints)
 
 
+/*
+class QCP_LIB_DECL QCPScatter
+{
+public:
+  QCPScatter(QCP::ScatterStyle style)
+  ~QCPScatter();
+  
+  void scatter
+};
+*/
+
 class QCP_LIB_DECL QCPPainter : public QPainter
 {
 public:
@@ -156,12 +189,16 @@ public:
   bool antialiasing() const { return testRenderHint(QPainter::Antialiasing); }
   bool pdfExportMode() const { return mPdfExportMode; }
   bool scaledExportMode() const { return mScaledExportMode; }
+  bool draftMode() const { return mDraftMode; }
+  QRectF dataRegion() const { return mDataRegion; }
   
   // setters:
   void setScatterPixmap(const QPixmap pm);
   void setAntialiasing(bool enabled);
   void setPdfExportMode(bool enabled);
   void setScaledExportMode(bool enabled);
+  void setDraftMode(bool enabled);
+  void setDataRegion(const QRectF &region);
  
   // methods hiding non-virtual base class functions (QPainter bug workarounds):
   void setPen(const QPen &pen);
@@ -169,25 +206,60 @@ public:
   void setPen(Qt::PenStyle penStyle);
   void drawLine(const QLineF &line);
   void drawLine(const QPointF &p1, const QPointF &p2) {drawLine(QLineF(p1, p2));}
+  void drawLines(const QVector<QLineF> &lines);
+  void drawLines(const QVector<QPointF> &pointPairs) {QPainter::drawLines(pointPairs);}
   void save();
   void restore();
 
   // helpers:
   void fixScaledPen();
   void drawScatter(double x, double y, double size, QCP::ScatterStyle style);
+  void drawScatters(const QVector<QPointF> &points, double size, QCP::ScatterStyle style);
+  void drawPolylineChunked(const QVector<QPointF> &points, int chunkSize);
   
 protected:
+  struct ScatterStamp
+  {
+    QCP::ScatterStyle style;
+    double size;
+    QPen pen;
+    bool antialiasing;
+    QPointF translation; // sub-pixel part of the painter translation the stamps were rendered for
+    int center; // offset of the symbol center from the top left of the images
+    QImage images[16]; // rendered on demand, indexed by the quarter pixel offset of the symbol center (4*y+x)
+  };
+  
   QPixmap mScatterPixmap;
   bool mScaledExportMode;
   bool mPdfExportMode;
+  bool mDraftMode;
+  QRectF mDataRegion;
   bool mIsAntialiasing;
   QStack<bool> mAntialiasingStack;
+  QList<ScatterStamp> mScatterStamps;
+  int mCurrentScatterStamp;
+  
+  bool scatterStampUsable(double size, QCP::ScatterStyle style) const;
+  void drawScatterStamp(double x, double y, double size, QCP::ScatterStyle style);
+  void drawScatterShape(double x, double y, double size, QCP::ScatterStyle style);
+  void addScatterShape(QPainterPath *path, double x, double y, double size, QCP::ScatterStyle style) const;
+  bool vectorExport() const;
+  int autoPolylineChunkSize(const QPen &pen) const;
 };
 
 
 class QCP_LIB_DECL QCPLayer
 {
 public:
+  /*!
+    Defines how the contents of a layer are rendered when the QCustomPlot is replotted.
+    
+    \see setMode
+  */
+  enum LayerMode { lmLogical   ///< Layer only controls the rendering order, its layerables are drawn directly on the plot's paint buffer at every replot
+                   ,lmBuffered ///< Layer has its own render buffer, which is only redrawn when it was invalidated. Allows replotting the layer individually with \ref replot
+                 };
+  
   QCPLayer(QCustomPlot* parentPlot, const QString &layerName);
   ~QCPLayer();
   
@@ -196,11 +268,23 @@ public:
   QString name() const { return mName; }
   int index() const;
   QList<QCPLayerable*> children() const { return mChildren; }
+  LayerMode mode() const { return mMode; }
+  
+  // setters:
+  void setMode(LayerMode mode);
+  
+  // non-property methods:
+  void invalidateBuffer();
+  void replot();
   
 protected:
   QCustomPlot *mParentPlot;
   QString mName;
   QList<QCPLayerable*> mChildren;
+  LayerMode mMode;
+  // non-property members:
+  QPixmap mBuffer;
+  bool mBufferValid;
   
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
@@ -208,6 +292,7 @@ protected:
 private:
   Q_DISABLE_COPY(QCPLayer)
   
+  friend class QCustomPlot;
   friend class QCPLayerable;
 };
 
@@ -286,6 +371,8 @@ public:
   QPen pen() const { return mPen; }
   QPen subGridPen() const { return mSubGridPen; }
   QPen zeroLinePen() const { return mZeroLinePen; }
+  QBrush sectionBrushEven() const { return mSectionBrushEven; }
+  QBrush sectionBrushOdd() const { return mSectionBrushOdd; }
   
   // setters:
   void setSubGridVisible(bool visible);
@@ -294,19 +381,23 @@ public:
   void setPen(const QPen &pen);
   void setSubGridPen(const QPen &pen);
   void setZeroLinePen(const QPen &pen);
+  void setSectionBrushes(const QBrush &brushEven, const QBrush &brushOdd);
   
 protected:
   QCPAxis *mParentAxis;
   bool mSubGridVisible;
   bool mAntialiasedSubGrid, mAntialiasedZeroLine;
   QPen mPen, mSubGridPen, mZeroLinePen;
+  QBrush mSectionBrushEven, mSectionBrushOdd;
   
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const;
   virtual void draw(QCPPainter *painter);
   // drawing helpers:
+  void drawSections(QCPPainter *painter) const;
   void drawGridLines(QCPPainter *painter) const;
   void drawSubGridLines(QCPPainter *painter) const;
   
+  friend class QCustomPlot;
   friend class QCPAxis;
 };
 
@@ -509,6 +600,7 @@ public:
   void setScaleRatio(const QCPAxis *otherAxis, double ratio=1.0);
   double pixelToCoord(double value) const;
   double coordToPixel(double value) const;
+  void coordToPixel(const double *coords, qreal *pixels, int count, int coordStride=sizeof(double), int pixelStride=sizeof(qreal)) const;
   SelectablePart selectTest(const QPointF &pos) const;
   
 public slots:
@@ -594,6 +686,7 @@ protected:
   virtual TickLabelData getTickLabelData(const QFont &font, const QString &text) const;
   virtual QPointF getTickLabelDrawOffset(const TickLabelData &labelData) const;
   virtual void getMaxTickLabelSize(const QFont &font, const QString &text, QSize *tickLabelsSize) const;
+  bool labelCacheUsable() const;
   
   // basic non virtual helpers:
   void visibleTickBounds(int &lowIndex, int &highIndex) const;
@@ -933,6 +1026,10 @@ protected:
   void applyScattersAntialiasingHint(QCPPainter *painter) const;
   void applyErrorBarsAntialiasingHint(QCPPainter *painter) const;
   
+  // scatter culling helpers:
+  bool scatterCullingUsable(QCP::ScatterStyle style, const QPixmap &scatterPixmap) const;
+  bool cullScatter(QBitArray &occupancy, const QRect &rect, double x, double y) const;
+  
   // selection test helpers:
   double distSqrToLine(const QPointF &start, const QPointF &end, const QPointF &point) const;
 
@@ -1175,6 +1272,16 @@ public:
                          ,limAbove ///< Layer is inserted above other layer
                    };
   Q_ENUMS(LayerInsertMode)
+  /*!
+    Defines when a replot requested with \ref replot is performed.
+    
+    \see replot, QCP::phQueuedReplot
+  */
+  enum RefreshPriority { rpImmediate ///< The replot is performed immediately
+                         ,rpQueued   ///< The replot is queued and performed in the next event loop iteration. Further queued replots until then are coalesced with it
+                         ,rpHint     ///< Queued if the plotting hint QCP::phQueuedReplot is set, immediate otherwise
+                       };
+  Q_ENUMS(RefreshPriority)
   
   explicit QCustomPlot(QWidget *parent = 0);
   virtual ~QCustomPlot();
@@ -1210,6 +1317,10 @@ public:
   bool noAntialiasingOnDrag() const { return mNoAntialiasingOnDrag; }
   QCP::PlottingHints plottingHints() const { return mPlottingHints; }
   Qt::KeyboardModifier multiSelectModifier() const { return mMultiSelectModifier; }
+  int exportTileSize() const { return mExportTileSize; }
+  int draftPointBudget() const { return mDraftPointBudget; }
+  int refineDelay() const { return mRefineDelay; }
+  int polylineChunkSize() const { return mPolylineChunkSize; }
 
   // setters:
   void setTitle(const QString &title);
@@ -1248,6 +1359,10 @@ public:
   void setPlottingHints(const QCP::PlottingHints &hints);
   void setPlottingHint(QCP::PlottingHint hint, bool enabled=true);
   void setMultiSelectModifier(Qt::KeyboardModifier modifier);
+  void setExportTileSize(int pixels);
+  void setDraftPointBudget(int points);
+  void setRefineDelay(int msec);
+  void setPolylineChunkSize(int points);
   
   // non-property methods:
   // plottable interface:
@@ -1302,14 +1417,16 @@ public:
   bool saveJpg(const QString &fileName, int width=0, int height=0, double scale=1.0, int quality=-1);
   bool saveBmp(const QString &fileName, int width=0, int height=0, double scale=1.0);
   bool saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality=-1);
+  bool savePpm(const QString &fileName, int width=0, int height=0, double scale=1.0);
   QPixmap pixmap(int width=0, int height=0, double scale=1.0);
+  QImage toImage(int width=0, int height=0, double scale=1.0);
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
   
 public slots:
   void deselectAll();
-  void replot();
+  void replot(QCustomPlot::RefreshPriority priority=QCustomPlot::rpHint);
   void rescaleAxes();
   
 signals:
@@ -1335,6 +1452,15 @@ signals:
   void afterReplot();
   
 protected:
+  struct ScrollBuffer
+  {
+    QPixmap pixmap;
+    bool valid;
+    QRect axisRect;
+    QList<QCPLayerable*> layerables;
+    QList<QCPRange> axisRanges; // of xAxis, yAxis, xAxis2 and yAxis2 at the time the pixmap was rendered
+  };
+  
   QString mTitle;
   QFont mTitleFont, mSelectedTitleFont;
   QColor mTitleColor, mSelectedTitleColor;
@@ -1365,11 +1491,20 @@ protected:
   QPoint mDragStart;
   QCPRange mDragStartHorzRange, mDragStartVertRange;
   QPixmap mScaledAxisBackground;
-  bool mReplotting;
+  bool mReplotting, mReplotQueued, mDragReplotQueued;
+  QFutureWatcher<QImage> mAsyncFrameWatcher;
+  QPicture mPendingAsyncFrame;
+  bool mAsyncFramePending, mDropRunningAsyncFrame;
   QCP::AntialiasedElements mAADragBackup, mNotAADragBackup;
   QCPLayer *mCurrentLayer;
   QCP::PlottingHints mPlottingHints;
   Qt::KeyboardModifier mMultiSelectModifier;
+  int mExportTileSize;
+  int mDraftPointBudget, mRefineDelay;
+  int mPolylineChunkSize;
+  ScrollBuffer mScrollBuffer;
+  bool mDrafting;
+  QTimer mRefineTimer;
   
   // reimplemented methods:
   virtual QSize minimumSizeHint() const;
@@ -1391,11 +1526,32 @@ protected:
   virtual void drawAxisBackground(QCPPainter *painter);
   
   // helpers:
+  void updateLayout(QCPPainter *painter);
+  void drawExport(QCPPainter *painter, int width, int height, double scale);
+  void drawLayer(QCPPainter *painter, QCPLayer *layer);
+  void drawLayerParallel(QCPPainter *painter, QCPLayer *layer);
+  void drawLayerable(QCPPainter *painter, QCPLayerable *layerable);
+  static QImage renderLayerable(QCPLayerable *layerable, const QRect &rect, bool draft);
+  void drawTitle(QCPPainter *painter);
+  void compositeLayers(bool relayout);
+  void recordAsyncFrame();
+  void startAsyncFrame(const QPicture &frame);
+  bool dragReplot();
+  bool scrollable(QCPLayerable *layerable, QList<QCPAxis*> *usedAxes) const;
+  void updateScrollBuffer(const QList<QCPLayerable*> &layerables, const QList<QCPAxis*> &usedAxes);
+  void renderScrollBuffer(const QList<QCPLayerable*> &layerables, const QRect &region, bool restrictData);
+  int scrollOverhang(const QList<QCPLayerable*> &layerables) const;
+  void beginDraft();
   void updateAxisRect();
   bool selectTestTitle(const QPointF &pos) const;
   friend class QCPLegend;
   friend class QCPAxis;
   friend class QCPLayer;
+  
+protected slots:
+  void processQueuedReplot();
+  void asyncFrameFinished();
+  void refineReplot();
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCustomPlot::Interactions)
 
@@ -1415,13 +1571,173 @@ Q_DECLARE_TYPEINFO(QCPData, Q_MOVABLE_TYPE);
   Container for storing QCPData items in a sorted fashion. The key of the map
   is the key member of the QCPData instance.
   
-  This is the container in which QCPGraph holds its data.
-  \see QCPData, QCPGraph::setData
+  QCPGraph accepts data in this form (e.g. \ref QCPGraph::setData(QCPDataMap *data, bool copy)),
+  but internally holds it in a \ref QCPDataContainer.
+  \see QCPData, QCPDataContainer, QCPGraph::setData
 */
 typedef QMap<double, QCPData> QCPDataMap;
 typedef QMapIterator<double, QCPData> QCPDataMapIterator;
 typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
 
+class QCP_LIB_DECL QCPDataView
+{
+public:
+  QCPDataView();
+  QCPDataView(const double *keys, const double *values, int size, int keyStride=sizeof(double), int valueStride=sizeof(double));
+  
+  // getters:
+  int size() const { return mSize; }
+  bool isEmpty() const { return mSize == 0; }
+  double key(int index) const { return *reinterpret_cast<const double*>(mKeys+qint64(index)*mKeyStride); }
+  double value(int index) const { return *reinterpret_cast<const double*>(mValues+qint64(index)*mValueStride); }
+  const double *keys() const { return reinterpret_cast<const double*>(mKeys); }
+  const double *values() const { return reinterpret_cast<const double*>(mValues); }
+  int keyStride() const { return mKeyStride; }
+  int valueStride() const { return mValueStride; }
+  
+  // non-property methods:
+  QCPDataView mid(int index, int count) const;
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+  
+protected:
+  const char *mKeys, *mValues;
+  int mKeyStride, mValueStride;
+  int mSize;
+};
+Q_DECLARE_TYPEINFO(QCPDataView, Q_MOVABLE_TYPE);
+
+class QCP_LIB_DECL QCPAbstractDataSource : public QObject
+{
+  Q_OBJECT
+public:
+  QCPAbstractDataSource(QObject *parent=0);
+  virtual ~QCPAbstractDataSource();
+  
+  // non-property methods:
+  virtual QCPDataView dataView() const = 0;
+  
+signals:
+  void dataChanged();
+};
+
+class QCP_LIB_DECL QCPArrayDataSource : public QCPAbstractDataSource
+{
+  Q_OBJECT
+public:
+  QCPArrayDataSource(QObject *parent=0);
+  virtual ~QCPArrayDataSource();
+  
+  // getters:
+  int size() const { return mSize; }
+  
+  // setters:
+  void setArrays(const double *keys, const double *values, int size, int keyStride=sizeof(double), int valueStride=sizeof(double));
+  void setSize(int size);
+  
+  // non-property methods:
+  virtual QCPDataView dataView() const;
+  void notifyDataChanged();
+  
+protected:
+  const double *mKeys, *mValues;
+  int mSize, mKeyStride, mValueStride;
+};
+
+class QCP_LIB_DECL QCPDataLodIndex
+{
+public:
+  QCPDataLodIndex();
+  
+  // getters:
+  bool isValid() const { return mValid; }
+  
+  // non-property methods:
+  void invalidate();
+  void rebuild(const QCPDataView &data);
+  void append(const QCPDataView &data, int oldSize);
+  void removeFront(int count);
+  void removeBack(const QCPDataView &data);
+  QCPRange valueRange(const QCPDataView &data, int begin, int end) const;
+  
+protected:
+  enum { baseShift = 3 }; // level 0 buckets hold 2^baseShift data points
+  QVector<QVector<QCPRange> > mLevels;
+  QVector<qint64> mFirstBucket;
+  qint64 mOffset;
+  bool mValid;
+  
+  void updateUpperLevels(qint64 firstChangedBucket);
+};
+
+class QCP_LIB_DECL QCPDataContainer
+{
+public:
+  QCPDataContainer();
+  
+  // getters:
+  int size() const { return mSize; }
+  bool isEmpty() const { return mSize == 0; }
+  QCPData at(int index) const;
+  QCPData first() const { return at(0); }
+  QCPData last() const { return at(mSize-1); }
+  bool hasErrors() const { return mRecordSize == fullRecordSize; }
+  int capacity() const { return mCapacity; }
+  bool lodIndex() const { return mLodIndexEnabled; }
+  int revision() const { return mRevision; }
+  qint64 frontOffset() const { return mFrontOffset; }
+  
+  // setters:
+  void set(const QCPDataMap &dataMap);
+  void set(const QVector<QCPData> &data, bool alreadySorted=false);
+  void setCapacity(int capacity);
+  void setLodIndex(bool enabled);
+  
+  // non-property methods:
+  void add(const QCPDataMap &dataMap);
+  void add(const QVector<QCPData> &data, bool alreadySorted=false);
+  void add(const QCPData &data);
+  void removeBefore(double key);
+  void removeAfter(double key);
+  void remove(double fromKey, double toKey);
+  void remove(double key);
+  void clear();
+  void reserve(int size);
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+  QCPRange valueRange(int begin, int end) const;
+  void ensureLodIndex() const;
+  QCPDataView view() const;
+  QCPDataMap toMap() const;
+  
+protected:
+  enum { compactRecordSize = 2, fullRecordSize = sizeof(QCPData)/sizeof(double) }; // in doubles
+  enum { parallelSortChunkSize = 262144 }; // minimum number of points per concurrently sorted chunk
+  QVector<double> mStore;
+  int mRecordSize;
+  int mBegin, mSize, mCapacity;
+  int mAppendStart;
+  int mRevision;
+  qint64 mFrontOffset;
+  bool mLodIndexEnabled;
+  mutable QCPDataLodIndex mLodIndex;
+  
+  void removeRange(int begin, int end);
+  void newRevision();
+  void reserveAppend(int count, bool withErrors);
+  void appendUnchecked(const QCPData &data);
+  void finishAppend();
+  void writeRecord(int slot, const QCPData &data);
+  QVector<QCPData> toVector() const;
+  void assign(const QVector<QCPData> &data, bool withErrors);
+  void mergeSorted(const QVector<QCPData> &data);
+  static void sortByKey(QVector<QCPData> &data);
+  static bool isSorted(const QVector<QCPData> &data);
+  static bool containsErrors(const QCPData &data);
+  
+  friend class QCPGraph;
+};
+
 
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
 {
@@ -1455,7 +1771,8 @@ public:
   virtual ~QCPGraph();
   
   // getters:
-  const QCPDataMap *data() const { return mData; }
+  const QCPDataContainer *data() const { return mData; }
+  QCPAbstractDataSource *dataSource() const { return mDataSource; }
   LineStyle lineStyle() const { return mLineStyle; }
   QCP::ScatterStyle scatterStyle() const { return mScatterStyle; }
   double scatterSize() const { return mScatterSize; }
@@ -1465,10 +1782,14 @@ public:
   double errorBarSize() const { return mErrorBarSize; }
   bool errorBarSkipSymbol() const { return mErrorBarSkipSymbol; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
+  bool lodIndex() const { return mLodIndex; }
+  int dataCapacity() const { return mDataCapacity; }
   
   // setters:
+  void setData(QCPDataContainer *data, bool copy=false);
   void setData(QCPDataMap *data, bool copy=false);
-  void setData(const QVector<double> &key, const QVector<double> &value);
+  void setData(const QVector<double> &key, const QVector<double> &value, bool alreadySorted=false);
   void setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError);
   void setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus);
   void setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError);
@@ -1484,27 +1805,67 @@ public:
   void setErrorBarSize(double size);
   void setErrorBarSkipSymbol(bool enabled);
   void setChannelFillGraph(QCPGraph *targetGraph);
+  void setAdaptiveSampling(bool enabled);
+  void setLodIndex(bool enabled);
+  void setDataCapacity(int capacity);
+  void setDataSource(QCPAbstractDataSource *source);
   
   // non-property methods:
   void addData(const QCPDataMap &dataMap);
   void addData(const QCPData &data);
   void addData(double key, double value);
-  void addData(const QVector<double> &keys, const QVector<double> &values);
+  void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
   void removeDataBefore(double key);
   void removeDataAfter(double key);
   void removeData(double fromKey, double toKey);
   void removeData(double key);
   virtual void clearData();
   virtual double selectTest(const QPointF &pos) const;
+  QCPDataView dataView() const;
   using QCPAbstractPlottable::rescaleAxes;
   using QCPAbstractPlottable::rescaleKeyAxis;
   using QCPAbstractPlottable::rescaleValueAxis;
   virtual void rescaleAxes(bool onlyEnlarge, bool includeErrorBars) const; // overloads base class interface
   virtual void rescaleKeyAxis(bool onlyEnlarge, bool includeErrorBars) const; // overloads base class interface
   virtual void rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const; // overloads base class interface
+  void rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars, bool inKeyRange) const;
   
 protected:
-  QCPDataMap *mData;
+  struct CachedRange
+  {
+    CachedRange() : haveLower(false), haveUpper(false), revision(0), frontOffset(0), end(0), lowerIndex(0), upperIndex(0) {}
+    QCPRange range;
+    bool haveLower, haveUpper;
+    int revision; // revision of the data container the range was determined for
+    qint64 frontOffset, end; // front offset of the data container and absolute index of the first point not yet included
+    qint64 lowerIndex, upperIndex; // absolute indices (front offset plus index) of the points that determine the range bounds
+  };
+  struct CachedAxisState
+  {
+    CachedAxisState() : axis(0), scaleType(0), scaleLogBase(0), rangeReversed(false) {}
+    bool operator==(const CachedAxisState &other) const;
+    QCPAxis *axis;
+    QCPRange range;
+    QRect axisRect;
+    int scaleType; // QCPAxis::ScaleType
+    double scaleLogBase;
+    bool rangeReversed;
+  };
+  struct CachedGeometry
+  {
+    CachedGeometry() : valid(false), hasPointData(false), lineStyle(lsNone), adaptiveSampling(false), lodIndex(false), revision(0), size(0), frontOffset(0) {}
+    bool valid, hasPointData;
+    CachedAxisState keyAxis, valueAxis;
+    LineStyle lineStyle;
+    bool adaptiveSampling, lodIndex;
+    int revision, size; // revision and size of the data container the geometry was generated for
+    qint64 frontOffset; // front offset of the data container the geometry was generated for
+    QVector<QPointF> lineData;
+    QVector<QCPData> pointData;
+  };
+  
+  QCPDataContainer *mData;
+  QPointer<QCPAbstractDataSource> mDataSource;
   QPen mErrorPen;
   LineStyle mLineStyle;
   QCP::ScatterStyle mScatterStyle;
@@ -1514,29 +1875,42 @@ protected:
   double mErrorBarSize;
   bool mErrorBarSkipSymbol;
   QCPGraph *mChannelFillGraph;
+  bool mAdaptiveSampling;
+  bool mLodIndex;
+  int mDataCapacity;
+  mutable CachedRange mKeyRangeCache[3][2], mValueRangeCache[3][2]; // indexed by sign domain and whether errors are included
+  mutable CachedGeometry mGeometryCache;
+  mutable QMutex mGeometryCacheMutex;
 
   virtual void draw(QCPPainter *painter);
   virtual void drawLegendIcon(QCPPainter *painter, const QRect &rect) const;
 
   // functions to generate plot data points in pixel coordinates:
-  void getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
+  void getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getCachedPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride) const;
+  CachedAxisState cachedAxisState(QCPAxis *axis) const;
   // plot style specific functions to generate plot data, used by getPlotData:
-  void getScatterPlotData(QVector<QCPData> *pointData) const;
-  void getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
-  void getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
-  void getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
-  void getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
-  void getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
+  void getScatterPlotData(QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
   
   // helper functions for drawing:
-  virtual void drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const;
-  virtual void drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData) const;
+  virtual void drawFill(QCPPainter *painter, QVector<QPointF> *lineData, int draftStride) const;
+  virtual void drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData, int draftStride) const;
   virtual void drawLinePlot(QCPPainter *painter, QVector<QPointF> *lineData) const;
   virtual void drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData) const;
-  void drawError(QCPPainter *painter, double x, double y, const QCPData &data) const;
+  void getErrorBarLines(QVector<QLineF> *lines, const QVector<QCPData> *pointData, const QVector<qreal> &keyPixels, const QVector<qreal> &valuePixels) const;
+  void addErrorBarLines(QVector<QLineF> *lines, bool verticalSpine, double spinePos, double symbolPos, double a, double b, bool skipSymbol) const;
   
   // helper functions:
-  void getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper, int &count) const;
+  void getVisibleDataBounds(int &lower, int &upper, int &count, const QCPRange &keyRange) const;
+  QCPDataView getLineSourceData(int lower, int upper, QVector<QCPData> *sampledData, int draftStride) const;
+  void getAdaptiveSampledData(QVector<QCPData> *sampledData, int lower, int upper) const;
+  void getLodSampledData(QVector<QCPData> *sampledData, int lower, int upper) const;
+  void getPixelCoords(const QCPDataView &data, QVector<qreal> *keyPixels, QVector<qreal> *valuePixels) const;
   void addFillBasePoints(QVector<QPointF> *lineData) const;
   void removeFillBasePoints(QVector<QPointF> *lineData) const;
   QPointF lowerFillBasePoint(double lowerKey) const;
@@ -1551,6 +1925,9 @@ protected:
   virtual QCPRange getValueRange(bool &validRange, SignDomain inSignDomain=sdBoth) const;
   virtual QCPRange getKeyRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const; // overloads base class interface
   virtual QCPRange getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const; // overloads base class interface
+  QCPRange getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors, const QCPRange &inKeyRange) const;
+  void accumulateKeyRange(CachedRange &cache, SignDomain inSignDomain, bool includeErrors, int begin, int end) const;
+  void accumulateValueRange(CachedRange &cache, SignDomain inSignDomain, bool includeErrors, int begin, int end) const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -1639,7 +2016,7 @@ protected:
   void getCurveData(QVector<QPointF> *lineData) const;
   double pointDistance(const QPointF &pixelPoint) const;
 
-  QPointF outsideCoordsToPixels(double key, double value, int region) const;
+  QPointF outsidePixelPoint(const QPointF &pixelPoint, int region) const;
   virtual QCPRange getKeyRange(bool &validRange, SignDomain inSignDomain=sdBoth) const;
   virtual QCPRange getValueRange(bool &validRange, SignDomain inSignDomain=sdBoth) const;
   
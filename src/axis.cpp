@@ -1471,6 +1471,88 @@ double QCPAxis::coordToPixel(double value) const
   }
 }
 
+/*! \overload
+  
+  Transforms the \a count values at \a coords (in coordinates of the axis) to pixel coordinates of
+  the QCustomPlot widget and writes them to \a pixels. The values are located at steps of \a
+  coordStride bytes, the results are written at steps of \a pixelStride bytes. This allows reading
+  from and writing to arrays of structs directly, e.g. writing the x coordinates of an array of
+  QPointF with a \a pixelStride of sizeof(QPointF).
+  
+  This is much faster than calling \ref coordToPixel(double value) const for each value, because
+  the axis properties are evaluated once per call and the transformation is reduced to one
+  multiplication and addition per value (plus a logarithm on logarithmic axes). If both strides are
+  the natural ones (i.e. the values and results are contiguous arrays), the transformation loop can
+  be vectorized by the compiler.
+  
+  The results may differ from the ones of \ref coordToPixel(double value) const in the last digits,
+  due to the different order of the floating point operations.
+*/
+void QCPAxis::coordToPixel(const double *coords, qreal *pixels, int count, int coordStride, int pixelStride) const
+{
+  if (count <= 0) return;
+  const char *source = reinterpret_cast<const char*>(coords);
+  char *dest = reinterpret_cast<char*>(pixels);
+  
+  // pixel position of the range bounds (for non-reversed range), and the pixel extent of the range:
+  double lowerPixel, extent;
+  if (orientation() == Qt::Horizontal)
+  {
+    lowerPixel = mAxisRect.left();
+    extent = mAxisRect.width();
+  } else
+  {
+    lowerPixel = mAxisRect.bottom();
+    extent = -mAxisRect.height();
+  }
+  
+  if (mScaleType == stLinear)
+  {
+    // pixel = (coord-lower)*factor + offset
+    const double lower = mRange.lower;
+    const double factor = (mRangeReversed ? -extent : extent)/mRange.size();
+    const double offset = (mRangeReversed ? lowerPixel+extent : lowerPixel);
+    if (coordStride == sizeof(double) && pixelStride == sizeof(qreal))
+    {
+      for (int i=0; i<count; ++i)
+        pixels[i] = (coords[i]-lower)*factor+offset;
+    } else
+    {
+      for (int i=0; i<count; ++i)
+        *reinterpret_cast<qreal*>(dest+qint64(i)*pixelStride) = (*reinterpret_cast<const double*>(source+qint64(i)*coordStride)-lower)*factor+offset;
+    }
+  } else // mScaleType == stLogarithmic
+  {
+    // pixel = ln(coord/lower)*factor + offset, the base of the logarithm cancels out:
+    const double lower = mRange.lower;
+    const double factor = (mRangeReversed ? -extent : extent)/qLn(mRange.upper/mRange.lower);
+    const double offset = (mRangeReversed ? lowerPixel+extent : lowerPixel);
+    // invalid values for logarithmic scale are drawn outside the visible range, as in coordToPixel(double):
+    double beyondUpper, beyondLower;
+    if (orientation() == Qt::Horizontal)
+    {
+      beyondUpper = !mRangeReversed ? mAxisRect.right()+200 : mAxisRect.left()-200;
+      beyondLower = !mRangeReversed ? mAxisRect.left()-200 : mAxisRect.right()+200;
+    } else
+    {
+      beyondUpper = !mRangeReversed ? mAxisRect.top()-200 : mAxisRect.bottom()+200;
+      beyondLower = !mRangeReversed ? mAxisRect.bottom()+200 : mAxisRect.top()-200;
+    }
+    for (int i=0; i<count; ++i)
+    {
+      const double value = *reinterpret_cast<const double*>(source+qint64(i)*coordStride);
+      double pixel;
+      if (value >= 0 && mRange.upper < 0)
+        pixel = beyondUpper;
+      else if (value <= 0 && mRange.upper > 0)
+        pixel = beyondLower;
+      else
+        pixel = qLn(value/lower)*factor+offset;
+      *reinterpret_cast<qreal*>(dest+qint64(i)*pixelStride) = pixel;
+    }
+  }
+}
+
 /*!
   Returns the part of the axis that is hit by \a pos (in pixels). The return value of this function
   is independent of the user-selectable parts defined with \ref setSelectable. Further, this
@@ -1925,7 +2007,7 @@ void QCPAxis::placeTickLabel(QCPPainter *painter, double position, int distanceT
     case atTop:    labelAnchor = QPointF(position, mAxisRect.top()-distanceToAxis); break;
     case atBottom: labelAnchor = QPointF(position, mAxisRect.bottom()+distanceToAxis); break;
   }
-  if (parentPlot()->plottingHints().testFlag(QCP::phCacheLabels)) // label caching enabled
+  if (labelCacheUsable()) // label caching enabled
   {
     if (!mLabelCache.contains(text))  // no cached label exists, create it
     {
@@ -2200,7 +2282,7 @@ void QCPAxis::getMaxTickLabelSize(const QFont &font, const QString &text,  QSize
 {
   // note: this function must return the same tick label sizes as the placeTickLabel function.
   QSize finalSize;
-  if (parentPlot()->plottingHints().testFlag(QCP::phCacheLabels) && mLabelCache.contains(text)) // label caching enabled and have cached label
+  if (labelCacheUsable() && mLabelCache.contains(text)) // label caching enabled and have cached label
   {
     const CachedLabel *cachedLabel = mLabelCache.object(text);
     finalSize = cachedLabel->pixmap.size();
@@ -2217,6 +2299,18 @@ void QCPAxis::getMaxTickLabelSize(const QFont &font, const QString &text,  QSize
     tickLabelsSize->setHeight(finalSize.height());
 }
 
+/*! \internal
+  
+  Returns whether tick labels may be drawn from and stored in the label cache. This is the case if
+  the plotting hint QCP::phCacheLabels is set and the axis is drawn on the thread the parent plot
+  lives in. When rendering on a worker thread (see QCustomPlot::toImage), the cache, which holds
+  pixmaps and isn't synchronized, is bypassed.
+*/
+bool QCPAxis::labelCacheUsable() const
+{
+  return mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && QThread::currentThread() == mParentPlot->thread();
+}
+
 /*! \internal
   
   Handles the selection \a event and returns true when the selection event hit any parts of the
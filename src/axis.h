@@ -73,6 +73,7 @@ protected:
   void drawGridLines(QCPPainter *painter) const;
   void drawSubGridLines(QCPPainter *painter) const;
   
+  friend class QCustomPlot;
   friend class QCPAxis;
 };
 
@@ -275,6 +276,7 @@ public:
   void setScaleRatio(const QCPAxis *otherAxis, double ratio=1.0);
   double pixelToCoord(double value) const;
   double coordToPixel(double value) const;
+  void coordToPixel(const double *coords, qreal *pixels, int count, int coordStride=sizeof(double), int pixelStride=sizeof(qreal)) const;
   SelectablePart selectTest(const QPointF &pos) const;
   
 public slots:
@@ -360,6 +362,7 @@ protected:
   virtual TickLabelData getTickLabelData(const QFont &font, const QString &text) const;
   virtual QPointF getTickLabelDrawOffset(const TickLabelData &labelData) const;
   virtual void getMaxTickLabelSize(const QFont &font, const QString &text, QSize *tickLabelsSize) const;
+  bool labelCacheUsable() const;
   
   // basic non virtual helpers:
   void visibleTickBounds(int &lowIndex, int &highIndex) const;
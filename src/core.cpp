@@ -33,6 +33,7 @@
 #include "plottable.h"
 #include "item.h"
 #include "plottables/plottable-graph.h"
+#include "plottables/plottable-curve.h"
 
 /*! \mainpage %QCustomPlot Documentation
  
@@ -159,6 +160,37 @@
   drawing pixel precise things, e.g. scatters, isn't possible with Qt 4.8.0/1. So it's a performance vs. plot
   quality tradeoff when switching to Qt 4.8.
   \li To increase responsiveness during dragging, consider setting \ref QCustomPlot::setNoAntialiasingOnDrag to true.
+  \li For graphs and curves with long lines (e.g. with adaptive sampling disabled), especially with antialiased, wide or
+  dashed pens, keep the automatic polyline chunk size (\ref QCustomPlot::setPolylineChunkSize), so the lines are stroked
+  in chunks.
+  \li If graphs with very many visible points make dragging and zooming sluggish, set a draft point budget (\ref
+  QCustomPlot::setDraftPointBudget). While interacting, such graphs are then drawn coarsely, and in full detail once the
+  interaction is idle.
+  \li When dragging plots with large graphs, set the plotting hint QCP::phScrollOnDrag. The graphs are then only rendered
+  in the strips that are newly exposed by the drag, the rest of the axis rect is shifted.
+  \li If the plot is replotted from many places (e.g. a slot connected to a data arrival signal), set the plotting hint
+  QCP::phQueuedReplot. Replots are then deferred to the next event loop iteration and coalesced, so the plot is rendered
+  at most once per event loop iteration. This also applies to the replots during range dragging and zooming.
+  \li If rasterizing the plot takes long (e.g. large antialiased or semi-transparent fills), set the plotting hint
+  QCP::phAsyncReplot, so it happens on a worker thread and the application stays responsive.
+  \li With many expensive plottables (e.g. dozens of graphs with millions of points), set the plotting hint
+  QCP::phParallelPlottables, so they are drawn concurrently on all cores.
+  \li For very large rastered exports, set an export tile size (\ref QCustomPlot::setExportTileSize), so the image
+  is rasterized on all cores. If the image doesn't fit into memory, export it with \ref QCustomPlot::savePpm, which
+  writes it band by band.
+  \li If only a few objects change frequently (e.g. a tracer item following the mouse), put them on a buffered layer (\ref
+  QCPLayer::setMode) and replot only that layer with \ref QCPLayer::replot. Put the expensive objects (e.g. the "main"
+  layer with the graphs) on buffered layers, too, so they are only composited instead of redrawn.
+  \li For dense scatter plots with many points on the same pixels, set the plotting hint QCP::phCullScatters, so only one
+  symbol per pixel is drawn.
+  \li Keep adaptive sampling of graphs enabled (\ref QCPGraph::setAdaptiveSampling, default). With it, the cost of drawing
+  a graph line depends on the size of the axis rect rather than on the number of visible data points.
+  \li For graphs with millions of points that are zoomed and dragged a lot, enable the level of detail index
+  (\ref QCPGraph::setLodIndex). Adaptive sampling then doesn't need to visit every visible data point anymore.
+  \li For realtime plots that show a sliding window of recent data, set a data capacity on the graphs (\ref
+  QCPGraph::setDataCapacity). New data points then overwrite the oldest ones in a preallocated ring buffer.
+  \li When loading large data sets into graphs, pass the data sorted by key and set the alreadySorted parameter of \ref
+  QCPGraph::setData or \ref QCPGraph::addData, if possible.
   \li On X11 (linux), avoid the (slow) native drawing system, use raster by supplying
   "-graphicssystem raster" as command line argument or calling QApplication::setGraphicsSystem("raster")
   before creating the QApplication object.
@@ -409,11 +441,20 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   QWidget(parent),
   mDragging(false),
   mReplotting(false),
-  mPlottingHints(QCP::phCacheLabels)
+  mReplotQueued(false),
+  mDragReplotQueued(false),
+  mAsyncFramePending(false),
+  mDropRunningAsyncFrame(false),
+  mPlottingHints(QCP::phCacheLabels),
+  mDrafting(false)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
   setMouseTracking(true);
+  mScrollBuffer.valid = false;
+  connect(&mAsyncFrameWatcher, SIGNAL(finished()), this, SLOT(asyncFrameFinished()));
+  mRefineTimer.setSingleShot(true);
+  connect(&mRefineTimer, SIGNAL(timeout()), this, SLOT(refineReplot()));
   QLocale currentLocale = locale();
   currentLocale.setNumberOptions(QLocale::OmitGroupSeparator);
   setLocale(currentLocale);
@@ -470,6 +511,10 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   setNotAntialiasedElements(QCP::aeNone);
   setInteractions(iRangeDrag|iRangeZoom);
   setMultiSelectModifier(Qt::ControlModifier);
+  setExportTileSize(0);
+  setDraftPointBudget(0);
+  setRefineDelay(250);
+  setPolylineChunkSize(-1);
   setRangeDragAxes(xAxis, yAxis);
   setRangeZoomAxes(xAxis, yAxis);
   setRangeDrag(0);
@@ -484,6 +529,7 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
 
 QCustomPlot::~QCustomPlot()
 {
+  mAsyncFrameWatcher.waitForFinished();
   clearPlottables();
   clearItems();
   delete legend;
@@ -1089,6 +1135,81 @@ void QCustomPlot::setMultiSelectModifier(Qt::KeyboardModifier modifier)
   mMultiSelectModifier = modifier;
 }
 
+/*!
+  Sets the edge length in pixels of the tiles that rastered exports (\ref toImage, \ref
+  saveRastered, \ref savePng, etc.) are rendered in. If the exported image is larger than one
+  tile, the drawing commands of the plot are recorded once and then rasterized tile by tile on
+  multiple threads, directly into the resulting image. This is useful for very large exports
+  (e.g. posters with 16k x 8k pixels), which would otherwise be rasterized by a single thread.
+  
+  Since the tiles are rasterized on worker threads, this requires the raster graphics system on
+  X11 if pixmaps are part of the plot (e.g. cached tick labels, see QCustomPlot::toImage).
+  
+  Tiling doesn't reduce the memory needed by \ref toImage and the save functions based on it: The
+  complete image is allocated, and the recorded drawing commands are held in addition while the
+  tiles are rasterized, so the peak memory grows with the image size. Only \ref savePpm streams
+  the image to the file in bands of \a pixels rows, so its memory doesn't depend on the image
+  height.
+  
+  Set \a pixels to 0 (the default) to disable tiled rendering.
+*/
+void QCustomPlot::setExportTileSize(int pixels)
+{
+  mExportTileSize = qMax(0, pixels);
+}
+
+/*!
+  Sets the number of visible data points up to which plottables are drawn in full detail while the
+  user drags or zooms the axis ranges (\ref setInteractions). Plottables with more visible data
+  points are then drawn with reduced detail, e.g. a graph draws a coarsely decimated line and
+  skips its scatter symbols, error bars and channel fill. As soon as the interaction has been idle
+  for the refine delay (\ref setRefineDelay) or the mouse button is released, the plot is replotted
+  in full detail.
+  
+  This keeps interactions with very large graphs responsive, at the price of a coarser look while
+  interacting. Exports are always drawn in full detail.
+  
+  Set \a points to 0 (the default) to always draw in full detail.
+  
+  \see QCPPainter::setDraftMode
+*/
+void QCustomPlot::setDraftPointBudget(int points)
+{
+  mDraftPointBudget = qMax(0, points);
+}
+
+/*!
+  Sets the time in milliseconds after the last drag or zoom step, after which a plot that was drawn
+  with reduced detail during the interaction is replotted in full detail. The default is 250 ms.
+  
+  \see setDraftPointBudget
+*/
+void QCustomPlot::setRefineDelay(int msec)
+{
+  mRefineDelay = qMax(0, msec);
+}
+
+/*!
+  Sets the maximum number of points per chunk, in which the lines of graphs and curves are drawn.
+  Stroking a polyline gets disproportionately expensive with its number of points, especially with
+  antialiased, wide or dashed pens, so drawing long lines in chunks of a few hundred points is
+  considerably faster. Joins and caps are still drawn correctly and the chunks don't overlap, see
+  QCPPainter::drawPolylineChunked. The benchmarks in tests/benchmark compare chunk sizes for
+  different pens.
+  
+  If a fixed chunk size is set, it takes precedence over the plotting hint QCP::phFastPolylines,
+  which draws each line segment separately and thus loses the joins.
+  
+  Set \a points to -1 (the default) to choose the chunk size per pen, e.g. thin solid lines aren't
+  chunked while wide and dashed lines are (see QCPPainter::drawPolylineChunked). In this mode, the
+  plotting hint QCP::phFastPolylines takes precedence. Set \a points to 0 to always draw lines as
+  a single polyline.
+*/
+void QCustomPlot::setPolylineChunkSize(int points)
+{
+  mPolylineChunkSize = qMax(-1, points);
+}
+
 /*!
   Returns the plottable with \a index. If the index is invalid, returns 0.
   
@@ -1865,30 +1986,74 @@ void QCustomPlot::deselectAll()
   Causes a complete replot (axes, labels, graphs, etc.) into the internal buffer. Finally, update()
   is called, to redraw the buffer on the QCustomPlot widget surface.
   
+  The buffers of all buffered layers (see QCPLayer::setMode) are invalidated and rendered again. To
+  replot only the contents of a single buffered layer, use QCPLayer::replot.
+  
+  The \a priority controls whether the replot is performed immediately or queued for the next
+  event loop iteration, see \ref RefreshPriority. By default (\ref rpHint), replots are queued if
+  the plotting hint QCP::phQueuedReplot is set. Queued replots are coalesced: No matter how many
+  replots are requested until the event loop is reached (e.g. by a burst of data arrival signals
+  or mouse move events), the plot is only rendered once. An immediate replot also takes care of a
+  pending queued replot.
+  
+  If the plotting hint QCP::phAsyncReplot is set, the replot only records the drawing commands of
+  the plot in a QPicture on the GUI thread, which is fast compared to rasterizing them. The QPicture
+  is then rasterized into a QImage on a worker thread, while the event loop keeps running. When the
+  frame is finished, it replaces the internal buffer and the widget surface is updated. If further
+  replots are requested while a frame is rasterized, only the most recent one is rasterized next,
+  the others are dropped. In this mode, layer buffers aren't used (see QCPLayer::setMode). Since
+  pixmaps (e.g. cached tick labels, scatter pixmaps and the axis background) are then drawn on a
+  worker thread, this mode requires the raster graphics system on X11 (see \ref
+  performancetweaks).
+  
   Before the replot happens, the signal \ref beforeReplot is emitted. After the replot, \ref afterReplot is
   emitted. It is safe to mutually connect the replot slot with any of those two signals on two QCustomPlots
-  to make them replot synchronously (i.e. it won't cause an infinite recursion).
-*/
-void QCustomPlot::replot()
-{
+  to make them replot synchronously (i.e. it won't cause an infinite recursion). In asynchronous mode,
+  \ref afterReplot is emitted when the drawing commands are recorded, the frame appears on the
+  widget surface later.
+  
+  If the plotting hint QCP::phParallelPlottables is set, plottables that follow each other on a
+  layer are drawn concurrently on worker threads (e.g. with many graphs on the "main" layer). Each
+  is rendered into an own image of the size of its clip rect, the images are then composited in
+  layer order. The replot still returns only when the frame is complete. Plottables must not share
+  unguarded mutable state for this. For the plottables of QCustomPlot this is the case: draw
+  doesn't modify the plottable, and the geometry a channel fill reads from another graph is
+  guarded by that graph's cache (see QCPGraph::setChannelFillGraph). Like with
+  QCP::phAsyncReplot, drawing pixmaps (scatter pixmaps) on worker threads requires the raster
+  graphics system on X11.
+*/
+void QCustomPlot::replot(QCustomPlot::RefreshPriority priority)
+{
+  if (priority == rpQueued || (priority == rpHint && mPlottingHints.testFlag(QCP::phQueuedReplot)))
+  {
+    mDragReplotQueued = false; // a full replot supersedes a queued drag replot
+    if (!mReplotQueued)
+    {
+      mReplotQueued = true;
+      QMetaObject::invokeMethod(this, "processQueuedReplot", Qt::QueuedConnection);
+    }
+    return;
+  }
+  
   if (mReplotting) // incase signals loop back to replot slot
     return;
   mReplotting = true;
+  mReplotQueued = false; // a pending queued replot would render the same state again
+  mDragReplotQueued = false;
+  mScrollBuffer.valid = false;
   emit beforeReplot();
-  mPaintBuffer.fill(mColor);
-  QCPPainter painter;
-  painter.begin(&mPaintBuffer);
-  if (painter.isActive()) 
+  for (int i=0; i<mLayers.size(); ++i)
+    mLayers.at(i)->invalidateBuffer();
+  if (mPlottingHints.testFlag(QCP::phAsyncReplot))
   {
-    painter.setRenderHint(QPainter::HighQualityAntialiasing);
-    draw(&painter);
-    if (mPlottingHints.testFlag(QCP::phForceRepaint))
-      repaint();
-    else
-      update();
-    painter.end();
-  } else // might happen if QCustomPlot has width or height zero
-    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer";
+    recordAsyncFrame();
+  } else
+  {
+    // an asynchronous frame that is still being rasterized is older than this replot:
+    mAsyncFramePending = false;
+    mDropRunningAsyncFrame = mAsyncFrameWatcher.isRunning();
+    compositeLayers(true);
+  }
   emit afterReplot();
   mReplotting = false;
 }
@@ -2176,10 +2341,17 @@ void QCustomPlot::paintEvent(QPaintEvent *event)
 void QCustomPlot::resizeEvent(QResizeEvent *event)
 {
   // resize and repaint the buffer:
+  QPixmap oldBuffer = mPaintBuffer;
   mPaintBuffer = QPixmap(event->size());
+  if (mPlottingHints.testFlag(QCP::phAsyncReplot)) // show the old frame until the new one is rasterized
+  {
+    mPaintBuffer.fill(mColor);
+    QPainter painter(&mPaintBuffer);
+    painter.drawPixmap(0, 0, oldBuffer);
+  }
   mViewport = rect();
   updateAxisRect();
-  replot();
+  replot(rpImmediate); // the new buffer is uninitialized, so don't wait for a queued replot
 }
 
 /*! \internal
@@ -2324,7 +2496,18 @@ void QCustomPlot::mouseMoveEvent(QMouseEvent *event)
       {
         if (mNoAntialiasingOnDrag)
           setNotAntialiasedElements(QCP::aeAll);
-        replot();
+        beginDraft();
+        if (mPlottingHints.testFlag(QCP::phQueuedReplot))
+        {
+          // coalesce drag steps like other replots, the queued replot takes the fast path if possible:
+          if (!mReplotQueued)
+          {
+            mReplotQueued = true;
+            mDragReplotQueued = true;
+            QMetaObject::invokeMethod(this, "processQueuedReplot", Qt::QueuedConnection);
+          }
+        } else if (!dragReplot())
+          replot();
       }
     }
   }
@@ -2350,6 +2533,18 @@ void QCustomPlot::mouseReleaseEvent(QMouseEvent *event)
     setNotAntialiasedElements(mNotAADragBackup);
     doReplot = true;
   }
+  if (mScrollBuffer.valid) // the drag was rendered by shifting, finish with a complete replot
+  {
+    mScrollBuffer.pixmap = QPixmap();
+    mScrollBuffer.valid = false;
+    doReplot = true;
+  }
+  if (mDrafting) // the drag was rendered with reduced detail, finish in full detail right away
+  {
+    mDrafting = false;
+    mRefineTimer.stop();
+    doReplot = true;
+  }
   
   // determine whether it was a drag or click operation:
   if ((mDragStart-event->pos()).manhattanLength() < 5) // was a click
@@ -2480,6 +2675,7 @@ void QCustomPlot::wheelEvent(QWheelEvent *event)
         factor = pow(mRangeZoomFactorVert, wheelSteps);
         mRangeZoomVertAxis->scaleRange(factor, mRangeZoomVertAxis->pixelToCoord(event->pos().y()));
       }
+      beginDraft();
       replot();
     }
   }
@@ -2669,8 +2865,126 @@ bool QCustomPlot::handleTitleSelection(QMouseEvent *event, bool additiveSelectio
   This is the main draw function which first generates the tick vectors of all axes,
   calculates and applies appropriate margins if autoMargin is true and finally draws
   all elements with the passed \a painter. (axis background, title, subgrid, grid, axes, plottables)
+  
+  All layers are drawn directly with \a painter, regardless of their QCPLayer::mode. This is used
+  for exporting the plot (e.g. \ref savePdf, \ref pixmap). The widget surface is drawn by \ref
+  compositeLayers.
 */
 void QCustomPlot::draw(QCPPainter *painter)
+{
+  updateLayout(painter);
+  
+  // draw axis background:
+  drawAxisBackground(painter);
+  
+  // draw all layered objects (grid, axes, plottables, items, legend,...):
+  for (int layerIndex=0; layerIndex < mLayers.size(); ++layerIndex)
+    drawLayer(painter, mLayers.at(layerIndex));
+  
+  drawTitle(painter);
+}
+
+/*! \internal
+
+  If an axis background is provided via \ref setAxisBackground, this function first buffers the
+  scaled version depending on \ref setAxisBackgroundScaled and \ref setAxisBackgroundScaledMode and
+  then draws it inside the current axisRect with the provided \a painter. The scaled version is
+  buffered in mScaledAxisBackground to prevent the need for rescaling at every redraw. It is only
+  updated, when the axisRect has changed in a way that requires a rescale of the background pixmap
+  (this is dependant on the \ref setAxisBackgroundScaledMode), or when a differend axis backgroud
+  was set.
+  
+  \see draw, setAxisBackground, setAxisBackgroundScaled, setAxisBackgroundScaledMode
+*/
+void QCustomPlot::drawAxisBackground(QCPPainter *painter)
+{
+  if (!mAxisBackground.isNull())
+  {
+    if (mAxisBackgroundScaled)
+    {
+      // check whether mScaledAxisBackground needs to be updated:
+      QSize scaledSize(mAxisBackground.size());
+      scaledSize.scale(mAxisRect.size(), mAxisBackgroundScaledMode);
+      if (mScaledAxisBackground.size() != scaledSize)
+        mScaledAxisBackground = mAxisBackground.scaled(mAxisRect.size(), mAxisBackgroundScaledMode, Qt::SmoothTransformation);
+      painter->drawPixmap(mAxisRect.topLeft(), mScaledAxisBackground, QRect(0, 0, mAxisRect.width(), mAxisRect.height()) & mScaledAxisBackground.rect());
+    } else
+    {
+      painter->drawPixmap(mAxisRect.topLeft(), mAxisBackground, QRect(0, 0, mAxisRect.width(), mAxisRect.height()));
+    }
+  }
+}
+
+/*! \internal
+  
+  Performs the replot that was queued by \ref replot, unless an immediate replot has taken care of
+  it in the meantime.
+  
+  If only range drag steps were queued (see \ref mouseMoveEvent with QCP::phQueuedReplot), the
+  replot is performed with \ref dragReplot if possible.
+*/
+void QCustomPlot::processQueuedReplot()
+{
+  if (mReplotQueued)
+  {
+    bool dragOnly = mDragReplotQueued;
+    mDragReplotQueued = false;
+    if (!dragOnly || !dragReplot())
+      replot(rpImmediate);
+  }
+}
+
+/*! \internal
+  
+  Called when the worker thread has finished rasterizing a frame that was started with \ref
+  startAsyncFrame. Unless the frame was made obsolete by a synchronous replot in the meantime (or
+  the widget was resized), it becomes the new internal buffer and the widget surface is updated.
+  If a newer frame is pending, its rasterization is started.
+*/
+void QCustomPlot::asyncFrameFinished()
+{
+  QImage frame = mAsyncFrameWatcher.result();
+  if (!mDropRunningAsyncFrame && frame.size() == mPaintBuffer.size())
+  {
+    mPaintBuffer = QPixmap::fromImage(frame);
+    if (mPlottingHints.testFlag(QCP::phForceRepaint))
+      repaint();
+    else
+      update();
+  }
+  mDropRunningAsyncFrame = false;
+  if (mAsyncFramePending)
+  {
+    mAsyncFramePending = false;
+    QPicture pendingFrame = mPendingAsyncFrame;
+    mPendingAsyncFrame = QPicture();
+    startAsyncFrame(pendingFrame);
+  }
+}
+
+/*! \internal
+  
+  Called when the interaction that was started with \ref beginDraft has been idle for the refine
+  delay. Replots the plot in full detail.
+*/
+void QCustomPlot::refineReplot()
+{
+  if (mDrafting)
+  {
+    mDrafting = false;
+    replot();
+  }
+}
+
+/*! \internal
+  
+  Calculates the title bounding box, generates the tick vectors of all axes, applies appropriate
+  margins if autoMargin is true and positions the legend. The \a painter is only used to determine
+  the font metrics of the title.
+  
+  \see draw, compositeLayers
+*/
+void QCustomPlot::updateLayout(QCPPainter *painter)
 {
   // calculate title bounding box:
   if (!mTitle.isEmpty())
@@ -2695,29 +3009,129 @@ void QCustomPlot::draw(QCPPainter *painter)
   }
   // position legend:
   legend->reArrange();
+}
+
+/*! \internal
   
-  // draw axis background:
-  drawAxisBackground(painter);
+  Draws all visible layerables of \a layer with the provided \a painter, each clipped to its
+  clip rect and with its default antialiasing hint applied.
   
-  // draw all layered objects (grid, axes, plottables, items, legend,...):
-  for (int layerIndex=0; layerIndex < mLayers.size(); ++layerIndex)
+  \see draw, compositeLayers
+*/
+void QCustomPlot::drawLayer(QCPPainter *painter, QCPLayer *layer)
+{
+  QList<QCPLayerable*> layerChildren = layer->children();
+  for (int k=0; k < layerChildren.size(); ++k)
   {
-    QList<QCPLayerable*> layerChildren = mLayers.at(layerIndex)->children();
-    for (int k=0; k < layerChildren.size(); ++k)
+    if (layerChildren.at(k)->visible())
+      drawLayerable(painter, layerChildren.at(k));
+  }
+}
+
+/*! \internal
+  
+  Like \ref drawLayer, but consecutive visible plottables on \a layer are drawn concurrently: Up to
+  QThread::idealThreadCount plottables at a time are rendered on worker threads into separate
+  transparent images covering their clip rects (see \ref renderLayerable). The images are then
+  drawn with \a painter in the order of the plottables on the layer, so the result looks the same
+  as with \ref drawLayer. Other layerables (e.g. items) are drawn directly on the calling thread.
+  
+  \a painter must paint on a device of the size of the internal paint buffer without any
+  transformation, which is why this is only used by \ref compositeLayers.
+  
+  \see QCP::phParallelPlottables
+*/
+void QCustomPlot::drawLayerParallel(QCPPainter *painter, QCPLayer *layer)
+{
+  QList<QCPLayerable*> layerChildren = layer->children();
+  const int maxBatchSize = qMax(1, QThread::idealThreadCount());
+  int k = 0;
+  while (k < layerChildren.size())
+  {
+    // collect consecutive visible plottables, invisible layerables don't interrupt a batch:
+    QList<QCPLayerable*> batch;
+    while (k < layerChildren.size() && batch.size() < maxBatchSize)
     {
       QCPLayerable *child = layerChildren.at(k);
       if (child->visible())
       {
-        painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
-        child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
+        if (!qobject_cast<QCPAbstractPlottable*>(child))
+          break;
+        batch.append(child);
+        // the level of detail index of a graph is built lazily. Build it here, so a graph with a
+        // channel fill to this one doesn't race with it for that:
+        if (QCPGraph *graph = qobject_cast<QCPGraph*>(child))
+          graph->data()->ensureLodIndex();
+      }
+      ++k;
+    }
+    
+    if (batch.size() > 1)
+    {
+      QList<QFuture<QImage> > images;
+      QList<QRect> rects;
+      for (int i=0; i<batch.size(); ++i)
+      {
+        rects.append(batch.at(i)->clipRect().translated(0, -1) & mPaintBuffer.rect());
+        images.append(QtConcurrent::run(renderLayerable, batch.at(i), rects.last(), painter->draftMode()));
       }
+      for (int i=0; i<batch.size(); ++i)
+        painter->drawImage(rects.at(i).topLeft(), images.at(i).result()); // result() waits for the worker
+    } else if (batch.size() == 1)
+    {
+      drawLayerable(painter, batch.first());
+    } else if (k < layerChildren.size()) // layerChildren.at(k) is a visible layerable that isn't a plottable
+    {
+      drawLayerable(painter, layerChildren.at(k));
+      ++k;
     }
   }
+}
+
+/*! \internal
+  
+  Draws the \a layerable with the provided \a painter, clipped to its clip rect and with its
+  default antialiasing hint applied.
+*/
+void QCustomPlot::drawLayerable(QCPPainter *painter, QCPLayerable *layerable)
+{
+  painter->save();
+  painter->setClipRect(layerable->clipRect().translated(0, -1));
+  layerable->applyDefaultAntialiasingHint(painter);
+  layerable->draw(painter);
+  painter->restore();
+}
+
+/*! \internal
+  
+  Renders the \a layerable into a transparent image that corresponds to the region \a rect of the
+  plot, and returns it. If \a draft is true, the painter is put in draft mode (see \ref
+  QCPPainter::setDraftMode). This runs on a worker thread, see \ref drawLayerParallel.
+*/
+QImage QCustomPlot::renderLayerable(QCPLayerable *layerable, const QRect &rect, bool draft)
+{
+  QImage image(rect.size(), QImage::Format_ARGB32_Premultiplied);
+  image.fill(0);
+  if (!rect.isEmpty())
+  {
+    QCPPainter painter(&image);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    painter.setDraftMode(draft);
+    painter.translate(-rect.topLeft());
+    painter.setClipRect(rect);
+    layerable->applyDefaultAntialiasingHint(&painter);
+    layerable->draw(&painter);
+  }
+  return image;
+}
+
+/*! \internal
   
-  // draw title:
+  Draws the plot title with the provided \a painter, inside the title bounding box determined by
+  the last call to \ref updateLayout.
+*/
+void QCustomPlot::drawTitle(QCPPainter *painter)
+{
   if (!mTitle.isEmpty())
   {
     painter->setFont(titleSelected() ? mSelectedTitleFont : mTitleFont);
@@ -2727,33 +3141,402 @@ void QCustomPlot::draw(QCPPainter *painter)
 }
 
 /*! \internal
+  
+  Paints the plot into the internal paint buffer and updates the widget surface. If \a relayout
+  is true, the tick vectors, margins and legend position are recalculated first (see \ref
+  updateLayout), otherwise the layout of the previous replot is used.
+  
+  Logical layers (QCPLayer::lmLogical) are drawn directly into the paint buffer. Buffered layers
+  (QCPLayer::lmBuffered) are only rendered into their own buffer if it was invalidated (or the
+  widget size changed), and are then composited into the paint buffer.
+  
+  \see replot, QCPLayer::replot
+*/
+void QCustomPlot::compositeLayers(bool relayout)
+{
+  mPaintBuffer.fill(mColor);
+  QCPPainter painter;
+  painter.begin(&mPaintBuffer);
+  if (painter.isActive()) 
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    painter.setDraftMode(mDrafting);
+    if (relayout)
+      updateLayout(&painter);
+    drawAxisBackground(&painter);
+    const bool parallel = mPlottingHints.testFlag(QCP::phParallelPlottables);
+    for (int layerIndex=0; layerIndex < mLayers.size(); ++layerIndex)
+    {
+      QCPLayer *layer = mLayers.at(layerIndex);
+      if (layer->mode() == QCPLayer::lmBuffered)
+      {
+        if (layer->mBuffer.size() != mPaintBuffer.size())
+        {
+          layer->mBuffer = QPixmap(mPaintBuffer.size());
+          layer->mBufferValid = false;
+        }
+        if (!layer->mBufferValid)
+        {
+          layer->mBuffer.fill(Qt::transparent);
+          QCPPainter layerPainter;
+          layerPainter.begin(&layer->mBuffer);
+          if (layerPainter.isActive())
+          {
+            layerPainter.setRenderHint(QPainter::HighQualityAntialiasing);
+            layerPainter.setDraftMode(mDrafting);
+            if (parallel)
+              drawLayerParallel(&layerPainter, layer);
+            else
+              drawLayer(&layerPainter, layer);
+            layerPainter.end();
+            layer->mBufferValid = true;
+          } else
+            qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer of layer" << layer->name();
+        }
+        painter.drawPixmap(0, 0, layer->mBuffer);
+      } else if (parallel)
+        drawLayerParallel(&painter, layer);
+      else
+        drawLayer(&painter, layer);
+    }
+    drawTitle(&painter);
+    if (mPlottingHints.testFlag(QCP::phForceRepaint))
+      repaint();
+    else
+      update();
+    painter.end();
+  } else // might happen if QCustomPlot has width or height zero
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer";
+}
 
-  If an axis background is provided via \ref setAxisBackground, this function first buffers the
-  scaled version depending on \ref setAxisBackgroundScaled and \ref setAxisBackgroundScaledMode and
-  then draws it inside the current axisRect with the provided \a painter. The scaled version is
-  buffered in mScaledAxisBackground to prevent the need for rescaling at every redraw. It is only
-  updated, when the axisRect has changed in a way that requires a rescale of the background pixmap
-  (this is dependant on the \ref setAxisBackgroundScaledMode), or when a differend axis backgroud
-  was set.
+/*! \internal
   
-  \see draw, setAxisBackground, setAxisBackgroundScaled, setAxisBackgroundScaledMode
+  Rasterizes the recorded drawing commands \a frame into an image of the given \a size, filled with
+  \a background first. Runs on a worker thread, see \ref QCustomPlot::startAsyncFrame.
 */
-void QCustomPlot::drawAxisBackground(QCPPainter *painter)
+static QImage qcpRasterizeFrame(const QPicture &frame, const QSize &size, const QColor &background)
 {
-  if (!mAxisBackground.isNull())
+  QImage image(size, QImage::Format_ARGB32_Premultiplied);
+  image.fill(0);
+  QPainter painter(&image);
+  painter.fillRect(image.rect(), background);
+  painter.drawPicture(0, 0, frame);
+  return image;
+}
+
+/*! \internal
+  
+  Records the drawing commands of the whole plot (see \ref draw) in a QPicture and passes it on to
+  \ref startAsyncFrame. If a frame is currently being rasterized, the recorded frame becomes the
+  pending frame instead, replacing (and thus dropping) a previously pending frame.
+  
+  \see replot, QCP::phAsyncReplot
+*/
+void QCustomPlot::recordAsyncFrame()
+{
+  QPicture frame;
+  QCPPainter painter;
+  painter.begin(&frame);
+  if (painter.isActive())
   {
-    if (mAxisBackgroundScaled)
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    painter.setDraftMode(mDrafting);
+    draw(&painter);
+    painter.end();
+    if (mAsyncFrameWatcher.isRunning())
     {
-      // check whether mScaledAxisBackground needs to be updated:
-      QSize scaledSize(mAxisBackground.size());
-      scaledSize.scale(mAxisRect.size(), mAxisBackgroundScaledMode);
-      if (mScaledAxisBackground.size() != scaledSize)
-        mScaledAxisBackground = mAxisBackground.scaled(mAxisRect.size(), mAxisBackgroundScaledMode, Qt::SmoothTransformation);
-      painter->drawPixmap(mAxisRect.topLeft(), mScaledAxisBackground, QRect(0, 0, mAxisRect.width(), mAxisRect.height()) & mScaledAxisBackground.rect());
+      mPendingAsyncFrame = frame;
+      mAsyncFramePending = true;
     } else
+      startAsyncFrame(frame);
+  } else
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on picture";
+}
+
+/*! \internal
+  
+  Starts rasterizing the recorded \a frame on a worker thread, with the size of the internal buffer
+  and the background color. When finished, \ref asyncFrameFinished is called.
+*/
+void QCustomPlot::startAsyncFrame(const QPicture &frame)
+{
+  mDropRunningAsyncFrame = false;
+  mAsyncFrameWatcher.setFuture(QtConcurrent::run(qcpRasterizeFrame, frame, mPaintBuffer.size(), mColor));
+}
+
+/*! \internal
+  
+  Replots the plot during a range drag (see \ref mouseMoveEvent), if the plotting hint
+  QCP::phScrollOnDrag is set. Returns false if the fast path isn't enabled or currently not
+  possible, in which case the caller should perform a normal \ref replot.
+  
+  The visible layerables in the rendering order are split in two: The bottom ones that are shifted
+  by the drag (plottables and grids that only use the drag axes in the dragged orientations, see
+  \ref scrollable), and all others, starting with the first layerable that isn't shifted. The
+  former are drawn from the scroll buffer, which is updated by \ref updateScrollBuffer, the latter
+  are drawn normally on top. For typical plots, the first group contains the grids and graphs,
+  and the second one the axes, legend and items.
+  
+  Like \ref replot, this emits \ref beforeReplot and \ref afterReplot. If the plotting hint
+  QCP::phQueuedReplot is set, the drag steps are coalesced and this is called from \ref
+  processQueuedReplot instead.
+*/
+bool QCustomPlot::dragReplot()
+{
+  if (!mPlottingHints.testFlag(QCP::phScrollOnDrag) || mPlottingHints.testFlag(QCP::phAsyncReplot) || mReplotting || mPaintBuffer.isNull())
+    return false;
+  
+  mReplotting = true;
+  mReplotQueued = false;
+  mDragReplotQueued = false;
+  emit beforeReplot();
+  for (int i=0; i<mLayers.size(); ++i)
+    mLayers.at(i)->invalidateBuffer();
+  mPaintBuffer.fill(mColor);
+  QCPPainter painter;
+  painter.begin(&mPaintBuffer);
+  if (painter.isActive())
+  {
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    painter.setDraftMode(mDrafting);
+    updateLayout(&painter);
+    drawAxisBackground(&painter);
+    
+    // split visible layerables into the bottom ones that are shifted by the drag and the others:
+    QList<QCPLayerable*> scrolled, others;
+    QList<QCPAxis*> usedAxes;
+    for (int layerIndex=0; layerIndex < mLayers.size(); ++layerIndex)
     {
-      painter->drawPixmap(mAxisRect.topLeft(), mAxisBackground, QRect(0, 0, mAxisRect.width(), mAxisRect.height()));
+      QList<QCPLayerable*> layerChildren = mLayers.at(layerIndex)->children();
+      for (int k=0; k < layerChildren.size(); ++k)
+      {
+        QCPLayerable *child = layerChildren.at(k);
+        if (!child->visible())
+          continue;
+        if (others.isEmpty() && scrollable(child, &usedAxes))
+          scrolled.append(child);
+        else
+          others.append(child);
+      }
+    }
+    
+    updateScrollBuffer(scrolled, usedAxes);
+    painter.drawPixmap(mAxisRect.translated(0, -1).topLeft(), mScrollBuffer.pixmap);
+    for (int i=0; i<others.size(); ++i)
+      drawLayerable(&painter, others.at(i));
+    drawTitle(&painter);
+    if (mPlottingHints.testFlag(QCP::phForceRepaint))
+      repaint();
+    else
+      update();
+    painter.end();
+  } else
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer";
+  emit afterReplot();
+  mReplotting = false;
+  return true;
+}
+
+/*! \internal
+  
+  Returns whether the contents of \a layerable move rigidly with a range drag, so it may be drawn
+  from the scroll buffer (see \ref dragReplot). This is the case for plottables and grids, if each
+  of their axes is the range drag axis of its orientation, or its orientation isn't dragged at all.
+  
+  If so, the axes of \a layerable are added to \a usedAxes (if not already contained).
+*/
+bool QCustomPlot::scrollable(QCPLayerable *layerable, QList<QCPAxis*> *usedAxes) const
+{
+  QList<QCPAxis*> axes;
+  if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(layerable))
+    axes << plottable->keyAxis() << plottable->valueAxis();
+  else if (QCPGrid *grid = qobject_cast<QCPGrid*>(layerable))
+    axes << grid->mParentAxis;
+  else
+    return false;
+  
+  for (int i=0; i<axes.size(); ++i)
+  {
+    QCPAxis *axis = axes.at(i);
+    if (!axis)
+      return false;
+    Qt::Orientation orientation = axis->orientation();
+    if (mRangeDrag.testFlag(orientation) && axis != (orientation == Qt::Horizontal ? mRangeDragHorzAxis : mRangeDragVertAxis))
+      return false;
+  }
+  for (int i=0; i<axes.size(); ++i)
+  {
+    if (!usedAxes->contains(axes.at(i)))
+      usedAxes->append(axes.at(i));
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Brings the scroll buffer up to date with the current axis ranges, for the provided scrollable
+  \a layerables, which use the axes \a usedAxes.
+  
+  If the buffer holds the same layerables for the same axis rect, and the ranges of the used drag
+  axes were only shifted by a whole number of pixels (while the other used axes kept their
+  ranges), the buffer contents are shifted accordingly and only the exposed strips are rendered
+  (see \ref renderScrollBuffer). Otherwise, the whole buffer is rendered.
+*/
+void QCustomPlot::updateScrollBuffer(const QList<QCPLayerable*> &layerables, const QList<QCPAxis*> &usedAxes)
+{
+  const QList<QCPAxis*> allAxes = QList<QCPAxis*>() << xAxis << yAxis << xAxis2 << yAxis2;
+  const QRect bufferRect = mAxisRect.translated(0, -1); // layerables are clipped to this rect, see drawLayerable
+  
+  // determine the pixel offset of the contents since the buffer was rendered:
+  bool shiftable = mScrollBuffer.valid && mScrollBuffer.axisRect == mAxisRect && mScrollBuffer.layerables == layerables;
+  QPoint offset;
+  for (int i=0; i<usedAxes.size() && shiftable; ++i)
+  {
+    QCPAxis *axis = usedAxes.at(i);
+    QCPRange oldRange = mScrollBuffer.axisRanges.at(allAxes.indexOf(axis));
+    QCPRange newRange = axis->range();
+    if (mRangeDrag.testFlag(axis->orientation())) // range drag axis, range may be shifted
+    {
+      bool sameSpan;
+      if (axis->scaleType() == QCPAxis::stLinear)
+        sameSpan = qAbs(newRange.size()-oldRange.size()) <= oldRange.size()*1e-9;
+      else
+        sameSpan = qAbs(newRange.upper/newRange.lower-oldRange.upper/oldRange.lower) <= oldRange.upper/oldRange.lower*1e-9;
+      double shift = axis->coordToPixel(oldRange.lower)-axis->coordToPixel(newRange.lower);
+      if (!sameSpan || qAbs(shift-qRound(shift)) > 0.01)
+        shiftable = false;
+      else if (axis->orientation() == Qt::Horizontal)
+        offset.setX(qRound(shift));
+      else
+        offset.setY(qRound(shift));
+    } else if (newRange.lower != oldRange.lower || newRange.upper != oldRange.upper)
+      shiftable = false;
+  }
+  if (qAbs(offset.x()) >= bufferRect.width() || qAbs(offset.y()) >= bufferRect.height())
+    shiftable = false;
+  
+  if (shiftable)
+  {
+    if (offset.isNull())
+      return;
+    QPixmap shifted(bufferRect.size());
+    shifted.fill(Qt::transparent);
+    QPainter shiftPainter(&shifted);
+    shiftPainter.drawPixmap(offset, mScrollBuffer.pixmap);
+    shiftPainter.end();
+    mScrollBuffer.pixmap = shifted;
+    // render the exposed strips, the horizontal strip leaves out the columns of the vertical strip:
+    int dx = qAbs(offset.x());
+    int dy = qAbs(offset.y());
+    if (dx > 0)
+    {
+      QRect strip(offset.x() > 0 ? bufferRect.left() : bufferRect.right()+1-dx, bufferRect.top(), dx, bufferRect.height());
+      renderScrollBuffer(layerables, strip, true);
     }
+    if (dy > 0)
+    {
+      QRect strip(offset.x() > 0 ? bufferRect.left()+dx : bufferRect.left(), offset.y() > 0 ? bufferRect.top() : bufferRect.bottom()+1-dy, bufferRect.width()-dx, dy);
+      renderScrollBuffer(layerables, strip, true);
+    }
+  } else
+  {
+    mScrollBuffer.pixmap = QPixmap(bufferRect.size());
+    mScrollBuffer.pixmap.fill(Qt::transparent);
+    renderScrollBuffer(layerables, bufferRect, false);
+  }
+  
+  mScrollBuffer.valid = true;
+  mScrollBuffer.axisRect = mAxisRect;
+  mScrollBuffer.layerables = layerables;
+  mScrollBuffer.axisRanges.clear();
+  for (int i=0; i<allAxes.size(); ++i)
+    mScrollBuffer.axisRanges.append(allAxes.at(i)->range());
+}
+
+/*! \internal
+  
+  Draws the \a layerables into the scroll buffer, clipped to \a region (in widget coordinates).
+  
+  If \a restrictData is true, the \a region, widened by the pixel overhang of the layerables (see
+  \ref scrollOverhang), is passed to the layerables as data region of the painter (see
+  QCPPainter::setDataRegion). Graphs then only process the data in and near the region, which
+  makes rendering a narrow strip cheap, while scatter symbols and error bars of data points just
+  outside the region still reach into it. If the overhang isn't bounded, the layerables are only
+  clipped to the region. The axes aren't modified, so no rangeChanged signals are emitted and the
+  geometry caches of the graphs aren't affected.
+*/
+void QCustomPlot::renderScrollBuffer(const QList<QCPLayerable*> &layerables, const QRect &region, bool restrictData)
+{
+  QCPPainter painter(&mScrollBuffer.pixmap);
+  painter.setRenderHint(QPainter::HighQualityAntialiasing);
+  painter.setDraftMode(mDrafting);
+  int overhang = restrictData ? scrollOverhang(layerables) : -1;
+  if (overhang >= 0)
+    painter.setDataRegion(QRectF(region.adjusted(-overhang, -overhang, overhang, overhang)));
+  painter.translate(-mAxisRect.translated(0, -1).topLeft());
+  for (int i=0; i<layerables.size(); ++i)
+  {
+    QCPLayerable *layerable = layerables.at(i);
+    painter.save();
+    painter.setClipRect(layerable->clipRect().translated(0, -1) & region);
+    layerable->applyDefaultAntialiasingHint(&painter);
+    layerable->draw(&painter);
+    painter.restore();
+  }
+  painter.end();
+}
+
+/*! \internal
+  
+  Returns by how many pixels the drawing of the scrollable \a layerables may reach beyond the
+  pixel positions of their data, i.e. half the extent of scatter symbols and error bar ends plus
+  the pen widths. Returns -1 if this isn't bounded in pixels, e.g. for bars, statistical boxes and
+  graphs with key error bars, whose extent is given in plot coordinates.
+  
+  \see renderScrollBuffer
+*/
+int QCustomPlot::scrollOverhang(const QList<QCPLayerable*> &layerables) const
+{
+  double overhang = 0;
+  for (int i=0; i<layerables.size(); ++i)
+  {
+    QCPLayerable *layerable = layerables.at(i);
+    double symbolSize, penWidth;
+    if (QCPGraph *graph = qobject_cast<QCPGraph*>(layerable))
+    {
+      if (graph->errorType() == QCPGraph::etKey || graph->errorType() == QCPGraph::etBoth)
+        return -1;
+      symbolSize = graph->scatterStyle() == QCP::ssPixmap ? qMax(graph->scatterPixmap().width(), graph->scatterPixmap().height()) : graph->scatterSize();
+      if (graph->errorType() != QCPGraph::etNone)
+        symbolSize = qMax(symbolSize, graph->errorBarSize());
+      penWidth = qMax(qMax(graph->pen().widthF(), graph->selectedPen().widthF()), graph->errorPen().widthF());
+    } else if (QCPCurve *curve = qobject_cast<QCPCurve*>(layerable))
+    {
+      symbolSize = curve->scatterStyle() == QCP::ssPixmap ? qMax(curve->scatterPixmap().width(), curve->scatterPixmap().height()) : curve->scatterSize();
+      penWidth = qMax(curve->pen().widthF(), curve->selectedPen().widthF());
+    } else if (QCPGrid *grid = qobject_cast<QCPGrid*>(layerable))
+    {
+      symbolSize = 0;
+      penWidth = qMax(qMax(grid->pen().widthF(), grid->subGridPen().widthF()), grid->zeroLinePen().widthF());
+    } else
+      return -1;
+    overhang = qMax(overhang, symbolSize*0.5 + qMax(penWidth, 1.0));
+  }
+  return qCeil(overhang)+1; // one more pixel for antialiasing
+}
+
+/*! \internal
+  
+  Called for every drag and zoom step of a user interaction. If a draft point budget is set (\ref
+  setDraftPointBudget), the following replots are drawn with reduced detail, until the interaction
+  has been idle for the refine delay (\ref setRefineDelay) and \ref refineReplot is called.
+*/
+void QCustomPlot::beginDraft()
+{
+  if (mDraftPointBudget > 0)
+  {
+    mDrafting = true;
+    mRefineTimer.start(mRefineDelay);
   }
 }
 
@@ -2792,9 +3575,25 @@ bool QCustomPlot::selectTestTitle(const QPointF &pos) const
   Returns true on success. If this function fails, most likely the given \a format isn't supported
   by the system, see Qt docs about QImageWriter::supportedImageFormats().
   
+  The plot is rendered with \ref toImage, so this function may be called from a worker thread
+  under the same conditions.
+  
   \see saveBmp, saveJpg, savePng, savePdf
 */
 bool QCustomPlot::saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality)
+{
+  return toImage(width, height, scale).save(fileName, format, quality);
+}
+
+/*!
+  Renders the plot to a pixmap and returns it.
+  
+  The plot is sized to \a width and \a height in pixels and scaled with \a scale. (width 100 and
+  scale 2.0 lead to a full resolution pixmap with width 200.)
+  
+  \see saveRastered, saveBmp, savePng, saveJpg, savePdf
+*/
+QPixmap QCustomPlot::pixmap(int width, int height, double scale)
 {
   int newWidth, newHeight;
   if (width == 0 || height == 0)
@@ -2809,9 +3608,9 @@ bool QCustomPlot::saveRastered(const QString &fileName, int width, int height, d
   int scaledWidth = qRound(scale*newWidth);
   int scaledHeight = qRound(scale*newHeight);
 
-  QPixmap pngBuffer(scaledWidth, scaledHeight); // use QPixmap instead of QImage (like live painting buffer), because it supports background transparency (of mColor).
-  pngBuffer.fill(mColor);
-  QCPPainter painter(&pngBuffer);
+  QPixmap result(scaledWidth, scaledHeight);
+  result.fill(mColor);
+  QCPPainter painter(&result);
   QRect oldViewport = mViewport;
   mViewport = QRect(0, 0, newWidth, newHeight);
   updateAxisRect();
@@ -2827,18 +3626,120 @@ bool QCustomPlot::saveRastered(const QString &fileName, int width, int height, d
   draw(&painter);
   mViewport = oldViewport;
   updateAxisRect();
-  return pngBuffer.save(fileName, format, quality);
+  return result;
+}
+
+/*! \internal
+  
+  Rasterizes the recorded drawing commands \a pictureData (see QPicture::data) in the region \a
+  tile into the pixels of an ARGB32_Premultiplied image, which start with the top left pixel of the
+  tile at \a bits and have \a bytesPerLine bytes per line. Runs on a worker thread, see \ref
+  QCustomPlot::setExportTileSize and \ref QCustomPlot::savePpm.
+  
+  Each tile creates its own QPicture from \a pictureData, because playing a QPicture isn't
+  reentrant.
+*/
+static void qcpRenderTile(uchar *bits, int bytesPerLine, const QRect &tile, const QByteArray &pictureData)
+{
+  QImage tileImage(bits, tile.width(), tile.height(), bytesPerLine, QImage::Format_ARGB32_Premultiplied);
+  QPicture picture;
+  picture.setData(pictureData.constData(), pictureData.size());
+  QPainter painter(&tileImage);
+  painter.translate(-tile.topLeft());
+  painter.drawPicture(0, 0, picture);
 }
 
 /*!
-  Renders the plot to a pixmap and returns it.
+  Renders the plot to an image and returns it.
   
   The plot is sized to \a width and \a height in pixels and scaled with \a scale. (width 100 and
-  scale 2.0 lead to a full resolution pixmap with width 200.)
+  scale 2.0 lead to a full resolution image with width 200.) If \a width or \a height is zero, the
+  current widget size is used.
   
-  \see saveRastered, saveBmp, savePng, saveJpg, savePdf
+  Unlike \ref pixmap, this function doesn't need the GUI thread and the widget doesn't need to be
+  shown. This allows generating images without a display, and in parallel: Create several
+  QCustomPlot instances (widgets must be created on the GUI thread) and hand each one to a worker
+  thread, which sets it up and calls toImage or \ref saveRastered. While a worker thread renders a
+  plot, no other thread may access that plot. Tick labels aren't pixmap-cached when rendering on a
+  thread other than the one the plot lives in (see QCP::phCacheLabels). Pixmaps set by the user
+  (e.g. \ref setAxisBackground, scatter pixmaps, QCPItemPixmap) are still drawn, which requires the
+  raster graphics system on X11 when rendering on a worker thread.
+  
+  Large images can be rendered in tiles on multiple threads, see \ref setExportTileSize.
+  
+  \see pixmap, saveRastered
 */
-QPixmap QCustomPlot::pixmap(int width, int height, double scale)
+QImage QCustomPlot::toImage(int width, int height, double scale)
+{
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  int scaledWidth = qRound(scale*newWidth);
+  int scaledHeight = qRound(scale*newHeight);
+  
+  QImage result(scaledWidth, scaledHeight, QImage::Format_ARGB32_Premultiplied); // supports background transparency (of mColor), like the pixmaps
+  result.fill(0);
+  {
+    QPainter backgroundPainter(&result);
+    backgroundPainter.fillRect(result.rect(), mColor);
+  }
+  // with tiled rendering, record the drawing commands and rasterize them tile by tile afterwards:
+  const bool tiled = mExportTileSize > 0 && (scaledWidth > mExportTileSize || scaledHeight > mExportTileSize);
+  QPicture picture;
+  QCPPainter painter;
+  if (tiled)
+    painter.begin(&picture);
+  else
+    painter.begin(&result);
+  drawExport(&painter, newWidth, newHeight, scale);
+  painter.end();
+  
+  if (tiled)
+  {
+    const QByteArray pictureData(picture.data(), picture.size());
+    uchar *bits = result.bits();
+    QFutureSynchronizer<void> synchronizer;
+    for (int y=0; y<scaledHeight; y+=mExportTileSize)
+    {
+      for (int x=0; x<scaledWidth; x+=mExportTileSize)
+      {
+        QRect tile(x, y, qMin(mExportTileSize, scaledWidth-x), qMin(mExportTileSize, scaledHeight-y));
+        synchronizer.addFuture(QtConcurrent::run(qcpRenderTile, bits + y*result.bytesPerLine() + x*4, result.bytesPerLine(), tile, pictureData));
+      }
+    }
+    synchronizer.waitForFinished();
+  }
+  return result;
+}
+
+/*!
+  Saves a binary PPM (portable pixmap) image file to \a fileName on disc. The parameters \a width,
+  \a height and \a scale have the same meaning as for \ref savePng.
+  
+  Unlike the other save functions, this doesn't allocate the complete image. The drawing commands
+  of the plot are recorded once, then the image is rasterized in bands of full width on multiple
+  threads and each band is written to the file before the next ones are rasterized. The band
+  height is the export tile size (\ref setExportTileSize) or 256 rows if tiled rendering is
+  disabled. So apart from the recorded drawing commands, the memory needed is bounded by the width
+  of the image times the band height times the number of cores, regardless of the image height.
+  This allows exporting images that are larger than the available memory. The file can be converted
+  to other formats by external tools.
+  
+  PPM doesn't support transparency, so a translucent background color (\ref setColor) is blended
+  with white.
+  
+  Returns true on success, or false if the file couldn't be written.
+  
+  \see savePng, saveRastered, toImage
+*/
+bool QCustomPlot::savePpm(const QString &fileName, int width, int height, double scale)
 {
   int newWidth, newHeight;
   if (width == 0 || height == 0)
@@ -2852,24 +3753,88 @@ QPixmap QCustomPlot::pixmap(int width, int height, double scale)
   }
   int scaledWidth = qRound(scale*newWidth);
   int scaledHeight = qRound(scale*newHeight);
+  if (scaledWidth <= 0 || scaledHeight <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "Invalid image size" << scaledWidth << scaledHeight;
+    return false;
+  }
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't open file" << fileName;
+    return false;
+  }
+  
+  QPicture picture;
+  QCPPainter painter;
+  painter.begin(&picture);
+  drawExport(&painter, newWidth, newHeight, scale);
+  painter.end();
+  const QByteArray pictureData(picture.data(), picture.size());
+  
+  char header[64];
+  int headerLength = qsnprintf(header, sizeof(header), "P6\n%d %d\n255\n", scaledWidth, scaledHeight);
+  bool ok = file.write(header, headerLength) == headerLength;
+  const int bandHeight = mExportTileSize > 0 ? mExportTileSize : 256;
+  const int concurrentBands = qMax(1, QThread::idealThreadCount());
+  QByteArray line(3*scaledWidth, 0);
+  for (int firstTop=0; firstTop<scaledHeight && ok; firstTop+=concurrentBands*bandHeight)
+  {
+    // rasterize the next bands concurrently, then write them in order:
+    QVector<QImage> bands;
+    for (int top=firstTop; top<scaledHeight && bands.size()<concurrentBands; top+=bandHeight)
+      bands.append(QImage(scaledWidth, qMin(bandHeight, scaledHeight-top), QImage::Format_ARGB32_Premultiplied));
+    QFutureSynchronizer<void> synchronizer;
+    for (int i=0; i<bands.size(); ++i)
+    {
+      QPainter backgroundPainter(&bands[i]);
+      backgroundPainter.fillRect(bands[i].rect(), Qt::white);
+      backgroundPainter.fillRect(bands[i].rect(), mColor);
+      backgroundPainter.end();
+      synchronizer.addFuture(QtConcurrent::run(qcpRenderTile, bands[i].bits(), bands[i].bytesPerLine(), QRect(0, firstTop+i*bandHeight, scaledWidth, bands.at(i).height()), pictureData));
+    }
+    synchronizer.waitForFinished();
+    for (int i=0; i<bands.size() && ok; ++i)
+    {
+      for (int row=0; row<bands.at(i).height() && ok; ++row)
+      {
+        const QRgb *pixels = reinterpret_cast<const QRgb*>(bands.at(i).scanLine(row));
+        char *rgb = line.data();
+        for (int x=0; x<scaledWidth; ++x)
+        {
+          *rgb++ = char(qRed(pixels[x]));
+          *rgb++ = char(qGreen(pixels[x]));
+          *rgb++ = char(qBlue(pixels[x]));
+        }
+        ok = file.write(line) == line.size();
+      }
+    }
+  }
+  if (!ok)
+    qDebug() << Q_FUNC_INFO << "Couldn't write file" << fileName;
+  return ok;
+}
 
-  QPixmap result(scaledWidth, scaledHeight);
-  result.fill(mColor);
-  QCPPainter painter(&result);
+/*! \internal
+  
+  Draws the plot with \a painter for an export, sized to \a width and \a height in pixels and
+  scaled with \a scale (see \ref toImage). The viewport of the plot is restored afterwards.
+*/
+void QCustomPlot::drawExport(QCPPainter *painter, int width, int height, double scale)
+{
   QRect oldViewport = mViewport;
-  mViewport = QRect(0, 0, newWidth, newHeight);
+  mViewport = QRect(0, 0, width, height);
   updateAxisRect();
   if (!qFuzzyCompare(scale, 1.0))
   {
     if (scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines would disappear
     {
-      painter.setScaledExportMode(true);
-      painter.setRenderHint(QPainter::NonCosmeticDefaultPen);
+      painter->setScaledExportMode(true);
+      painter->setRenderHint(QPainter::NonCosmeticDefaultPen);
     }
-    painter.scale(scale, scale);
+    painter->scale(scale, scale);
   }
-  draw(&painter);
+  draw(painter);
   mViewport = oldViewport;
   updateAxisRect();
-  return result;
 }
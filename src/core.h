@@ -78,6 +78,16 @@ public:
                          ,limAbove ///< Layer is inserted above other layer
                    };
   Q_ENUMS(LayerInsertMode)
+  /*!
+    Defines when a replot requested with \ref replot is performed.
+    
+    \see replot, QCP::phQueuedReplot
+  */
+  enum RefreshPriority { rpImmediate ///< The replot is performed immediately
+                         ,rpQueued   ///< The replot is queued and performed in the next event loop iteration. Further queued replots until then are coalesced with it
+                         ,rpHint     ///< Queued if the plotting hint QCP::phQueuedReplot is set, immediate otherwise
+                       };
+  Q_ENUMS(RefreshPriority)
   
   explicit QCustomPlot(QWidget *parent = 0);
   virtual ~QCustomPlot();
@@ -113,6 +123,10 @@ public:
   bool noAntialiasingOnDrag() const { return mNoAntialiasingOnDrag; }
   QCP::PlottingHints plottingHints() const { return mPlottingHints; }
   Qt::KeyboardModifier multiSelectModifier() const { return mMultiSelectModifier; }
+  int exportTileSize() const { return mExportTileSize; }
+  int draftPointBudget() const { return mDraftPointBudget; }
+  int refineDelay() const { return mRefineDelay; }
+  int polylineChunkSize() const { return mPolylineChunkSize; }
 
   // setters:
   void setTitle(const QString &title);
@@ -151,6 +165,10 @@ public:
   void setPlottingHints(const QCP::PlottingHints &hints);
   void setPlottingHint(QCP::PlottingHint hint, bool enabled=true);
   void setMultiSelectModifier(Qt::KeyboardModifier modifier);
+  void setExportTileSize(int pixels);
+  void setDraftPointBudget(int points);
+  void setRefineDelay(int msec);
+  void setPolylineChunkSize(int points);
   
   // non-property methods:
   // plottable interface:
@@ -205,14 +223,16 @@ public:
   bool saveJpg(const QString &fileName, int width=0, int height=0, double scale=1.0, int quality=-1);
   bool saveBmp(const QString &fileName, int width=0, int height=0, double scale=1.0);
   bool saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality=-1);
+  bool savePpm(const QString &fileName, int width=0, int height=0, double scale=1.0);
   QPixmap pixmap(int width=0, int height=0, double scale=1.0);
+  QImage toImage(int width=0, int height=0, double scale=1.0);
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
   
 public slots:
   void deselectAll();
-  void replot();
+  void replot(QCustomPlot::RefreshPriority priority=QCustomPlot::rpHint);
   void rescaleAxes();
   
 signals:
@@ -238,6 +258,15 @@ signals:
   void afterReplot();
   
 protected:
+  struct ScrollBuffer
+  {
+    QPixmap pixmap;
+    bool valid;
+    QRect axisRect;
+    QList<QCPLayerable*> layerables;
+    QList<QCPRange> axisRanges; // of xAxis, yAxis, xAxis2 and yAxis2 at the time the pixmap was rendered
+  };
+  
   QString mTitle;
   QFont mTitleFont, mSelectedTitleFont;
   QColor mTitleColor, mSelectedTitleColor;
@@ -268,11 +297,20 @@ protected:
   QPoint mDragStart;
   QCPRange mDragStartHorzRange, mDragStartVertRange;
   QPixmap mScaledAxisBackground;
-  bool mReplotting;
+  bool mReplotting, mReplotQueued, mDragReplotQueued;
+  QFutureWatcher<QImage> mAsyncFrameWatcher;
+  QPicture mPendingAsyncFrame;
+  bool mAsyncFramePending, mDropRunningAsyncFrame;
   QCP::AntialiasedElements mAADragBackup, mNotAADragBackup;
   QCPLayer *mCurrentLayer;
   QCP::PlottingHints mPlottingHints;
   Qt::KeyboardModifier mMultiSelectModifier;
+  int mExportTileSize;
+  int mDraftPointBudget, mRefineDelay;
+  int mPolylineChunkSize;
+  ScrollBuffer mScrollBuffer;
+  bool mDrafting;
+  QTimer mRefineTimer;
   
   // reimplemented methods:
   virtual QSize minimumSizeHint() const;
@@ -294,11 +332,32 @@ protected:
   virtual void drawAxisBackground(QCPPainter *painter);
   
   // helpers:
+  void updateLayout(QCPPainter *painter);
+  void drawExport(QCPPainter *painter, int width, int height, double scale);
+  void drawLayer(QCPPainter *painter, QCPLayer *layer);
+  void drawLayerParallel(QCPPainter *painter, QCPLayer *layer);
+  void drawLayerable(QCPPainter *painter, QCPLayerable *layerable);
+  static QImage renderLayerable(QCPLayerable *layerable, const QRect &rect, bool draft);
+  void drawTitle(QCPPainter *painter);
+  void compositeLayers(bool relayout);
+  void recordAsyncFrame();
+  void startAsyncFrame(const QPicture &frame);
+  bool dragReplot();
+  bool scrollable(QCPLayerable *layerable, QList<QCPAxis*> *usedAxes) const;
+  void updateScrollBuffer(const QList<QCPLayerable*> &layerables, const QList<QCPAxis*> &usedAxes);
+  void renderScrollBuffer(const QList<QCPLayerable*> &layerables, const QRect &region, bool restrictData);
+  int scrollOverhang(const QList<QCPLayerable*> &layerables) const;
+  void beginDraft();
   void updateAxisRect();
   bool selectTestTitle(const QPointF &pos) const;
   friend class QCPLegend;
   friend class QCPAxis;
   friend class QCPLayer;
+  
+protected slots:
+  void processQueuedReplot();
+  void asyncFrameFinished();
+  void refineReplot();
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCustomPlot::Interactions)
 
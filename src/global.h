@@ -31,6 +31,8 @@
 #include <QPaintEvent>
 #include <QMouseEvent>
 #include <QPixmap>
+#include <QPicture>
+#include <QFile>
 #include <QVector>
 #include <QString>
 #include <QPrinter>
@@ -41,6 +43,15 @@
 #include <QVector2D>
 #include <QStack>
 #include <QCache>
+#include <QBitArray>
+#include <QPointer>
+#include <QThread>
+#include <QMutex>
+#include <QTimer>
+#include <QtConcurrentRun>
+#include <QFutureSynchronizer>
+#include <QFutureWatcher>
+#include <QAtomicInt>
 #include <qmath.h>
 #include <limits>
 
@@ -122,6 +133,17 @@ enum PlottingHint { phNone            = 0x000 ///< <tt>0x000</tt> No hints are s
                     ,phForceRepaint   = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called. This is set by default
                                               ///<                on Windows-Systems to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phQueuedReplot   = 0x008 ///< <tt>0x008</tt> QCustomPlot::replot() only schedules a replot for the next event loop iteration. Multiple replot requests
+                                              ///<                until then are coalesced into a single replot (see QCustomPlot::RefreshPriority).
+                    ,phAsyncReplot    = 0x010 ///< <tt>0x010</tt> QCustomPlot::replot() records the drawing commands and rasterizes them on a worker thread. The finished frame is
+                                              ///<                shown when ready, frames made stale by newer replots are dropped (see QCustomPlot::replot).
+                    ,phParallelPlottables = 0x020 ///< <tt>0x020</tt> Consecutive plottables on a layer are drawn concurrently on worker threads into separate images, which are then
+                                              ///<                composited in layer order (see QCustomPlot::replot).
+                    ,phScrollOnDrag   = 0x040 ///< <tt>0x040</tt> While the user drags the axis ranges, the previous contents of the axis rect are shifted by the drag distance and
+                                              ///<                only the newly exposed strips are rendered (see QCustomPlot::dragReplot). Combined with
+                                              ///<                phQueuedReplot, the drag steps are coalesced.
+                    ,phCullScatters   = 0x080 ///< <tt>0x080</tt> Graphs and curves skip scatter symbols that would be drawn on the same pixel as a previous, opaque symbol of the
+                                              ///<                same plottable. This bounds the number of drawn symbols by the pixel count of the axis rect.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 } // end of namespace QCP
@@ -327,40 +327,42 @@ void QCPItemTracer::updatePosition()
   {
     if (mParentPlot->hasPlottable(mGraph))
     {
-      if (mGraph->data()->size() > 1)
+      QCPDataView data = mGraph->dataView();
+      if (data.size() > 1)
       {
-        QCPDataMap::const_iterator first = mGraph->data()->constBegin();
-        QCPDataMap::const_iterator last = mGraph->data()->constEnd()-1;
-        if (mGraphKey < first.key())
-          position->setCoords(first.key(), first.value().value);
-        else if (mGraphKey > last.key())
-          position->setCoords(last.key(), last.value().value);
+        int last = data.size()-1;
+        if (mGraphKey < data.key(0))
+          position->setCoords(data.key(0), data.value(0));
+        else if (mGraphKey > data.key(last))
+          position->setCoords(data.key(last), data.value(last));
         else
         {
-          QCPDataMap::const_iterator it = first;
-          it = mGraph->data()->lowerBound(mGraphKey);
-          if (it != first) // mGraphKey is somewhere between iterators
+          int index = data.lowerBound(mGraphKey);
+          if (index != 0) // mGraphKey is somewhere between data points
           {
-            QCPDataMap::const_iterator prevIt = it-1;
+            double prevKey = data.key(index-1);
+            double prevValue = data.value(index-1);
+            double nextKey = data.key(index);
+            double nextValue = data.value(index);
             if (mInterpolating)
             {
-              // interpolate between iterators around mGraphKey:
-              double slope = (it.value().value-prevIt.value().value)/(it.key()-prevIt.key());
-              position->setCoords(mGraphKey, (mGraphKey-prevIt.key())*slope+prevIt.value().value);
+              // interpolate between data points around mGraphKey:
+              double slope = (nextValue-prevValue)/(nextKey-prevKey);
+              position->setCoords(mGraphKey, (mGraphKey-prevKey)*slope+prevValue);
             } else
             {
-              // find iterator with key closest to mGraphKey:
-              if (mGraphKey < (prevIt.key()+it.key())*0.5)
-                it = prevIt;
-              position->setCoords(it.key(), it.value().value);
+              // find data point with key closest to mGraphKey:
+              if (mGraphKey < (prevKey+nextKey)*0.5)
+                position->setCoords(prevKey, prevValue);
+              else
+                position->setCoords(nextKey, nextValue);
             }
-          } else // mGraphKey is exactly on first iterator
-            position->setCoords(it.key(), it.value().value);
+          } else // mGraphKey is exactly on first data point
+            position->setCoords(data.key(0), data.value(0));
         }
-      } else if (mGraph->data()->size() == 1)
+      } else if (data.size() == 1)
       {
-        QCPDataMap::const_iterator it = mGraph->data()->constBegin();
-        position->setCoords(it.key(), it.value().value);
+        position->setCoords(data.key(0), data.value(0));
       } else
         qDebug() << Q_FUNC_INFO << "graph has no data";
     } else
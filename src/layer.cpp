@@ -69,6 +69,27 @@
   
   When a layer is deleted, the objects on it are not deleted with it, but fall on the layer below
   the deleted layer, see QCustomPlot::removeLayer.
+  
+  \section layerbuffering Buffered layers
+  
+  By default, layers are logical (\ref lmLogical): They only control the rendering order, and all
+  layerables on them are drawn anew on every QCustomPlot::replot. If a layer is set to \ref
+  lmBuffered with \ref setMode, it renders its layerables into an own offscreen buffer instead. The
+  buffer is then composited onto the plot at the layer's position in the rendering order.
+  
+  A QCustomPlot::replot invalidates the buffers of all layers, because it may change axis ranges,
+  margins etc. However, a buffered layer can be replotted individually with \ref replot. Only that
+  layer's buffer (and any other buffer that was invalidated, see \ref invalidateBuffer) is then
+  rendered, all other buffered layers are just composited again. This is useful for objects that
+  change often while the rest of the plot stays the same, for example a tracer item following the
+  mouse cursor: Place the tracer on a buffered layer on top, place the expensive graphs on a
+  buffered layer, too (e.g. set the "main" layer to \ref lmBuffered), and call \ref replot of the
+  tracer's layer when moving it. The cost of moving the tracer then is mostly the cost of a few
+  pixmap blits, independent of the number and size of the graphs.
+  
+  Layerables on logical layers are still drawn at every (full or layer) replot, so expensive objects
+  should reside on buffered layers when using layer replots. Buffered layers need memory for a
+  pixmap the size of the QCustomPlot widget each.
 */
 
 /* start documentation of inline functions */
@@ -79,6 +100,13 @@
   i.e. layerables with higher indices are drawn above layerables with lower indices.
 */
 
+/*! \fn LayerMode QCPLayer::mode() const
+  
+  Returns whether this layer is drawn directly or via an own buffer.
+  
+  \see setMode
+*/
+
 /* end documentation of inline functions */
 
 /*!
@@ -91,7 +119,9 @@
 */
 QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mParentPlot(parentPlot),
-  mName(layerName)
+  mName(layerName),
+  mMode(lmLogical),
+  mBufferValid(false)
 {
   // Note: no need to make sure layerName doesn't already, because layer
   // management is done with QCustomPlot functions.
@@ -112,6 +142,74 @@ int QCPLayer::index() const
   return mParentPlot->mLayers.indexOf(const_cast<QCPLayer*>(this));
 }
 
+/*!
+  Sets whether this layer renders its layerables into an own buffer (\ref lmBuffered) or whether
+  they are drawn directly onto the plot at every replot (\ref lmLogical).
+  
+  Only buffered layers can be replotted individually with \ref replot. See the \ref
+  layerbuffering "class documentation" for details.
+  
+  Switching the mode invalidates the buffer, so the layer is rendered at the next replot. Switching
+  to \ref lmLogical releases the memory of the buffer.
+*/
+void QCPLayer::setMode(LayerMode mode)
+{
+  if (mMode != mode)
+  {
+    mMode = mode;
+    if (mMode == lmLogical)
+      mBuffer = QPixmap();
+    mBufferValid = false;
+  }
+}
+
+/*!
+  Marks the buffer of this layer as outdated, so it is rendered again at the next replot of this
+  or any other buffered layer (see \ref replot). A full QCustomPlot::replot invalidates the buffers
+  of all layers anyway.
+  
+  The buffer is invalidated automatically when layerables are added to or removed from the layer.
+  When changing properties of a layerable (e.g. the position of an item) and then calling \ref
+  replot on a different layer than the one of the layerable, call this function on the
+  layerable's layer before.
+  
+  For logical layers (\ref lmLogical), this function does nothing.
+*/
+void QCPLayer::invalidateBuffer()
+{
+  mBufferValid = false;
+}
+
+/*!
+  Replots only this layer, if it is a buffered layer (\ref lmBuffered). Its buffer is rendered
+  again, and then composited with the unchanged buffers of the other buffered layers and the
+  layerables of the logical layers into the plot's paint buffer. Finally, the widget surface is
+  updated.
+  
+  Since the axis ranges, tick vectors and margins are not recalculated, this must only be used for
+  changes that don't affect other layers, for example moving an item on this layer. Unlike
+  QCustomPlot::replot, this function doesn't emit QCustomPlot::beforeReplot and
+  QCustomPlot::afterReplot.
+  
+  If this layer is a logical layer (\ref lmLogical), or the plotting hint QCP::phAsyncReplot is set
+  (in which case layer buffers aren't used), this performs a full QCustomPlot::replot.
+  
+  \see setMode, invalidateBuffer
+*/
+void QCPLayer::replot()
+{
+  if (mMode == lmBuffered && !mParentPlot->plottingHints().testFlag(QCP::phAsyncReplot))
+  {
+    mBufferValid = false;
+    if (!mParentPlot->mReplotting) // if a replot is in progress, it renders this layer anyway
+    {
+      mParentPlot->mScrollBuffer.valid = false;
+      mParentPlot->compositeLayers(false);
+    }
+  } else
+    mParentPlot->replot();
+}
+
 /*! \internal
   
   Adds the \a layerable to the list of this layer. If \a prepend is set to true, the layerable will
@@ -130,6 +228,7 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
       mChildren.prepend(layerable);
     else
       mChildren.append(layerable);
+    mBufferValid = false;
   } else
     qDebug() << Q_FUNC_INFO << "layerable is already child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
@@ -145,7 +244,9 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
 */
 void QCPLayer::removeChild(QCPLayerable *layerable)
 {
-  if (!mChildren.removeOne(layerable))
+  if (mChildren.removeOne(layerable))
+    mBufferValid = false;
+  else
     qDebug() << Q_FUNC_INFO << "layerable is not child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
 
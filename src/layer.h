@@ -34,6 +34,15 @@ class QCPLayerable;
 class QCP_LIB_DECL QCPLayer
 {
 public:
+  /*!
+    Defines how the contents of a layer are rendered when the QCustomPlot is replotted.
+    
+    \see setMode
+  */
+  enum LayerMode { lmLogical   ///< Layer only controls the rendering order, its layerables are drawn directly on the plot's paint buffer at every replot
+                   ,lmBuffered ///< Layer has its own render buffer, which is only redrawn when it was invalidated. Allows replotting the layer individually with \ref replot
+                 };
+  
   QCPLayer(QCustomPlot* parentPlot, const QString &layerName);
   ~QCPLayer();
   
@@ -42,11 +51,23 @@ public:
   QString name() const { return mName; }
   int index() const;
   QList<QCPLayerable*> children() const { return mChildren; }
+  LayerMode mode() const { return mMode; }
+  
+  // setters:
+  void setMode(LayerMode mode);
+  
+  // non-property methods:
+  void invalidateBuffer();
+  void replot();
   
 protected:
   QCustomPlot *mParentPlot;
   QString mName;
   QList<QCPLayerable*> mChildren;
+  LayerMode mMode;
+  // non-property members:
+  QPixmap mBuffer;
+  bool mBufferValid;
   
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
@@ -54,6 +75,7 @@ protected:
 private:
   Q_DISABLE_COPY(QCPLayer)
   
+  friend class QCustomPlot;
   friend class QCPLayerable;
 };
 
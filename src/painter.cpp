@@ -48,7 +48,9 @@ QCPPainter::QCPPainter() :
   QPainter(),
   mScaledExportMode(false),
   mPdfExportMode(false),
-  mIsAntialiasing(false)
+  mDraftMode(false),
+  mIsAntialiasing(false),
+  mCurrentScatterStamp(-1)
 {
 }
 
@@ -60,7 +62,9 @@ QCPPainter::QCPPainter(QPaintDevice *device) :
   QPainter(device),
   mScaledExportMode(false),
   mPdfExportMode(false),
-  mIsAntialiasing(false)
+  mDraftMode(false),
+  mIsAntialiasing(false),
+  mCurrentScatterStamp(-1)
 {
 }
 
@@ -133,6 +137,27 @@ void QCPPainter::drawLine(const QLineF &line)
     QPainter::drawLine(line.toLine());
 }
 
+/*! \overload
+  
+  Draws all \a lines with one call, applying the same workaround as \ref drawLine when
+  antialiasing is disabled.
+  
+  \note this function hides the non-virtual base class implementation.
+*/
+void QCPPainter::drawLines(const QVector<QLineF> &lines)
+{
+  if (mIsAntialiasing)
+  {
+    QPainter::drawLines(lines);
+  } else
+  {
+    QVector<QLine> roundedLines(lines.size());
+    for (int i=0; i<lines.size(); ++i)
+      roundedLines[i] = lines.at(i).toLine();
+    QPainter::drawLines(roundedLines);
+  }
+}
+
 /*! 
   Sets whether painting uses antialiasing or not. Use this method instead of using setRenderHint
   with QPainter::Antialiasing directly, as it allows QCPPainter to regain pixel exactness between
@@ -210,6 +235,35 @@ void QCPPainter::setScaledExportMode(bool enabled)
   mScaledExportMode = enabled;
 }
 
+/*!
+  Sets whether the painter is used to draw an intermediate frame during a user interaction, such
+  as dragging or zooming an axis range.
+
+  Plottables may then reduce their level of detail to keep the interaction responsive, see \ref
+  QCustomPlot::setDraftPointBudget. QCustomPlot sets this mode itself where appropriate; painters
+  used for exporting never are in draft mode.
+*/
+void QCPPainter::setDraftMode(bool enabled)
+{
+  mDraftMode = enabled;
+}
+
+/*!
+  Sets the \a region (in the coordinates the layerables draw in) that is actually rendered with
+  this painter, including a margin for scatter symbols and pen widths of data points just outside
+  of it. Plottables may then skip generating the geometry of data points outside of \a region.
+
+  QCustomPlot sets this when it renders only a narrow strip of the axis rect, see
+  QCP::phScrollOnDrag. The default is a null rect, meaning the whole axis rect is rendered.
+
+  Unlike a clip rect, this doesn't limit the drawing itself, so the painter should additionally be
+  clipped to the region.
+*/
+void QCPPainter::setDataRegion(const QRectF &region)
+{
+  mDataRegion = region;
+}
+
 /*!
   Provides a workaround for a QPainter bug that prevents scaling of pen widths for pens with width
   0, although the QPainter::NonCosmeticDefaultPen render hint is set.
@@ -233,8 +287,333 @@ void QCPPainter::fixScaledPen()
   
   If the \a style is ssPixmap, make sure to pass the respective pixmap with \ref setScatterPixmap before calling
   this function.
+  
+  When painting on a raster paint device, the symbols are drawn as pre-rendered stamps (see \ref drawScatterStamp).
 */
 void QCPPainter::drawScatter(double x, double y, double size, QCP::ScatterStyle style)
+{
+  if (scatterStampUsable(size, style))
+    drawScatterStamp(x, y, size, style);
+  else
+    drawScatterShape(x, y, size, style);
+}
+
+/*!
+  Draws scatter symbols with the specified \a style and \a size in pixels at all pixel positions
+  in \a points. The result is the same as calling \ref drawScatter for each point.
+  
+  When exporting to a vector format such as PDF, the symbols of all points are combined into one
+  painter path, which is drawn at once. The paint engine then emits a single path object instead
+  of one per symbol, which reduces export time and file size considerably for many points.
+  
+  Unlike \ref drawScatter, this leaves the brush of the painter unchanged.
+*/
+void QCPPainter::drawScatters(const QVector<QPointF> &points, double size, QCP::ScatterStyle style)
+{
+  if (points.isEmpty() || style == QCP::ssNone)
+    return;
+  const QBrush oldBrush = brush();
+  if (!vectorExport() || style == QCP::ssPixmap)
+  {
+    for (int i=0; i<points.size(); ++i)
+      drawScatter(points.at(i).x(), points.at(i).y(), size, style);
+  } else if (style == QCP::ssDot)
+  {
+    drawPoints(points.constData(), points.size());
+  } else
+  {
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill); // overlapping discs mustn't cancel each other out
+    for (int i=0; i<points.size(); ++i)
+      addScatterShape(&path, points.at(i).x(), points.at(i).y(), size, style);
+    setBrush(style == QCP::ssDisc ? QBrush(pen().color()) : QBrush(Qt::NoBrush));
+    drawPath(path);
+  }
+  setBrush(oldBrush);
+}
+
+/*! \internal
+  
+  Returns \a end moved away from \a from by \a distance, i.e. the end point of the segment from \a
+  from to \a end, when the segment is extended by \a distance. Used by \ref drawPolylineChunked to
+  emulate square caps.
+*/
+static QPointF qcpExtendSegment(const QPointF &from, const QPointF &end, double distance)
+{
+  QPointF dir = end-from;
+  double length = qSqrt(dir.x()*dir.x()+dir.y()*dir.y());
+  if (length == 0)
+    return end;
+  return end+dir*(distance/length);
+}
+
+/*! \internal
+  
+  Adds a half disc with the given \a radius to \a path, centered on \a end and facing away from \a
+  from. Used by \ref drawPolylineChunked to emulate round caps.
+*/
+static void qcpAddRoundCap(QPainterPath *path, const QPointF &from, const QPointF &end, double radius)
+{
+  QPointF dir = end-from;
+  if (dir.x() == 0 && dir.y() == 0)
+    return;
+  double angle = qAtan2(-dir.y(), dir.x())/M_PI*180.0; // counter-clockwise on screen, like QPainterPath::arcTo
+  path->moveTo(end);
+  path->arcTo(QRectF(end.x()-radius, end.y()-radius, 2*radius, 2*radius), angle-90, 180);
+  path->closeSubpath();
+}
+
+/*!
+  Draws the polyline through \a points like QPainter::drawPolyline, but submits it in chunks of at
+  most \a chunkSize points. The cost of stroking a polyline grows faster than linearly with the
+  number of points (especially for antialiased, wide or dashed pens), so drawing very long
+  polylines in chunks is considerably faster.
+  
+  Each chunk ends in the middle of the segment following its last point, where the next chunk
+  starts. So all joins are drawn by one chunk, and the chunks abut on a straight segment without
+  overlapping, with a flat cap at both sides. Every pixel is thus painted once, which keeps
+  antialiased edges intact. The caps at the two ends of the polyline are emulated: Square caps by
+  extending the first and last segment by half the pen width, round caps by adding half discs.
+  Dashed pens continue their dash offset across chunk boundaries. Their dashes are drawn with a flat
+  cap, too, a square cap is emulated by lengthening the dashes of the pattern by one pen width and
+  shortening the gaps accordingly.
+  
+  The polyline is drawn at once if it has at most \a chunkSize points, if \a chunkSize is smaller
+  than 3 or if the painter is in PDF export mode. This is also the case for cosmetic pens, whose
+  stroking cost is linear anyway, for dashed pens with round caps or with gaps narrower than the
+  square caps, and if the seams between the chunks could be visible, i.e. for pens that aren't
+  opaque, a painter opacity below one or composition modes other than SourceOver.
+  
+  If \a chunkSize is negative, the chunk size is chosen for the current pen, see \ref
+  autoPolylineChunkSize.
+  
+  \see QCustomPlot::setPolylineChunkSize
+*/
+void QCPPainter::drawPolylineChunked(const QVector<QPointF> &points, int chunkSize)
+{
+  const int count = points.size();
+  const QPen originalPen = pen();
+  if (chunkSize < 0)
+    chunkSize = autoPolylineChunkSize(originalPen);
+  const bool solid = originalPen.style() == Qt::SolidLine;
+  const Qt::PenCapStyle capStyle = originalPen.capStyle();
+  QVector<qreal> dashPattern;
+  if (!solid && capStyle == Qt::SquareCap)
+  {
+    // a square cap adds half a pen width to both ends of every dash:
+    dashPattern = originalPen.dashPattern();
+    for (int i=0; i<dashPattern.size(); ++i)
+    {
+      dashPattern[i] += i%2 == 0 ? 1 : -1;
+      if (dashPattern.at(i) < 0)
+      {
+        dashPattern.clear(); // the square caps of neighbouring dashes overlap, can't be emulated
+        chunkSize = 0;
+        break;
+      }
+    }
+  }
+  if (chunkSize < 3 || count <= chunkSize || mPdfExportMode || originalPen.isCosmetic() || (!solid && capStyle == Qt::RoundCap) ||
+      !originalPen.brush().isOpaque() || opacity() < 1 || compositionMode() != QPainter::CompositionMode_SourceOver)
+  {
+    drawPolyline(points.constData(), count);
+    return;
+  }
+  
+  const double halfWidth = originalPen.widthF()*0.5;
+  QPen chunkPen = originalPen;
+  chunkPen.setCapStyle(Qt::FlatCap);
+  if (!dashPattern.isEmpty())
+    chunkPen.setDashPattern(dashPattern);
+  double length = 0; // length of the drawn polyline up to the first point of the current chunk, for the dash offset
+  QVector<QPointF> chunk;
+  chunk.reserve(chunkSize);
+  QPointF chunkStart = capStyle == Qt::SquareCap ? qcpExtendSegment(points.at(1), points.at(0), halfWidth) : points.at(0);
+  int first = 1; // index of the first original point after chunkStart
+  while (true)
+  {
+    int last = qMin(first+chunkSize-3, count-1);
+    while (last < count-1 && points.at(last) == points.at(last+1)) // don't end a chunk on a segment without direction
+      ++last;
+    chunk.resize(0);
+    chunk.append(chunkStart);
+    for (int i=first; i<=last; ++i)
+      chunk.append(points.at(i));
+    if (last < count-1)
+      chunk.append((points.at(last)+points.at(last+1))*0.5);
+    else if (capStyle == Qt::SquareCap)
+      chunk.last() = qcpExtendSegment(points.at(count-2), points.at(count-1), halfWidth);
+    if (!solid)
+      chunkPen.setDashOffset(originalPen.dashOffset()+length/originalPen.widthF()); // dash patterns are in units of the pen width
+    setPen(chunkPen);
+    drawPolyline(chunk.constData(), chunk.size());
+    if (last == count-1)
+      break;
+    if (!solid)
+    {
+      for (int i=1; i<chunk.size(); ++i)
+        length += QLineF(chunk.at(i-1), chunk.at(i)).length();
+    }
+    chunkStart = chunk.last();
+    first = last+1;
+  }
+  setPen(originalPen);
+  
+  if (solid && capStyle == Qt::RoundCap)
+  {
+    QPainterPath caps;
+    qcpAddRoundCap(&caps, points.at(1), points.at(0), halfWidth);
+    qcpAddRoundCap(&caps, points.at(count-2), points.at(count-1), halfWidth);
+    const QBrush oldBrush = brush();
+    setPen(Qt::NoPen);
+    setBrush(originalPen.brush());
+    drawPath(caps);
+    setBrush(oldBrush);
+    setPen(originalPen);
+  }
+}
+
+/*! \internal
+  
+  Returns the chunk size \ref drawPolylineChunked uses for polylines drawn with \a pen, if no
+  chunk size is specified. The value depends on the pen class. The values below are estimates
+  derived from how the raster engine strokes each class, they haven't been tuned by measurement
+  yet. The benchmark QCPGraph_ChunkedPolyline (tests/benchmark) compares them with fixed chunk
+  sizes for each class:
+  
+  \li Thin solid pens (width of at most one) are drawn by the cosmetic stroker of the raster
+  engine, or nearly as cheaply, so their cost is linear in the number of points. They aren't
+  chunked (returns 0).
+  \li Wide solid pens are stroked into an outline which is then filled. This gets expensive for
+  long polylines, chunks of 200 points keep it cheap without submitting too many small chunks.
+  \li Dashed pens create a separate subpath for every dash, so the outlines grow faster with the
+  number of points. They use smaller chunks of 100 points.
+*/
+int QCPPainter::autoPolylineChunkSize(const QPen &pen) const
+{
+  if (pen.style() != Qt::SolidLine)
+    return 100;
+  else if (pen.widthF() > 1)
+    return 200;
+  else
+    return 0;
+}
+
+/*! \internal
+  
+  Returns whether the painter is used for exporting to a vector format, like PDF (see \ref
+  setPdfExportMode) or PostScript. Scatters are then batched by \ref drawScatters.
+*/
+bool QCPPainter::vectorExport() const
+{
+  if (mPdfExportMode)
+    return true;
+  if (!paintEngine())
+    return false;
+  QPaintEngine::Type type = paintEngine()->type();
+  return type == QPaintEngine::Pdf || type == QPaintEngine::PostScript || type == QPaintEngine::SVG || type == QPaintEngine::MacPrinter;
+}
+
+/*! \internal
+  
+  Returns whether a scatter of the given \a size and \a style may be drawn by \ref
+  drawScatterStamp. This is the case for the vector shaped scatter styles of moderate size, when
+  painting on a raster paint engine without a transformation other than a translation. PDF export,
+  scaled export, QPicture recording and other paint engines use the vector path.
+*/
+bool QCPPainter::scatterStampUsable(double size, QCP::ScatterStyle style) const
+{
+  if (style == QCP::ssNone || style == QCP::ssDot || style == QCP::ssPixmap)
+    return false;
+  if (mPdfExportMode || size > 64)
+    return false;
+  if (!paintEngine() || paintEngine()->type() != QPaintEngine::Raster)
+    return false;
+  return transform().type() <= QTransform::TxTranslate && compositionMode() == QPainter::CompositionMode_SourceOver;
+}
+
+/*! \internal
+  
+  Draws the scatter like \ref drawScatterShape, but by drawing a pre-rendered image (stamp) of the
+  scatter symbol. Stamps are rendered once per combination of scatter style, size, pen,
+  antialiasing and sub-pixel translation, with a separate image for every quarter pixel offset of
+  the symbol center, and are kept for the lifetime of the painter. For plots with many scatters,
+  this is a lot faster than stroking each symbol.
+  
+  Non-antialiased symbols are placed exactly like the vector path places them (for symbol sizes
+  that are multiples of 0.5 pixels), antialiased ones with quarter pixel precision.
+  
+  \see scatterStampUsable
+*/
+void QCPPainter::drawScatterStamp(double x, double y, double size, QCP::ScatterStyle style)
+{
+  const QTransform &t = transform();
+  QPointF translation(t.dx()-floor(t.dx()), t.dy()-floor(t.dy()));
+  
+  // find the stamp for the current painter state, starting with the one used last:
+  if (mCurrentScatterStamp < 0 || mScatterStamps.at(mCurrentScatterStamp).style != style || mScatterStamps.at(mCurrentScatterStamp).size != size ||
+      mScatterStamps.at(mCurrentScatterStamp).antialiasing != mIsAntialiasing || mScatterStamps.at(mCurrentScatterStamp).translation != translation ||
+      mScatterStamps.at(mCurrentScatterStamp).pen != pen())
+  {
+    mCurrentScatterStamp = -1;
+    for (int i=0; i<mScatterStamps.size(); ++i)
+    {
+      const ScatterStamp &stamp = mScatterStamps.at(i);
+      if (stamp.style == style && stamp.size == size && stamp.antialiasing == mIsAntialiasing && stamp.translation == translation && stamp.pen == pen())
+      {
+        mCurrentScatterStamp = i;
+        break;
+      }
+    }
+    if (mCurrentScatterStamp < 0)
+    {
+      if (mScatterStamps.size() >= 8) // painter states usually alternate between few stamps, drop the oldest one
+        mScatterStamps.removeFirst();
+      ScatterStamp stamp;
+      stamp.style = style;
+      stamp.size = size;
+      stamp.pen = pen();
+      stamp.antialiasing = mIsAntialiasing;
+      stamp.translation = translation;
+      stamp.center = qCeil(size/2.0+qMax(1.0, pen().widthF())+2);
+      mScatterStamps.append(stamp);
+      mCurrentScatterStamp = mScatterStamps.size()-1;
+    }
+  }
+  ScatterStamp &stamp = mScatterStamps[mCurrentScatterStamp];
+  
+  // split the position into whole pixels and a quarter pixel offset (rounded for antialiased
+  // symbols, truncated for non-antialiased ones, so the rounding of drawLine is reproduced):
+  double ix = floor(x);
+  double iy = floor(y);
+  int qx = int((x-ix)*4+(mIsAntialiasing ? 0.5 : 0));
+  int qy = int((y-iy)*4+(mIsAntialiasing ? 0.5 : 0));
+  if (qx > 3) { ix += 1; qx = 0; }
+  if (qy > 3) { iy += 1; qy = 0; }
+  
+  QImage &image = stamp.images[4*qy+qx];
+  if (image.isNull())
+  {
+    image = QImage(2*stamp.center+2, 2*stamp.center+2, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+    QCPPainter stampPainter(&image);
+    stampPainter.setRenderHints(renderHints());
+    stampPainter.mIsAntialiasing = mIsAntialiasing;
+    stampPainter.translate(translation);
+    stampPainter.QPainter::setPen(stamp.pen);
+    stampPainter.drawScatterShape(stamp.center+qx*0.25, stamp.center+qy*0.25, size, style);
+  }
+  // ix-center-translation maps to a whole device pixel, so the image is drawn without resampling:
+  drawImage(QPointF(ix-stamp.center-translation.x(), iy-stamp.center-translation.y()), image);
+}
+
+/*! \internal
+  
+  Draws the scatter symbol of the given \a size and \a style at \a x and \a y by stroking its
+  vector shape with the current pen. This is the path used by \ref drawScatter where stamps
+  aren't usable (see \ref drawScatterStamp).
+*/
+void QCPPainter::drawScatterShape(double x, double y, double size, QCP::ScatterStyle style)
 {
   double w = size/2.0;
   switch (style)
@@ -355,3 +734,133 @@ void QCPPainter::drawScatter(double x, double y, double size, QCP::ScatterStyle
     }
   }
 }
+
+/*! \internal
+  
+  Adds the vector shape of a scatter symbol of the given \a size and \a style at \a x and \a y
+  to \a path, matching the shape drawn by \ref drawScatterShape. Used by \ref drawScatters to
+  combine many symbols into one path. Only vector shaped styles are supported, i.e. not
+  QCP::ssNone, QCP::ssDot and QCP::ssPixmap.
+*/
+void QCPPainter::addScatterShape(QPainterPath *path, double x, double y, double size, QCP::ScatterStyle style) const
+{
+  double w = size/2.0;
+  switch (style)
+  {
+    case QCP::ssCross:
+    {
+      path->moveTo(x-w, y-w);
+      path->lineTo(x+w, y+w);
+      path->moveTo(x-w, y+w);
+      path->lineTo(x+w, y-w);
+      break;
+    }
+    case QCP::ssPlus:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x+w, y);
+      path->moveTo(x, y+w);
+      path->lineTo(x, y-w);
+      break;
+    }
+    case QCP::ssCircle:
+    case QCP::ssDisc:
+    {
+      path->addEllipse(QPointF(x, y), w, w);
+      break;
+    }
+    case QCP::ssSquare:
+    {
+      path->addRect(QRectF(x-w, y-w, size, size));
+      break;
+    }
+    case QCP::ssDiamond:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x, y-w);
+      path->lineTo(x+w, y);
+      path->lineTo(x, y+w);
+      path->closeSubpath();
+      break;
+    }
+    case QCP::ssStar:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x+w, y);
+      path->moveTo(x, y+w);
+      path->lineTo(x, y-w);
+      path->moveTo(x-w*0.707, y-w*0.707);
+      path->lineTo(x+w*0.707, y+w*0.707);
+      path->moveTo(x-w*0.707, y+w*0.707);
+      path->lineTo(x+w*0.707, y-w*0.707);
+      break;
+    }
+    case QCP::ssTriangle:
+    {
+      path->moveTo(x-w, y+0.755*w);
+      path->lineTo(x+w, y+0.755*w);
+      path->lineTo(x, y-0.977*w);
+      path->closeSubpath();
+      break;
+    }
+    case QCP::ssTriangleInverted:
+    {
+      path->moveTo(x-w, y-0.755*w);
+      path->lineTo(x+w, y-0.755*w);
+      path->lineTo(x, y+0.977*w);
+      path->closeSubpath();
+      break;
+    }
+    case QCP::ssCrossSquare:
+    {
+      path->moveTo(x-w, y-w);
+      path->lineTo(x+w*0.95, y+w*0.95);
+      path->moveTo(x-w, y+w*0.95);
+      path->lineTo(x+w*0.95, y-w);
+      path->addRect(QRectF(x-w, y-w, size, size));
+      break;
+    }
+    case QCP::ssPlusSquare:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x+w*0.95, y);
+      path->moveTo(x, y+w);
+      path->lineTo(x, y-w);
+      path->addRect(QRectF(x-w, y-w, size, size));
+      break;
+    }
+    case QCP::ssCrossCircle:
+    {
+      path->moveTo(x-w*0.707, y-w*0.707);
+      path->lineTo(x+w*0.67, y+w*0.67);
+      path->moveTo(x-w*0.707, y+w*0.67);
+      path->lineTo(x+w*0.67, y-w*0.707);
+      path->addEllipse(QPointF(x, y), w, w);
+      break;
+    }
+    case QCP::ssPlusCircle:
+    {
+      path->moveTo(x-w, y);
+      path->lineTo(x+w, y);
+      path->moveTo(x, y+w);
+      path->lineTo(x, y-w);
+      path->addEllipse(QPointF(x, y), w, w);
+      break;
+    }
+    case QCP::ssPeace:
+    {
+      path->moveTo(x, y-w);
+      path->lineTo(x, y+w);
+      path->moveTo(x, y);
+      path->lineTo(x-w*0.707, y+w*0.707);
+      path->moveTo(x, y);
+      path->lineTo(x+w*0.707, y+w*0.707);
+      path->addEllipse(QPointF(x, y), w, w);
+      break;
+    }
+    case QCP::ssNone:
+    case QCP::ssDot:
+    case QCP::ssPixmap:
+      break;
+  }
+}
@@ -50,12 +50,16 @@ public:
   bool antialiasing() const { return testRenderHint(QPainter::Antialiasing); }
   bool pdfExportMode() const { return mPdfExportMode; }
   bool scaledExportMode() const { return mScaledExportMode; }
+  bool draftMode() const { return mDraftMode; }
+  QRectF dataRegion() const { return mDataRegion; }
   
   // setters:
   void setScatterPixmap(const QPixmap pm);
   void setAntialiasing(bool enabled);
   void setPdfExportMode(bool enabled);
   void setScaledExportMode(bool enabled);
+  void setDraftMode(bool enabled);
+  void setDataRegion(const QRectF &region);
  
   // methods hiding non-virtual base class functions (QPainter bug workarounds):
   void setPen(const QPen &pen);
@@ -63,19 +67,45 @@ public:
   void setPen(Qt::PenStyle penStyle);
   void drawLine(const QLineF &line);
   void drawLine(const QPointF &p1, const QPointF &p2) {drawLine(QLineF(p1, p2));}
+  void drawLines(const QVector<QLineF> &lines);
+  void drawLines(const QVector<QPointF> &pointPairs) {QPainter::drawLines(pointPairs);}
   void save();
   void restore();
 
   // helpers:
   void fixScaledPen();
   void drawScatter(double x, double y, double size, QCP::ScatterStyle style);
+  void drawScatters(const QVector<QPointF> &points, double size, QCP::ScatterStyle style);
+  void drawPolylineChunked(const QVector<QPointF> &points, int chunkSize);
   
 protected:
+  struct ScatterStamp
+  {
+    QCP::ScatterStyle style;
+    double size;
+    QPen pen;
+    bool antialiasing;
+    QPointF translation; // sub-pixel part of the painter translation the stamps were rendered for
+    int center; // offset of the symbol center from the top left of the images
+    QImage images[16]; // rendered on demand, indexed by the quarter pixel offset of the symbol center (4*y+x)
+  };
+  
   QPixmap mScatterPixmap;
   bool mScaledExportMode;
   bool mPdfExportMode;
+  bool mDraftMode;
+  QRectF mDataRegion;
   bool mIsAntialiasing;
   QStack<bool> mAntialiasingStack;
+  QList<ScatterStamp> mScatterStamps;
+  int mCurrentScatterStamp;
+  
+  bool scatterStampUsable(double size, QCP::ScatterStyle style) const;
+  void drawScatterStamp(double x, double y, double size, QCP::ScatterStyle style);
+  void drawScatterShape(double x, double y, double size, QCP::ScatterStyle style);
+  void addScatterShape(QPainterPath *path, double x, double y, double size, QCP::ScatterStyle style) const;
+  bool vectorExport() const;
+  int autoPolylineChunkSize(const QPen &pen) const;
 };
 
 #endif // QCP_PAINTER_H
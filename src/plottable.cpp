@@ -649,6 +649,46 @@ void QCPAbstractPlottable::applyErrorBarsAntialiasingHint(QCPPainter *painter) c
   applyAntialiasingHint(painter, mAntialiasedErrorBars, QCP::aeErrorBars);
 }
 
+/*! \internal
+
+  Returns whether scatter symbols of the given \a style (and \a scatterPixmap, if the style is
+  QCP::ssPixmap) may be culled with \ref cullScatter. This is the case if the plotting hint
+  QCP::phCullScatters is set and the symbols are opaque, so a symbol drawn on top of an identical
+  one doesn't change the result.
+  
+  \see cullScatter
+*/
+bool QCPAbstractPlottable::scatterCullingUsable(QCP::ScatterStyle style, const QPixmap &scatterPixmap) const
+{
+  if (!mParentPlot->plottingHints().testFlag(QCP::phCullScatters))
+    return false;
+  if (style == QCP::ssPixmap)
+    return !scatterPixmap.hasAlphaChannel();
+  return mainPen().color().alpha() == 255;
+}
+
+/*! \internal
+
+  Returns true if a scatter symbol at the pixel position \a x, \a y may be skipped, because a
+  symbol was already drawn on that pixel. Otherwise marks the pixel as occupied and returns false.
+  
+  \a occupancy holds one bit for every pixel of \a rect, which is usually the clip rect of the
+  plottable. It must be initialized with rect.width()*rect.height() cleared bits before the first
+  symbol. Symbols outside \a rect are never skipped.
+  
+  \see scatterCullingUsable
+*/
+bool QCPAbstractPlottable::cullScatter(QBitArray &occupancy, const QRect &rect, double x, double y) const
+{
+  if (!(x >= rect.left() && y >= rect.top() && x < rect.left()+rect.width() && y < rect.top()+rect.height())) // also catches NaN
+    return false;
+  int index = int(x-rect.left()) + int(y-rect.top())*rect.width();
+  if (occupancy.testBit(index))
+    return true;
+  occupancy.setBit(index);
+  return false;
+}
+
 /*! \internal
 
   Finds the shortest squared distance of \a point to the line segment defined by \a start and \a
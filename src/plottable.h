@@ -112,6 +112,10 @@ protected:
   void applyScattersAntialiasingHint(QCPPainter *painter) const;
   void applyErrorBarsAntialiasingHint(QCPPainter *painter) const;
   
+  // scatter culling helpers:
+  bool scatterCullingUsable(QCP::ScatterStyle style, const QPixmap &scatterPixmap) const;
+  bool cullScatter(QBitArray &occupancy, const QRect &rect, double x, double y) const;
+  
   // selection test helpers:
   double distSqrToLine(const QPointF &start, const QPointF &end, const QPointF &point) const;
 
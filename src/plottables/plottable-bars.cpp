@@ -387,11 +387,11 @@ void QCPBars::draw(QCPPainter *painter)
 {
   if (mData->isEmpty()) return;
   
-  QCPBarDataMap::const_iterator it;
-  for (it = mData->constBegin(); it != mData->constEnd(); ++it)
+  // only visit bars that reach into the visible key range, found by binary search in the sorted map:
+  QCPBarDataMap::const_iterator it = mData->lowerBound(mKeyAxis->range().lower-mWidth*0.5);
+  QCPBarDataMap::const_iterator itEnd = mData->upperBound(mKeyAxis->range().upper+mWidth*0.5);
+  for (; it != itEnd; ++it)
   {
-    if (it.key()+mWidth*0.5 < mKeyAxis->range().lower || it.key()-mWidth*0.5 > mKeyAxis->range().upper)
-      continue;
     QPolygonF barPolygon = getBarPolygon(it.key(), it.value().value);
     // draw bar fill:
     if (mainBrush().style() != Qt::NoBrush && mainBrush().color().alpha() != 0)
@@ -395,8 +395,13 @@ void QCPCurve::draw(QCPPainter *painter)
     applyDefaultAntialiasingHint(painter);
     painter->setPen(mainPen());
     painter->setBrush(Qt::NoBrush);
-    // if drawing solid line and not in PDF, use much faster line drawing instead of polyline:
-    if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
+    // draw long lines in chunks (see QCustomPlot::setPolylineChunkSize), or if drawing solid line
+    // and not in PDF, use much faster line drawing instead of polyline:
+    int chunkSize = mParentPlot->polylineChunkSize();
+    if (chunkSize > 0 || (chunkSize < 0 && !mParentPlot->plottingHints().testFlag(QCP::phFastPolylines)))
+    {
+      painter->drawPolylineChunked(*lineData, chunkSize);
+    } else if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
         painter->pen().style() == Qt::SolidLine &&
         !painter->pdfExportMode())
     {
@@ -458,8 +463,21 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> *poin
   painter->setPen(mainPen());
   painter->setBrush(mainBrush());
   painter->setScatterPixmap(mScatterPixmap);
-  for (int i=0; i<pointData->size(); ++i)
-    painter->drawScatter(pointData->at(i).x(), pointData->at(i).y(), mScatterSize, mScatterStyle);
+  if (scatterCullingUsable(mScatterStyle, mScatterPixmap))
+  {
+    // skip symbols on pixels that already hold an identical symbol:
+    QRect rect = clipRect();
+    QBitArray occupancy(rect.width()*rect.height());
+    QVector<QPointF> scatters;
+    scatters.reserve(pointData->size());
+    for (int i=0; i<pointData->size(); ++i)
+    {
+      if (!cullScatter(occupancy, rect, pointData->at(i).x(), pointData->at(i).y()))
+        scatters.append(pointData->at(i));
+    }
+    painter->drawScatters(scatters, mScatterSize, mScatterStyle);
+  } else
+    painter->drawScatters(*pointData, mScatterSize, mScatterStyle);
 }
 
 /*! \internal
@@ -479,7 +497,11 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
      fills inside R consistent.
      The region R has index 5.
   */
-  lineData->reserve(mData->size());
+  // the points of the line are collected in plot coordinates first, and transformed to pixels at once at the end:
+  QVector<QCPCurveData> points;
+  QVector<int> pointRegions; // region of each point, for points that are placed optimized outside R (see outsidePixelPoint), else 5
+  points.reserve(mData->size());
+  pointRegions.reserve(mData->size());
   QCPCurveDataMap::const_iterator it;
   int lastRegion = 5;
   int currentRegion = 5;
@@ -531,17 +553,24 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
     if (currentRegion == 5 || (firstPoint && mBrush.style() != Qt::NoBrush)) // current is in R, add current and last if it wasn't added already
     {
       if (!addedLastAlready) // in case curve just entered R, make sure the last point outside R is also drawn correctly
-        lineData->append(coordsToPixels((it-1).value().key, (it-1).value().value)); // add last point to vector
+      {
+        points.append((it-1).value()); // add last point to vector
+        pointRegions.append(5);
+      }
       else if (lastRegion != 5) // added last already. If that's the case, we probably added it at optimized position. So go back and make sure it's at original position (else the angle changes under which this segment enters R)
       {
         if (!firstPoint) // because on firstPoint, currentRegion is 5 and addedLastAlready is true, although there is no last point
-          lineData->replace(lineData->size()-1, coordsToPixels((it-1).value().key, (it-1).value().value));
+        {
+          points.last() = (it-1).value();
+          pointRegions.last() = 5;
+        }
       }
-      lineData->append(coordsToPixels(it.value().key, it.value().value)); // add current point to vector
+      points.append(it.value()); // add current point to vector
+      pointRegions.append(5);
       addedLastAlready = true; // so in next iteration, we don't add this point twice
     } else if (currentRegion != lastRegion) // changed region, add current and last if not added already
     {
-      // using outsideCoordsToPixels instead of coorsToPixels for optimized point placement (places points just outside axisRect instead of potentially far away)
+      // using a region other than 5 for optimized point placement (places points just outside axisRect instead of potentially far away, see outsidePixelPoint)
       
       // if we're coming from R or we skip diagonally over the corner regions (so line might still be visible in R), we can't place points optimized
       if (lastRegion == 5 || // coming from R
@@ -553,16 +582,24 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
       {
         // always add last point if not added already, original:
         if (!addedLastAlready)
-          lineData->append(coordsToPixels((it-1).value().key, (it-1).value().value));
+        {
+          points.append((it-1).value());
+          pointRegions.append(5);
+        }
         // add current point, original:
-        lineData->append(coordsToPixels(it.value().key, it.value().value));
+        points.append(it.value());
+        pointRegions.append(5);
       } else // no special case that forbids optimized point placement, so do it:
       {
         // always add last point if not added already, optimized:
         if (!addedLastAlready)
-          lineData->append(outsideCoordsToPixels((it-1).value().key, (it-1).value().value, currentRegion));
+        {
+          points.append((it-1).value());
+          pointRegions.append(currentRegion);
+        }
         // add current point, optimized:
-        lineData->append(outsideCoordsToPixels(it.value().key, it.value().value, currentRegion));
+        points.append(it.value());
+        pointRegions.append(currentRegion);
       }
       addedLastAlready = true; // so that if next point enters 5, or crosses another region boundary, we don't add this point twice
     } else // neither in R, nor crossed a region boundary, skip current point
@@ -574,7 +611,29 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   }
   // If curve ends outside R, we want to add very last point so the fill looks like it should when the curve started inside R:
   if (lastRegion != 5 && mBrush.style() != Qt::NoBrush && !mData->isEmpty())
-    lineData->append(coordsToPixels((mData->constEnd()-1).value().key, (mData->constEnd()-1).value().value));
+  {
+    points.append((mData->constEnd()-1).value());
+    pointRegions.append(5);
+  }
+  
+  // transform all points to pixel coordinates at once:
+  lineData->resize(points.size());
+  if (points.isEmpty()) return;
+  QPointF *pixels = lineData->data();
+  if (mKeyAxis->orientation() == Qt::Horizontal)
+  {
+    mKeyAxis->coordToPixel(&points.constData()->key, &pixels->rx(), points.size(), sizeof(QCPCurveData), sizeof(QPointF));
+    mValueAxis->coordToPixel(&points.constData()->value, &pixels->ry(), points.size(), sizeof(QCPCurveData), sizeof(QPointF));
+  } else
+  {
+    mKeyAxis->coordToPixel(&points.constData()->key, &pixels->ry(), points.size(), sizeof(QCPCurveData), sizeof(QPointF));
+    mValueAxis->coordToPixel(&points.constData()->value, &pixels->rx(), points.size(), sizeof(QCPCurveData), sizeof(QPointF));
+  }
+  for (int i=0; i<pointRegions.size(); ++i)
+  {
+    if (pointRegions.at(i) != 5)
+      pixels[i] = outsidePixelPoint(pixels[i], pointRegions.at(i));
+  }
 }
 
 /*! \internal 
@@ -612,19 +671,19 @@ double QCPCurve::pointDistance(const QPointF &pixelPoint) const
 
 /*! \internal
   
-  This is a specialized \ref coordsToPixels function for points that are outside the visible
-  axisRect and just crossing a boundary (since \ref getCurveData reduces non-visible curve segments
-  to those line segments that cross region boundaries, see documentation there). It only uses the
-  coordinate parallel to the region boundary of the axisRect. The other coordinate is picked 10
-  pixels outside the axisRect. Together with the optimization in \ref getCurveData this improves
-  performance for large curves (or zoomed in ones) significantly while keeping the illusion the
-  whole curve and its filling is still being drawn for the viewer.
+  Returns \a pixelPoint moved just outside the visible axisRect, for points that are outside the
+  axisRect in \a region and just crossing a boundary (since \ref getCurveData reduces non-visible
+  curve segments to those line segments that cross region boundaries, see documentation there). It
+  only keeps the coordinate parallel to the region boundary of the axisRect. The other coordinate is
+  picked 10 pixels outside the axisRect. Together with the optimization in \ref getCurveData this
+  improves performance for large curves (or zoomed in ones) significantly while keeping the
+  illusion the whole curve and its filling is still being drawn for the viewer.
 */
-QPointF QCPCurve::outsideCoordsToPixels(double key, double value, int region) const
+QPointF QCPCurve::outsidePixelPoint(const QPointF &pixelPoint, int region) const
 {
   int margin = 10;
   QRect axisRect = mKeyAxis->axisRect() | mValueAxis->axisRect();
-  QPointF result = coordsToPixels(key, value);
+  QPointF result = pixelPoint;
   switch (region)
   {
     case 2: result.setX(axisRect.left()-margin); break; // left
@@ -73,6 +73,1390 @@ QCPData::QCPData(double key, double value) :
 }
 
 
+// ================================================================================
+// =================== QCPDataView
+// ================================================================================
+
+/*! \class QCPDataView
+  \brief Read-only view on keys and values of data points, located anywhere in memory
+  
+  A data view describes where the keys and values of a number of data points are stored, by a
+  pointer to the first key, a pointer to the first value and a stride for each. The stride is the
+  distance in bytes from one key (or value) to the next. This way, keys and values can be stored in
+  two separate arrays of doubles (stride sizeof(double), the default), interleaved in one array of
+  structs (stride sizeof(struct)), or in any other regular layout. The view doesn't own or copy the
+  memory it refers to.
+  
+  The keys must be sorted ascending, because searching by key (\ref lowerBound, \ref upperBound)
+  is done with binary searches.
+  
+  QCPGraph uses data views to read data points independently of whether they are held in its own
+  \ref QCPDataContainer (\ref QCPDataContainer::view) or provided by an external data source (\ref
+  QCPAbstractDataSource::dataView, \ref QCPGraph::setDataSource).
+*/
+
+/*! \fn int QCPDataView::size() const
+  
+  Returns the number of data points in the view.
+*/
+
+/*! \fn bool QCPDataView::isEmpty() const
+  
+  Returns true if the view contains no data points.
+*/
+
+/*! \fn double QCPDataView::key(int index) const
+  
+  Returns the key of the data point at \a index. \a index must be a valid index, i.e. 0 <= \a index
+  < \ref size.
+*/
+
+/*! \fn double QCPDataView::value(int index) const
+  
+  Returns the value of the data point at \a index. \a index must be a valid index, i.e. 0 <= \a
+  index < \ref size.
+*/
+
+/*! \fn const double *QCPDataView::keys() const
+  
+  Returns a pointer to the key of the first data point. The following keys are located at steps of
+  \ref keyStride bytes. Together, they can be passed to functions working on arrays of doubles,
+  like \ref QCPAxis::coordToPixel(const double *coords, qreal *pixels, int count, int coordStride, int pixelStride) const.
+*/
+
+/*! \fn const double *QCPDataView::values() const
+  
+  Returns a pointer to the value of the first data point. The following values are located at steps
+  of \ref valueStride bytes.
+*/
+
+/*! \fn int QCPDataView::keyStride() const
+  
+  Returns the distance in bytes from one key to the next.
+*/
+
+/*! \fn int QCPDataView::valueStride() const
+  
+  Returns the distance in bytes from one value to the next.
+*/
+
+/*!
+  Constructs an empty data view.
+*/
+QCPDataView::QCPDataView() :
+  mKeys(0),
+  mValues(0),
+  mKeyStride(0),
+  mValueStride(0),
+  mSize(0)
+{
+}
+
+/*!
+  Constructs a data view of \a size data points. The key of the first data point is located at \a
+  keys, the following keys are found at steps of \a keyStride bytes. Accordingly, the values are
+  located at \a values with steps of \a valueStride bytes.
+  
+  The keys must be sorted ascending. The memory must stay valid as long as the view is used.
+*/
+QCPDataView::QCPDataView(const double *keys, const double *values, int size, int keyStride, int valueStride) :
+  mKeys(reinterpret_cast<const char*>(keys)),
+  mValues(reinterpret_cast<const char*>(values)),
+  mKeyStride(keyStride),
+  mValueStride(valueStride),
+  mSize(size)
+{
+  if (mSize < 0 || (mSize > 0 && (!mKeys || !mValues)))
+  {
+    qDebug() << Q_FUNC_INFO << "invalid size or null pointer, constructing empty view";
+    mSize = 0;
+  }
+}
+
+/*!
+  Returns a view on the \a count data points starting at \a index. The range is clipped to the
+  data points of this view, so the returned view may be smaller than \a count.
+*/
+QCPDataView QCPDataView::mid(int index, int count) const
+{
+  index = qBound(0, index, mSize);
+  count = qBound(0, count, mSize-index);
+  if (count == 0)
+    return QCPDataView();
+  QCPDataView result(*this);
+  result.mKeys += qint64(index)*mKeyStride;
+  result.mValues += qint64(index)*mValueStride;
+  result.mSize = count;
+  return result;
+}
+
+/*!
+  Returns the index of the first data point whose key is equal to or greater than \a key. If there
+  is no such data point, returns \ref size.
+  
+  \see upperBound
+*/
+int QCPDataView::lowerBound(double key) const
+{
+  int begin = 0;
+  int count = mSize;
+  while (count > 0)
+  {
+    int half = count/2;
+    if (this->key(begin+half) < key)
+    {
+      begin += half+1;
+      count -= half+1;
+    } else
+      count = half;
+  }
+  return begin;
+}
+
+/*!
+  Returns the index of the first data point whose key is greater than \a key. If there is no such
+  data point, returns \ref size.
+  
+  \see lowerBound
+*/
+int QCPDataView::upperBound(double key) const
+{
+  int begin = 0;
+  int count = mSize;
+  while (count > 0)
+  {
+    int half = count/2;
+    if (!(key < this->key(begin+half)))
+    {
+      begin += half+1;
+      count -= half+1;
+    } else
+      count = half;
+  }
+  return begin;
+}
+
+
+// ================================================================================
+// =================== QCPAbstractDataSource
+// ================================================================================
+
+/*! \class QCPAbstractDataSource
+  \brief The abstract base class for external data that is plotted by a QCPGraph without copying
+  
+  Normally, a QCPGraph holds its data points in its own \ref QCPDataContainer, so all data is
+  copied into the graph when calling \ref QCPGraph::setData or \ref QCPGraph::addData. If the data
+  already lives in memory the application manages, e.g. an acquisition buffer or a memory-mapped
+  file, this duplicates potentially huge amounts of memory. Instead, an instance of a subclass of
+  QCPAbstractDataSource can be passed to \ref QCPGraph::setDataSource. The graph then reads the
+  data points directly from the memory described by \ref dataView whenever it is replotted.
+  
+  Subclasses must implement \ref dataView, returning a \ref QCPDataView that describes where the
+  keys and values are located. The keys must be sorted ascending. Whenever the data or its
+  location changes, the subclass should emit \ref dataChanged. Since QCPGraph only reads the data
+  during replots, the memory must not be changed or freed while a replot is in progress.
+  
+  For data in plain arrays, \ref QCPArrayDataSource can be used directly.
+  
+  External data sources can't provide error bars.
+*/
+
+/* start of documentation of pure virtual functions */
+
+/*! \fn virtual QCPDataView QCPAbstractDataSource::dataView() const = 0
+  
+  Returns a view on the current data of this data source. QCPGraph calls this function at the
+  beginning of every operation that reads the data, e.g. once per replot, so the returned view
+  may change between calls.
+*/
+
+/* end of documentation of pure virtual functions */
+/* start of documentation of signals */
+
+/*! \fn void QCPAbstractDataSource::dataChanged()
+  
+  This signal should be emitted by subclasses when the data or its location in memory has changed.
+  Connect it to a slot that replots the plot, if the changes shall become visible immediately.
+*/
+
+/* end of documentation of signals */
+
+/*!
+  Constructs an abstract data source with the given \a parent.
+*/
+QCPAbstractDataSource::QCPAbstractDataSource(QObject *parent) :
+  QObject(parent)
+{
+}
+
+QCPAbstractDataSource::~QCPAbstractDataSource()
+{
+}
+
+
+// ================================================================================
+// =================== QCPArrayDataSource
+// ================================================================================
+
+/*! \class QCPArrayDataSource
+  \brief A data source for QCPGraph that refers to keys and values in application-owned arrays
+  
+  This is the straightforward implementation of \ref QCPAbstractDataSource for data that is stored
+  in arrays with a fixed location. Pass the location of the arrays with \ref setArrays. If the
+  arrays are filled successively, e.g. by an acquisition, update the number of valid data points
+  with \ref setSize. If the data was changed in place, call \ref notifyDataChanged.
+  
+  The arrays are not copied and must stay valid as long as the data source refers to them.
+*/
+
+/*! \fn int QCPArrayDataSource::size() const
+  
+  Returns the number of data points as set with \ref setArrays or \ref setSize.
+*/
+
+/*!
+  Constructs an empty array data source with the given \a parent. Call \ref setArrays to let it
+  refer to data.
+*/
+QCPArrayDataSource::QCPArrayDataSource(QObject *parent) :
+  QCPAbstractDataSource(parent),
+  mKeys(0),
+  mValues(0),
+  mSize(0),
+  mKeyStride(sizeof(double)),
+  mValueStride(sizeof(double))
+{
+}
+
+QCPArrayDataSource::~QCPArrayDataSource()
+{
+}
+
+/*!
+  Sets the location of the data. The key of the first of \a size data points is located at \a
+  keys, the following keys are found at steps of \a keyStride bytes. Accordingly, the values are
+  located at \a values with steps of \a valueStride bytes. The default strides correspond to two
+  separate arrays of doubles. For an array of structs, pass the address of the key and value
+  member of the first struct and sizeof(struct) as strides.
+  
+  The keys must be sorted ascending. Emits \ref dataChanged.
+*/
+void QCPArrayDataSource::setArrays(const double *keys, const double *values, int size, int keyStride, int valueStride)
+{
+  mKeys = keys;
+  mValues = values;
+  mSize = size;
+  mKeyStride = keyStride;
+  mValueStride = valueStride;
+  emit dataChanged();
+}
+
+/*!
+  Sets the number of valid data points in the arrays passed with \ref setArrays. This is useful
+  when the arrays are filled successively. Emits \ref dataChanged.
+*/
+void QCPArrayDataSource::setSize(int size)
+{
+  mSize = size;
+  emit dataChanged();
+}
+
+/* inherits documentation from base class */
+QCPDataView QCPArrayDataSource::dataView() const
+{
+  return QCPDataView(mKeys, mValues, mSize, mKeyStride, mValueStride);
+}
+
+/*!
+  Emits \ref dataChanged. Call this function after the data in the arrays was modified in place.
+*/
+void QCPArrayDataSource::notifyDataChanged()
+{
+  emit dataChanged();
+}
+
+
+// ================================================================================
+// =================== QCPDataLodIndex
+// ================================================================================
+
+/*! \class QCPDataLodIndex
+  \brief Level of detail index over the values of a QCPDataContainer
+  
+  This is an internal class used by \ref QCPDataContainer, when its level of detail index is
+  enabled (\ref QCPDataContainer::setLodIndex). It allows to determine the minimum and maximum
+  value of any index range of the data points in O(log n), instead of scanning all points in the
+  range.
+  
+  The index is a pyramid of levels. Level 0 divides the data points into buckets of
+  2^baseShift consecutive points and stores the minimum and maximum value of each bucket (as a
+  QCPRange). Every higher level combines two buckets of the level below, so the bucket size
+  doubles from level to level, until the top level consists of a single bucket. The first and last
+  value of a bucket are not stored, since they can be read directly from the data container.
+  
+  Buckets are aligned to an absolute index, that keeps counting when data points are removed from
+  the front. This way, the index can be maintained incrementally in the typical realtime use case
+  of appending points at the end (\ref append) and removing old points at the front (\ref
+  removeFront), or truncating the data at the end (\ref removeBack). All other modifications of
+  the data container invalidate the index (\ref invalidate), and it is rebuilt the next time it is
+  needed.
+*/
+
+/*!
+  Constructs an invalid level of detail index. Call \ref rebuild to make it valid.
+*/
+QCPDataLodIndex::QCPDataLodIndex() :
+  mOffset(0),
+  mValid(false)
+{
+}
+
+/*!
+  Marks the index as invalid and frees its memory. Until the next call to \ref rebuild, all
+  updates via \ref append, \ref removeFront and \ref removeBack are ignored.
+*/
+void QCPDataLodIndex::invalidate()
+{
+  mLevels.clear();
+  mFirstBucket.clear();
+  mOffset = 0;
+  mValid = false;
+}
+
+/*!
+  Builds the index for the data points in \a data, which must be sorted by key. Afterwards, the
+  index is valid.
+*/
+void QCPDataLodIndex::rebuild(const QCPDataView &data)
+{
+  invalidate();
+  mValid = true;
+  append(data, 0);
+}
+
+/*!
+  Updates the index after data points were appended at the end of the data container. \a data is
+  the view on all data points of the container after the points were appended, \a oldSize is the
+  size of the container before.
+*/
+void QCPDataLodIndex::append(const QCPDataView &data, int oldSize)
+{
+  int newSize = data.size();
+  if (!mValid || newSize <= oldSize) return;
+  
+  qint64 firstChangedBucket = (mOffset+oldSize) >> baseShift;
+  if (mLevels.isEmpty())
+  {
+    mLevels.append(QVector<QCPRange>());
+    mFirstBucket.append(firstChangedBucket);
+  }
+  // update level 0 directly with the new data points:
+  QVector<QCPRange> &level = mLevels[0];
+  for (int i=oldSize; i<newSize; ++i)
+  {
+    int bucket = ((mOffset+i) >> baseShift) - mFirstBucket.at(0);
+    double value = data.value(i);
+    if (bucket == level.size())
+    {
+      level.append(QCPRange(value, value));
+    } else
+    {
+      QCPRange &range = level[bucket];
+      if (value < range.lower)
+        range.lower = value;
+      if (value > range.upper)
+        range.upper = value;
+    }
+  }
+  updateUpperLevels(firstChangedBucket);
+}
+
+/*!
+  Updates the index after \a count data points were removed from the front of the data container.
+  
+  Buckets that only contained removed points are dropped. The bucket containing the new first data
+  point keeps its stale range. This is no problem, because only buckets that lie completely inside
+  the queried index range are used by \ref valueRange.
+*/
+void QCPDataLodIndex::removeFront(int count)
+{
+  if (!mValid || count <= 0) return;
+  
+  mOffset += count;
+  for (int i=0; i<mLevels.size(); ++i)
+  {
+    int obsoleteBuckets = qMin(qint64(mLevels.at(i).size()), (mOffset >> (baseShift+i)) - mFirstBucket.at(i));
+    if (obsoleteBuckets > 0)
+    {
+      mLevels[i].remove(0, obsoleteBuckets);
+      mFirstBucket[i] += obsoleteBuckets;
+    }
+    if (mLevels.at(i).isEmpty()) // let next appended data point start in correct bucket
+      mFirstBucket[i] = mOffset >> (baseShift+i);
+  }
+}
+
+/*!
+  Updates the index after data points were removed from the end of the data container. \a data is
+  the view on the remaining data points of the container.
+  
+  Unlike in \ref removeFront, the buckets containing the new last data point must be recalculated,
+  because further data points appended later will end up in them.
+*/
+void QCPDataLodIndex::removeBack(const QCPDataView &data)
+{
+  if (!mValid) return;
+  int newSize = data.size();
+  if (newSize <= 0)
+  {
+    // nothing left to index, start over but keep counting the absolute index:
+    qint64 offset = mOffset;
+    rebuild(data);
+    mOffset = offset;
+    return;
+  }
+  
+  qint64 end = mOffset+newSize; // absolute index after last data point
+  for (int i=0; i<mLevels.size(); ++i)
+  {
+    int bucketCount = ((end-1) >> (baseShift+i)) - mFirstBucket.at(i) + 1;
+    if (bucketCount < mLevels.at(i).size())
+      mLevels[i].resize(bucketCount);
+  }
+  // recalculate last bucket of level 0 from the data points, the upper levels from their children:
+  qint64 lastBucket = (end-1) >> baseShift;
+  int begin = qMax(lastBucket << baseShift, mOffset) - mOffset;
+  QCPRange range(data.value(begin), data.value(begin));
+  for (int i=begin+1; i<newSize; ++i)
+  {
+    double value = data.value(i);
+    if (value < range.lower)
+      range.lower = value;
+    if (value > range.upper)
+      range.upper = value;
+  }
+  mLevels[0].last() = range;
+  updateUpperLevels(lastBucket);
+}
+
+/*!
+  Returns the minimum (QCPRange::lower) and maximum (QCPRange::upper) value of the data points with
+  indices from \a begin up to \a end (excluding \a end). \a data is the view on the data points of
+  the container the index was built for. The range from \a begin to \a end must not be empty.
+  
+  The data points at the borders of the range, which only partially cover a bucket, are read
+  directly from \a data. The rest of the range is covered with the largest possible buckets of the
+  index, so this takes O(log n) time.
+  
+  The index must be valid when calling this function.
+*/
+QCPRange QCPDataLodIndex::valueRange(const QCPDataView &data, int begin, int end) const
+{
+  QCPRange result(data.value(begin), data.value(begin));
+  qint64 lowerIndex = mOffset+begin+1;
+  qint64 upperIndex = mOffset+end;
+  const qint64 bucketMask = (qint64(1) << baseShift)-1;
+  // data points before the first complete bucket:
+  while (lowerIndex < upperIndex && (lowerIndex & bucketMask) != 0)
+  {
+    double value = data.value(lowerIndex-mOffset);
+    if (value < result.lower)
+      result.lower = value;
+    if (value > result.upper)
+      result.upper = value;
+    ++lowerIndex;
+  }
+  // data points after the last complete bucket:
+  while (upperIndex > lowerIndex && (upperIndex & bucketMask) != 0)
+  {
+    --upperIndex;
+    double value = data.value(upperIndex-mOffset);
+    if (value < result.lower)
+      result.lower = value;
+    if (value > result.upper)
+      result.upper = value;
+  }
+  // complete buckets, walking up the levels:
+  qint64 lowerBucket = lowerIndex >> baseShift;
+  qint64 upperBucket = upperIndex >> baseShift;
+  for (int i=0; i<mLevels.size() && lowerBucket < upperBucket; ++i)
+  {
+    const QVector<QCPRange> &level = mLevels.at(i);
+    qint64 firstBucket = mFirstBucket.at(i);
+    bool topLevel = i == mLevels.size()-1;
+    while (lowerBucket < upperBucket && (topLevel || (lowerBucket & 1) != 0))
+    {
+      const QCPRange &range = level.at(lowerBucket-firstBucket);
+      if (range.lower < result.lower)
+        result.lower = range.lower;
+      if (range.upper > result.upper)
+        result.upper = range.upper;
+      ++lowerBucket;
+    }
+    if (lowerBucket < upperBucket && (upperBucket & 1) != 0)
+    {
+      --upperBucket;
+      const QCPRange &range = level.at(upperBucket-firstBucket);
+      if (range.lower < result.lower)
+        result.lower = range.lower;
+      if (range.upper > result.upper)
+        result.upper = range.upper;
+    }
+    lowerBucket >>= 1;
+    upperBucket >>= 1;
+  }
+  return result;
+}
+
+/*! \internal
+  
+  Recalculates the buckets of all levels above level 0 that depend on the level 0 bucket \a
+  firstChangedBucket or any bucket after it. New levels are added on top until the top level
+  consists of a single bucket.
+*/
+void QCPDataLodIndex::updateUpperLevels(qint64 firstChangedBucket)
+{
+  for (int i=1; i<mLevels.size() || mLevels.last().size() > 1; ++i)
+  {
+    if (i == mLevels.size())
+    {
+      // add new top level, which needs to be calculated completely:
+      mLevels.append(QVector<QCPRange>());
+      mFirstBucket.append(mFirstBucket.at(i-1) >> 1);
+      firstChangedBucket = mFirstBucket.at(i-1);
+    }
+    const QVector<QCPRange> &childLevel = mLevels.at(i-1);
+    qint64 firstChild = mFirstBucket.at(i-1);
+    qint64 endChild = firstChild+childLevel.size();
+    if (endChild <= firstChild) break;
+    QVector<QCPRange> &level = mLevels[i];
+    qint64 firstBucket = mFirstBucket.at(i);
+    qint64 endBucket = ((endChild-1) >> 1) + 1;
+    level.resize(endBucket-firstBucket);
+    for (qint64 bucket=qMax(firstChangedBucket >> 1, firstBucket); bucket<endBucket; ++bucket)
+    {
+      qint64 child = qMax(bucket*2, firstChild);
+      QCPRange range = childLevel.at(child-firstChild);
+      if (child+1 < endChild && child+1 < bucket*2+2)
+      {
+        const QCPRange &secondRange = childLevel.at(child+1-firstChild);
+        if (secondRange.lower < range.lower)
+          range.lower = secondRange.lower;
+        if (secondRange.upper > range.upper)
+          range.upper = secondRange.upper;
+      }
+      level[bucket-firstBucket] = range;
+    }
+    firstChangedBucket >>= 1;
+  }
+}
+
+
+// ================================================================================
+// =================== QCPDataContainer
+// ================================================================================
+
+/*! \class QCPDataContainer
+  \brief Holds the data points of a QCPGraph in a contiguous array sorted by key.
+  
+  Unlike a \ref QCPDataMap, where every data point is a separately allocated tree node, this
+  container keeps all data points in one contiguous block of memory, sorted ascending by their key.
+  Iterating over a key range therefore streams linearly through memory, which is what the drawing
+  routines of QCPGraph spend most of their time doing.
+  
+  As long as no data point carries error values, only the key and value of each point are stored,
+  which makes the container a third of the size of an array of \ref QCPData. As soon as a point
+  with non-zero errors is added, the container switches to a layout that stores all members of
+  \ref QCPData (\ref hasErrors). Since the points aren't stored as \ref QCPData instances, \ref at
+  returns them by value. For fast iteration over keys and values, use \ref view.
+  
+  Appending points with keys equal to or greater than the current last key (the typical case for
+  realtime data) is amortized O(1). Points with smaller keys are inserted at their sorted
+  position. Searching by key (\ref lowerBound, \ref upperBound) is done with binary searches and
+  returns indices that can be passed to \ref at.
+  
+  Points with equal keys are allowed and keep the order in which they were added.
+  
+  Optionally, the container maintains a level of detail index over the values of its data points
+  (\ref setLodIndex), which allows \ref valueRange to determine the value extremes of any index
+  range in O(log n).
+  
+  For realtime data, the container can be limited to a fixed capacity (\ref setCapacity). It then
+  works as a ring buffer that overwrites the oldest data points when new ones are appended, without
+  any memory allocations.
+  
+  \see QCPGraph::data, QCPGraph::setData
+*/
+
+/*! \internal
+  
+  Comparison function that orders \ref QCPData instances by their key. Used for sorting inside
+  \ref QCPDataContainer.
+*/
+inline bool qcpDataKeyLessThan(const QCPData &a, const QCPData &b)
+{
+  return a.key < b.key;
+}
+
+/*! \fn int QCPDataContainer::size() const
+  
+  Returns the number of data points in the container.
+*/
+
+/*! \fn bool QCPDataContainer::isEmpty() const
+  
+  Returns true if the container holds no data points.
+*/
+
+/*! \fn QCPData QCPDataContainer::first() const
+  
+  Returns the data point with the smallest key. The container must not be empty.
+*/
+
+/*! \fn QCPData QCPDataContainer::last() const
+  
+  Returns the data point with the largest key. The container must not be empty.
+*/
+
+/*! \fn bool QCPDataContainer::hasErrors() const
+  
+  Returns whether the container stores error values for its data points. This is the case as soon
+  as a data point with non-zero errors was added. Otherwise, only keys and values are stored and
+  the errors returned by \ref at are zero.
+*/
+
+/*! \fn int QCPDataContainer::revision() const
+  
+  Returns the revision of the data points. The revision changes whenever data points are removed
+  or replaced, but neither when data points are appended at the end nor when they are removed from
+  the front (see \ref frontOffset). So as long as the revision stays the same, the data point with
+  index \a i at some earlier point now has index \a i minus the growth of \ref frontOffset, if it
+  wasn't removed. This allows to incrementally maintain information derived from the data points,
+  like QCPGraph does for its key and value ranges.
+  
+  Revisions are unique among all containers, except for copies of a container, which hold the
+  same data points.
+*/
+
+/*! \fn qint64 QCPDataContainer::frontOffset() const
+  
+  Returns the total number of data points that were removed from the front of the container, e.g.
+  with \ref removeBefore or by overwriting the oldest points of a ring buffer (\ref setCapacity).
+  The sum of the front offset and the index of a data point identifies the point as long as the
+  \ref revision stays the same.
+*/
+
+/*!
+  Constructs an empty data container.
+*/
+QCPDataContainer::QCPDataContainer() :
+  mRecordSize(compactRecordSize),
+  mBegin(0),
+  mSize(0),
+  mCapacity(0),
+  mAppendStart(0),
+  mRevision(0),
+  mFrontOffset(0),
+  mLodIndexEnabled(false)
+{
+  newRevision();
+}
+
+/*!
+  Returns the data point at \a index. Data points are sorted ascending by key, so index 0 is the
+  point with the smallest key. \a index must be a valid index, i.e. 0 <= \a index < \ref size.
+  
+  If the container doesn't store errors (\ref hasErrors), the errors of the returned point are zero.
+*/
+QCPData QCPDataContainer::at(int index) const
+{
+  const double *record = mStore.constData()+qint64(mBegin+index)*mRecordSize;
+  QCPData result(record[0], record[1]);
+  if (mRecordSize == fullRecordSize)
+  {
+    result.keyErrorPlus = record[2];
+    result.keyErrorMinus = record[3];
+    result.valueErrorPlus = record[4];
+    result.valueErrorMinus = record[5];
+  }
+  return result;
+}
+
+/*!
+  Limits the number of data points in the container to \a capacity. If \a capacity is 0, the
+  container grows without limit, which is the default.
+  
+  With a capacity, the container works as a ring buffer: When data points are appended at the end
+  while the container is full, the oldest data points (those with the smallest keys) are discarded
+  to make room. The memory for the ring buffer is allocated once in this function, so appending and
+  removing data points in the typical realtime usage (appending new points, optionally removing old
+  ones with \ref removeBefore) is O(1) per point and never allocates memory.
+  
+  The ring buffer holds every data point twice, at its position and at its position plus \a
+  capacity. This way, the data points are always contiguous in memory even when the ring has
+  wrapped around, and all functions that take indices or search by key work unchanged. The memory
+  consumption is thus twice the one of \a capacity data points.
+  
+  Modifications that don't append at the end or remove from the front (e.g. inserting a point with
+  a key smaller than the last key) are still possible, but are O(n) in ring buffer mode. This also
+  applies to the first point with errors that is appended to a container which didn't store errors
+  so far (see \ref hasErrors).
+  
+  If the container currently holds more than \a capacity data points, the oldest ones are removed.
+*/
+void QCPDataContainer::setCapacity(int capacity)
+{
+  if (capacity < 0)
+  {
+    qDebug() << Q_FUNC_INFO << "capacity must not be negative:" << capacity;
+    return;
+  }
+  QVector<QCPData> data = toVector();
+  mCapacity = capacity;
+  assign(data, hasErrors());
+}
+
+/*!
+  Sets whether the container maintains a level of detail index over the values of its data points.
+  The index allows \ref valueRange to determine the minimum and maximum value of a range of data
+  points in O(log n) time, instead of scanning all points in the range. It requires roughly a
+  quarter of the memory of the data values themselves.
+  
+  The index is kept up to date incrementally when points are appended at the end or removed from
+  the front or the end of the container (e.g. with \ref removeBefore), which is the typical usage
+  in realtime plots. Any other modification causes the index to be rebuilt the next time it is
+  needed.
+*/
+void QCPDataContainer::setLodIndex(bool enabled)
+{
+  mLodIndexEnabled = enabled;
+  if (!mLodIndexEnabled)
+    mLodIndex.invalidate();
+}
+
+/*!
+  Replaces the current data with the data points in \a dataMap. Since the map is already sorted,
+  this is a linear operation.
+*/
+void QCPDataContainer::set(const QCPDataMap &dataMap)
+{
+  QVector<QCPData> data;
+  data.reserve(dataMap.size());
+  QCPDataMap::const_iterator it = dataMap.constBegin();
+  while (it != dataMap.constEnd())
+  {
+    data.append(it.value());
+    ++it;
+  }
+  assign(data, false);
+}
+
+/*! \overload
+  
+  Replaces the current data with the data points in \a data. The points may be passed in any order,
+  they are sorted by key if necessary (see \ref add for details on the sorting).
+  
+  If you know that the keys in \a data are ascending, set \a alreadySorted to true. This skips the
+  check whether sorting is necessary. If the keys aren't ascending despite \a alreadySorted being
+  true, the behaviour of the container is undefined.
+*/
+void QCPDataContainer::set(const QVector<QCPData> &data, bool alreadySorted)
+{
+  if (alreadySorted || isSorted(data))
+  {
+    assign(data, false);
+  } else
+  {
+    QVector<QCPData> sorted = data;
+    sortByKey(sorted);
+    assign(sorted, false);
+  }
+}
+
+/*!
+  Adds the data points in \a dataMap to the current data. Since the map is already sorted, it is
+  merged with the current data in linear time (see \ref add(const QVector<QCPData> &data, bool
+  alreadySorted)).
+*/
+void QCPDataContainer::add(const QCPDataMap &dataMap)
+{
+  if (dataMap.isEmpty()) return;
+  QVector<QCPData> data;
+  data.reserve(dataMap.size());
+  QCPDataMap::const_iterator it = dataMap.constBegin();
+  while (it != dataMap.constEnd())
+  {
+    data.append(it.value());
+    ++it;
+  }
+  mergeSorted(data);
+}
+
+/*! \overload
+  
+  Adds the data points in \a data to the current data. The points may be passed in any order.
+  
+  If the keys in \a data are ascending, the points are merged with the current data in linear
+  time. Only the current points with keys greater than the smallest key in \a data need to be
+  touched, so if all keys in \a data are equal to or greater than the current last key, the points
+  are simply appended. If the keys aren't ascending, \a data is sorted first. Large vectors are
+  sorted in chunks on multiple threads, which are then merged.
+  
+  If you know that the keys in \a data are ascending, set \a alreadySorted to true. This skips the
+  check whether sorting is necessary. If the keys aren't ascending despite \a alreadySorted being
+  true, the behaviour of the container is undefined.
+*/
+void QCPDataContainer::add(const QVector<QCPData> &data, bool alreadySorted)
+{
+  if (data.isEmpty()) return;
+  if (alreadySorted || isSorted(data))
+  {
+    mergeSorted(data);
+  } else
+  {
+    QVector<QCPData> sorted = data;
+    sortByKey(sorted);
+    mergeSorted(sorted);
+  }
+}
+
+/*! \overload
+  
+  Adds the single data point \a data. If its key is equal to or greater than the current last key,
+  this is an amortized O(1) operation. Otherwise the point is inserted at its sorted position,
+  which takes time proportional to the number of points with greater keys.
+*/
+void QCPDataContainer::add(const QCPData &data)
+{
+  if (isEmpty() || data.key >= last().key)
+  {
+    reserveAppend(1, containsErrors(data));
+    appendUnchecked(data);
+    finishAppend();
+  } else
+    mergeSorted(QVector<QCPData>() << data);
+}
+
+/*!
+  Removes all data points with keys smaller than \a key.
+*/
+void QCPDataContainer::removeBefore(double key)
+{
+  removeRange(0, lowerBound(key));
+}
+
+/*!
+  Removes all data points with keys greater than \a key.
+*/
+void QCPDataContainer::removeAfter(double key)
+{
+  removeRange(upperBound(key), mSize);
+}
+
+/*!
+  Removes all data points with keys greater than \a fromKey and smaller than or equal to \a toKey.
+  If \a fromKey is greater or equal to \a toKey, the function does nothing.
+*/
+void QCPDataContainer::remove(double fromKey, double toKey)
+{
+  if (fromKey >= toKey) return;
+  int begin = upperBound(fromKey);
+  int end = upperBound(toKey);
+  removeRange(begin, end);
+}
+
+/*! \overload
+  
+  Removes all data points with a key equal to \a key.
+*/
+void QCPDataContainer::remove(double key)
+{
+  int begin = lowerBound(key);
+  int end = upperBound(key);
+  removeRange(begin, end);
+}
+
+/*!
+  Removes all data points. If the container has a capacity (\ref setCapacity), the memory of the
+  ring buffer is kept.
+  
+  Afterwards, the container doesn't store errors anymore until a point with errors is added (\ref
+  hasErrors).
+*/
+void QCPDataContainer::clear()
+{
+  newRevision();
+  mBegin = 0;
+  mSize = 0;
+  mRecordSize = compactRecordSize;
+  if (mCapacity == 0)
+    mStore.clear();
+  else
+    mStore.resize(2*mCapacity*mRecordSize);
+  mLodIndex.invalidate();
+}
+
+/*!
+  Preallocates memory for at least \a size data points. If you know in advance how many points
+  will be added, this avoids reallocations while adding them.
+  
+  If the container has a capacity (\ref setCapacity), the memory is already allocated and this
+  function does nothing.
+*/
+void QCPDataContainer::reserve(int size)
+{
+  if (mCapacity == 0)
+    mStore.reserve(size*mRecordSize);
+}
+
+/*!
+  Returns the index of the first data point whose key is equal to or greater than \a key. If there
+  is no such data point, returns \ref size.
+  
+  \see upperBound
+*/
+int QCPDataContainer::lowerBound(double key) const
+{
+  return view().lowerBound(key);
+}
+
+/*!
+  Returns the index of the first data point whose key is greater than \a key. If there is no such
+  data point, returns \ref size.
+  
+  \see lowerBound
+*/
+int QCPDataContainer::upperBound(double key) const
+{
+  return view().upperBound(key);
+}
+
+/*!
+  If the level of detail index is enabled (\ref setLodIndex) but currently not built, builds it.
+  Otherwise does nothing.
+  
+  The index is built lazily by the first query that needs it (e.g. \ref valueRange), which
+  modifies the container. Call this before the container is read from several threads
+  concurrently (see QCP::phParallelPlottables), so the reads don't race for building the index.
+*/
+void QCPDataContainer::ensureLodIndex() const
+{
+  if (mLodIndexEnabled && !mLodIndex.isValid())
+    mLodIndex.rebuild(view());
+}
+
+/*!
+  Returns the minimum (QCPRange::lower) and maximum (QCPRange::upper) value of the data points with
+  indices from \a begin up to \a end (excluding \a end). If the range is empty, returns a default
+  constructed QCPRange.
+  
+  If the level of detail index is enabled (\ref setLodIndex), this takes O(log n) time. Otherwise
+  all data points in the range are scanned.
+*/
+QCPRange QCPDataContainer::valueRange(int begin, int end) const
+{
+  begin = qMax(begin, 0);
+  end = qMin(end, mSize);
+  if (begin >= end)
+    return QCPRange();
+  
+  QCPDataView data = view();
+  if (mLodIndexEnabled)
+  {
+    ensureLodIndex();
+    return mLodIndex.valueRange(data, begin, end);
+  }
+  QCPRange result(data.value(begin), data.value(begin));
+  for (int i=begin+1; i<end; ++i)
+  {
+    const double value = data.value(i);
+    if (value < result.lower)
+      result.lower = value;
+    if (value > result.upper)
+      result.upper = value;
+  }
+  return result;
+}
+
+/*!
+  Returns a \ref QCPDataView on the keys and values of the data points in this container. The view
+  becomes invalid when the container is modified.
+*/
+QCPDataView QCPDataContainer::view() const
+{
+  if (mSize == 0)
+    return QCPDataView();
+  const double *record = mStore.constData()+qint64(mBegin)*mRecordSize;
+  const int stride = mRecordSize*sizeof(double);
+  return QCPDataView(record, record+1, mSize, stride, stride);
+}
+
+/*!
+  Returns a copy of the data points in the form of a \ref QCPDataMap.
+*/
+QCPDataMap QCPDataContainer::toMap() const
+{
+  QCPDataMap result;
+  for (int i=0; i<mSize; ++i)
+  {
+    QCPData data = at(i);
+    result.insertMulti(data.key, data);
+  }
+  return result;
+}
+
+/*! \internal
+  
+  Removes the data points with indices from \a begin up to \a end (excluding \a end) and updates
+  the level of detail index accordingly.
+  
+  Removing from the front of a ring buffer only moves its start, removing from the back only
+  reduces its size. Both are O(1). Removing from the front increases the \ref frontOffset instead
+  of changing the \ref revision, so information derived from the remaining points stays valid.
+*/
+void QCPDataContainer::removeRange(int begin, int end)
+{
+  if (begin >= end) return;
+  if (begin == 0)
+  {
+    mFrontOffset += end;
+    if (mCapacity > 0)
+      mBegin = (mBegin+end) % mCapacity;
+    else
+      mStore.remove(0, end*mRecordSize);
+    mSize -= end;
+    mLodIndex.removeFront(end);
+  } else if (end == mSize)
+  {
+    newRevision();
+    if (mCapacity == 0)
+      mStore.resize(begin*mRecordSize);
+    mSize = begin;
+    mLodIndex.removeBack(view());
+  } else if (mCapacity == 0)
+  {
+    newRevision();
+    mStore.remove(begin*mRecordSize, (end-begin)*mRecordSize);
+    mSize -= end-begin;
+    mLodIndex.invalidate();
+  } else
+  {
+    QVector<QCPData> data = toVector();
+    data.remove(begin, end-begin);
+    assign(data, hasErrors());
+  }
+}
+
+/*! \internal
+  
+  Assigns a new, unique revision to the container. Must be called whenever data points are removed
+  or replaced, except when they are removed from the front (see \ref revision and \ref frontOffset).
+*/
+void QCPDataContainer::newRevision()
+{
+  static QAtomicInt revisionCounter;
+  mRevision = revisionCounter.fetchAndAddRelaxed(1)+1;
+}
+
+/*! \internal
+  
+  Prepares the appending of \a count data points with \ref appendUnchecked. In ring buffer mode,
+  the oldest data points are discarded to make room for the new ones, otherwise memory is
+  reserved. Further calls of \ref appendUnchecked must be concluded with \ref finishAppend.
+  
+  If \a withErrors is true and the container doesn't store errors yet, it is converted to the
+  layout that stores errors.
+  
+  If more points than the capacity of the ring buffer are appended, the first ones of them are
+  overwritten by the later ones within \ref appendUnchecked.
+*/
+void QCPDataContainer::reserveAppend(int count, bool withErrors)
+{
+  if (withErrors && mRecordSize != fullRecordSize)
+    assign(toVector(), true);
+  if (mCapacity > 0)
+  {
+    int discard = qMin(mSize, mSize+count-mCapacity);
+    if (discard > 0)
+      removeRange(0, discard);
+  } else
+    mStore.reserve((mSize+count)*mRecordSize);
+  mAppendStart = mSize;
+}
+
+/*! \internal
+  
+  Appends \a data at the end of the container without checking the key order and without updating
+  the level of detail index. Must be embraced by \ref reserveAppend and \ref finishAppend.
+  
+  In ring buffer mode, every data point is written twice, at its slot in the ring and at the slot
+  plus the capacity, so the data points are contiguous in memory starting at mBegin, regardless
+  where the ring currently wraps around.
+*/
+void QCPDataContainer::appendUnchecked(const QCPData &data)
+{
+  if (mCapacity > 0)
+  {
+    if (mSize == mCapacity) // only happens if more points than the capacity are appended at once
+    {
+      mBegin = (mBegin+1) % mCapacity;
+      --mSize;
+      --mAppendStart;
+      ++mFrontOffset;
+    }
+    int slot = (mBegin+mSize) % mCapacity;
+    writeRecord(slot, data);
+    writeRecord(slot+mCapacity, data);
+  } else
+  {
+    mStore.resize((mSize+1)*mRecordSize);
+    writeRecord(mSize, data);
+  }
+  ++mSize;
+}
+
+/*! \internal
+  
+  Concludes appending data points with \ref appendUnchecked by updating the level of detail index.
+*/
+void QCPDataContainer::finishAppend()
+{
+  if (mAppendStart < 0)
+  {
+    // the ring buffer was overrun by the appended points, the index can't follow incrementally:
+    mLodIndex.invalidate();
+  } else
+    mLodIndex.append(view(), mAppendStart);
+}
+
+/*! \internal
+  
+  Writes \a data to the record at \a slot of the store, using the current record layout. If the
+  layout doesn't hold errors, the errors of \a data are dropped.
+*/
+void QCPDataContainer::writeRecord(int slot, const QCPData &data)
+{
+  double *record = mStore.data()+qint64(slot)*mRecordSize;
+  record[0] = data.key;
+  record[1] = data.value;
+  if (mRecordSize == fullRecordSize)
+  {
+    record[2] = data.keyErrorPlus;
+    record[3] = data.keyErrorMinus;
+    record[4] = data.valueErrorPlus;
+    record[5] = data.valueErrorMinus;
+  }
+}
+
+/*! \internal
+  
+  Returns a copy of all data points in the container as a plain vector.
+*/
+QVector<QCPData> QCPDataContainer::toVector() const
+{
+  QVector<QCPData> result;
+  result.reserve(mSize);
+  for (int i=0; i<mSize; ++i)
+    result.append(at(i));
+  return result;
+}
+
+/*! \internal
+  
+  Replaces the content of the store with \a data, which must be sorted by key. The record layout
+  holds errors if \a withErrors is true or any point in \a data has non-zero errors, otherwise
+  only keys and values are stored.
+  
+  In ring buffer mode, the oldest points that exceed the capacity are discarded and the remaining
+  ones are written to a newly allocated ring buffer.
+*/
+void QCPDataContainer::assign(const QVector<QCPData> &data, bool withErrors)
+{
+  for (int i=0; i<data.size() && !withErrors; ++i)
+    withErrors = containsErrors(data.at(i));
+  mRecordSize = withErrors ? fullRecordSize : compactRecordSize;
+  newRevision();
+  
+  int discard = mCapacity > 0 ? qMax(0, data.size()-mCapacity) : 0;
+  mBegin = 0;
+  mSize = data.size()-discard;
+  if (mCapacity > 0)
+  {
+    mStore = QVector<double>(2*mCapacity*mRecordSize);
+    for (int i=0; i<mSize; ++i)
+    {
+      writeRecord(i, data.at(i+discard));
+      writeRecord(i+mCapacity, data.at(i+discard));
+    }
+  } else
+  {
+    mStore = QVector<double>(mSize*mRecordSize);
+    for (int i=0; i<mSize; ++i)
+      writeRecord(i, data.at(i));
+  }
+  mLodIndex.invalidate();
+}
+
+/*! \internal
+  
+  Adds the points in \a data, which must be sorted by key, to the container.
+  
+  The current points with keys up to the smallest key in \a data keep their place. The remaining
+  points (the tail) are merged with \a data in linear time, removed from the container and then
+  appended again together with \a data. This way, the ring buffer and the level of detail index
+  are handled by the same code as a plain append, which is also what this function boils down to
+  when \a data starts after the current last key.
+*/
+void QCPDataContainer::mergeSorted(const QVector<QCPData> &data)
+{
+  if (data.isEmpty()) return;
+  if (isEmpty())
+  {
+    assign(data, false);
+    return;
+  }
+  
+  int split = upperBound(data.first().key);
+  QVector<QCPData> merged;
+  if (split < mSize)
+  {
+    merged.resize(mSize-split+data.size());
+    QCPDataView current = view();
+    int i = split;
+    int j = 0;
+    int k = 0;
+    while (i < mSize && j < data.size())
+    {
+      // on equal keys, current points come first, to keep points in the order they were added:
+      if (data.at(j).key < current.key(i))
+        merged[k++] = data.at(j++);
+      else
+        merged[k++] = at(i++);
+    }
+    while (i < mSize)
+      merged[k++] = at(i++);
+    while (j < data.size())
+      merged[k++] = data.at(j++);
+    removeRange(split, mSize);
+  } else
+    merged = data; // plain append, implicitly shared
+  
+  bool withErrors = false;
+  for (int i=0; i<data.size() && !withErrors; ++i)
+    withErrors = containsErrors(data.at(i));
+  reserveAppend(merged.size(), withErrors);
+  for (int i=0; i<merged.size(); ++i)
+    appendUnchecked(merged.at(i));
+  finishAppend();
+}
+
+/*! \internal
+  
+  Sorts a range of data points by key, keeping the order of points with equal keys. Used as task
+  of \ref QCPDataContainer::sortByKey.
+*/
+static void qcpSortDataRange(QCPData *begin, QCPData *end)
+{
+  qStableSort(begin, end, qcpDataKeyLessThan);
+}
+
+/*! \internal
+  
+  Merges the two sorted, adjacent ranges of data points from \a begin to \a middle and from \a
+  middle to \a end into \a dest. Points of the first range come before points of the second range
+  with equal keys. Used as task of \ref QCPDataContainer::sortByKey.
+*/
+static void qcpMergeDataRanges(const QCPData *begin, const QCPData *middle, const QCPData *end, QCPData *dest)
+{
+  const QCPData *first = begin;
+  const QCPData *second = middle;
+  while (first != middle && second != end)
+  {
+    if (second->key < first->key)
+      *dest++ = *second++;
+    else
+      *dest++ = *first++;
+  }
+  dest = qCopy(first, middle, dest);
+  qCopy(second, end, dest);
+}
+
+/*! \internal
+  
+  Sorts \a data by key, keeping the order of points with equal keys.
+  
+  If \a data is large enough to be split into several chunks of at least parallelSortChunkSize
+  points, and more than one processor core is available, the chunks are sorted concurrently in the
+  global thread pool. The sorted chunks are then merged pairwise, again concurrently, until one
+  sorted range is left.
+*/
+void QCPDataContainer::sortByKey(QVector<QCPData> &data)
+{
+  const int size = data.size();
+  int chunkCount = qMin(QThread::idealThreadCount(), size/parallelSortChunkSize);
+  if (chunkCount < 2)
+  {
+    qStableSort(data.begin(), data.end(), qcpDataKeyLessThan);
+    return;
+  }
+  
+  // sort chunks concurrently:
+  QVector<int> bounds(chunkCount+1);
+  for (int i=0; i<=chunkCount; ++i)
+    bounds[i] = qint64(size)*i/chunkCount;
+  QCPData *source = data.data();
+  QFutureSynchronizer<void> synchronizer;
+  for (int i=0; i<chunkCount; ++i)
+    synchronizer.addFuture(QtConcurrent::run(qcpSortDataRange, source+bounds.at(i), source+bounds.at(i+1)));
+  synchronizer.waitForFinished();
+  
+  // merge neighbouring chunks until only one is left, alternating between data and buffer as destination:
+  QVector<QCPData> buffer(size);
+  QCPData *dest = buffer.data();
+  while (bounds.size() > 2)
+  {
+    QVector<int> mergedBounds;
+    for (int i=0; i+1<bounds.size(); i+=2)
+    {
+      mergedBounds.append(bounds.at(i));
+      if (i+2 < bounds.size())
+        synchronizer.addFuture(QtConcurrent::run(qcpMergeDataRanges, source+bounds.at(i), source+bounds.at(i+1), source+bounds.at(i+2), dest+bounds.at(i)));
+      else
+        qCopy(source+bounds.at(i), source+bounds.at(i+1), dest+bounds.at(i)); // odd chunk out, carry over
+    }
+    mergedBounds.append(size);
+    synchronizer.waitForFinished();
+    bounds = mergedBounds;
+    qSwap(source, dest);
+  }
+  if (source != data.data())
+    qCopy(source, source+size, data.data());
+}
+
+/*! \internal
+  
+  Returns whether the keys of the points in \a data are ascending.
+*/
+bool QCPDataContainer::isSorted(const QVector<QCPData> &data)
+{
+  for (int i=1; i<data.size(); ++i)
+  {
+    if (data.at(i).key < data.at(i-1).key)
+      return false;
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Returns whether any of the errors of \a data is non-zero.
+*/
+bool QCPDataContainer::containsErrors(const QCPData &data)
+{
+  return data.keyErrorPlus != 0 || data.keyErrorMinus != 0 || data.valueErrorPlus != 0 || data.valueErrorMinus != 0;
+}
+
+
 // ================================================================================
 // =================== QCPGraph
 // ================================================================================
@@ -117,7 +1501,7 @@ QCPData::QCPData(double key, double value) :
 QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable(keyAxis, valueAxis)
 {
-  mData = new QCPDataMap;
+  mData = new QCPDataContainer;
   
   setPen(QPen(Qt::blue));
   setErrorPen(QPen(Qt::black));
@@ -132,6 +1516,9 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setErrorBarSize(6);
   setErrorBarSkipSymbol(true);
   setChannelFillGraph(0);
+  setAdaptiveSampling(true);
+  setLodIndex(false);
+  setDataCapacity(0);
 }
 
 QCPGraph::~QCPGraph()
@@ -154,8 +1541,11 @@ QCPGraph::~QCPGraph()
   If \a copy is set to true, data points in \a data will only be copied. if false, the graph
   takes ownership of the passed data and replaces the internal data pointer with it. This is
   significantly faster than copying for large datasets.
+  
+  The level of detail index and capacity settings of the graph (\ref setLodIndex, \ref
+  setDataCapacity) are applied to the new data.
 */
-void QCPGraph::setData(QCPDataMap *data, bool copy)
+void QCPGraph::setData(QCPDataContainer *data, bool copy)
 {
   if (copy)
   {
@@ -165,6 +1555,24 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
     delete mData;
     mData = data;
   }
+  mData->newRevision(); // data may carry a revision the geometry cache has already seen, e.g. when copied from another container
+  mData->setLodIndex(mLodIndex);
+  mData->setCapacity(mDataCapacity);
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided \a data map. The data points are transferred into
+  the graph's internal \ref QCPDataContainer.
+  
+  If \a copy is set to true, \a data will stay untouched. If false, the graph takes ownership of
+  the passed map and deletes it after its points were transferred.
+*/
+void QCPGraph::setData(QCPDataMap *data, bool copy)
+{
+  mData->set(*data);
+  if (!copy)
+    delete data;
 }
 
 /*! \overload
@@ -172,19 +1580,21 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
   Replaces the current data with the provided points in \a key and \a value pairs. The provided
   vectors should have equal length. Else, the number of added points will be the size of the
   smallest vector.
+  
+  If you know that \a key is sorted ascending, set \a alreadySorted to true to skip the check
+  whether the points need to be sorted (see \ref QCPDataContainer::set).
 */
-void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
+void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value, bool alreadySorted)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    mData->insertMulti(newData.key, newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
   }
+  mData->set(newData, alreadySorted);
 }
 
 /*!
@@ -198,19 +1608,18 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.valueErrorMinus = valueError[i];
-    newData.valueErrorPlus = valueError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].valueErrorMinus = valueError[i];
+    newData[i].valueErrorPlus = valueError[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -224,20 +1633,19 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.valueErrorMinus = valueErrorMinus[i];
-    newData.valueErrorPlus = valueErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].valueErrorMinus = valueErrorMinus[i];
+    newData[i].valueErrorPlus = valueErrorPlus[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -251,19 +1659,18 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, keyError.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyError[i];
-    newData.keyErrorPlus = keyError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyError[i];
+    newData[i].keyErrorPlus = keyError[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -277,20 +1684,19 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyErrorMinus[i];
-    newData.keyErrorPlus = keyErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyErrorMinus[i];
+    newData[i].keyErrorPlus = keyErrorPlus[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -304,22 +1710,21 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError, const QVector<double> &valueError)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueError.size());
   n = qMin(n, keyError.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyError[i];
-    newData.keyErrorPlus = keyError[i];
-    newData.valueErrorMinus = valueError[i];
-    newData.valueErrorPlus = valueError[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyError[i];
+    newData[i].keyErrorPlus = keyError[i];
+    newData[i].valueErrorMinus = valueError[i];
+    newData[i].valueErrorPlus = valueError[i];
   }
+  mData->set(newData);
 }
 
 /*!
@@ -333,24 +1738,23 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
-  mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
   n = qMin(n, valueErrorMinus.size());
   n = qMin(n, valueErrorPlus.size());
   n = qMin(n, keyErrorMinus.size());
   n = qMin(n, keyErrorPlus.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = key[i];
-    newData.value = value[i];
-    newData.keyErrorMinus = keyErrorMinus[i];
-    newData.keyErrorPlus = keyErrorPlus[i];
-    newData.valueErrorMinus = valueErrorMinus[i];
-    newData.valueErrorPlus = valueErrorPlus[i];
-    mData->insertMulti(key[i], newData);
+    newData[i].key = key[i];
+    newData[i].value = value[i];
+    newData[i].keyErrorMinus = keyErrorMinus[i];
+    newData[i].keyErrorPlus = keyErrorPlus[i];
+    newData[i].valueErrorMinus = valueErrorMinus[i];
+    newData[i].valueErrorPlus = valueErrorPlus[i];
   }
+  mData->set(newData);
 }
 
 
@@ -473,13 +1877,102 @@ void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
   mChannelFillGraph = targetGraph;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this graph. QCustomPlot's adaptive
+  sampling technique can drastically improve the replot performance for graphs with a large number
+  of points (e.g. above 10,000), without notably changing the appearance of the graph.
+  
+  When many data points fall into the same pixel column of the key axis, only the first and last
+  point of that column and the points with the minimum and maximum value inside it are used for
+  the line. The resulting line covers exactly the same pixels, but the number of line segments
+  that need to be drawn only depends on the size of the axis rect and not on the number of data
+  points. This applies to all line styles (\ref setLineStyle). Scatter symbols and error bars are
+  still drawn for every visible data point.
+  
+  Adaptive sampling is enabled by default. There is usually no reason to disable it, except when
+  the exact path of the line inside a single pixel column is relevant, e.g. when exporting to a
+  vector format with the intention to zoom into the graph.
+*/
+void QCPGraph::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
+/*!
+  Sets whether the graph's data container maintains a level of detail index over the data values
+  (see \ref QCPDataContainer::setLodIndex).
+  
+  With adaptive sampling (\ref setAdaptiveSampling), every visible data point is still visited
+  once per replot. For graphs with millions of points in the visible key range, this scan becomes
+  the dominating cost. If the level of detail index is enabled, the adaptive sampling instead
+  determines the value extremes of each pixel column with binary searches and index lookups, so
+  the replot time becomes nearly independent of the number of visible data points. The line
+  covers the same pixels, only the exact keys at which the minimum and maximum of a pixel column
+  are reached are no longer preserved.
+  
+  The index costs additional memory of roughly a quarter of the data values and some time when
+  data is modified. It is therefore disabled by default. Enable it for very large graphs that are
+  replotted often, e.g. when the user zooms and drags through a long recording.
+*/
+void QCPGraph::setLodIndex(bool enabled)
+{
+  mLodIndex = enabled;
+  mData->setLodIndex(mLodIndex);
+}
+
+/*!
+  Limits the number of data points the graph holds to \a capacity. When new data points are added
+  to a full graph, the oldest data points are discarded. If \a capacity is 0, the number of data
+  points is unlimited, which is the default.
+  
+  This is intended for realtime plots that show a sliding window of the most recent data. The data
+  container then works as a preallocated ring buffer (see \ref QCPDataContainer::setCapacity), so
+  adding a point and discarding the oldest one is O(1) and doesn't allocate memory. Calling \ref
+  removeDataBefore additionally to trim the data by key stays O(1), too.
+  
+  Note that the ring buffer uses the memory of twice \a capacity data points, regardless of how
+  many points the graph currently holds.
+*/
+void QCPGraph::setDataCapacity(int capacity)
+{
+  if (capacity < 0)
+  {
+    qDebug() << Q_FUNC_INFO << "capacity must not be negative:" << capacity;
+    return;
+  }
+  mDataCapacity = capacity;
+  mData->setCapacity(mDataCapacity);
+}
+
+/*!
+  Sets an external data source that this graph plots instead of the data in its own data
+  container. The graph then reads the keys and values directly from the memory described by the
+  source (see \ref QCPAbstractDataSource), so large data sets that already exist in the
+  application's memory, e.g. acquisition buffers or memory-mapped files, don't need to be copied.
+  Only the visible data points (reduced by adaptive sampling, see \ref setAdaptiveSampling) are
+  read during a replot.
+  
+  The graph doesn't take ownership of \a source. If \a source is deleted, the graph automatically
+  returns to plotting its own data container. Pass 0 to return to the data container explicitly.
+  
+  While a data source is set, the data container (\ref data) still exists and may be modified
+  with the usual functions like \ref setData and \ref addData, but it isn't plotted. Since data
+  sources don't provide error bars, the error bars of a graph with a data source are not drawn.
+  
+  \see dataView
+*/
+void QCPGraph::setDataSource(QCPAbstractDataSource *source)
+{
+  mDataSource = source;
+}
+
 /*!
   Adds the provided data points in \a dataMap to the current data.
   \see removeData
 */
 void QCPGraph::addData(const QCPDataMap &dataMap)
 {
-  mData->unite(dataMap);
+  mData->add(dataMap);
 }
 
 /*! \overload
@@ -488,7 +1981,7 @@ void QCPGraph::addData(const QCPDataMap &dataMap)
 */
 void QCPGraph::addData(const QCPData &data)
 {
-  mData->insertMulti(data.key, data);
+  mData->add(data);
 }
 
 /*! \overload
@@ -497,26 +1990,27 @@ void QCPGraph::addData(const QCPData &data)
 */
 void QCPGraph::addData(double key, double value)
 {
-  QCPData newData;
-  newData.key = key;
-  newData.value = value;
-  mData->insertMulti(newData.key, newData);
+  mData->add(QCPData(key, value));
 }
 
 /*! \overload
   Adds the provided data points as \a key and \a value pairs to the current data.
+  
+  Sorted points are merged with the current data in linear time, unsorted ones are sorted first
+  (see \ref QCPDataContainer::add). If you know that \a keys is sorted ascending, set \a
+  alreadySorted to true to skip the check whether the points need to be sorted.
   \see removeData
 */
-void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values)
+void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
 {
   int n = qMin(keys.size(), values.size());
-  QCPData newData;
+  QVector<QCPData> newData(n);
   for (int i=0; i<n; ++i)
   {
-    newData.key = keys[i];
-    newData.value = values[i];
-    mData->insertMulti(newData.key, newData);
+    newData[i].key = keys[i];
+    newData[i].value = values[i];
   }
+  mData->add(newData, alreadySorted);
 }
 
 /*!
@@ -525,9 +2019,7 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
-  QCPDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  mData->removeBefore(key);
 }
 
 /*!
@@ -536,10 +2028,7 @@ void QCPGraph::removeDataBefore(double key)
 */
 void QCPGraph::removeDataAfter(double key)
 {
-  if (mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->removeAfter(key);
 }
 
 /*!
@@ -551,11 +2040,7 @@ void QCPGraph::removeDataAfter(double key)
 */
 void QCPGraph::removeData(double fromKey, double toKey)
 {
-  if (fromKey >= toKey || mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(fromKey);
-  QCPDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->remove(fromKey, toKey);
 }
 
 /*! \overload
@@ -580,10 +2065,25 @@ void QCPGraph::clearData()
   mData->clear();
 }
 
+/*!
+  Returns a \ref QCPDataView on the keys and values this graph currently plots. If a data source
+  is set (\ref setDataSource), this is the view provided by the data source, otherwise a view on
+  the graph's data container (\ref data).
+  
+  The view is only valid until the data is modified.
+*/
+QCPDataView QCPGraph::dataView() const
+{
+  if (mDataSource)
+    return mDataSource->dataView();
+  else
+    return mData->view();
+}
+
 /* inherits documentation from base class */
 double QCPGraph::selectTest(const QPointF &pos) const
 {
-  if (mData->isEmpty() || !mVisible)
+  if (dataView().isEmpty() || !mVisible)
     return -1;
   
   return pointDistance(pos);
@@ -609,7 +2109,7 @@ void QCPGraph::rescaleKeyAxis(bool onlyEnlarge, bool includeErrorBars) const
 {
   // this code is a copy of QCPAbstractPlottable::rescaleKeyAxis with the only change
   // that getKeyRange is passed the includeErrorBars value.
-  if (mData->isEmpty()) return;
+  if (dataView().isEmpty()) return;
 
   SignDomain signDomain = sdBoth;
   if (mKeyAxis->scaleType() == QCPAxis::stLogarithmic)
@@ -637,17 +2137,38 @@ void QCPGraph::rescaleKeyAxis(bool onlyEnlarge, bool includeErrorBars) const
   when determining the new axis range.
 */
 void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
+{
+  rescaleValueAxis(onlyEnlarge, includeErrorBars, false);
+}
+
+/*! \overload
+  
+  If \a inKeyRange is true, only the data points with keys inside the current range of the key
+  axis are taken into consideration, so the value axis is fit to the visible part of the graph.
+  Calling this in a slot connected to the \ref QCPAxis::rangeChanged signal of the key axis keeps
+  the graph vertically fit while the user drags or zooms horizontally.
+  
+  The visible data points are found with binary searches. If the level of detail index is enabled
+  (\ref setLodIndex), their value range is determined in O(log n) time, so this function is cheap
+  even for millions of visible points. This does not apply to logarithmic value axes, or if error
+  bars are included and the graph has error values. Then the visible points are scanned.
+*/
+void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars, bool inKeyRange) const
 {
   // this code is a copy of QCPAbstractPlottable::rescaleValueAxis with the only change
-  // is that getValueRange is passed the includeErrorBars value.
-  if (mData->isEmpty()) return;
+  // is that getValueRange is passed the includeErrorBars value and optionally the key range.
+  if (dataView().isEmpty()) return;
 
   SignDomain signDomain = sdBoth;
   if (mValueAxis->scaleType() == QCPAxis::stLogarithmic)
     signDomain = (mValueAxis->range().upper < 0 ? sdNegative : sdPositive);
   
   bool validRange;
-  QCPRange newRange = getValueRange(validRange, signDomain, includeErrorBars);
+  QCPRange newRange;
+  if (inKeyRange)
+    newRange = getValueRange(validRange, signDomain, includeErrorBars, mKeyAxis->range());
+  else
+    newRange = getValueRange(validRange, signDomain, includeErrorBars);
   
   if (validRange)
   {
@@ -665,35 +2186,64 @@ void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
 /* inherits documentation from base class */
 void QCPGraph::draw(QCPPainter *painter)
 {
-  if (mKeyAxis->range().size() <= 0 || mData->isEmpty()) return;
+  if (mKeyAxis->range().size() <= 0 || dataView().isEmpty()) return;
   if (mLineStyle == lsNone && mScatterStyle == QCP::ssNone) return;
   
-  // allocate line and (if necessary) point vectors:
-  QVector<QPointF> *lineData = new QVector<QPointF>;
-  QVector<QCPData> *pointData = 0;
-  if (mScatterStyle != QCP::ssNone)
-    pointData = new QVector<QCPData>;
+  // if only a part of the axis rect is rendered (see QCPPainter::setDataRegion), only process the
+  // data in and near it:
+  QCPRange keyRange = mKeyAxis->range();
+  bool restricted = !painter->dataRegion().isNull();
+  if (restricted)
+  {
+    QRectF region = painter->dataRegion();
+    double a, b;
+    if (mKeyAxis->orientation() == Qt::Horizontal)
+    {
+      a = mKeyAxis->pixelToCoord(region.left());
+      b = mKeyAxis->pixelToCoord(region.right());
+    } else
+    {
+      a = mKeyAxis->pixelToCoord(region.bottom());
+      b = mKeyAxis->pixelToCoord(region.top());
+    }
+    keyRange.lower = qMax(keyRange.lower, qMin(a, b));
+    keyRange.upper = qMin(keyRange.upper, qMax(a, b));
+    if (keyRange.lower > keyRange.upper)
+      return;
+  }
+  
+  // during user interactions, reduce detail if more points are visible than the draft point budget:
+  int draftStride = 1;
+  if (painter->draftMode() && mParentPlot->draftPointBudget() > 0)
+  {
+    int lower, upper, count;
+    getVisibleDataBounds(lower, upper, count, keyRange);
+    int budget = mParentPlot->draftPointBudget();
+    if (count > budget)
+      draftStride = (count+budget-1)/budget;
+  }
   
-  // fill vectors with data appropriate to plot style:
-  getPlotData(lineData, pointData);
+  // get line and (if necessary) point vectors appropriate to plot style:
+  QVector<QPointF> lineData;
+  QVector<QCPData> pointData;
+  bool drawScatters = mScatterStyle != QCP::ssNone && (draftStride == 1 || mLineStyle == lsNone); // with reduced detail, scatters are only drawn if there is no line
+  if (restricted) // the geometry cache holds the whole axis range
+    getPlotData(&lineData, drawScatters ? &pointData : 0, draftStride, keyRange);
+  else
+    getCachedPlotData(&lineData, drawScatters ? &pointData : 0, draftStride);
 
   // draw fill of graph:
-  drawFill(painter, lineData);
+  drawFill(painter, &lineData, draftStride);
   
   // draw line:
   if (mLineStyle == lsImpulse)
-    drawImpulsePlot(painter, lineData);
+    drawImpulsePlot(painter, &lineData);
   else if (mLineStyle != lsNone)
-    drawLinePlot(painter, lineData); // also step plots can be drawn as a line plot
+    drawLinePlot(painter, &lineData); // also step plots can be drawn as a line plot
   
   // draw scatters:
-  if (pointData)
-    drawScatterPlot(painter, pointData);
-  
-  // free allocated line and point vectors:
-  delete lineData;
-  if (pointData)
-    delete pointData;
+  if (drawScatters)
+    drawScatterPlot(painter, &pointData, draftStride);
 }
 
 /* inherits documentation from base class */
@@ -734,67 +2284,155 @@ void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRect &rect) const
   line style of the graph.
   \param lineData will be filled with raw points that will be drawn with the according draw functions, e.g. \ref drawLinePlot and \ref drawImpulsePlot.
   These aren't necessarily the original data points, since for step plots for example, additional points are needed for drawing lines that make up steps.
-  If the line style of the graph is \ref lsNone, the \a lineData vector will be left untouched.
+  If the line style of the graph is \ref lsNone or the graph has no data, the \a lineData vector will be left untouched.
   \param pointData will be filled with the original data points so \ref drawScatterPlot can draw the scatter symbols accordingly. If no scatters need to be
   drawn, i.e. scatter style is \ref QCP::ssNone, pass 0 as \a pointData, and this step will be skipped.
+  \param draftStride is one for the full level of detail. While the graph is drawn with reduced detail
+  (see QCustomPlot::setDraftPointBudget), only every \a draftStride-th data point is used.
+  \param keyRange is the key range whose data points are processed, usually the range of the key
+  axis. When only a part of the axis rect is drawn, \ref draw passes the corresponding key range.
   
   \see getScatterPlotData, getLinePlotData, getStepLeftPlotData, getStepRightPlotData, getStepCenterPlotData, getImpulsePlotData
 */
-void QCPGraph::getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
+  if (dataView().isEmpty()) return;
   switch(mLineStyle)
   {
-    case lsNone: getScatterPlotData(pointData); break;
-    case lsLine: getLinePlotData(lineData, pointData); break;
-    case lsStepLeft: getStepLeftPlotData(lineData, pointData); break;
-    case lsStepRight: getStepRightPlotData(lineData, pointData); break;
-    case lsStepCenter: getStepCenterPlotData(lineData, pointData); break;
-    case lsImpulse: getImpulsePlotData(lineData, pointData); break;
+    case lsNone: getScatterPlotData(pointData, draftStride, keyRange); break;
+    case lsLine: getLinePlotData(lineData, pointData, draftStride, keyRange); break;
+    case lsStepLeft: getStepLeftPlotData(lineData, pointData, draftStride, keyRange); break;
+    case lsStepRight: getStepRightPlotData(lineData, pointData, draftStride, keyRange); break;
+    case lsStepCenter: getStepCenterPlotData(lineData, pointData, draftStride, keyRange); break;
+    case lsImpulse: getImpulsePlotData(lineData, pointData, draftStride, keyRange); break;
+  }
+}
+
+/*! \internal
+  
+  Like \ref getPlotData, but the generated vectors are retained in a cache and reused, as long as
+  the axis ranges, axis rects and scale types, the line style and sampling settings as well as the
+  data points (see QCPDataContainer::revision) are unchanged. Drawing, hit testing (\ref
+  pointDistance) and channel fills of other graphs (\ref getChannelFillPolygon) thus share the
+  generated geometry, and replots that don't change the graph don't regenerate it.
+  
+  The returned vectors are implicitly shared with the cache, so callers may modify them without
+  affecting it.
+  
+  Graphs with an external data source (\ref setDataSource), which may change without notice, and
+  requests with reduced detail (\a draftStride greater than one) don't use the cache.
+  
+  This is thread-safe, a channel fill may request the geometry of its target graph from a worker
+  thread (see QCP::phParallelPlottables). The level of detail is passed in by the caller rather
+  than kept on the graph, so such a request always gets the full detail, even while the target
+  graph itself is drawn with reduced detail.
+*/
+void QCPGraph::getCachedPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride) const
+{
+  if (dataView().isEmpty()) return;
+  if (mDataSource || draftStride > 1)
+  {
+    getPlotData(lineData, pointData, draftStride, mKeyAxis->range());
+    return;
   }
+  
+  QMutexLocker locker(&mGeometryCacheMutex);
+  CachedGeometry &cache = mGeometryCache;
+  CachedAxisState keyAxisState = cachedAxisState(mKeyAxis);
+  CachedAxisState valueAxisState = cachedAxisState(mValueAxis);
+  if (!cache.valid || !(cache.keyAxis == keyAxisState) || !(cache.valueAxis == valueAxisState) ||
+      cache.lineStyle != mLineStyle || cache.adaptiveSampling != mAdaptiveSampling || cache.lodIndex != mLodIndex ||
+      cache.revision != mData->revision() || cache.frontOffset != mData->frontOffset() || cache.size != mData->size())
+  {
+    cache.lineData.clear();
+    cache.pointData.clear();
+    getPlotData(&cache.lineData, pointData ? &cache.pointData : 0, 1, mKeyAxis->range());
+    cache.valid = true;
+    cache.hasPointData = pointData != 0;
+    cache.keyAxis = keyAxisState;
+    cache.valueAxis = valueAxisState;
+    cache.lineStyle = mLineStyle;
+    cache.adaptiveSampling = mAdaptiveSampling;
+    cache.lodIndex = mLodIndex;
+    cache.revision = mData->revision();
+    cache.frontOffset = mData->frontOffset();
+    cache.size = mData->size();
+  } else if (pointData && !cache.hasPointData) // the point vector doesn't depend on the line style, see getPlotData
+  {
+    getScatterPlotData(&cache.pointData, 1, mKeyAxis->range());
+    cache.hasPointData = true;
+  }
+  if (lineData)
+    *lineData = cache.lineData;
+  if (pointData)
+    *pointData = cache.pointData;
+}
+
+/*! \internal
+  
+  Returns the state of \a axis that determines how coordinates are transformed to pixels, for use
+  as part of the key of the geometry cache (see \ref getCachedPlotData).
+*/
+QCPGraph::CachedAxisState QCPGraph::cachedAxisState(QCPAxis *axis) const
+{
+  CachedAxisState state;
+  state.axis = axis;
+  state.range = axis->range();
+  state.axisRect = axis->axisRect();
+  state.scaleType = axis->scaleType();
+  state.scaleLogBase = axis->scaleLogBase();
+  state.rangeReversed = axis->rangeReversed();
+  return state;
+}
+
+bool QCPGraph::CachedAxisState::operator==(const CachedAxisState &other) const
+{
+  return axis == other.axis && range.lower == other.range.lower && range.upper == other.range.upper &&
+      axisRect == other.axisRect && scaleType == other.scaleType && scaleLogBase == other.scaleLogBase &&
+      rangeReversed == other.rangeReversed;
 }
 
 /*! 
   \internal
-  If line style is \ref lsNone and scatter style is not \ref QCP::ssNone, this function serves at providing the
-  visible data points in \a pointData, so the \ref drawScatterPlot function can draw the scatter points
-  accordingly.
+  Provides the visible data points in \a pointData, so the \ref drawScatterPlot function can draw
+  the scatter points accordingly. If line style is \ref lsNone, this is the only plot data that is
+  generated.
   
-  If line style is not \ref lsNone, this function is not called and the data for the scatter points
-  are (if needed) calculated inside the corresponding other "get(...)PlotData" functions.
+  For the other line styles, the "get(...)PlotData" functions call this function to fill their \a
+  pointData. Unlike the line data, the scatter points are never reduced by adaptive sampling (see
+  \ref setAdaptiveSampling), so every visible data point gets its scatter symbol.
   \see drawScatterPlot
 */
-void QCPGraph::getScatterPlotData(QVector<QCPData> *pointData) const
+void QCPGraph::getScatterPlotData(QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
   if (!pointData) return;
   
   // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  if (draftStride > 1) // reduced detail (see draw), only use every draftStride-th point
+  {
+    QCPDataView data = dataView();
+    pointData->clear();
+    pointData->reserve(dataCount/draftStride+1);
+    for (int i=lower; i<=upper; i+=draftStride)
+      pointData->append(QCPData(data.key(i), data.value(i)));
+    return;
+  }
   // prepare vectors:
-  if (pointData)
-    pointData->resize(dataCount);
+  pointData->resize(dataCount);
 
-  // position data points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
-  int i = 0;
-  if (mKeyAxis->orientation() == Qt::Vertical)
+  // copy data points:
+  if (mDataSource)
   {
-    while (it != upperEnd)
-    {
-      (*pointData)[i] = it.value();
-      ++i;
-      ++it;
-    }
-  } else // key axis is horizontal
+    QCPDataView data = dataView();
+    for (int i=0; i<dataCount; ++i)
+      (*pointData)[i] = QCPData(data.key(lower+i), data.value(lower+i));
+  } else
   {
-    while (it != upperEnd)
-    {
-      (*pointData)[i] = it.value();
-      ++i;
-      ++it;
-    }
+    for (int i=0; i<dataCount; ++i)
+      (*pointData)[i] = mData->at(lower+i);
   }
 }
 
@@ -808,48 +2446,33 @@ void QCPGraph::getScatterPlotData(QVector<QCPData> *pointData) const
   filling the vector.
   \see drawLinePlot
 */
-void QCPGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the line consists of:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
   // prepare vectors:
-  if (lineData)
-  { 
-    // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-    lineData->reserve(dataCount+2);
-    lineData->resize(dataCount);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  lineData->reserve(count+2);
+  lineData->resize(count);
 
-  // position data points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
-  int i = 0;
+  // position data points, transforming keys and values directly into the coordinates of the polyline points:
+  if (count == 0) return;
+  QPointF *points = lineData->data();
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
-    while (it != upperEnd)
-    {
-      if (pointData)
-        (*pointData)[i] = it.value();
-      (*lineData)[i].setX(mValueAxis->coordToPixel(it.value().value));
-      (*lineData)[i].setY(mKeyAxis->coordToPixel(it.key()));
-      ++i;
-      ++it;
-    }
+    mValueAxis->coordToPixel(data.values(), &points->rx(), count, data.valueStride(), sizeof(QPointF));
+    mKeyAxis->coordToPixel(data.keys(), &points->ry(), count, data.keyStride(), sizeof(QPointF));
   } else // key axis is horizontal
   {
-    while (it != upperEnd)
-    {
-      if (pointData)
-        (*pointData)[i] = it.value();
-      (*lineData)[i].setX(mKeyAxis->coordToPixel(it.key()));
-      (*lineData)[i].setY(mValueAxis->coordToPixel(it.value().value));
-      ++i;
-      ++it;
-    }
+    mKeyAxis->coordToPixel(data.keys(), &points->rx(), count, data.keyStride(), sizeof(QPointF));
+    mValueAxis->coordToPixel(data.values(), &points->ry(), count, data.valueStride(), sizeof(QPointF));
   }
 }
 
@@ -863,69 +2486,56 @@ void QCPGraph::getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *poi
   filling the vector.
   \see drawLinePlot
 */
-void QCPGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the line consists of:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
+  QVector<qreal> keyPixels, valuePixels;
+  getPixelCoords(data, &keyPixels, &valuePixels);
   // prepare vectors:
-  if (lineData)
-  {
-    // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-    // multiplied by 2 because step plot needs two polyline points per one actual data point
-    lineData->reserve(dataCount*2+2);
-    lineData->resize(dataCount*2);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  // multiplied by 2 because step plot needs two polyline points per one actual data point
+  lineData->reserve(count*2+2);
+  lineData->resize(count*2);
   
   // position data points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
   int i = 0;
-  int ipoint = 0;
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
-    double lastValue = mValueAxis->coordToPixel(it.value().value);
+    double lastValue = valuePixels.at(0);
     double key;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = mKeyAxis->coordToPixel(it.key());
+      key = keyPixels.at(d);
       (*lineData)[i].setX(lastValue);
       (*lineData)[i].setY(key);
       ++i;
-      lastValue = mValueAxis->coordToPixel(it.value().value);
+      lastValue = valuePixels.at(d);
       (*lineData)[i].setX(lastValue);
       (*lineData)[i].setY(key);
       ++i;
-      ++it;
     }
   } else // key axis is horizontal
   {
-    double lastValue = mValueAxis->coordToPixel(it.value().value);
+    double lastValue = valuePixels.at(0);
     double key;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = mKeyAxis->coordToPixel(it.key());
+      key = keyPixels.at(d);
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(lastValue);
       ++i;
-      lastValue = mValueAxis->coordToPixel(it.value().value);
+      lastValue = valuePixels.at(d);
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(lastValue);
       ++i;
-      ++it;
     }
   }
 }
@@ -940,69 +2550,56 @@ void QCPGraph::getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData>
   filling the vector.
   \see drawLinePlot
 */
-void QCPGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the line consists of:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
+  QVector<qreal> keyPixels, valuePixels;
+  getPixelCoords(data, &keyPixels, &valuePixels);
   // prepare vectors:
-  if (lineData)
-  {
-    // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-    // multiplied by 2 because step plot needs two polyline points per one actual data point
-    lineData->reserve(dataCount*2+2);
-    lineData->resize(dataCount*2);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  // multiplied by 2 because step plot needs two polyline points per one actual data point
+  lineData->reserve(count*2+2);
+  lineData->resize(count*2);
   
   // position points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
   int i = 0;
-  int ipoint = 0;
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = mKeyAxis->coordToPixel(it.key());
+    double lastKey = keyPixels.at(0);
     double value;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      value = mValueAxis->coordToPixel(it.value().value);
+      value = valuePixels.at(d);
       (*lineData)[i].setX(value);
       (*lineData)[i].setY(lastKey);
       ++i;
-      lastKey = mKeyAxis->coordToPixel(it.key());
+      lastKey = keyPixels.at(d);
       (*lineData)[i].setX(value);
       (*lineData)[i].setY(lastKey);
       ++i;
-      ++it;
     }
   } else // key axis is horizontal
   {
-    double lastKey = mKeyAxis->coordToPixel(it.key());
+    double lastKey = keyPixels.at(0);
     double value;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      value = mValueAxis->coordToPixel(it.value().value);
+      value = valuePixels.at(d);
       (*lineData)[i].setX(lastKey);
       (*lineData)[i].setY(value);
       ++i;
-      lastKey = mKeyAxis->coordToPixel(it.key());
+      lastKey = keyPixels.at(d);
       (*lineData)[i].setX(lastKey);
       (*lineData)[i].setY(value);
       ++i;
-      ++it;
     }
   }
 }
@@ -1017,92 +2614,67 @@ void QCPGraph::getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData>
   filling the vector.
   \see drawLinePlot
 */
-void QCPGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the line consists of:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
+  QVector<qreal> keyPixels, valuePixels;
+  getPixelCoords(data, &keyPixels, &valuePixels);
   // prepare vectors:
-  if (lineData)
-  {
-    // added 2 to reserve memory for lower/upper fill base points that might be needed for base fill
-    // multiplied by 2 because step plot needs two polyline points per one actual data point
-    lineData->reserve(dataCount*2+2);
-    lineData->resize(dataCount*2);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // added 2 to reserve memory for lower/upper fill base points that might be needed for base fill
+  // multiplied by 2 because step plot needs two polyline points per one actual data point
+  lineData->reserve(count*2+2);
+  lineData->resize(count*2);
   
   // position points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
   int i = 0;
-  int ipoint = 0;
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = mKeyAxis->coordToPixel(it.key());
-    double lastValue = mValueAxis->coordToPixel(it.value().value);
+    double lastKey = keyPixels.at(0);
+    double lastValue = valuePixels.at(0);
     double key;
-    if (pointData)
-    {
-      (*pointData)[ipoint] = it.value();
-      ++ipoint;
-    }
     (*lineData)[i].setX(lastValue);
     (*lineData)[i].setY(lastKey);
-    ++it;
     ++i;
-    while (it != upperEnd)
+    for (int d=1; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = (mKeyAxis->coordToPixel(it.key())-lastKey)*0.5 + lastKey;
+      key = (keyPixels.at(d)-lastKey)*0.5 + lastKey;
       (*lineData)[i].setX(lastValue);
       (*lineData)[i].setY(key);
       ++i;
-      lastValue = mValueAxis->coordToPixel(it.value().value);
-      lastKey = mKeyAxis->coordToPixel(it.key());
+      lastValue = valuePixels.at(d);
+      lastKey = keyPixels.at(d);
       (*lineData)[i].setX(lastValue);
       (*lineData)[i].setY(key);
-      ++it;
       ++i;
     }
     (*lineData)[i].setX(lastValue);
     (*lineData)[i].setY(lastKey);
   } else // key axis is horizontal
   {
-    double lastKey = mKeyAxis->coordToPixel(it.key());
-    double lastValue = mValueAxis->coordToPixel(it.value().value);
+    double lastKey = keyPixels.at(0);
+    double lastValue = valuePixels.at(0);
     double key;
-    if (pointData)
-    {
-      (*pointData)[ipoint] = it.value();
-      ++ipoint;
-    }
     (*lineData)[i].setX(lastKey);
     (*lineData)[i].setY(lastValue);
-    ++it;
     ++i;
-    while (it != upperEnd)
+    for (int d=1; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = (mKeyAxis->coordToPixel(it.key())-lastKey)*0.5 + lastKey;
+      key = (keyPixels.at(d)-lastKey)*0.5 + lastKey;
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(lastValue);
       ++i;
-      lastValue = mValueAxis->coordToPixel(it.value().value);
-      lastKey = mKeyAxis->coordToPixel(it.key());
+      lastValue = valuePixels.at(d);
+      lastKey = keyPixels.at(d);
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(lastValue);
-      ++it;
       ++i;
     }
     (*lineData)[i].setX(lastKey);
@@ -1120,65 +2692,52 @@ void QCPGraph::getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData
   filling the vector.
   \see drawImpulsePlot
 */
-void QCPGraph::getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const
+void QCPGraph::getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const
 {
-  // get visible data range:
-  QCPDataMap::const_iterator lower, upper;
+  getScatterPlotData(pointData, draftStride, keyRange);
+  
+  // get visible data range and the points the impulses are drawn for:
+  int lower, upper;
   int dataCount;
-  getVisibleDataBounds(lower, upper, dataCount);
+  getVisibleDataBounds(lower, upper, dataCount, keyRange);
+  QVector<QCPData> sampledData;
+  QCPDataView data = getLineSourceData(lower, upper, &sampledData, draftStride);
+  int count = data.size();
+  QVector<qreal> keyPixels, valuePixels;
+  getPixelCoords(data, &keyPixels, &valuePixels);
   // prepare vectors:
-  if (lineData)
-  {
-    // no need to reserve 2 extra points, because there is no fill for impulse plot
-    lineData->resize(dataCount*2);
-  }
-  if (pointData)
-    pointData->resize(dataCount);
+  // no need to reserve 2 extra points, because there is no fill for impulse plot
+  lineData->resize(count*2);
   
   // position data points:
-  QCPDataMap::const_iterator it = lower;
-  QCPDataMap::const_iterator upperEnd = upper+1;
   int i = 0;
-  int ipoint = 0;
   if (mKeyAxis->orientation() == Qt::Vertical)
   {
     double zeroPointX = mValueAxis->coordToPixel(0);
     double key;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = mKeyAxis->coordToPixel(it.key());
+      key = keyPixels.at(d);
       (*lineData)[i].setX(zeroPointX);
       (*lineData)[i].setY(key);
       ++i;
-      (*lineData)[i].setX(mValueAxis->coordToPixel(it.value().value));
+      (*lineData)[i].setX(valuePixels.at(d));
       (*lineData)[i].setY(key);
       ++i;
-      ++it;
     }
   } else // key axis is horizontal
   {
     double zeroPointY = mValueAxis->coordToPixel(0);
     double key;
-    while (it != upperEnd)
+    for (int d=0; d<count; ++d)
     {
-      if (pointData)
-      {
-        (*pointData)[ipoint] = it.value();
-        ++ipoint;
-      }
-      key = mKeyAxis->coordToPixel(it.key());
+      key = keyPixels.at(d);
       (*lineData)[i].setX(key);
       (*lineData)[i].setY(zeroPointY);
       ++i;
       (*lineData)[i].setX(key);
-      (*lineData)[i].setY(mValueAxis->coordToPixel(it.value().value));
+      (*lineData)[i].setY(valuePixels.at(d));
       ++i;
-      ++it;
     }
   }
 }
@@ -1194,12 +2753,15 @@ void QCPGraph::getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *
   polygon is calculated with the \ref getChannelFillPolygon function.
   \see drawLinePlot
 */
-void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const
+void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData, int draftStride) const
 {
   if (mLineStyle == lsImpulse) return; // fill doesn't make sense for impulse plot
   if (mainBrush().style() == Qt::NoBrush || mainBrush().color().alpha() == 0) return;
+  if (draftStride > 1 && mChannelFillGraph) return; // reduced detail, the channel needs the full line of the other graph
   
   applyFillAntialiasingHint(painter);
+  if (draftStride > 1) // reduced detail, fill without antialiasing
+    painter->setAntialiasing(false);
   if (!mChannelFillGraph)
   {
     // draw base fill under graph, fill goes all the way to the zero-value-line:
@@ -1224,22 +2786,24 @@ void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const
   is outputted by all "get(...)PlotData" functions, together with the (line style dependent) line data.
   \see drawLinePlot, drawImpulsePlot
 */
-void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData) const
+void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData, int draftStride) const
 {
+  if (pointData->isEmpty()) return;
+  
+  // transform all points to pixel coordinates at once:
+  const QCPData *points = pointData->constData();
+  QVector<qreal> keyPixels(pointData->size()), valuePixels(pointData->size());
+  mKeyAxis->coordToPixel(&points->key, keyPixels.data(), pointData->size(), sizeof(QCPData));
+  mValueAxis->coordToPixel(&points->value, valuePixels.data(), pointData->size(), sizeof(QCPData));
+  
   // draw error bars:
-  if (mErrorType != etNone)
+  if (mErrorType != etNone && !mDataSource && draftStride == 1) // external data sources don't provide error bars, reduced detail skips them
   {
     applyErrorBarsAntialiasingHint(painter);
     painter->setPen(mErrorPen);
-    if (mKeyAxis->orientation() == Qt::Vertical)
-    {
-      for (int i=0; i<pointData->size(); ++i)
-        drawError(painter, mValueAxis->coordToPixel(pointData->at(i).value), mKeyAxis->coordToPixel(pointData->at(i).key), pointData->at(i));
-    } else
-    {
-      for (int i=0; i<pointData->size(); ++i)
-        drawError(painter, mKeyAxis->coordToPixel(pointData->at(i).key), mValueAxis->coordToPixel(pointData->at(i).value), pointData->at(i));
-    }
+    QVector<QLineF> errorLines;
+    getErrorBarLines(&errorLines, pointData, keyPixels, valuePixels);
+    painter->drawLines(errorLines);
   }
   
   // draw scatter point symbols:
@@ -1247,15 +2811,28 @@ void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData)
   painter->setPen(mainPen());
   painter->setBrush(mainBrush());
   painter->setScatterPixmap(mScatterPixmap);
+  const qreal *xPixels = keyPixels.constData();
+  const qreal *yPixels = valuePixels.constData();
   if (mKeyAxis->orientation() == Qt::Vertical)
-  {
+    qSwap(xPixels, yPixels);
+  QVector<QPointF> scatters;
+  scatters.reserve(pointData->size());
+  if (scatterCullingUsable(mScatterStyle, mScatterPixmap))
+  {
+    // skip symbols on pixels that already hold an identical symbol:
+    QRect rect = clipRect();
+    QBitArray occupancy(rect.width()*rect.height());
     for (int i=0; i<pointData->size(); ++i)
-      painter->drawScatter(mValueAxis->coordToPixel(pointData->at(i).value), mKeyAxis->coordToPixel(pointData->at(i).key), mScatterSize, mScatterStyle);
+    {
+      if (!cullScatter(occupancy, rect, xPixels[i], yPixels[i]))
+        scatters.append(QPointF(xPixels[i], yPixels[i]));
+    }
   } else
   {
     for (int i=0; i<pointData->size(); ++i)
-      painter->drawScatter(mKeyAxis->coordToPixel(pointData->at(i).key), mValueAxis->coordToPixel(pointData->at(i).value), mScatterSize, mScatterStyle);
+      scatters.append(QPointF(xPixels[i], yPixels[i]));
   }
+  painter->drawScatters(scatters, mScatterSize, mScatterStyle);
 }
 
 /*! 
@@ -1275,23 +2852,13 @@ void QCPGraph::drawLinePlot(QCPPainter *painter, QVector<QPointF> *lineData) con
     painter->setPen(mainPen());
     painter->setBrush(Qt::NoBrush);
     
-    /* Draws polyline in batches, currently not used:
-    int p = 0;
-    while (p < lineData->size())
+    // draw long lines in chunks (see QCustomPlot::setPolylineChunkSize), or if drawing solid line
+    // and not in PDF, use much faster line drawing instead of polyline:
+    int chunkSize = mParentPlot->polylineChunkSize();
+    if (chunkSize > 0 || (chunkSize < 0 && !mParentPlot->plottingHints().testFlag(QCP::phFastPolylines)))
     {
-      int batch = qMin(25, lineData->size()-p);
-      if (p != 0)
-      {
-        ++batch;
-        --p; // to draw the connection lines between two batches
-      }
-      painter->drawPolyline(lineData->constData()+p, batch);
-      p += batch;
-    }
-    */
-    
-    // if drawing solid line and not in PDF, use much faster line drawing instead of polyline:
-    if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
+      painter->drawPolylineChunked(*lineData, chunkSize);
+    } else if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
         painter->pen().style() == Qt::SolidLine &&
         !painter->pdfExportMode())
     {
@@ -1324,137 +2891,324 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData)
   }
 }
 
-/*! 
-  \internal
-  called by the scatter drawing function (\ref drawScatterPlot) to draw the error bars on one data
-  point. \a x and \a y pixel positions of the data point are passed since they are already known in
-  pixel coordinates in the drawing function, so we save some extra coordToPixel transforms here. \a
-  data is therefore only used for the errors, not key and value.
+/*! \internal
+  
+  Called by the scatter drawing function (\ref drawScatterPlot) to generate the line segments of the
+  error bars of all points in \a pointData, so they can be drawn with a single call. \a keyPixels
+  and \a valuePixels are the pixel positions of the data points, which are already known in the
+  drawing function, so we save some extra coordToPixel transforms here. The segments are appended
+  to \a lines.
+  
+  Value error bars of consecutive points that fall into the same pixel column along the key axis
+  are merged into one envelope, reaching from the lowest to the highest error bound of those points
+  (with handles only at the ends). For dense graphs, this limits the number of value error bars to
+  the number of pixel columns.
 */
-void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData &data) const
+void QCPGraph::getErrorBarLines(QVector<QLineF> *lines, const QVector<QCPData> *pointData, const QVector<qreal> &keyPixels, const QVector<qreal> &valuePixels) const
 {
-  double a, b; // positions of error bar bounds in pixels
-  double barWidthHalf = mErrorBarSize*0.5;
-  double skipSymbolMargin = mScatterSize*1.25; // pixels left blank per side, when mErrorBarSkipSymbol is true
-
-  if (mKeyAxis->orientation() == Qt::Vertical)
+  const bool keyVertical = mKeyAxis->orientation() == Qt::Vertical;
+  const bool keyErrors = mErrorType == etKey || mErrorType == etBoth;
+  const bool valueErrors = mErrorType == etValue || mErrorType == etBoth;
+  const int count = pointData->size();
+  lines->reserve(lines->size() + count*((keyErrors ? 4 : 0) + (valueErrors ? 4 : 0)));
+  
+  if (keyErrors)
   {
-    // draw key error vertically and value error horizontally
-    if (mErrorType == etKey || mErrorType == etBoth)
+    for (int i=0; i<count; ++i)
     {
-      a = mKeyAxis->coordToPixel(data.key-data.keyErrorMinus);
-      b = mKeyAxis->coordToPixel(data.key+data.keyErrorPlus);
-      if (mKeyAxis->rangeReversed())
-        qSwap(a,b);
-      // draw spine:
-      if (mErrorBarSkipSymbol)
-      {
-        if (a-y > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(x, a, x, y+skipSymbolMargin));
-        if (y-b > skipSymbolMargin) 
-          painter->drawLine(QLineF(x, y-skipSymbolMargin, x, b));
-      } else
-        painter->drawLine(QLineF(x, a, x, b));
-      // draw handles:
-      painter->drawLine(QLineF(x-barWidthHalf, a, x+barWidthHalf, a));
-      painter->drawLine(QLineF(x-barWidthHalf, b, x+barWidthHalf, b));
-    }
-    if (mErrorType == etValue || mErrorType == etBoth)
-    {
-      a = mValueAxis->coordToPixel(data.value-data.valueErrorMinus);
-      b = mValueAxis->coordToPixel(data.value+data.valueErrorPlus);
-      if (mValueAxis->rangeReversed())
-        qSwap(a,b);
-      // draw spine:
-      if (mErrorBarSkipSymbol)
-      {
-        if (x-a > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(a, y, x-skipSymbolMargin, y));
-        if (b-x > skipSymbolMargin)
-          painter->drawLine(QLineF(x+skipSymbolMargin, y, b, y));
-      } else
-        painter->drawLine(QLineF(a, y, b, y));
-      // draw handles:
-      painter->drawLine(QLineF(a, y-barWidthHalf, a, y+barWidthHalf));
-      painter->drawLine(QLineF(b, y-barWidthHalf, b, y+barWidthHalf));
+      const QCPData &data = pointData->at(i);
+      addErrorBarLines(lines, keyVertical, valuePixels.at(i), keyPixels.at(i), mKeyAxis->coordToPixel(data.key-data.keyErrorMinus),
+                       mKeyAxis->coordToPixel(data.key+data.keyErrorPlus), mErrorBarSkipSymbol);
     }
-  } else // mKeyAxis->orientation() is Qt::Horizontal
+  }
+  if (valueErrors)
   {
-    // draw value error vertically and key error horizontally
-    if (mErrorType == etKey || mErrorType == etBoth)
+    int i = 0;
+    while (i < count)
     {
-      a = mKeyAxis->coordToPixel(data.key-data.keyErrorMinus);
-      b = mKeyAxis->coordToPixel(data.key+data.keyErrorPlus);
-      if (mKeyAxis->rangeReversed())
-        qSwap(a,b);
-      // draw spine:
-      if (mErrorBarSkipSymbol)
-      {
-        if (x-a > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(a, y, x-skipSymbolMargin, y));
-        if (b-x > skipSymbolMargin)
-          painter->drawLine(QLineF(x+skipSymbolMargin, y, b, y));
-      } else
-        painter->drawLine(QLineF(a, y, b, y));
-      // draw handles:
-      painter->drawLine(QLineF(a, y-barWidthHalf, a, y+barWidthHalf));
-      painter->drawLine(QLineF(b, y-barWidthHalf, b, y+barWidthHalf));
-    }
-    if (mErrorType == etValue || mErrorType == etBoth)
-    {
-      a = mValueAxis->coordToPixel(data.value-data.valueErrorMinus);
-      b = mValueAxis->coordToPixel(data.value+data.valueErrorPlus);
-      if (mValueAxis->rangeReversed())
-        qSwap(a,b);
-      // draw spine:
-      if (mErrorBarSkipSymbol)
+      // collect the points in the pixel column of point i (keys are sorted, so they are consecutive):
+      double column = floor(keyPixels.at(i));
+      double a = mValueAxis->coordToPixel(pointData->at(i).value-pointData->at(i).valueErrorMinus);
+      double b = mValueAxis->coordToPixel(pointData->at(i).value+pointData->at(i).valueErrorPlus);
+      double lower = qMin(a, b);
+      double upper = qMax(a, b);
+      int end = i+1;
+      while (end < count && floor(keyPixels.at(end)) == column)
       {
-        if (a-y > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(x, a, x, y+skipSymbolMargin));
-        if (y-b > skipSymbolMargin)
-          painter->drawLine(QLineF(x, y-skipSymbolMargin, x, b));
-      } else
-        painter->drawLine(QLineF(x, a, x, b));
-      // draw handles:
-      painter->drawLine(QLineF(x-barWidthHalf, a, x+barWidthHalf, a));
-      painter->drawLine(QLineF(x-barWidthHalf, b, x+barWidthHalf, b));
+        a = mValueAxis->coordToPixel(pointData->at(end).value-pointData->at(end).valueErrorMinus);
+        b = mValueAxis->coordToPixel(pointData->at(end).value+pointData->at(end).valueErrorPlus);
+        lower = qMin(lower, qMin(a, b));
+        upper = qMax(upper, qMax(a, b));
+        ++end;
+      }
+      if (end-i == 1)
+        addErrorBarLines(lines, !keyVertical, keyPixels.at(i), valuePixels.at(i), lower, upper, mErrorBarSkipSymbol);
+      else // envelope of several error bars, the symbols cover most of it anyway, so don't skip them
+        addErrorBarLines(lines, !keyVertical, keyPixels.at(i), 0, lower, upper, false);
+      i = end;
     }
   }
 }
 
+/*! \internal
+  
+  Appends the line segments of a single error bar to \a lines. The spine of the error bar reaches
+  from pixel position \a a to \a b, and is vertical if \a verticalSpine is true, horizontal
+  otherwise. \a spinePos is the pixel position of the spine perpendicular to it, \a symbolPos the
+  position of the data point along it. If \a skipSymbol is true, the spine leaves a gap around the
+  scatter symbol (see \ref setErrorBarSkipSymbol). The handles at both ends are \ref
+  setErrorBarSize pixels wide.
+*/
+void QCPGraph::addErrorBarLines(QVector<QLineF> *lines, bool verticalSpine, double spinePos, double symbolPos, double a, double b, bool skipSymbol) const
+{
+  double lower = qMin(a, b);
+  double upper = qMax(a, b);
+  double barWidthHalf = mErrorBarSize*0.5;
+  double skipSymbolMargin = mScatterSize*1.25; // pixels left blank per side, when skipSymbol is true
+  
+  // collect segments with coordinates along the spine and across it:
+  QLineF segments[4];
+  int segmentCount = 0;
+  if (skipSymbol)
+  {
+    if (symbolPos-lower > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolMargin
+      segments[segmentCount++] = QLineF(lower, spinePos, symbolPos-skipSymbolMargin, spinePos);
+    if (upper-symbolPos > skipSymbolMargin)
+      segments[segmentCount++] = QLineF(symbolPos+skipSymbolMargin, spinePos, upper, spinePos);
+  } else
+    segments[segmentCount++] = QLineF(lower, spinePos, upper, spinePos);
+  // handles:
+  segments[segmentCount++] = QLineF(lower, spinePos-barWidthHalf, lower, spinePos+barWidthHalf);
+  segments[segmentCount++] = QLineF(upper, spinePos-barWidthHalf, upper, spinePos+barWidthHalf);
+  
+  for (int i=0; i<segmentCount; ++i)
+  {
+    if (verticalSpine)
+      lines->append(QLineF(segments[i].y1(), segments[i].x1(), segments[i].y2(), segments[i].x2()));
+    else
+      lines->append(segments[i]);
+  }
+}
+
 /*! 
   \internal
   called by the specific plot data generating functions "get(...)PlotData" to determine
   which data range is visible, so only that needs to be processed.
   
-  \param[out] lower returns an iterator to the lowest data point that needs to be taken into account
+  \param[out] lower returns the index of the lowest data point that needs to be taken into account
   when plotting. Note that in order to get a clean plot all the way to the edge of the axes, \a lower
   may still be outside the visible range.
-  \param[out] upper returns an iterator to the highest data point. Same as before, \a upper may also
+  \param[out] upper returns the index of the highest data point. Same as before, \a upper may also
   lie outside of the visible range.
   \param[out] count number of data points that need plotting, i.e. points between \a lower and \a upper,
   including them. This is useful for allocating the array of QPointFs in the specific drawing functions.
+  \param keyRange the key range that is drawn, see \ref getPlotData.
 */
-void QCPGraph::getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper, int &count) const
+void QCPGraph::getVisibleDataBounds(int &lower, int &upper, int &count, const QCPRange &keyRange) const
 {
-  // get visible data range as QMap iterators
-  QCPDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis->range().lower);
-  QCPDataMap::const_iterator ubound = mData->upperBound(mKeyAxis->range().upper)-1;
-  bool lowoutlier = lbound != mData->constBegin(); // indicates whether there exist points below axis range
-  bool highoutlier = ubound+1 != mData->constEnd(); // indicates whether there exist points above axis range
+  // get visible data range as indices into the data view
+  QCPDataView data = dataView();
+  int lbound = data.lowerBound(keyRange.lower);
+  int ubound = data.upperBound(keyRange.upper)-1;
+  bool lowoutlier = lbound != 0; // indicates whether there exist points below axis range
+  bool highoutlier = ubound+1 != data.size(); // indicates whether there exist points above axis range
   lower = (lowoutlier ? lbound-1 : lbound); // data pointrange that will be actually drawn
   upper = (highoutlier ? ubound+1 : ubound); // data pointrange that will be actually drawn
   
-  // count number of points in range lower to upper (including them), so we can allocate array for them in draw functions:
-  QCPDataMap::const_iterator it = lower;
-  count = 1;
-  while (it != upper)
+  // number of points in range lower to upper (including them), so we can allocate array for them in draw functions:
+  count = upper-lower+1;
+}
+
+/*! \internal
+  
+  Returns a view on the data points from which the line of the graph is generated, for the visible
+  data range from index \a lower to \a upper (including them) as determined by \ref
+  getVisibleDataBounds.
+  
+  If adaptive sampling is enabled (\ref setAdaptiveSampling) and there are considerably more points
+  in the visible range than pixels along the key axis, the points are reduced with \ref
+  getAdaptiveSampledData. Then \a sampledData is used as storage for the reduced points and the
+  returned view refers to it. Otherwise the returned view refers directly to the graph's data
+  (\ref dataView) and \a sampledData is left untouched.
+  
+  While the graph is drawn with reduced detail (see QCustomPlot::setDraftPointBudget), only every
+  n-th point is used instead, so the draft point budget isn't exceeded. This doesn't need to visit
+  all visible points. The level of detail index (\ref setLodIndex) is accurate and fast, so it is
+  still used if available.
+*/
+QCPDataView QCPGraph::getLineSourceData(int lower, int upper, QVector<QCPData> *sampledData, int draftStride) const
+{
+  if (draftStride > 1 && !(mAdaptiveSampling && !mDataSource && mData->lodIndex()))
+  {
+    // keep the last point, so the line still reaches the border of the axis rect:
+    QCPDataView data = dataView();
+    sampledData->clear();
+    sampledData->reserve((upper-lower)/draftStride+2);
+    for (int i=lower; i<upper; i+=draftStride)
+      sampledData->append(QCPData(data.key(i), data.value(i)));
+    sampledData->append(QCPData(data.key(upper), data.value(upper)));
+    return QCPDataView(&sampledData->constData()->key, &sampledData->constData()->value, sampledData->size(), sizeof(QCPData), sizeof(QCPData));
+  }
+  if (mAdaptiveSampling)
   {
-    ++it;
-    ++count;
+    int keyPixelSpan = (mKeyAxis->orientation() == Qt::Horizontal ? mKeyAxis->axisRect().width() : mKeyAxis->axisRect().height());
+    if (upper-lower+1 > 4*keyPixelSpan) // adaptive sampling only reduces the point count if there are more than four points per pixel column
+    {
+      getAdaptiveSampledData(sampledData, lower, upper);
+      if (sampledData->isEmpty())
+        return QCPDataView();
+      return QCPDataView(&sampledData->constData()->key, &sampledData->constData()->value, sampledData->size(), sizeof(QCPData), sizeof(QCPData));
+    }
+  }
+  return dataView().mid(lower, upper-lower+1);
+}
+
+/*! \internal
+  
+  Reduces the data points from index \a lower to \a upper (including them) and places the result
+  in \a sampledData. The data points are grouped by the pixel column their key falls into. Of each
+  group, only the first point, the point with the minimum value, the point with the maximum value
+  and the last point are kept, in their original order. Connecting the kept points with lines
+  covers the same pixels as connecting all original points, so this reduction is invisible in
+  the plot while limiting the number of points to four per pixel column.
+  
+  \see setAdaptiveSampling, getLineSourceData
+*/
+void QCPGraph::getAdaptiveSampledData(QVector<QCPData> *sampledData, int lower, int upper) const
+{
+  int keyPixelSpan = (mKeyAxis->orientation() == Qt::Horizontal ? mKeyAxis->axisRect().width() : mKeyAxis->axisRect().height());
+  if (!mDataSource && mData->lodIndex() && upper-lower+1 > 64*keyPixelSpan) // with the level of detail index, columns are processed in O(log n) instead of scanning their points
+  {
+    getLodSampledData(sampledData, lower, upper);
+    return;
+  }
+  sampledData->clear();
+  sampledData->reserve(4*(keyPixelSpan+2)); // +2 for the columns of the points outside the visible range
+  
+  QCPDataView data = dataView();
+  int entryIndex = lower; // first point of current pixel column
+  int minIndex = lower;
+  int maxIndex = lower;
+  double minValue = data.value(lower);
+  double maxValue = minValue;
+  double column = floor(mKeyAxis->coordToPixel(data.key(lower)));
+  for (int i=lower+1; i<=upper+1; ++i) // i == upper+1 is used to finish the last column
+  {
+    double currentColumn = 0;
+    if (i <= upper)
+    {
+      currentColumn = floor(mKeyAxis->coordToPixel(data.key(i)));
+      if (currentColumn == column)
+      {
+        double value = data.value(i);
+        if (value < minValue)
+        {
+          minValue = value;
+          minIndex = i;
+        }
+        if (value > maxValue)
+        {
+          maxValue = value;
+          maxIndex = i;
+        }
+        continue;
+      }
+    }
+    // column is finished, append entry, extremes and exit point in their original order, skipping duplicates:
+    int columnIndices[4] = {entryIndex, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), i-1};
+    int lastIndex = -1;
+    for (int k=0; k<4; ++k)
+    {
+      if (columnIndices[k] != lastIndex)
+      {
+        sampledData->append(QCPData(data.key(columnIndices[k]), data.value(columnIndices[k])));
+        lastIndex = columnIndices[k];
+      }
+    }
+    // start next column:
+    if (i <= upper)
+    {
+      column = currentColumn;
+      entryIndex = minIndex = maxIndex = i;
+      minValue = maxValue = data.value(i);
+    }
+  }
+}
+
+/*! \internal
+  
+  Like \ref getAdaptiveSampledData, reduces the data points from index \a lower to \a upper
+  (including them) to at most four points per pixel column and places the result in \a
+  sampledData. Instead of visiting every data point, the borders of each pixel column are found by
+  binary searches and the value extremes inside the column are retrieved from the level of detail
+  index of the data container (\ref QCPDataContainer::valueRange). This makes the effort
+  proportional to the number of pixel columns times log n.
+  
+  Since the index doesn't tell where inside a column the extremes are located, they are placed at
+  the keys of the first and last point of the column, ordered such that the line runs through the
+  whole value range of the column and continues to the last point without crossing back.
+  
+  \see setLodIndex
+*/
+void QCPGraph::getLodSampledData(QVector<QCPData> *sampledData, int lower, int upper) const
+{
+  int keyPixelSpan = (mKeyAxis->orientation() == Qt::Horizontal ? mKeyAxis->axisRect().width() : mKeyAxis->axisRect().height());
+  sampledData->clear();
+  sampledData->reserve(4*(keyPixelSpan+2)); // +2 for the columns of the points outside the visible range
+  
+  QCPDataView data = mData->view();
+  // pixel coordinate may increase or decrease with key, depending on axis orientation and range reversal:
+  bool ascending = mKeyAxis->coordToPixel(data.key(upper)) >= mKeyAxis->coordToPixel(data.key(lower));
+  int begin = lower;
+  while (begin <= upper)
+  {
+    // find end of current pixel column (index after its last point):
+    double column = floor(mKeyAxis->coordToPixel(data.key(begin)));
+    int end = ascending ? data.lowerBound(mKeyAxis->pixelToCoord(column+1)) : data.upperBound(mKeyAxis->pixelToCoord(column));
+    end = qBound(begin+1, end, upper+1); // guarantee progress in case pixelToCoord isn't exactly inverse to coordToPixel
+    if (end-begin <= 4)
+    {
+      for (int i=begin; i<end; ++i)
+        sampledData->append(QCPData(data.key(i), data.value(i)));
+    } else
+    {
+      QCPData entry(data.key(begin), data.value(begin));
+      QCPData exit(data.key(end-1), data.value(end-1));
+      QCPRange extremes = mData->valueRange(begin+1, end-1);
+      sampledData->append(entry);
+      if (exit.value >= entry.value)
+      {
+        sampledData->append(QCPData(entry.key, extremes.lower));
+        sampledData->append(QCPData(exit.key, extremes.upper));
+      } else
+      {
+        sampledData->append(QCPData(entry.key, extremes.upper));
+        sampledData->append(QCPData(exit.key, extremes.lower));
+      }
+      sampledData->append(exit);
+    }
+    begin = end;
   }
 }
 
+/*! \internal
+  
+  Transforms the keys and values of the data points in \a data to pixel coordinates along the key
+  and value axis, respectively, and writes them to \a keyPixels and \a valuePixels. The
+  transformation is done in batches with \ref QCPAxis::coordToPixel(const double *coords, qreal
+  *pixels, int count, int coordStride, int pixelStride) const.
+  
+  Used by the plot data generating functions that need more than one polyline point per data point.
+*/
+void QCPGraph::getPixelCoords(const QCPDataView &data, QVector<qreal> *keyPixels, QVector<qreal> *valuePixels) const
+{
+  keyPixels->resize(data.size());
+  valuePixels->resize(data.size());
+  if (data.isEmpty()) return;
+  mKeyAxis->coordToPixel(data.keys(), keyPixels->data(), data.size(), data.keyStride());
+  mValueAxis->coordToPixel(data.values(), valuePixels->data(), data.size(), data.valueStride());
+}
+
 /*! 
   \internal
   The line data vector generated by e.g. getLinePlotData contains only the line
@@ -1616,8 +3370,8 @@ QPointF QCPGraph::upperFillBasePoint(double upperKey) const
 /*! \internal
   
   Generates the polygon needed for drawing channel fills between this graph (data passed via \a
-  lineData) and the graph specified by mChannelFillGraph (data generated by calling its \ref
-  getPlotData function). May return an empty polygon if the key ranges have no overlap or fill
+  lineData) and the graph specified by mChannelFillGraph (data retrieved by calling its \ref
+  getCachedPlotData function). May return an empty polygon if the key ranges have no overlap or fill
   target graph and this graph don't have same orientation (i.e. both key axes horizontal or both
   key axes vertical). For increased performance (due to implicit sharing), keep the returned QPolygonF
   const.
@@ -1629,7 +3383,7 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData
   
   if (lineData->isEmpty()) return QPolygonF();
   QVector<QPointF> otherData;
-  mChannelFillGraph->getPlotData(&otherData, 0);
+  mChannelFillGraph->getCachedPlotData(&otherData, 0, 1); // always full detail, see getCachedPlotData
   if (otherData.isEmpty()) return QPolygonF();
   QVector<QPointF> thisData;
   thisData.reserve(lineData->size()+otherData.size()); // because we will join both vectors at end of this function
@@ -1823,14 +3577,15 @@ int QCPGraph::findIndexAboveY(const QVector<QPointF> *data, double y) const
 */
 double QCPGraph::pointDistance(const QPointF &pixelPoint) const
 {
-  if (mData->isEmpty())
+  QCPDataView data = dataView();
+  if (data.isEmpty())
   {
     qDebug() << Q_FUNC_INFO << "requested point distance on graph" << mName << "without data";
     return 500;
   }
-  if (mData->size() == 1)
+  if (data.size() == 1)
   {
-    QPointF dataPoint = coordsToPixels(mData->constBegin().key(), mData->constBegin().value().value);
+    QPointF dataPoint = coordsToPixels(data.key(0), data.value(0));
     return QVector2D(dataPoint-pixelPoint).length();
   }
   
@@ -1841,47 +3596,45 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint) const
   if (mLineStyle == lsNone)
   {
     // no line displayed, only calculate distance to scatter points:
-    QVector<QCPData> *pointData = new QVector<QCPData>;
-    getScatterPlotData(pointData);
+    QVector<QCPData> pointData;
+    getCachedPlotData(0, &pointData, 1);
     double minDistSqr = std::numeric_limits<double>::max();
     QPointF ptA;
-    QPointF ptB = coordsToPixels(pointData->at(0).key, pointData->at(0).value); // getScatterPlotData returns in plot coordinates, so transform to pixels
-    for (int i=1; i<pointData->size(); ++i)
+    QPointF ptB = coordsToPixels(pointData.at(0).key, pointData.at(0).value); // getScatterPlotData returns in plot coordinates, so transform to pixels
+    for (int i=1; i<pointData.size(); ++i)
     {
       ptA = ptB;
-      ptB = coordsToPixels(pointData->at(i).key, pointData->at(i).value);
+      ptB = coordsToPixels(pointData.at(i).key, pointData.at(i).value);
       double currentDistSqr = distSqrToLine(ptA, ptB, pixelPoint);
       if (currentDistSqr < minDistSqr)
         minDistSqr = currentDistSqr;
     }
-    delete pointData;
     return sqrt(minDistSqr);
   } else
   {
     // line displayed calculate distance to line segments:
-    QVector<QPointF> *lineData = new QVector<QPointF>;
-    getPlotData(lineData, 0); // unlike with getScatterPlotData we get pixel coordinates here
+    QVector<QPointF> lineData;
+    getCachedPlotData(&lineData, 0, 1); // unlike with getScatterPlotData we get pixel coordinates here
     double minDistSqr = std::numeric_limits<double>::max();
     if (mLineStyle == lsImpulse)
     {
       // impulse plot differs from other line styles in that the lineData points are only pairwise connected:
-      for (int i=0; i<lineData->size()-1; i+=2) // iterate pairs
+      for (int i=0; i<lineData.size()-1; i+=2) // iterate pairs
       {
-        double currentDistSqr = distSqrToLine(lineData->at(i), lineData->at(i+1), pixelPoint);
+        double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
         if (currentDistSqr < minDistSqr)
           minDistSqr = currentDistSqr;
       }
     } else 
     {
       // all other line plots (line and step) connect points directly:
-      for (int i=0; i<lineData->size()-1; ++i)
+      for (int i=0; i<lineData.size()-1; ++i)
       {
-        double currentDistSqr = distSqrToLine(lineData->at(i), lineData->at(i+1), pixelPoint);
+        double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
         if (currentDistSqr < minDistSqr)
           minDistSqr = currentDistSqr;
       }
     }
-    delete lineData;
     return sqrt(minDistSqr);
   }
 }
@@ -1931,102 +3684,147 @@ QCPRange QCPGraph::getValueRange(bool &validRange, SignDomain inSignDomain) cons
 */
 QCPRange QCPGraph::getKeyRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const
 {
-  QCPRange range;
-  bool haveLower = false;
-  bool haveUpper = false;
+  if (mDataSource || !mData->hasErrors())
+    includeErrors = false; // no error values stored (see QCPDataContainer::hasErrors) or provided by the data source
+  
+  if (inSignDomain == sdBoth && !includeErrors) // keys are sorted, so the range spans from the first to the last key
+  {
+    QCPDataView data = dataView();
+    validRange = !data.isEmpty();
+    return validRange ? QCPRange(data.key(0), data.key(data.size()-1)) : QCPRange();
+  }
+  
+  // the range of the data container is cached and only extended by appended points, as long as no
+  // points were removed or replaced (see QCPDataContainer::revision). External data sources
+  // may change without notice, so their range is always determined from scratch:
+  CachedRange uncached;
+  CachedRange &cache = mDataSource ? uncached : mKeyRangeCache[inSignDomain][includeErrors ? 1 : 0];
+  if (!mDataSource)
+  {
+    // points removed from the front only invalidate the range if they determined one of its bounds:
+    qint64 frontOffset = mData->frontOffset();
+    if (cache.revision != mData->revision() || (cache.haveLower && cache.lowerIndex < frontOffset) || (cache.haveUpper && cache.upperIndex < frontOffset))
+    {
+      cache = CachedRange();
+      cache.revision = mData->revision();
+      cache.end = frontOffset;
+    }
+    cache.frontOffset = frontOffset;
+  }
+  int size = dataView().size();
+  int begin = int(qMax(qint64(0), cache.end-cache.frontOffset));
+  if (begin < size)
+  {
+    accumulateKeyRange(cache, inSignDomain, includeErrors, begin, size);
+    cache.end = cache.frontOffset+size;
+  }
+  
+  validRange = cache.haveLower && cache.haveUpper;
+  return cache.range;
+}
+
+/*! \internal
   
+  Extends the key range in \a cache by the data points with indices from \a begin up to \a end
+  (excluding \a end), following the rules of \ref getKeyRange. Used by \ref getKeyRange to update
+  its cached ranges incrementally.
+*/
+void QCPGraph::accumulateKeyRange(CachedRange &cache, SignDomain inSignDomain, bool includeErrors, int begin, int end) const
+{
   double current, currentErrorMinus, currentErrorPlus;
+  QCPDataView data = dataView();
   
   if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
-      if (current-currentErrorMinus < range.lower || !haveLower)
+      current = data.key(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).keyErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).keyErrorPlus : 0);
+      if (current-currentErrorMinus < cache.range.lower || !cache.haveLower)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if (current+currentErrorPlus > range.upper || !haveUpper)
+      if (current+currentErrorPlus > cache.range.upper || !cache.haveUpper)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
-      ++it;
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
-      if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus < 0)
+      current = data.key(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).keyErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).keyErrorPlus : 0);
+      if ((current-currentErrorMinus < cache.range.lower || !cache.haveLower) && current-currentErrorMinus < 0)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if ((current+currentErrorPlus > range.upper || !haveUpper) && current+currentErrorPlus < 0)
+      if ((current+currentErrorPlus > cache.range.upper || !cache.haveUpper) && current+currentErrorPlus < 0)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
       if (includeErrors) // in case point is in valid sign domain but errobars stretch beyond it, we still want to geht that point.
       {
-        if ((current < range.lower || !haveLower) && current < 0)
+        if ((current < cache.range.lower || !cache.haveLower) && current < 0)
         {
-          range.lower = current;
-          haveLower = true;
+          cache.range.lower = current;
+          cache.haveLower = true;
+          cache.lowerIndex = cache.frontOffset+i;
         }
-        if ((current > range.upper || !haveUpper) && current < 0)
+        if ((current > cache.range.upper || !cache.haveUpper) && current < 0)
         {
-          range.upper = current;
-          haveUpper = true;
+          cache.range.upper = current;
+          cache.haveUpper = true;
+          cache.upperIndex = cache.frontOffset+i;
         }
       }
-      ++it;
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().key;
-      currentErrorMinus = (includeErrors ? it.value().keyErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().keyErrorPlus : 0);
-      if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus > 0)
+      current = data.key(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).keyErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).keyErrorPlus : 0);
+      if ((current-currentErrorMinus < cache.range.lower || !cache.haveLower) && current-currentErrorMinus > 0)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if ((current+currentErrorPlus > range.upper || !haveUpper) && current+currentErrorPlus > 0)
+      if ((current+currentErrorPlus > cache.range.upper || !cache.haveUpper) && current+currentErrorPlus > 0)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
       if (includeErrors) // in case point is in valid sign domain but errobars stretch beyond it, we still want to get that point.
       {
-        if ((current < range.lower || !haveLower) && current > 0)
+        if ((current < cache.range.lower || !cache.haveLower) && current > 0)
         {
-          range.lower = current;
-          haveLower = true;
+          cache.range.lower = current;
+          cache.haveLower = true;
+          cache.lowerIndex = cache.frontOffset+i;
         }
-        if ((current > range.upper || !haveUpper) && current > 0)
+        if ((current > cache.range.upper || !cache.haveUpper) && current > 0)
         {
-          range.upper = current;
-          haveUpper = true;
+          cache.range.upper = current;
+          cache.haveUpper = true;
+          cache.upperIndex = cache.frontOffset+i;
         }
       }
-      ++it;
     }
   }
-  
-  validRange = haveLower && haveUpper;
-  return range;
 }
 
 /*! \overload
@@ -2036,100 +3834,180 @@ QCPRange QCPGraph::getKeyRange(bool &validRange, SignDomain inSignDomain, bool i
 */
 QCPRange QCPGraph::getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const
 {
-  QCPRange range;
-  bool haveLower = false;
-  bool haveUpper = false;
+  if (mDataSource || !mData->hasErrors())
+    includeErrors = false; // no error values stored (see QCPDataContainer::hasErrors) or provided by the data source
+  
+  // the range of the data container is cached and only extended by appended points, as long as no
+  // points were removed or replaced (see QCPDataContainer::revision). External data sources
+  // may change without notice, so their range is always determined from scratch:
+  CachedRange uncached;
+  CachedRange &cache = mDataSource ? uncached : mValueRangeCache[inSignDomain][includeErrors ? 1 : 0];
+  if (!mDataSource)
+  {
+    // points removed from the front only invalidate the range if they determined one of its bounds:
+    qint64 frontOffset = mData->frontOffset();
+    if (cache.revision != mData->revision() || (cache.haveLower && cache.lowerIndex < frontOffset) || (cache.haveUpper && cache.upperIndex < frontOffset))
+    {
+      cache = CachedRange();
+      cache.revision = mData->revision();
+      cache.end = frontOffset;
+    }
+    cache.frontOffset = frontOffset;
+  }
+  int size = dataView().size();
+  int begin = int(qMax(qint64(0), cache.end-cache.frontOffset));
+  if (begin == 0 && size > 0 && !mDataSource && inSignDomain == sdBoth && !includeErrors && mData->lodIndex())
+  {
+    // the level of detail index provides the range in O(log n), but not the points that determine
+    // it, so the range is conservatively determined anew after the next removal from the front:
+    cache.range = mData->valueRange(0, size);
+    cache.haveLower = true;
+    cache.haveUpper = true;
+    cache.lowerIndex = cache.frontOffset;
+    cache.upperIndex = cache.frontOffset;
+    begin = size;
+    cache.end = cache.frontOffset+size;
+  }
+  if (begin < size)
+  {
+    accumulateValueRange(cache, inSignDomain, includeErrors, begin, size);
+    cache.end = cache.frontOffset+size;
+  }
+  
+  validRange = cache.haveLower && cache.haveUpper;
+  return cache.range;
+}
+
+/*! \overload
+  
+  Returns the value range of the data points with keys inside \a inKeyRange only.
+  
+  The data points in \a inKeyRange are found with binary searches. Their value range is taken from
+  \ref QCPDataContainer::valueRange, which is O(log n) if the level of detail index is enabled
+  (\ref setLodIndex). For sign domains other than \ref sdBoth, when errors are included, or for
+  external data sources, the data points in \a inKeyRange are scanned.
+  
+  \see rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars, bool inKeyRange)
+*/
+QCPRange QCPGraph::getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors, const QCPRange &inKeyRange) const
+{
+  if (mDataSource || !mData->hasErrors())
+    includeErrors = false; // no error values stored (see QCPDataContainer::hasErrors) or provided by the data source
+  
+  QCPDataView data = dataView();
+  int begin = data.lowerBound(inKeyRange.lower);
+  int end = data.upperBound(inKeyRange.upper);
+  if (!mDataSource && inSignDomain == sdBoth && !includeErrors)
+  {
+    validRange = begin < end;
+    return mData->valueRange(begin, end);
+  }
+  CachedRange range;
+  accumulateValueRange(range, inSignDomain, includeErrors, begin, end);
+  validRange = range.haveLower && range.haveUpper;
+  return range.range;
+}
+
+/*! \internal
   
+  Extends the value range in \a cache by the data points with indices from \a begin up to \a end
+  (excluding \a end), following the rules of \ref getValueRange. Used by \ref getValueRange to update
+  its cached ranges incrementally.
+*/
+void QCPGraph::accumulateValueRange(CachedRange &cache, SignDomain inSignDomain, bool includeErrors, int begin, int end) const
+{
   double current, currentErrorMinus, currentErrorPlus;
+  QCPDataView data = dataView();
   
   if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
-      if (current-currentErrorMinus < range.lower || !haveLower)
+      current = data.value(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).valueErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).valueErrorPlus : 0);
+      if (current-currentErrorMinus < cache.range.lower || !cache.haveLower)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if (current+currentErrorPlus > range.upper || !haveUpper)
+      if (current+currentErrorPlus > cache.range.upper || !cache.haveUpper)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
-      ++it;
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
-      if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus < 0)
+      current = data.value(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).valueErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).valueErrorPlus : 0);
+      if ((current-currentErrorMinus < cache.range.lower || !cache.haveLower) && current-currentErrorMinus < 0)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if ((current+currentErrorPlus > range.upper || !haveUpper) && current+currentErrorPlus < 0)
+      if ((current+currentErrorPlus > cache.range.upper || !cache.haveUpper) && current+currentErrorPlus < 0)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
       if (includeErrors) // in case point is in valid sign domain but errobars stretch beyond it, we still want to get that point.
       {
-        if ((current < range.lower || !haveLower) && current < 0)
+        if ((current < cache.range.lower || !cache.haveLower) && current < 0)
         {
-          range.lower = current;
-          haveLower = true;
+          cache.range.lower = current;
+          cache.haveLower = true;
+          cache.lowerIndex = cache.frontOffset+i;
         }
-        if ((current > range.upper || !haveUpper) && current < 0)
+        if ((current > cache.range.upper || !cache.haveUpper) && current < 0)
         {
-          range.upper = current;
-          haveUpper = true;
+          cache.range.upper = current;
+          cache.haveUpper = true;
+          cache.upperIndex = cache.frontOffset+i;
         }
       }
-      ++it;
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    for (int i=begin; i<end; ++i)
     {
-      current = it.value().value;
-      currentErrorMinus = (includeErrors ? it.value().valueErrorMinus : 0);
-      currentErrorPlus = (includeErrors ? it.value().valueErrorPlus : 0);
-      if ((current-currentErrorMinus < range.lower || !haveLower) && current-currentErrorMinus > 0)
+      current = data.value(i);
+      currentErrorMinus = (includeErrors ? mData->at(i).valueErrorMinus : 0);
+      currentErrorPlus = (includeErrors ? mData->at(i).valueErrorPlus : 0);
+      if ((current-currentErrorMinus < cache.range.lower || !cache.haveLower) && current-currentErrorMinus > 0)
       {
-        range.lower = current-currentErrorMinus;
-        haveLower = true;
+        cache.range.lower = current-currentErrorMinus;
+        cache.haveLower = true;
+        cache.lowerIndex = cache.frontOffset+i;
       }
-      if ((current+currentErrorPlus > range.upper || !haveUpper) && current+currentErrorPlus > 0)
+      if ((current+currentErrorPlus > cache.range.upper || !cache.haveUpper) && current+currentErrorPlus > 0)
       {
-        range.upper = current+currentErrorPlus;
-        haveUpper = true;
+        cache.range.upper = current+currentErrorPlus;
+        cache.haveUpper = true;
+        cache.upperIndex = cache.frontOffset+i;
       }
       if (includeErrors) // in case point is in valid sign domain but errobars stretch beyond it, we still want to geht that point.
       {
-        if ((current < range.lower || !haveLower) && current > 0)
+        if ((current < cache.range.lower || !cache.haveLower) && current > 0)
         {
-          range.lower = current;
-          haveLower = true;
+          cache.range.lower = current;
+          cache.haveLower = true;
+          cache.lowerIndex = cache.frontOffset+i;
         }
-        if ((current > range.upper || !haveUpper) && current > 0)
+        if ((current > cache.range.upper || !cache.haveUpper) && current > 0)
         {
-          range.upper = current;
-          haveUpper = true;
+          cache.range.upper = current;
+          cache.haveUpper = true;
+          cache.upperIndex = cache.frontOffset+i;
         }
       }
-      ++it;
     }
   }
-  
-  validRange = haveLower && haveUpper;
-  return range;
 }
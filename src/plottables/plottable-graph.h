@@ -47,13 +47,173 @@ Q_DECLARE_TYPEINFO(QCPData, Q_MOVABLE_TYPE);
   Container for storing QCPData items in a sorted fashion. The key of the map
   is the key member of the QCPData instance.
   
-  This is the container in which QCPGraph holds its data.
-  \see QCPData, QCPGraph::setData
+  QCPGraph accepts data in this form (e.g. \ref QCPGraph::setData(QCPDataMap *data, bool copy)),
+  but internally holds it in a \ref QCPDataContainer.
+  \see QCPData, QCPDataContainer, QCPGraph::setData
 */
 typedef QMap<double, QCPData> QCPDataMap;
 typedef QMapIterator<double, QCPData> QCPDataMapIterator;
 typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
 
+class QCP_LIB_DECL QCPDataView
+{
+public:
+  QCPDataView();
+  QCPDataView(const double *keys, const double *values, int size, int keyStride=sizeof(double), int valueStride=sizeof(double));
+  
+  // getters:
+  int size() const { return mSize; }
+  bool isEmpty() const { return mSize == 0; }
+  double key(int index) const { return *reinterpret_cast<const double*>(mKeys+qint64(index)*mKeyStride); }
+  double value(int index) const { return *reinterpret_cast<const double*>(mValues+qint64(index)*mValueStride); }
+  const double *keys() const { return reinterpret_cast<const double*>(mKeys); }
+  const double *values() const { return reinterpret_cast<const double*>(mValues); }
+  int keyStride() const { return mKeyStride; }
+  int valueStride() const { return mValueStride; }
+  
+  // non-property methods:
+  QCPDataView mid(int index, int count) const;
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+  
+protected:
+  const char *mKeys, *mValues;
+  int mKeyStride, mValueStride;
+  int mSize;
+};
+Q_DECLARE_TYPEINFO(QCPDataView, Q_MOVABLE_TYPE);
+
+class QCP_LIB_DECL QCPAbstractDataSource : public QObject
+{
+  Q_OBJECT
+public:
+  QCPAbstractDataSource(QObject *parent=0);
+  virtual ~QCPAbstractDataSource();
+  
+  // non-property methods:
+  virtual QCPDataView dataView() const = 0;
+  
+signals:
+  void dataChanged();
+};
+
+class QCP_LIB_DECL QCPArrayDataSource : public QCPAbstractDataSource
+{
+  Q_OBJECT
+public:
+  QCPArrayDataSource(QObject *parent=0);
+  virtual ~QCPArrayDataSource();
+  
+  // getters:
+  int size() const { return mSize; }
+  
+  // setters:
+  void setArrays(const double *keys, const double *values, int size, int keyStride=sizeof(double), int valueStride=sizeof(double));
+  void setSize(int size);
+  
+  // non-property methods:
+  virtual QCPDataView dataView() const;
+  void notifyDataChanged();
+  
+protected:
+  const double *mKeys, *mValues;
+  int mSize, mKeyStride, mValueStride;
+};
+
+class QCP_LIB_DECL QCPDataLodIndex
+{
+public:
+  QCPDataLodIndex();
+  
+  // getters:
+  bool isValid() const { return mValid; }
+  
+  // non-property methods:
+  void invalidate();
+  void rebuild(const QCPDataView &data);
+  void append(const QCPDataView &data, int oldSize);
+  void removeFront(int count);
+  void removeBack(const QCPDataView &data);
+  QCPRange valueRange(const QCPDataView &data, int begin, int end) const;
+  
+protected:
+  enum { baseShift = 3 }; // level 0 buckets hold 2^baseShift data points
+  QVector<QVector<QCPRange> > mLevels;
+  QVector<qint64> mFirstBucket;
+  qint64 mOffset;
+  bool mValid;
+  
+  void updateUpperLevels(qint64 firstChangedBucket);
+};
+
+class QCP_LIB_DECL QCPDataContainer
+{
+public:
+  QCPDataContainer();
+  
+  // getters:
+  int size() const { return mSize; }
+  bool isEmpty() const { return mSize == 0; }
+  QCPData at(int index) const;
+  QCPData first() const { return at(0); }
+  QCPData last() const { return at(mSize-1); }
+  bool hasErrors() const { return mRecordSize == fullRecordSize; }
+  int capacity() const { return mCapacity; }
+  bool lodIndex() const { return mLodIndexEnabled; }
+  int revision() const { return mRevision; }
+  qint64 frontOffset() const { return mFrontOffset; }
+  
+  // setters:
+  void set(const QCPDataMap &dataMap);
+  void set(const QVector<QCPData> &data, bool alreadySorted=false);
+  void setCapacity(int capacity);
+  void setLodIndex(bool enabled);
+  
+  // non-property methods:
+  void add(const QCPDataMap &dataMap);
+  void add(const QVector<QCPData> &data, bool alreadySorted=false);
+  void add(const QCPData &data);
+  void removeBefore(double key);
+  void removeAfter(double key);
+  void remove(double fromKey, double toKey);
+  void remove(double key);
+  void clear();
+  void reserve(int size);
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+  QCPRange valueRange(int begin, int end) const;
+  void ensureLodIndex() const;
+  QCPDataView view() const;
+  QCPDataMap toMap() const;
+  
+protected:
+  enum { compactRecordSize = 2, fullRecordSize = sizeof(QCPData)/sizeof(double) }; // in doubles
+  enum { parallelSortChunkSize = 262144 }; // minimum number of points per concurrently sorted chunk
+  QVector<double> mStore;
+  int mRecordSize;
+  int mBegin, mSize, mCapacity;
+  int mAppendStart;
+  int mRevision;
+  qint64 mFrontOffset;
+  bool mLodIndexEnabled;
+  mutable QCPDataLodIndex mLodIndex;
+  
+  void removeRange(int begin, int end);
+  void newRevision();
+  void reserveAppend(int count, bool withErrors);
+  void appendUnchecked(const QCPData &data);
+  void finishAppend();
+  void writeRecord(int slot, const QCPData &data);
+  QVector<QCPData> toVector() const;
+  void assign(const QVector<QCPData> &data, bool withErrors);
+  void mergeSorted(const QVector<QCPData> &data);
+  static void sortByKey(QVector<QCPData> &data);
+  static bool isSorted(const QVector<QCPData> &data);
+  static bool containsErrors(const QCPData &data);
+  
+  friend class QCPGraph;
+};
+
 
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
 {
@@ -87,7 +247,8 @@ public:
   virtual ~QCPGraph();
   
   // getters:
-  const QCPDataMap *data() const { return mData; }
+  const QCPDataContainer *data() const { return mData; }
+  QCPAbstractDataSource *dataSource() const { return mDataSource; }
   LineStyle lineStyle() const { return mLineStyle; }
   QCP::ScatterStyle scatterStyle() const { return mScatterStyle; }
   double scatterSize() const { return mScatterSize; }
@@ -97,10 +258,14 @@ public:
   double errorBarSize() const { return mErrorBarSize; }
   bool errorBarSkipSymbol() const { return mErrorBarSkipSymbol; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
+  bool lodIndex() const { return mLodIndex; }
+  int dataCapacity() const { return mDataCapacity; }
   
   // setters:
+  void setData(QCPDataContainer *data, bool copy=false);
   void setData(QCPDataMap *data, bool copy=false);
-  void setData(const QVector<double> &key, const QVector<double> &value);
+  void setData(const QVector<double> &key, const QVector<double> &value, bool alreadySorted=false);
   void setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError);
   void setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus);
   void setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError);
@@ -116,27 +281,67 @@ public:
   void setErrorBarSize(double size);
   void setErrorBarSkipSymbol(bool enabled);
   void setChannelFillGraph(QCPGraph *targetGraph);
+  void setAdaptiveSampling(bool enabled);
+  void setLodIndex(bool enabled);
+  void setDataCapacity(int capacity);
+  void setDataSource(QCPAbstractDataSource *source);
   
   // non-property methods:
   void addData(const QCPDataMap &dataMap);
   void addData(const QCPData &data);
   void addData(double key, double value);
-  void addData(const QVector<double> &keys, const QVector<double> &values);
+  void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
   void removeDataBefore(double key);
   void removeDataAfter(double key);
   void removeData(double fromKey, double toKey);
   void removeData(double key);
   virtual void clearData();
   virtual double selectTest(const QPointF &pos) const;
+  QCPDataView dataView() const;
   using QCPAbstractPlottable::rescaleAxes;
   using QCPAbstractPlottable::rescaleKeyAxis;
   using QCPAbstractPlottable::rescaleValueAxis;
   virtual void rescaleAxes(bool onlyEnlarge, bool includeErrorBars) const; // overloads base class interface
   virtual void rescaleKeyAxis(bool onlyEnlarge, bool includeErrorBars) const; // overloads base class interface
   virtual void rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const; // overloads base class interface
+  void rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars, bool inKeyRange) const;
   
 protected:
-  QCPDataMap *mData;
+  struct CachedRange
+  {
+    CachedRange() : haveLower(false), haveUpper(false), revision(0), frontOffset(0), end(0), lowerIndex(0), upperIndex(0) {}
+    QCPRange range;
+    bool haveLower, haveUpper;
+    int revision; // revision of the data container the range was determined for
+    qint64 frontOffset, end; // front offset of the data container and absolute index of the first point not yet included
+    qint64 lowerIndex, upperIndex; // absolute indices (front offset plus index) of the points that determine the range bounds
+  };
+  struct CachedAxisState
+  {
+    CachedAxisState() : axis(0), scaleType(0), scaleLogBase(0), rangeReversed(false) {}
+    bool operator==(const CachedAxisState &other) const;
+    QCPAxis *axis;
+    QCPRange range;
+    QRect axisRect;
+    int scaleType; // QCPAxis::ScaleType
+    double scaleLogBase;
+    bool rangeReversed;
+  };
+  struct CachedGeometry
+  {
+    CachedGeometry() : valid(false), hasPointData(false), lineStyle(lsNone), adaptiveSampling(false), lodIndex(false), revision(0), size(0), frontOffset(0) {}
+    bool valid, hasPointData;
+    CachedAxisState keyAxis, valueAxis;
+    LineStyle lineStyle;
+    bool adaptiveSampling, lodIndex;
+    int revision, size; // revision and size of the data container the geometry was generated for
+    qint64 frontOffset; // front offset of the data container the geometry was generated for
+    QVector<QPointF> lineData;
+    QVector<QCPData> pointData;
+  };
+  
+  QCPDataContainer *mData;
+  QPointer<QCPAbstractDataSource> mDataSource;
   QPen mErrorPen;
   LineStyle mLineStyle;
   QCP::ScatterStyle mScatterStyle;
@@ -146,29 +351,42 @@ protected:
   double mErrorBarSize;
   bool mErrorBarSkipSymbol;
   QCPGraph *mChannelFillGraph;
+  bool mAdaptiveSampling;
+  bool mLodIndex;
+  int mDataCapacity;
+  mutable CachedRange mKeyRangeCache[3][2], mValueRangeCache[3][2]; // indexed by sign domain and whether errors are included
+  mutable CachedGeometry mGeometryCache;
+  mutable QMutex mGeometryCacheMutex;
 
   virtual void draw(QCPPainter *painter);
   virtual void drawLegendIcon(QCPPainter *painter, const QRect &rect) const;
 
   // functions to generate plot data points in pixel coordinates:
-  void getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
+  void getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getCachedPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride) const;
+  CachedAxisState cachedAxisState(QCPAxis *axis) const;
   // plot style specific functions to generate plot data, used by getPlotData:
-  void getScatterPlotData(QVector<QCPData> *pointData) const;
-  void getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
-  void getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
-  void getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
-  void getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
-  void getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData) const;
+  void getScatterPlotData(QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getLinePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getStepLeftPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getStepRightPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getStepCenterPlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
+  void getImpulsePlotData(QVector<QPointF> *lineData, QVector<QCPData> *pointData, int draftStride, const QCPRange &keyRange) const;
   
   // helper functions for drawing:
-  virtual void drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const;
-  virtual void drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData) const;
+  virtual void drawFill(QCPPainter *painter, QVector<QPointF> *lineData, int draftStride) const;
+  virtual void drawScatterPlot(QCPPainter *painter, QVector<QCPData> *pointData, int draftStride) const;
   virtual void drawLinePlot(QCPPainter *painter, QVector<QPointF> *lineData) const;
   virtual void drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData) const;
-  void drawError(QCPPainter *painter, double x, double y, const QCPData &data) const;
+  void getErrorBarLines(QVector<QLineF> *lines, const QVector<QCPData> *pointData, const QVector<qreal> &keyPixels, const QVector<qreal> &valuePixels) const;
+  void addErrorBarLines(QVector<QLineF> *lines, bool verticalSpine, double spinePos, double symbolPos, double a, double b, bool skipSymbol) const;
   
   // helper functions:
-  void getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper, int &count) const;
+  void getVisibleDataBounds(int &lower, int &upper, int &count, const QCPRange &keyRange) const;
+  QCPDataView getLineSourceData(int lower, int upper, QVector<QCPData> *sampledData, int draftStride) const;
+  void getAdaptiveSampledData(QVector<QCPData> *sampledData, int lower, int upper) const;
+  void getLodSampledData(QVector<QCPData> *sampledData, int lower, int upper) const;
+  void getPixelCoords(const QCPDataView &data, QVector<qreal> *keyPixels, QVector<qreal> *valuePixels) const;
   void addFillBasePoints(QVector<QPointF> *lineData) const;
   void removeFillBasePoints(QVector<QPointF> *lineData) const;
   QPointF lowerFillBasePoint(double lowerKey) const;
@@ -183,6 +401,9 @@ protected:
   virtual QCPRange getValueRange(bool &validRange, SignDomain inSignDomain=sdBoth) const;
   virtual QCPRange getKeyRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const; // overloads base class interface
   virtual QCPRange getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const; // overloads base class interface
+  QCPRange getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors, const QCPRange &inKeyRange) const;
+  void accumulateKeyRange(CachedRange &cache, SignDomain inSignDomain, bool includeErrors, int begin, int end) const;
+  void accumulateValueRange(CachedRange &cache, SignDomain inSignDomain, bool includeErrors, int begin, int end) const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
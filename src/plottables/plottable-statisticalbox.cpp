@@ -418,11 +418,10 @@ void QCPStatisticalBox::drawOutliers(QCPPainter *painter) const
   applyScattersAntialiasingHint(painter);
   painter->setPen(mOutlierPen);
   painter->setBrush(Qt::NoBrush);
+  QVector<QPointF> scatters(mOutliers.size());
   for (int i=0; i<mOutliers.size(); ++i)
-  {
-    QPointF dataPoint = coordsToPixels(mKey, mOutliers.at(i));
-    painter->drawScatter(dataPoint.x(), dataPoint.y(), mOutlierSize, mOutlierStyle);
-  }
+    scatters[i] = coordsToPixels(mKey, mOutliers.at(i));
+  painter->drawScatters(scatters, mOutlierSize, mOutlierStyle);
 }
 
 /* inherits documentation from base class */
@@ -15,6 +15,8 @@ private slots:
   void QCPGraph_Standard();
   void QCPGraph_ManyPoints();
   void QCPGraph_ManyLines();
+  void QCPGraph_ChunkedPolyline_data();
+  void QCPGraph_ChunkedPolyline();
   
   void QCPAxis_TickLabels();
   void QCPAxis_TickLabelsCached();
@@ -136,6 +138,62 @@ void Benchmark::QCPGraph_ManyLines()
   }
 }
 
+void Benchmark::QCPGraph_ChunkedPolyline_data()
+{
+  QTest::addColumn<QPen>("pen");
+  QTest::addColumn<bool>("antialiased");
+  QTest::addColumn<int>("chunkSize");
+  
+  // compare chunk sizes for each pen type, chunk size 0 draws the line as a single polyline, -1
+  // chooses the chunk size per pen:
+  QList<int> chunkSizes;
+  chunkSizes << 0 << -1 << 50 << 100 << 200 << 500 << 1000 << 5000;
+  QList<QPair<QString, QPen> > pens;
+  pens << qMakePair(QString("cosmetic"), QPen(Qt::blue));
+  pens << qMakePair(QString("wide"), QPen(QBrush(Qt::blue), 3));
+  pens << qMakePair(QString("dashed"), QPen(QBrush(Qt::blue), 1, Qt::DashLine));
+  pens << qMakePair(QString("wide dashed"), QPen(QBrush(Qt::blue), 3, Qt::DashLine));
+  for (int p=0; p<pens.size(); ++p)
+  {
+    for (int aa=1; aa>=0; --aa)
+    {
+      for (int c=0; c<chunkSizes.size(); ++c)
+      {
+        QString chunkName = chunkSizes.at(c) < 0 ? QString("auto") : QString::number(chunkSizes.at(c));
+        QString name = QString("%1 %2 chunk %3").arg(pens.at(p).first).arg(aa ? "aa" : "noaa").arg(chunkName);
+        QTest::newRow(name.toLatin1().constData()) << pens.at(p).second << (bool)aa << chunkSizes.at(c);
+      }
+    }
+  }
+}
+
+void Benchmark::QCPGraph_ChunkedPolyline()
+{
+  QFETCH(QPen, pen);
+  QFETCH(bool, antialiased);
+  QFETCH(int, chunkSize);
+  
+  QCPGraph *graph = mPlot->addGraph();
+  graph->setPen(pen);
+  graph->setAntialiased(antialiased);
+  graph->setAdaptiveSampling(false); // keep all points, so the polyline is long
+  mPlot->setPolylineChunkSize(chunkSize);
+  int n = 100000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i] = i/(double)n;
+    y[i] = qSin(x[i]*10*M_PI) + qrand()/(double)RAND_MAX*0.5;
+  }
+  graph->setData(x, y);
+  mPlot->rescaleAxes();
+  
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
 void Benchmark::QCPAxis_TickLabels()
 {
   mPlot->setPlottingHint(QCP::phCacheLabels, false);